@@ -16,6 +16,8 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
 #include <Library/IoLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -49,7 +51,7 @@ IsNumber( CHAR16* str )
 }
 
 
-EFI_STATUS
+static EFI_STATUS
 TurnOnSpeaker( VOID )
 {
     UINT8 Data;
@@ -62,7 +64,7 @@ TurnOnSpeaker( VOID )
 }
 
 
-EFI_STATUS
+static EFI_STATUS
 TurnOffSpeaker( VOID )
 {
     UINT8 Data;
@@ -89,14 +91,14 @@ GenerateBeep( UINTN NumberBeeps )
 }
 
 
-VOID
+static VOID
 Usage( BOOLEAN ErrorMsg )
 {
     if ( ErrorMsg ) {
-        Print(L"ERROR: Unknown option(s).\n");
+        OutPrint(L"ERROR: Unknown option(s).\n");
     }
-    Print(L"Usage: Beep [NumberOfBeeps]\n");
-    Print(L"       Beep [-V | --version]\n");
+    OutPrint(L"Usage: Beep [--json | --csv] [-o | --output filename] [NumberOfBeeps]\n");
+    OutPrint(L"       Beep [-V | --version]\n");
 }
 
 
@@ -108,10 +110,13 @@ ShellAppMain( UINTN Argc,
     EFI_STATUS Status = EFI_SUCCESS;
     UINTN NumberBeeps = 1;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -120,7 +125,7 @@ ShellAppMain( UINTN Argc,
         } else if (IsNumber(Argv[1])) {
             NumberBeeps = (UINTN) StrDecimalToUint64( Argv[1] );            
             if (NumberBeeps < 1) {
-                Print(L"ERROR: Invalid number of beeps\n");               
+                EmitError(L"Invalid number of beeps");               
                 Usage(FALSE);
                 return Status;
             } 
@@ -136,5 +141,9 @@ ShellAppMain( UINTN Argc,
 
     Status = GenerateBeep( NumberBeeps );
 
+    EmitBegin(L"Beep", UTILITY_VERSION);
+    EmitUint(L"beeps", NumberBeeps);
+    EmitString(L"status", EFI_ERROR(Status) ? L"failed" : L"ok");
+
     return Status;
 }
@@ -18,6 +18,9 @@
 #include <Library/ShellLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+#include <Library/PlatformIndexLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -27,11 +30,27 @@
 
 
 VOID
+PrintBootFwUi( BOOLEAN SupportBootFwUi,
+               BOOLEAN BootFwUi )
+{
+    if (EmitFormat() != EmitText) {
+        EmitBool(L"supported", SupportBootFwUi);
+        EmitBool(L"set", BootFwUi);
+        return;
+    }
+
+    OutPrint(L"  Boot to Firmware UI: %s. Current value is %s.\n", SupportBootFwUi ? L"Supported" : L"Unsupported", 
+                                                                   BootFwUi ? L"SET" : L"UNSET");
+}
+
+
+static VOID
 Usage( VOID )
 {
-    Print(L"Usage: BootFWUI [-s | --set]\n");
-    Print(L"                [-u | --unset]\n");
-    Print(L"                [-V | --version]\n");
+    OutPrint(L"Usage: BootFWUI [-s | --set]\n");
+    OutPrint(L"                [-u | --unset]\n");
+    OutPrint(L"                [--json | --csv] [-o | --output filename]\n");
+    OutPrint(L"                [-V | --version]\n");
 }
 
 
@@ -49,10 +68,13 @@ ShellAppMain( UINTN Argc,
     UINTN      DataSize;
     UINT32     Attributes;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--version") || 
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--set") ||
             !StrCmp(Argv[1], L"-s")) {
@@ -74,43 +96,43 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
+    EmitBegin(L"BootFWUI", UTILITY_VERSION);
 
     DataSize = sizeof(UINT64);
 
-    Status = gRT->GetVariable( EFI_OS_INDICATIONS_SUPPORT_VARIABLE_NAME,
-                               &gEfiGlobalVariableGuid,
-                               &Attributes,
-                               &DataSize,
-                               &OsIndicationsSupported);
+    Status = VarCacheGet( EFI_OS_INDICATIONS_SUPPORT_VARIABLE_NAME,
+                          &gEfiGlobalVariableGuid,
+                          &Attributes,
+                          &DataSize,
+                          &OsIndicationsSupported);
     if (Status == EFI_NOT_FOUND) {
-        Print(L"ERROR: OsIndicationsSupported variable not found.\n");
+        EmitError(L"OsIndicationsSupported variable not found.");
         return Status;
     }
 
 #ifdef DEBUG
-    Print(L"OSIndicationsSupported variable found: 0x%016x\n", OsIndicationSupport );
+    OutPrint(L"OSIndicationsSupported variable found: 0x%016x\n", OsIndicationSupport );
 #endif
 
-    Status = gRT->GetVariable( EFI_OS_INDICATIONS_VARIABLE_NAME,
-                               &gEfiGlobalVariableGuid,
-                               &Attributes,
-                               &DataSize,
-                               &OsIndications);
+    Status = VarCacheGet( EFI_OS_INDICATIONS_VARIABLE_NAME,
+                          &gEfiGlobalVariableGuid,
+                          &Attributes,
+                          &DataSize,
+                          &OsIndications);
     if (Status == EFI_NOT_FOUND) {
-        Print(L"ERROR: OsIndications variable not found.\n");
+        EmitError(L"OsIndications variable not found.");
         return Status;
     }
 
 #ifdef DEBUG
-    Print(L"OsIndications variable: 0x%016x\n", OsIndication);
+    OutPrint(L"OsIndications variable: 0x%016x\n", OsIndication);
 #endif
 
     SupportBootFwUi = (BOOLEAN) ((OsIndicationsSupported & EFI_OS_INDICATIONS_BOOT_TO_FW_UI) != 0);
     BootFwUi = (BOOLEAN) ((OsIndications & EFI_OS_INDICATIONS_BOOT_TO_FW_UI) != 0);
 
     if (Set == FALSE && Unset == FALSE) {
-        Print(L"  Boot to Firmware UI: %s. Current value is %s.\n", SupportBootFwUi ? L"Supported" : L"Unsupported", 
-                                                                    BootFwUi ? L"SET" : L"UNSET");
+        PrintBootFwUi(SupportBootFwUi, BootFwUi);
         return Status;
     }
 
@@ -120,35 +142,34 @@ ShellAppMain( UINTN Argc,
         OsIndications |= EFI_OS_INDICATIONS_BOOT_TO_FW_UI;
     }
 
-    Status = gRT->SetVariable( EFI_OS_INDICATIONS_VARIABLE_NAME, 
-                               &gEfiGlobalVariableGuid,
-                               EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_BOOTSERVICE_ACCESS,
-                               sizeof (OsIndications),
-                               &OsIndications);
+    Status = VarCacheSet( EFI_OS_INDICATIONS_VARIABLE_NAME, 
+                          &gEfiGlobalVariableGuid,
+                          EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                          sizeof (OsIndications),
+                          &OsIndications);
     if (Status != EFI_SUCCESS) {
-        Print(L"ERROR: SetVariable: %d\n", Status);
+        EmitError(L"SetVariable: %d", Status);
         return Status;
     }
     
     // check value actually changed!
-    Status = gRT->GetVariable( EFI_OS_INDICATIONS_VARIABLE_NAME,
-                               &gEfiGlobalVariableGuid,
-                               &Attributes,
-                               &DataSize,
-                               &OsIndications);
+    Status = VarCacheGet( EFI_OS_INDICATIONS_VARIABLE_NAME,
+                          &gEfiGlobalVariableGuid,
+                          &Attributes,
+                          &DataSize,
+                          &OsIndications);
     if (Status == EFI_NOT_FOUND) {
-        Print(L"ERROR: OsIndications variable not found.\n");
+        EmitError(L"OsIndications variable not found.");
         return Status;
     }
 
 #ifdef DEBUG
-    Print(L"OsIndications variable: 0x%016x\n", OsIndication);
+    OutPrint(L"OsIndications variable: 0x%016x\n", OsIndication);
 #endif
 
     BootFwUi = (BOOLEAN) ((OsIndications & EFI_OS_INDICATIONS_BOOT_TO_FW_UI) != 0);
 
-    Print(L"  Boot to Firmware UI: %s. Current value is %s.\n", SupportBootFwUi ? L"Supported" : L"Unsupported", 
-                                                                BootFwUi ? L"SET" : L"UNSET");
+    PrintBootFwUi(SupportBootFwUi, BootFwUi);
 
     return Status;
 }
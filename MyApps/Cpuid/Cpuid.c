@@ -16,6 +16,8 @@
 #include <Library/UefiLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
 
 #include <Register/Cpuid.h>
 
@@ -37,7 +39,7 @@ ProcessorSignature( VOID )
     AsmCpuid( CPUID_SIGNATURE, &Eax, &Ebx, &Ecx, &Edx );
 
 #ifdef DEBUG
-    Print(L"  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax, Ebx, Ecx, Edx);
+    OutPrint(L"  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax, Ebx, Ecx, Edx);
 #endif
 
     *(UINT32 *)(Signature + 0) = Ebx;
@@ -45,7 +47,10 @@ ProcessorSignature( VOID )
     *(UINT32 *)(Signature + 8) = Ecx;
     Signature[12] = 0;
 
-    Print(L"    Signature: %a\n", Signature);
+    if (EmitFormat() != EmitText)
+        EmitAscii(L"signature", Signature, 12);
+    else
+        OutPrint(L"    Signature: %a\n", Signature);
 }
 
 
@@ -60,7 +65,7 @@ ProcessorBrandString( VOID )
 
     AsmCpuid(CPUID_BRAND_STRING1, &Eax.Uint32, &Ebx.Uint32, &Ecx.Uint32, &Edx.Uint32);
 #ifdef DEBUG
-    Print(L"  String1:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
+    OutPrint(L"  String1:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
 #endif
     BrandString[0] = Eax.Uint32;
     BrandString[1] = Ebx.Uint32;
@@ -69,7 +74,7 @@ ProcessorBrandString( VOID )
 
     AsmCpuid(CPUID_BRAND_STRING2, &Eax.Uint32, &Ebx.Uint32, &Ecx.Uint32, &Edx.Uint32);
 #ifdef DEBUG
-    Print(L"  String2:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
+    OutPrint(L"  String2:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
 #endif
     BrandString[4] = Eax.Uint32;
     BrandString[5] = Ebx.Uint32;
@@ -78,7 +83,7 @@ ProcessorBrandString( VOID )
 
     AsmCpuid(CPUID_BRAND_STRING3, &Eax.Uint32, &Ebx.Uint32, &Ecx.Uint32, &Edx.Uint32);
 #ifdef DEBUG
-    Print(L"  String3:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
+    OutPrint(L"  String3:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
 #endif
     BrandString[8]  = Eax.Uint32;
     BrandString[9]  = Ebx.Uint32;
@@ -87,7 +92,10 @@ ProcessorBrandString( VOID )
 
     BrandString[12] = 0;
 
-    Print (L"   CPU String: %a\n", (CHAR8 *)BrandString);
+    if (EmitFormat() != EmitText)
+        EmitAscii(L"cpuString", (CHAR8 *)BrandString, 48);
+    else
+        OutPrint(L"   CPU String: %a\n", (CHAR8 *)BrandString);
 }
 
 
@@ -106,7 +114,7 @@ ProcessorVersionInfo( VOID )
 
     AsmCpuid(CPUID_VERSION_INFO, &Eax.Uint32, &Ebx.Uint32, &Ecx.Uint32, &Edx.Uint32);
 #ifdef DEBUG
-    Print(L"  VersionInfo:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
+    OutPrint(L"  VersionInfo:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
 #endif
 
     DisplayFamily = Eax.Bits.FamilyId;
@@ -119,9 +127,16 @@ ProcessorVersionInfo( VOID )
         DisplayModel |= (Eax.Bits.ExtendedModelId << 4);
     }
 
-    Print(L"       Family: 0x%x\n", DisplayFamily);
-    Print(L"        Model: 0x%x\n", DisplayModel);
-    Print(L"     Stepping: 0x%x\n", Eax.Bits.SteppingId);
+    if (EmitFormat() != EmitText) {
+        EmitUint(L"family", DisplayFamily);
+        EmitUint(L"model", DisplayModel);
+        EmitUint(L"stepping", Eax.Bits.SteppingId);
+        return;
+    }
+
+    OutPrint(L"       Family: 0x%x\n", DisplayFamily);
+    OutPrint(L"        Model: 0x%x\n", DisplayModel);
+    OutPrint(L"     Stepping: 0x%x\n", Eax.Bits.SteppingId);
 }
 
 
@@ -144,22 +159,23 @@ ProcessorFeatures( VOID )
     CHAR16                     Buf[80];
     UINT8                      Width = WIDTH;
     CHAR16                     *f = Features;
+    CHAR16                     *Name;
 
     ZeroMem( Features, 1000 );
 
     AsmCpuid(CPUID_VERSION_INFO, &Eax.Uint32, &Ebx.Uint32, &Ecx.Uint32, &Edx.Uint32);
 #ifdef DEBUG
-    Print(L"  Features:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
+    OutPrint(L"  Features:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", Eax.Uint32, Ebx.Uint32, Ecx.Uint32, Edx.Uint32);
 #endif
 
     AsmCpuid(CPUID_EXTENDED_CPU_SIG, &xEax, NULL, &xEcx.Uint32, &xEdx.Uint32);
 #ifdef DEBUG
-    Print (L"  Extended Features:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", xEax, 0, xEcx.Uint32, xEdx.Uint32);
+    OutPrint(L"  Extended Features:  EAX:%08x  EBX:%08x  ECX:%08x  EDX:%08x\n", xEax, 0, xEcx.Uint32, xEdx.Uint32);
 #endif
 
     // Presorted list. No sorting routine!
     if (Edx.Bits.ACPI) StrCat(Features, L" ACPI");             // ACPI via MSR Support
-    if (Ecx.Bits.AESNI) StrCat(Features, L" AESNT");
+    if (Ecx.Bits.AESNI) StrCat(Features, L" AESNI");
     if (Edx.Bits.APIC) StrCat(Features, L" APIC");
     if (Ecx.Bits.AVX) StrCat(Features, L" AVX");               // Advanced Vector Extensions
     if (Edx.Bits.CLFSH) StrCat(Features, L" CLFSH");           // CLFLUSH (Cache Line Flush) Instruction Support
@@ -225,7 +241,24 @@ ProcessorFeatures( VOID )
     if (Ecx.Bits.XSAVE) StrCat(Features, L" XSAVE");                             // Save Processor Extended States
     if (Ecx.Bits.xTPR_Update_Control) StrCat(Features, L" XTPR_UPDATE_CONTROL"); // Change IA32_MISC_ENABLE Support
 
-    Print(L"     Features:");
+    if (EmitFormat() != EmitText) {
+        EmitArray(L"features");
+        while (*f) {
+            while (*f == L' ')
+                f++;
+            Name = f;
+            while (*f && *f != L' ')
+                f++;
+            if (*f)
+                *f++ = CHAR_NULL;
+            if (*Name)
+                EmitString(NULL, Name);
+        }
+        EmitClose();
+        return;
+    }
+
+    OutPrint(L"     Features:");
 
     // Not the most elegant output folding code but it works!
     ZeroMem( Buf, 80 );
@@ -237,10 +270,10 @@ ProcessorFeatures( VOID )
                  f--; Col--;
              } 
              if (FirstRow) {
-                 Print(L"%s\n", Buf);
+                 OutPrint(L"%s\n", Buf);
                  FirstRow = FALSE;
              } else {
-                 Print(L"              %s\n", Buf);
+                 OutPrint(L"              %s\n", Buf);
              }
              ZeroMem(Buf,80);
              Col = 0;
@@ -248,22 +281,63 @@ ProcessorFeatures( VOID )
     }
     if (Col) {
         if (FirstRow) {
-            Print(L"%s\n", Buf);
+            OutPrint(L"%s\n", Buf);
         } else {
-            Print(L"              %s\n", Buf);
+            OutPrint(L"              %s\n", Buf);
         }
     }
 }
 
 
+//
+// Raw registers of each standard and extended leaf (subleaf 0), for
+// machine readable output only
+//
 VOID
+ProcessorLeaves( VOID )
+{
+    UINT32 Eax, Ebx, Ecx, Edx;
+    UINT32 MaxLeaf, Leaf;
+
+    EmitArray(L"leaves");
+
+    AsmCpuid(CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+    for (Leaf = 0; Leaf <= MaxLeaf && Leaf < 0x100; Leaf++) {
+        AsmCpuidEx(Leaf, 0, &Eax, &Ebx, &Ecx, &Edx);
+        EmitObject(NULL);
+        EmitHex(L"leaf", Leaf, 8);
+        EmitHex(L"eax", Eax, 8);
+        EmitHex(L"ebx", Ebx, 8);
+        EmitHex(L"ecx", Ecx, 8);
+        EmitHex(L"edx", Edx, 8);
+        EmitClose();
+    }
+
+    AsmCpuid(CPUID_EXTENDED_FUNCTION, &MaxLeaf, NULL, NULL, NULL);
+    for (Leaf = CPUID_EXTENDED_FUNCTION; Leaf <= MaxLeaf && Leaf < CPUID_EXTENDED_FUNCTION + 0x100; Leaf++) {
+        AsmCpuidEx(Leaf, 0, &Eax, &Ebx, &Ecx, &Edx);
+        EmitObject(NULL);
+        EmitHex(L"leaf", Leaf, 8);
+        EmitHex(L"eax", Eax, 8);
+        EmitHex(L"ebx", Ebx, 8);
+        EmitHex(L"ecx", Ecx, 8);
+        EmitHex(L"edx", Edx, 8);
+        EmitClose();
+    }
+
+    EmitClose();
+}
+
+
+static VOID
 Usage( BOOLEAN ErrorMsg )
 {
     if ( ErrorMsg ) {
-        Print(L"ERROR: Unknown option(s).\n");
+        OutPrint(L"ERROR: Unknown option(s).\n");
     }
 
-    Print(L"Usage: Cpuid [ -V | --version ]\n");
+    OutPrint(L"Usage: Cpuid [ --json | --csv ] [ -o | --output filename ]\n");
+    OutPrint(L"       Cpuid [ -V | --version ]\n");
 }
 
 
@@ -274,10 +348,13 @@ ShellAppMain( UINTN Argc,
 {
     EFI_STATUS Status = EFI_SUCCESS;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -293,12 +370,22 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
-    Print(L"\n");
+    if (EmitFormat() != EmitText) {
+        EmitBegin(L"Cpuid", UTILITY_VERSION);
+        ProcessorSignature();
+        ProcessorBrandString();
+        ProcessorVersionInfo();
+        ProcessorFeatures();
+        ProcessorLeaves();
+        return Status;
+    }
+
+    OutPrint(L"\n");
     ProcessorSignature();
     ProcessorBrandString();
     ProcessorVersionInfo();
     ProcessorFeatures();
-    Print(L"\n");
+    OutPrint(L"\n");
 
     return Status;
 }
@@ -17,6 +17,8 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
 
 #include <Protocol/LoadedImage.h>
 #include <Protocol/SimpleFileSystem.h>
@@ -36,8 +38,9 @@ PressKey( BOOLEAN DisplayText )
     UINTN         EventIndex;
 
     if (DisplayText) {
-        Print(L"\nPress any key to continue...\n\n");
+        OutPrint(L"\nPress any key to continue...\n\n");
     }
+    OutFlush();
 
     gBS->WaitForEvent(1, &gST->ConIn->WaitForKey, &EventIndex);
     Status = gST->ConIn->ReadKeyStroke(gST->ConIn, &Key);
@@ -46,7 +49,7 @@ PressKey( BOOLEAN DisplayText )
 }
 
 
-VOID
+static VOID
 AsciiToUnicodeSize( CHAR8 *String,
                     UINT8 length,
                     CHAR16 *UniString )
@@ -82,7 +85,7 @@ DisplayImage( EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop,
     Pixels = BmpHeader->PixelWidth * BmpHeader->PixelHeight;
     BltBuffer = AllocateZeroPool( sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL) * Pixels);
     if (BltBuffer == NULL) {
-        Print(L"ERROR: BltBuffer. No memory resources\n");
+        OutPrint(L"ERROR: BltBuffer. No memory resources\n");
         return EFI_OUT_OF_RESOURCES;
     }
 
@@ -105,7 +108,7 @@ DisplayImage( EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop,
                        BmpHeader->PixelWidth, BmpHeader->PixelHeight, 
                        0 );
     if (EFI_ERROR (Status)) {
-        Print(L"ERROR: Gop->Blt [%d]\n", Status);
+        OutPrint(L"ERROR: Gop->Blt [%d]\n", Status);
     }            
 
     FreePool(BltBuffer);
@@ -126,20 +129,20 @@ PrintBMP( EFI_HANDLE *BmpBuffer )
 
     // not BMP format
     if (BmpHeader->CharB != 'B' || BmpHeader->CharM != 'M') {
-        Print(L"ERROR: Unsupported image format\n"); 
+        EmitError(L"Unsupported image format");
         return EFI_UNSUPPORTED;
     }
 
     // BITMAPINFOHEADER format unsupported
     if (BmpHeader->HeaderSize != sizeof (BMP_IMAGE_HEADER) \
         - ((UINTN) &(((BMP_IMAGE_HEADER *)0)->HeaderSize))) {
-        Print(L"ERROR: Unsupported BITMAPFILEHEADER\n");
+        EmitError(L"Unsupported BITMAPFILEHEADER");
         return EFI_UNSUPPORTED;
     }
 
     // compression type not 0
     if (BmpHeader->CompressionType != 0) {
-        Print(L"ERROR: Compression type not 0\n");
+        EmitError(L"Compression type not 0");
         return EFI_UNSUPPORTED;
     }
 
@@ -148,41 +151,62 @@ PrintBMP( EFI_HANDLE *BmpBuffer )
         BmpHeader->BitPerPixel != 8 &&
         BmpHeader->BitPerPixel != 12 &&
         BmpHeader->BitPerPixel != 24) {
-        Print(L"ERROR: Bits per pixel is not one of 4, 8, 12 or 24\n");
+        EmitError(L"Bits per pixel is not one of 4, 8, 12 or 24");
         return EFI_UNSUPPORTED;
     }
 
+    if (EmitFormat() != EmitText) {
+        EmitObject(L"image");
+        EmitAscii(L"signature", (CHAR8 *)BmpHeader, 2);
+        EmitUint(L"size", BmpHeader->Size);
+        EmitUint(L"imageOffset", BmpHeader->ImageOffset);
+        EmitUint(L"headerSize", BmpHeader->HeaderSize);
+        EmitUint(L"width", BmpHeader->PixelWidth);
+        EmitUint(L"height", BmpHeader->PixelHeight);
+        EmitUint(L"planes", BmpHeader->Planes);
+        EmitUint(L"bitsPerPixel", BmpHeader->BitPerPixel);
+        EmitUint(L"compressionType", BmpHeader->CompressionType);
+        EmitUint(L"imageSize", BmpHeader->ImageSize);
+        EmitUint(L"xPixelsPerMeter", BmpHeader->XPixelsPerMeter);
+        EmitUint(L"yPixelsPerMeter", BmpHeader->YPixelsPerMeter);
+        EmitUint(L"numberOfColors", BmpHeader->NumberOfColors);
+        EmitUint(L"importantColors", BmpHeader->ImportantColors);
+        EmitClose();
+        return Status;
+    }
+
     AsciiToUnicodeSize((CHAR8 *)BmpHeader, 2, Buffer);
 
-    Print(L"\n");
-    Print(L"  BMP Signature      : %s\n", Buffer);
-    Print(L"  Size               : %d\n", BmpHeader->Size);
-    Print(L"  Image Offset       : %d\n", BmpHeader->ImageOffset);
-    Print(L"  Header Size        : %d\n", BmpHeader->HeaderSize);
-    Print(L"  Image Width        : %d\n", BmpHeader->PixelWidth);
-    Print(L"  Image Height       : %d\n", BmpHeader->PixelHeight);
-    Print(L"  Planes             : %d\n", BmpHeader->Planes);
-    Print(L"  Bit Per Pixel      : %d\n", BmpHeader->BitPerPixel);
-    Print(L"  Compression Type   : %d\n", BmpHeader->CompressionType);
-    Print(L"  Image Size         : %d\n", BmpHeader->ImageSize);
-    Print(L"  X Pixels Per Meter : %d\n", BmpHeader->XPixelsPerMeter);
-    Print(L"  Y Pixels Per Meter : %d\n", BmpHeader->YPixelsPerMeter);
-    Print(L"  Number of Colors   : %d\n", BmpHeader->NumberOfColors);
-    Print(L"  Important Colors   : %d\n", BmpHeader->ImportantColors);
+    OutPrint(L"\n");
+    OutPrint(L"  BMP Signature      : %s\n", Buffer);
+    OutPrint(L"  Size               : %d\n", BmpHeader->Size);
+    OutPrint(L"  Image Offset       : %d\n", BmpHeader->ImageOffset);
+    OutPrint(L"  Header Size        : %d\n", BmpHeader->HeaderSize);
+    OutPrint(L"  Image Width        : %d\n", BmpHeader->PixelWidth);
+    OutPrint(L"  Image Height       : %d\n", BmpHeader->PixelHeight);
+    OutPrint(L"  Planes             : %d\n", BmpHeader->Planes);
+    OutPrint(L"  Bit Per Pixel      : %d\n", BmpHeader->BitPerPixel);
+    OutPrint(L"  Compression Type   : %d\n", BmpHeader->CompressionType);
+    OutPrint(L"  Image Size         : %d\n", BmpHeader->ImageSize);
+    OutPrint(L"  X Pixels Per Meter : %d\n", BmpHeader->XPixelsPerMeter);
+    OutPrint(L"  Y Pixels Per Meter : %d\n", BmpHeader->YPixelsPerMeter);
+    OutPrint(L"  Number of Colors   : %d\n", BmpHeader->NumberOfColors);
+    OutPrint(L"  Important Colors   : %d\n", BmpHeader->ImportantColors);
 
     return Status;
 }
 
 
-VOID
+static VOID
 Usage( BOOLEAN ErrorMsg )
 {
     if ( ErrorMsg ) {
-        Print(L"ERROR: Unknown option(s).\n");
+        OutPrint(L"ERROR: Unknown option(s).\n");
     }
 
-    Print(L"Usage: DisplayBMP [-v | --verbose] BMPfilename\n"); 
-    Print(L"       DisplayBMP [-V | --version]\n"); 
+    OutPrint(L"Usage: DisplayBMP [-v | --verbose] BMPfilename\n"); 
+    OutPrint(L"       DisplayBMP [--json | --csv] [-o | --output filename] BMPfilename\n"); 
+    OutPrint(L"       DisplayBMP [-V | --version]\n"); 
 }
 
 
@@ -204,10 +228,13 @@ ShellAppMain( UINTN Argc,
 
     int OrgMode = 0, NewMode = 0, Pixels = 0;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -236,12 +263,14 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
+    EmitBegin(L"DisplayBMP", UTILITY_VERSION);
+
     // Open the file (has to be LAST arguement on command line)
     Status = ShellOpenFileByName( Argv[Argc - 1], 
                                   &FileHandle,
                                   EFI_FILE_MODE_READ , 0);
     if (EFI_ERROR (Status)) {
-        Print(L"ERROR: Could not open specified file [%d]\n", Status);
+        EmitError(L"Could not open specified file [%d]", Status);
         return Status;
     }            
 
@@ -249,7 +278,7 @@ ShellAppMain( UINTN Argc,
     FileInfo = ShellGetFileInfo(FileHandle);    
     FileBuffer = AllocateZeroPool( (UINTN)FileInfo -> FileSize);
     if (FileBuffer == NULL) {
-        Print(L"ERROR: File buffer. No memory resources\n");
+        EmitError(L"File buffer. No memory resources");
         return (SHELL_OUT_OF_RESOURCES);   
     }
 
@@ -257,12 +286,18 @@ ShellAppMain( UINTN Argc,
     FileSize = (UINTN) FileInfo->FileSize;
     Status = ShellReadFile(FileHandle, &FileSize, FileBuffer);
     if (EFI_ERROR (Status)) {
-        Print(L"ERROR: ShellReadFile failed [%d]\n", Status);
+        EmitError(L"ShellReadFile failed [%d]", Status);
         goto cleanup;
     }            
   
     ShellCloseFile(&FileHandle);
 
+    // the header is all there is to describe, the image is not shown
+    if (EmitFormat() != EmitText) {
+        Status = PrintBMP(FileBuffer);
+        goto cleanup;
+    }
+
     if (Verbose) {
          PrintBMP(FileBuffer);
          PressKey(TRUE); 
@@ -275,12 +310,12 @@ ShellAppMain( UINTN Argc,
                                       &HandleCount,
                                       &Handles );
     if (EFI_ERROR (Status)) {
-        Print(L"ERROR: No GOP handles found via LocateHandleBuffer\n");
+        EmitError(L"No GOP handles found via LocateHandleBuffer");
         goto cleanup;
     } 
 
 #ifdef DEBUG
-    Print(L"Found %d GOP handles via LocateHandleBuffer\n", HandleCount);
+    OutPrint(L"Found %d GOP handles via LocateHandleBuffer\n", HandleCount);
 #endif
 
     // Make sure we use the correct GOP handle
@@ -300,7 +335,7 @@ ShellAppMain( UINTN Argc,
      }
      FreePool(Handles);
      if (Gop == NULL) {
-         Print(L"Exiting. Graphics console not found.\n");
+         OutPrint(L"Exiting. Graphics console not found.\n");
          goto cleanup;
      }
 
@@ -315,6 +350,7 @@ ShellAppMain( UINTN Argc,
                                  &SizeOfInfo,
                                  &Info );
         if (EFI_ERROR(Status) && Status == EFI_NOT_STARTED) {
+            OutFlush();
             Gop->SetMode( Gop, 
                           Gop->Mode->Mode );
             Status = Gop->QueryMode( Gop,
@@ -332,14 +368,15 @@ ShellAppMain( UINTN Argc,
     }
 
 #ifdef DEBUG
-    Print(L"OrgMode; %d  NewMode: %d\n", OrgMode, NewMode);
+    OutPrint(L"OrgMode; %d  NewMode: %d\n", OrgMode, NewMode);
 #endif
    
     // Change screen mode 
+    OutFlush();
     Status = Gop->SetMode( Gop,
                            NewMode );
     if (EFI_ERROR (Status)) { 
-        Print(L"ERROR: SetMode [%d]\n", Status);
+        EmitError(L"SetMode [%d]", Status);
         goto cleanup;
     }
         
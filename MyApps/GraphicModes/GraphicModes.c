@@ -19,6 +19,8 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
 
 #include <Protocol/GraphicsOutput.h>
 #include <Protocol/UgaDraw.h>
@@ -44,29 +46,29 @@ PrintCCP( EFI_CONSOLE_CONTROL_PROTOCOL *ConsoleControl )
                                       &GopUgaExists,
                                       &StdInLocked );
     if (EFI_ERROR (Status)) {
-        Print(L"ERROR: ConsoleControl GetMode failed [%d]\n", Status );
+        OutPrint(L"ERROR: ConsoleControl GetMode failed [%d]\n", Status );
         return Status;
     }
 
-    Print(L"  CCP: Current screen mode: ");
+    OutPrint(L"  CCP: Current screen mode: ");
     switch (Mode) {
        case EfiConsoleControlScreenText:
-           Print(L"Text");
+           OutPrint(L"Text");
            break;
        case EfiConsoleControlScreenGraphics:
-           Print(L"Graphics");
+           OutPrint(L"Graphics");
            break;
        case EfiConsoleControlScreenMaxValue:
-           Print(L"MaxValue");
+           OutPrint(L"MaxValue");
            break;
     }
-    Print(L"\n");
-    Print(L"       Graphics support available: ");
+    OutPrint(L"\n");
+    OutPrint(L"       Graphics support available: ");
     if (GopUgaExists) 
-        Print(L"Yes");
+        OutPrint(L"Yes");
     else
-        Print(L"No");
-    Print(L"\n");
+        OutPrint(L"No");
+    OutPrint(L"\n");
 
     return EFI_SUCCESS;
 }
@@ -87,11 +89,11 @@ CheckCCP( BOOLEAN Verbose )
                                   (VOID **) &ConsoleControl );
     if (EFI_ERROR (Status)) {
         if (Verbose) {
-            Print(L"No ConsoleControl handle found via HandleProtocol\n");
+            OutPrint(L"No ConsoleControl handle found via HandleProtocol\n");
         }
     } else {
         if (Verbose) {
-            Print(L"ConsoleControl handle found via HandleProtocol\n");
+            OutPrint(L"ConsoleControl handle found via HandleProtocol\n");
         }
         PrintCCP(ConsoleControl);
         if (Verbose == FALSE) {
@@ -105,11 +107,11 @@ CheckCCP( BOOLEAN Verbose )
                                   (VOID **) &ConsoleControl );
     if (EFI_ERROR(Status) || ConsoleControl == NULL) {
         if (Verbose) {
-            Print(L"No ConsoleControl handle found via LocateProtocol\n");
+            OutPrint(L"No ConsoleControl handle found via LocateProtocol\n");
         }
     } else {
         if (Verbose) {
-            Print(L"Found ConsoleControl handle via LocateProtocol\n");
+            OutPrint(L"Found ConsoleControl handle via LocateProtocol\n");
         }
         PrintCCP(ConsoleControl);
         if (Verbose == FALSE) {
@@ -125,11 +127,11 @@ CheckCCP( BOOLEAN Verbose )
                                       &HandleBuffer );
     if (EFI_ERROR (Status)) {
         if (Verbose) {
-            Print(L"No ConsoleControl handles found via LocateHandleBuffer\n");
+            OutPrint(L"No ConsoleControl handles found via LocateHandleBuffer\n");
         }
     } else {
         if (Verbose) {
-            Print(L"Found %d ConsoleControl handle(s) via LocateHandleBuffer\n", HandleCount);
+            OutPrint(L"Found %d ConsoleControl handle(s) via LocateHandleBuffer\n", HandleCount);
         }
         for (int i = 0; i < HandleCount; i++) {
             Status = gBS->HandleProtocol( HandleBuffer[i],
@@ -163,13 +165,13 @@ PrintUGA( EFI_UGA_DRAW_PROTOCOL *Uga )
                            &ColorDepth, 
                            &RefreshRate );
     if (EFI_ERROR (Status)) {
-        Print(L"ERROR: UGA GetMode failed [%d]\n", Status );
+        OutPrint(L"ERROR: UGA GetMode failed [%d]\n", Status );
     } else {
-        Print(L"  UGA Horizontal Resolution: %d\n", HorzResolution);
-        Print(L"      Vertical Resolution: %d\n", VertResolution);
-        Print(L"      Color Depth: %d\n", ColorDepth);
-        Print(L"      Refresh Rate: %d\n", RefreshRate);
-        Print(L"\n");
+        OutPrint(L"  UGA Horizontal Resolution: %d\n", HorzResolution);
+        OutPrint(L"      Vertical Resolution: %d\n", VertResolution);
+        OutPrint(L"      Color Depth: %d\n", ColorDepth);
+        OutPrint(L"      Refresh Rate: %d\n", RefreshRate);
+        OutPrint(L"\n");
     }
 
     return Status;
@@ -191,11 +193,11 @@ CheckUGA( BOOLEAN Verbose )
                                   (VOID **) &Uga );
     if (EFI_ERROR (Status)) {
         if (Verbose) {
-            Print(L"No UGA handle found via HandleProtocol\n");
+            OutPrint(L"No UGA handle found via HandleProtocol\n");
         }
     } else {
         if (Verbose) {
-            Print(L"UGA handle found via HandleProtocol\n");
+            OutPrint(L"UGA handle found via HandleProtocol\n");
         }
         PrintUGA(Uga);
         UGAsupport = TRUE;
@@ -210,11 +212,11 @@ CheckUGA( BOOLEAN Verbose )
                                   (VOID **) &Uga );
     if (EFI_ERROR(Status) || Uga == NULL) {
         if (Verbose) {
-            Print(L"No UGA handle found via LocateProtocol\n");
+            OutPrint(L"No UGA handle found via LocateProtocol\n");
         }
     } else {
         if (Verbose) {
-            Print(L"Found UGA handle via LocateProtocol\n");
+            OutPrint(L"Found UGA handle via LocateProtocol\n");
         }
         PrintUGA(Uga);
         UGAsupport = TRUE;
@@ -231,11 +233,11 @@ CheckUGA( BOOLEAN Verbose )
                                       &HandleBuffer );
     if (EFI_ERROR (Status)) {
         if (Verbose) {
-            Print(L"No UGA handles found via LocateHandleBuffer\n");
+            OutPrint(L"No UGA handles found via LocateHandleBuffer\n");
         }
     } else {
         if (Verbose) {
-            Print(L"Found %d UGA handle(s) via LocateHandleBuffer\n", HandleCount);
+            OutPrint(L"Found %d UGA handle(s) via LocateHandleBuffer\n", HandleCount);
         }
         for (int i = 0; i < HandleCount; i++) {
             Status = gBS->HandleProtocol( HandleBuffer[i],
@@ -252,13 +254,32 @@ CheckUGA( BOOLEAN Verbose )
         FreePool(HandleBuffer);
     }
     if (UGAsupport == FALSE) {
-        Print(L"  UGA: No support found for this protocol\n");
+        OutPrint(L"  UGA: No support found for this protocol\n");
     }
 
     return Status;
 }
 
 
+VOID
+EmitGOPMode( EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop,
+             UINT32 ModeNumber,
+             EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info )
+{
+    static CONST CHAR16 *PixelFormats[] = { L"RGBReserved", L"BGRReserved", L"BitMask", L"BltOnly" };
+
+    EmitObject(NULL);
+    EmitUint(L"mode", ModeNumber);
+    EmitUint(L"width", Info->HorizontalResolution);
+    EmitUint(L"height", Info->VerticalResolution);
+    EmitString(L"pixelFormat", Info->PixelFormat < ARRAY_SIZE(PixelFormats) ? PixelFormats[Info->PixelFormat]
+                                                                            : L"Invalid");
+    EmitUint(L"pixelsPerScanLine", Info->PixelsPerScanLine);
+    EmitBool(L"current", ModeNumber == Gop->Mode->Mode);
+    EmitClose();
+}
+
+
 EFI_STATUS
 PrintGOP( EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop )
 {
@@ -267,7 +288,10 @@ PrintGOP( EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop )
 
     imax = Gop->Mode->MaxMode;
 
-    Print(L"  GOP: %d supported graphic modes\n", imax);
+    if (EmitFormat() != EmitText)
+        EmitArray(L"modes");
+    else
+        OutPrint(L"  GOP: %d supported graphic modes\n", imax);
 
     for (i = 0; i < imax; i++) {
          EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info;
@@ -278,6 +302,7 @@ PrintGOP( EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop )
                                   &SizeOfInfo,
                                   &Info );
          if (EFI_ERROR(Status) && Status == EFI_NOT_STARTED) {
+             OutFlush();
              Gop->SetMode( Gop, 
                            Gop->Mode->Mode );
              Status = Gop->QueryMode( Gop,
@@ -287,36 +312,43 @@ PrintGOP( EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop )
          }
 
          if (EFI_ERROR(Status)) {
-             Print(L"ERROR: Bad response from QueryMode: %d\n", Status);
+             EmitError(L"Bad response from QueryMode: %d", Status);
+             continue;
+         }
+         if (EmitFormat() != EmitText) {
+             EmitGOPMode(Gop, i, Info);
              continue;
          }
-         Print(L"       %c%d: %dx%d ", memcmp(Info,Gop->Mode->Info,sizeof(*Info)) == 0 ? '*' : ' ', i,
-                                       Info->HorizontalResolution,
-                                       Info->VerticalResolution);
+         OutPrint(L"       %c%d: %dx%d ", memcmp(Info,Gop->Mode->Info,sizeof(*Info)) == 0 ? '*' : ' ', i,
+                                          Info->HorizontalResolution,
+                                          Info->VerticalResolution);
          switch(Info->PixelFormat) {
              case PixelRedGreenBlueReserved8BitPerColor:
-                  Print(L"RGBRerserved");
+                  OutPrint(L"RGBRerserved");
                   break;
              case PixelBlueGreenRedReserved8BitPerColor:
-                  Print(L"BGRReserved");
+                  OutPrint(L"BGRReserved");
                   break;
              case PixelBitMask:
-                  Print(L"Red:%08x Green:%08x Blue:%08x Reserved:%08x",
-                          Info->PixelInformation.RedMask,
-                          Info->PixelInformation.GreenMask,
-                          Info->PixelInformation.BlueMask,
-                          Info->PixelInformation.ReservedMask);
+                  OutPrint(L"Red:%08x Green:%08x Blue:%08x Reserved:%08x",
+                             Info->PixelInformation.RedMask,
+                             Info->PixelInformation.GreenMask,
+                             Info->PixelInformation.BlueMask,
+                             Info->PixelInformation.ReservedMask);
                           break;
              case PixelBltOnly:
-                  Print(L"(blt only)");
+                  OutPrint(L"(blt only)");
                   break;
              default:
-                  Print(L"(Invalid pixel format)");
+                  OutPrint(L"(Invalid pixel format)");
                   break;
         }
-        Print(L" Pixels %d\n", Info->PixelsPerScanLine);
+        OutPrint(L" Pixels %d\n", Info->PixelsPerScanLine);
     }
 
+    if (EmitFormat() != EmitText)
+        EmitClose();
+
     return EFI_SUCCESS;
 }
 
@@ -334,11 +366,11 @@ CheckGOP( BOOLEAN Verbose )
                                   (VOID **) &Gop );
     if (EFI_ERROR (Status)) {
         if (Verbose) {
-            Print(L"No GOP handle found via HandleProtocol\n");
+            OutPrint(L"No GOP handle found via HandleProtocol\n");
         }
     } else {
         if (Verbose) {
-            Print(L"GOP handle found via HandleProtocol\n");
+            OutPrint(L"GOP handle found via HandleProtocol\n");
         }
         PrintGOP(Gop);
         if (Verbose == FALSE) {
@@ -352,11 +384,11 @@ CheckGOP( BOOLEAN Verbose )
                                   (VOID **) &Gop );
     if (EFI_ERROR(Status) || Gop == NULL) {
         if (Verbose) {
-            Print(L"No GOP handle found via LocateProtocol\n");
+            OutPrint(L"No GOP handle found via LocateProtocol\n");
         }
     } else {
         if (Verbose) {
-            Print(L"Found GOP handle via LocateProtocol\n");
+            OutPrint(L"Found GOP handle via LocateProtocol\n");
         }
         PrintGOP(Gop);
         if (Verbose == FALSE) {
@@ -372,11 +404,11 @@ CheckGOP( BOOLEAN Verbose )
                                       &HandleBuffer );
     if (EFI_ERROR (Status)) {
         if (Verbose) {
-            Print(L"No GOP handles found via LocateHandleBuffer\n");
+            OutPrint(L"No GOP handles found via LocateHandleBuffer\n");
         }
     } else {
         if (Verbose) {
-            Print(L"Found %d GOP handle(s) via LocateHandleBuffer\n", HandleCount);
+            OutPrint(L"Found %d GOP handle(s) via LocateHandleBuffer\n", HandleCount);
         }
         for (int i = 0; i < HandleCount; i++) {
             Status = gBS->HandleProtocol( HandleBuffer[i],
@@ -396,15 +428,16 @@ CheckGOP( BOOLEAN Verbose )
 }
 
 
-VOID
+static VOID
 Usage( BOOLEAN ErrorMsg )
 {
     if ( ErrorMsg ) {
-        Print(L"ERROR: Unknown option(s).\n");
+        OutPrint(L"ERROR: Unknown option(s).\n");
     }
 
-    Print(L"Usage: GraphicModes [ -v | --verbose ]\n");
-    Print(L"       GraphicModes [ -V | --version ]\n");
+    OutPrint(L"Usage: GraphicModes [ -v | --verbose ]\n");
+    OutPrint(L"       GraphicModes [ --json | --csv ] [ -o | --output filename ]\n");
+    OutPrint(L"       GraphicModes [ -V | --version ]\n");
 }
 
 
@@ -416,13 +449,16 @@ ShellAppMain( UINTN Argc,
     EFI_STATUS Status = EFI_SUCCESS;
     BOOLEAN    Verbose = FALSE;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--verbose") ||
             !StrCmp(Argv[1], L"-v")) {
             Verbose = TRUE;
         } else if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -438,13 +474,20 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
-    Print(L"\n");
+    // only the GOP modes are machine readable, CCP and UGA are long gone
+    if (EmitFormat() != EmitText) {
+        EmitBegin(L"GraphicModes", UTILITY_VERSION);
+        CheckGOP(FALSE);
+        return Status;
+    }
+
+    OutPrint(L"\n");
     CheckCCP(Verbose);       // First check for older EDK ConsoleControl protocol support
-    Print(L"\n");
+    OutPrint(L"\n");
     CheckUGA(Verbose);       // Next check for UGA support (probably none)
-    Print(L"\n");
+    OutPrint(L"\n");
     CheckGOP(Verbose);       // Finally check for GOP support 
-    Print(L"\n");
+    OutPrint(L"\n");
 
     return Status;
 }
@@ -0,0 +1,67 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Machine readable output for the MyApps utilities.  A utility describes
+//  what it found as nested objects and arrays of keyed values; in JSON or
+//  CSV mode each call writes its piece straight into the OutputLib buffer,
+//  so nothing is built up in memory first.  In text mode every Emit call
+//  does nothing and the utility prints as it always has.
+//
+//  CSV is for the flat tables: each object in an array is a row and its
+//  values are the columns, with a header row of keys before the first.
+//  Values outside any row are written as key,value lines, and anything
+//  nested inside a row is left out.
+//
+//  License: BSD License
+//
+
+#ifndef _EMIT_LIB_H
+#define _EMIT_LIB_H
+
+#define EMIT_MAX_DEPTH  16
+
+typedef enum {
+    EmitText,
+    EmitJson,
+    EmitCsv
+} EMIT_FORMAT;
+
+//
+//  Take --json, --csv and -o/--output filename out of Argv, moving the
+//  rest down, so that the utility's own option parsing never sees them.
+//  With an output file everything the utility prints goes there, text
+//  included.  Returns an error, having said why, if the file cannot be
+//  created.
+//
+EFI_STATUS  EFIAPI EmitParseArgs(UINTN *Argc, CHAR16 **Argv);
+EMIT_FORMAT EFIAPI EmitFormat(VOID);
+
+//
+//  The document is one object holding the utility's name and version;
+//  EmitEnd closes whatever is still open and the output file, and goes
+//  back to text mode for whatever runs next.  Key is
+//  ignored for the members of an array.  EmitAscii takes at most Length
+//  characters, stops at a NUL and drops trailing spaces, as ACPI ids are
+//  space padded; EmitHex writes a "0x" string of at least Digits digits.
+//
+VOID EFIAPI EmitBegin(CONST CHAR16 *Utility, CONST CHAR16 *Version);
+VOID EFIAPI EmitEnd(VOID);
+VOID EFIAPI EmitObject(CONST CHAR16 *Key);
+VOID EFIAPI EmitArray(CONST CHAR16 *Key);
+VOID EFIAPI EmitClose(VOID);
+
+VOID EFIAPI EmitString(CONST CHAR16 *Key, CONST CHAR16 *Value);
+VOID EFIAPI EmitAscii(CONST CHAR16 *Key, CONST CHAR8 *Value, UINTN Length);
+VOID EFIAPI EmitUint(CONST CHAR16 *Key, UINT64 Value);
+VOID EFIAPI EmitHex(CONST CHAR16 *Key, UINT64 Value, UINTN Digits);
+VOID EFIAPI EmitBool(CONST CHAR16 *Key, BOOLEAN Value);
+VOID EFIAPI EmitGuid(CONST CHAR16 *Key, CONST EFI_GUID *Guid);
+VOID EFIAPI EmitBytes(CONST CHAR16 *Key, CONST VOID *Data, UINTN Length);
+
+//
+//  An error message: an "error" member in JSON and CSV (inside an array,
+//  an object holding just that), ERROR: Message in text mode
+//
+VOID EFIAPI EmitError(CONST CHAR16 *Format, ...);
+
+#endif /* _EMIT_LIB_H */
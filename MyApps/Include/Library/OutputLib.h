@@ -0,0 +1,62 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Buffered console output for the MyApps utilities.  Text is collected
+//  in one buffer and handed to ConOut->OutputString when the buffer fills,
+//  at the end of a line in line-buffered mode, on OutFlush, and when the
+//  utility exits.  Anything that waits for a key, stalls or changes the
+//  video mode should call OutFlush first.
+//
+//  License: BSD License
+//
+
+#ifndef _OUTPUT_LIB_H
+#define _OUTPUT_LIB_H
+
+#define OUTPUT_BUFFER_SIZE  2048        // CHAR16s, terminator included
+#define OUTPUT_PRINT_MAX    512         // longest EmitError message
+
+typedef enum {
+    OutputBuffered,                     // flush when full (the default)
+    OutputLineBuffered,                 // flush after every newline as well
+    OutputUnbuffered
+} OUTPUT_MODE;
+
+//
+//  As Print: PrintLib format, a \n in Format is written as \r\n
+//
+UINTN EFIAPI OutPrint(CONST CHAR16 *Format, ...);
+
+//
+//  String as is, except that a \n not already after a \r becomes \r\n
+//
+VOID  EFIAPI OutString(CONST CHAR16 *String);
+VOID  EFIAPI OutChar(CHAR16 Char);
+
+//
+//  Fixed fields without format parsing: Value in Digits lower case hex
+//  digits, zero padded; Value in decimal, right aligned in Width columns
+//
+VOID  EFIAPI OutHex(UINT64 Value, UINTN Digits);
+VOID  EFIAPI OutDec(UINT64 Value, UINTN Width);
+
+//
+//  Data in the canonical hexdump -C layout: the offset, sixteen bytes in
+//  hex in two groups of eight, then the printable ones between bars.
+//  Offset is the value shown for the first byte.  A run of lines equal to
+//  the one before is shown as a single *, and the offset just past the
+//  data ends the dump.
+//
+VOID  EFIAPI OutHexDump(CONST VOID *Data, UINTN Length, UINT64 Offset);
+
+//
+//  Where flushed output goes instead of ConOut: Length characters, not
+//  terminated.  A NULL Sink puts output back on the console.
+//
+typedef VOID (EFIAPI *OUTPUT_SINK)(CONST CHAR16 *Text, UINTN Length);
+
+VOID        EFIAPI OutFlush(VOID);
+OUTPUT_MODE EFIAPI OutSetMode(OUTPUT_MODE Mode);
+VOID        EFIAPI OutSetSink(OUTPUT_SINK Sink);
+
+#endif /* _OUTPUT_LIB_H */
@@ -0,0 +1,80 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Indexes of the platform tables the MyApps utilities look at: the ACPI
+//  roots and their XSDT entries, every PCI function with its configuration
+//  space, and the UEFI variables read so far.  Each is built the first
+//  time it is asked for and then kept, so utilities run one after another
+//  from MyTools walk the configuration table, the XSDT and the PCI buses
+//  only once between them.  Nothing is ever freed by the caller.
+//
+//  License: BSD License
+//
+
+#ifndef _PLATFORM_INDEX_LIB_H
+#define _PLATFORM_INDEX_LIB_H
+
+#include <Protocol/AcpiSystemDescriptionTable.h>
+#include <Protocol/PciRootBridgeIo.h>
+#include <IndustryStandard/Acpi.h>
+#include <IndustryStandard/Pci.h>
+
+//
+//  One configuration table entry with an RSDP, ACPI 1.0 or 2.0 GUID.  Both
+//  entries usually point at the same RSDP.  Xsdt is NULL before ACPI 2.0;
+//  Tables holds the XSDT entries in order, none if the XSDT signature is
+//  wrong.
+//
+typedef struct {
+    EFI_GUID                                     *Guid;
+    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp;
+    EFI_ACPI_SDT_HEADER                          *Xsdt;
+    EFI_ACPI_SDT_HEADER                         **Tables;
+    UINTN                                         TableCount;
+} ACPI_ROOT;
+
+UINTN             EFIAPI AcpiRootCount(VOID);
+CONST ACPI_ROOT * EFIAPI AcpiGetRoot(UINTN Index);
+
+//
+//  The Instance'th table (from 0) with Signature in the first XSDT.  DSDT
+//  and FACS are found through the FADT as well.  NULL if there is none.
+//
+VOID *            EFIAPI AcpiFindTable(UINT32 Signature, UINTN Instance);
+
+//
+//  A PCI function and the first 256 bytes of its configuration space.
+//  Range numbers the bus ranges of all root bridges in the order they
+//  were scanned, an empty range included.
+//
+typedef struct {
+    EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL *IoDev;
+    UINTN                            Range;
+    UINT32                           Segment;
+    UINT8                            Bus;
+    UINT8                            Device;
+    UINT8                            Function;
+    union {
+        PCI_TYPE00                   Type0;
+        PCI_TYPE01                   Type1;        // bridges
+        UINT32                       Data[64];
+    } Config;
+} PCI_FUNCTION;
+
+//
+//  Every function on every root bridge, in bus, device, function order
+//  within each range.  EFI_NOT_READY if PCI enumeration has not completed,
+//  EFI_NOT_FOUND if there are no root bridges.
+//
+EFI_STATUS        EFIAPI PciGetFunctions(CONST PCI_FUNCTION **Functions, UINTN *Count, UINTN *RangeCount);
+
+//
+//  As GetVariable and SetVariable.  A variable, or the fact that it does
+//  not exist, is fetched once and answered from the cache after that;
+//  VarCacheSet drops the cached copy, so the next VarCacheGet sees what
+//  the firmware actually stored.
+//
+EFI_STATUS        EFIAPI VarCacheGet(CHAR16 *Name, EFI_GUID *Guid, UINT32 *Attributes, UINTN *DataSize, VOID *Data);
+EFI_STATUS        EFIAPI VarCacheSet(CHAR16 *Name, EFI_GUID *Guid, UINT32 Attributes, UINTN DataSize, VOID *Data);
+
+#endif /* _PLATFORM_INDEX_LIB_H */
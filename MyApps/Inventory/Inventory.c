@@ -0,0 +1,749 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Collect what the other utilities show - ACPI tables, PCI configuration
+//  space, EDID, CPUID leaves, the ESRT, OsIndications, variable store
+//  usage and the secure boot databases - into one archive file, by
+//  default at the root of the volume this image was loaded from.
+//
+//  The archive is put together in memory and then written front to back
+//  in large writes, so the file system sees one sequential stream rather
+//  than a write per table.  See Inventory.h for the format; host/ has
+//  the Linux reader that checks and unpacks it.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+
+#include <Library/UefiLib.h>
+#include <Library/ShellCEntryLib.h>
+#include <Library/ShellLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PrintLib.h>
+#include <Library/DevicePathLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+#include <Library/PlatformIndexLib.h>
+
+#include <Protocol/EfiShell.h>
+#include <Protocol/LoadedImage.h>
+#include <Protocol/GraphicsOutput.h>
+#include <Protocol/EdidDiscovered.h>
+
+#include <Guid/GlobalVariable.h>
+#include <Guid/ImageAuthentication.h>
+#include <Guid/SystemResourceTable.h>
+
+#include <Register/Cpuid.h>
+
+#include "Inventory.h"
+#include "../ListCerts/sha256.h"
+
+#define UTILITY_VERSION     L"20181018"
+#define ARCHIVE_FILE        L"inventory.inv"
+#define ARCHIVE_FIRST_SIZE  SIZE_1MB
+#define ARCHIVE_WRITE_SIZE  SIZE_1MB         // bytes per write
+#define INDEX_GROW          64               // entries per reallocation
+#undef DEBUG
+
+//
+//  The archive being built.  After the first failure Status holds the
+//  error and every further call does nothing, so the collectors need not
+//  check each step.
+//
+typedef struct {
+    UINT8           *Buffer;
+    UINTN            Size;
+    UINTN            Max;
+    INVENTORY_ENTRY *Index;
+    UINTN            Count;
+    UINTN            IndexMax;
+    EFI_STATUS       Status;
+} ARCHIVE;
+
+typedef struct {
+    CHAR16   *Name;
+    EFI_GUID  Guid;
+} VARIABLE;
+
+typedef struct {
+    UINT32 Leaf;
+    UINT32 SubLeaves;                        // how many to read
+} CPUID_SUBLEAVES;
+
+static VARIABLE Variables[] = {
+    { L"PK",                     EFI_GLOBAL_VARIABLE },
+    { L"KEK",                    EFI_GLOBAL_VARIABLE },
+    { L"db",                     EFI_IMAGE_SECURITY_DATABASE_GUID },
+    { L"dbx",                    EFI_IMAGE_SECURITY_DATABASE_GUID },
+    { L"dbt",                    EFI_IMAGE_SECURITY_DATABASE_GUID },
+    { L"dbr",                    EFI_IMAGE_SECURITY_DATABASE_GUID },
+    { L"PKDefault",              EFI_GLOBAL_VARIABLE },
+    { L"KEKDefault",             EFI_GLOBAL_VARIABLE },
+    { L"dbDefault",              EFI_GLOBAL_VARIABLE },
+    { L"dbxDefault",             EFI_GLOBAL_VARIABLE },
+    { L"dbtDefault",             EFI_GLOBAL_VARIABLE },
+    { L"dbrDefault",             EFI_GLOBAL_VARIABLE },
+    { L"SecureBoot",             EFI_GLOBAL_VARIABLE },
+    { L"SetupMode",              EFI_GLOBAL_VARIABLE },
+    { L"AuditMode",              EFI_GLOBAL_VARIABLE },
+    { L"DeployedMode",           EFI_GLOBAL_VARIABLE },
+    { L"OsIndications",          EFI_GLOBAL_VARIABLE },
+    { L"OsIndicationsSupported", EFI_GLOBAL_VARIABLE },
+};
+
+static CONST UINT32 VarStoreAttributes[] = {
+    EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+    EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+    EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+    EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS |
+        EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS,
+};
+
+// leaves that take a subleaf in ECX; every other leaf is read with 0
+static CONST CPUID_SUBLEAVES CpuidSubLeaves[] = {
+    { 0x04, 8 },                             // deterministic cache parameters
+    { 0x07, 4 },                             // structured extended features
+    { 0x0b, 4 },                             // extended topology
+    { 0x0d, 64 },                            // extended state
+    { 0x0f, 4 },                             // RDT monitoring
+    { 0x10, 4 },                             // RDT allocation
+    { 0x12, 8 },                             // SGX
+    { 0x14, 4 },                             // processor trace
+    { 0x17, 4 },                             // SoC vendor attributes
+    { 0x18, 8 },                             // deterministic address translation
+    { 0x1f, 8 },                             // V2 extended topology
+    { 0x8000001d, 8 },                       // AMD cache topology
+};
+
+
+static VOID *
+ArchiveReserve( ARCHIVE *Archive,
+                UINTN Size )
+{
+    UINT8 *New;
+    UINTN Max;
+    VOID *Data;
+
+    if (EFI_ERROR(Archive->Status))
+        return NULL;
+
+    if (Archive->Size + Size > Archive->Max) {
+        for (Max = Archive->Max ? Archive->Max : ARCHIVE_FIRST_SIZE; Max < Archive->Size + Size; Max *= 2)
+            ;
+        New = ReallocatePool(Archive->Max, Max, Archive->Buffer);
+        if (New == NULL) {
+            Archive->Status = EFI_OUT_OF_RESOURCES;
+            return NULL;
+        }
+        Archive->Buffer = New;
+        Archive->Max = Max;
+    }
+
+    Data = Archive->Buffer + Archive->Size;
+    Archive->Size += Size;
+
+    return Data;
+}
+
+
+static VOID
+ArchiveAppend( ARCHIVE *Archive,
+               CONST VOID *Data,
+               UINTN Size )
+{
+    VOID *Space;
+
+    Space = ArchiveReserve(Archive, Size);
+    if (Space != NULL)
+        CopyMem(Space, Data, Size);
+}
+
+
+//
+//  Everything appended until SectionEnd is the section's data.  A name
+//  too long for the index fails the archive rather than being cut short.
+//
+static INVENTORY_ENTRY *
+SectionBegin( ARCHIVE *Archive,
+              UINT32 Type,
+              CONST CHAR8 *Format,
+              ... )
+{
+    INVENTORY_ENTRY *Entry, *New;
+    CHAR8 Name[INVENTORY_NAME_MAX + 1];
+    VA_LIST Marker;
+
+    if (EFI_ERROR(Archive->Status))
+        return NULL;
+
+    VA_START(Marker, Format);
+    if (AsciiVSPrint(Name, sizeof(Name), Format, Marker) >= INVENTORY_NAME_MAX) {
+        VA_END(Marker);
+        EmitError(L"Section name too long [%a...]", Name);
+        Archive->Status = EFI_BAD_BUFFER_SIZE;
+        return NULL;
+    }
+    VA_END(Marker);
+
+    if (Archive->Count == Archive->IndexMax) {
+        New = ReallocatePool( Archive->IndexMax * sizeof(INVENTORY_ENTRY),
+                              (Archive->IndexMax + INDEX_GROW) * sizeof(INVENTORY_ENTRY),
+                              Archive->Index );
+        if (New == NULL) {
+            Archive->Status = EFI_OUT_OF_RESOURCES;
+            return NULL;
+        }
+        Archive->Index = New;
+        Archive->IndexMax += INDEX_GROW;
+    }
+
+    Entry = &Archive->Index[Archive->Count++];
+    ZeroMem(Entry, sizeof(*Entry));
+    AsciiStrCpyS(Entry->Name, sizeof(Entry->Name), Name);
+    Entry->Type = Type;
+    Entry->Offset = Archive->Size;
+
+    return Entry;
+}
+
+
+static VOID
+SectionEnd( ARCHIVE *Archive,
+            INVENTORY_ENTRY *Entry )
+{
+    if (EFI_ERROR(Archive->Status))
+        return;
+
+    Entry->Size = Archive->Size - Entry->Offset;
+    Sha256(Archive->Buffer + Entry->Offset, (UINTN)Entry->Size, Entry->Digest);
+}
+
+
+static VOID
+CollectAcpiTable( ARCHIVE *Archive,
+                  EFI_ACPI_SDT_HEADER *Table,
+                  UINTN Instance )
+{
+    INVENTORY_ENTRY *Entry;
+    CHAR8 Signature[5];
+
+    CopyMem(Signature, &Table->Signature, 4);
+    Signature[4] = '\0';
+
+    Entry = SectionBegin(Archive, INVENTORY_ACPI, "acpi/%a.%d", Signature, Instance);
+    ArchiveAppend(Archive, Table, Table->Length);
+    SectionEnd(Archive, Entry);
+}
+
+
+//
+//  The RSDP, the XSDT and every table in it, from the same root as
+//  AcpiFindTable uses.  DSDT and FACS are reached through the FADT.
+//
+static VOID
+CollectAcpi( ARCHIVE *Archive )
+{
+    EFI_ACPI_SDT_HEADER *Table;
+    CONST ACPI_ROOT *Root = NULL;
+    INVENTORY_ENTRY *Entry;
+    UINTN i, j, Instance;
+
+    for (i = 0; i < AcpiRootCount(); i++) {
+        if (AcpiGetRoot(i)->TableCount > 0) {
+            Root = AcpiGetRoot(i);
+            break;
+        }
+    }
+    if (Root == NULL)
+        return;
+
+    Entry = SectionBegin(Archive, INVENTORY_ACPI, "acpi/RSDP");
+    ArchiveAppend(Archive, Root->Rsdp, Root->Rsdp->Revision >= 2 ? Root->Rsdp->Length
+                                                                  : sizeof(EFI_ACPI_1_0_ROOT_SYSTEM_DESCRIPTION_POINTER));
+    SectionEnd(Archive, Entry);
+    CollectAcpiTable(Archive, Root->Xsdt, 0);
+
+    for (i = 0; i < Root->TableCount; i++) {
+        Table = Root->Tables[i];
+        if (Table->Signature == EFI_ACPI_2_0_DIFFERENTIATED_SYSTEM_DESCRIPTION_TABLE_SIGNATURE ||
+            Table->Signature == EFI_ACPI_2_0_FIRMWARE_ACPI_CONTROL_STRUCTURE_SIGNATURE)
+            continue;
+        for (Instance = 0, j = 0; j < i; j++) {
+            if (Root->Tables[j]->Signature == Table->Signature)
+                Instance++;
+        }
+        CollectAcpiTable(Archive, Table, Instance);
+    }
+
+    for (Instance = 0; (Table = AcpiFindTable(EFI_ACPI_2_0_DIFFERENTIATED_SYSTEM_DESCRIPTION_TABLE_SIGNATURE, Instance)) != NULL; Instance++)
+        CollectAcpiTable(Archive, Table, Instance);
+    for (Instance = 0; (Table = AcpiFindTable(EFI_ACPI_2_0_FIRMWARE_ACPI_CONTROL_STRUCTURE_SIGNATURE, Instance)) != NULL; Instance++)
+        CollectAcpiTable(Archive, Table, Instance);
+}
+
+
+//
+//  What is there even if the scan stopped part way
+//
+static VOID
+CollectPci( ARCHIVE *Archive )
+{
+    CONST PCI_FUNCTION *Functions;
+    INVENTORY_ENTRY *Entry;
+    UINTN Count;
+
+    PciGetFunctions(&Functions, &Count, NULL);
+
+    for (UINTN i = 0; i < Count; i++) {
+        Entry = SectionBegin( Archive,
+                              INVENTORY_PCI,
+                              "pci/%04x:%02x:%02x.%x",
+                              Functions[i].Segment,
+                              Functions[i].Bus,
+                              Functions[i].Device,
+                              Functions[i].Function );
+        ArchiveAppend(Archive, Functions[i].Config.Data, sizeof(Functions[i].Config.Data));
+        SectionEnd(Archive, Entry);
+    }
+}
+
+
+static VOID
+CollectEdid( ARCHIVE *Archive )
+{
+    EFI_GUID gEfiEdidDiscoveredProtocolGuid = EFI_EDID_DISCOVERED_PROTOCOL_GUID;
+    EFI_EDID_DISCOVERED_PROTOCOL *Edp;
+    INVENTORY_ENTRY *Entry;
+    EFI_HANDLE *HandleBuffer;
+    EFI_STATUS Status;
+    UINTN HandleCount = 0, Found = 0;
+
+    Status = gBS->LocateHandleBuffer( ByProtocol,
+                                      &gEfiGraphicsOutputProtocolGuid,
+                                      NULL,
+                                      &HandleCount,
+                                      &HandleBuffer );
+    if (EFI_ERROR(Status))
+        return;
+
+    for (UINTN i = 0; i < HandleCount; i++) {
+        Status = gBS->OpenProtocol( HandleBuffer[i],
+                                    &gEfiEdidDiscoveredProtocolGuid,
+                                    (VOID **)&Edp,
+                                    gImageHandle,
+                                    NULL,
+                                    EFI_OPEN_PROTOCOL_BY_HANDLE_PROTOCOL );
+        if (EFI_ERROR(Status) || Edp->SizeOfEdid == 0)
+            continue;
+
+        Entry = SectionBegin(Archive, INVENTORY_EDID, "edid/%d", Found++);
+        ArchiveAppend(Archive, Edp->Edid, Edp->SizeOfEdid);
+        SectionEnd(Archive, Entry);
+    }
+
+    FreePool(HandleBuffer);
+}
+
+
+static VOID
+CollectCpuidLeaf( ARCHIVE *Archive,
+                  UINT32 Leaf )
+{
+    INVENTORY_CPUID_LEAF Record;
+    UINT32 SubLeaves = 1;
+
+    for (UINTN i = 0; i < ARRAY_SIZE(CpuidSubLeaves); i++) {
+        if (CpuidSubLeaves[i].Leaf == Leaf)
+            SubLeaves = CpuidSubLeaves[i].SubLeaves;
+    }
+
+    Record.Leaf = Leaf;
+    for (Record.SubLeaf = 0; Record.SubLeaf < SubLeaves; Record.SubLeaf++) {
+        AsmCpuidEx(Leaf, Record.SubLeaf, &Record.Eax, &Record.Ebx, &Record.Ecx, &Record.Edx);
+        // unused subleaves read as zero; leave them out
+        if (Record.SubLeaf > 0 && (Record.Eax | Record.Ebx | Record.Ecx | Record.Edx) == 0)
+            continue;
+        ArchiveAppend(Archive, &Record, sizeof(Record));
+    }
+}
+
+
+//
+//  Leaves as this processor reports them; on a hybrid or mixed system
+//  the other processors may differ
+//
+static VOID
+CollectCpuid( ARCHIVE *Archive )
+{
+    INVENTORY_ENTRY *Entry;
+    UINT32 MaxLeaf, Leaf;
+
+    Entry = SectionBegin(Archive, INVENTORY_CPUID, "cpuid");
+
+    AsmCpuid(CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+    for (Leaf = 0; Leaf <= MaxLeaf && Leaf < 0x100; Leaf++)
+        CollectCpuidLeaf(Archive, Leaf);
+
+    AsmCpuid(CPUID_EXTENDED_FUNCTION, &MaxLeaf, NULL, NULL, NULL);
+    for (Leaf = CPUID_EXTENDED_FUNCTION; Leaf <= MaxLeaf && Leaf < CPUID_EXTENDED_FUNCTION + 0x100; Leaf++)
+        CollectCpuidLeaf(Archive, Leaf);
+
+    SectionEnd(Archive, Entry);
+}
+
+
+static VOID
+CollectEsrt( ARCHIVE *Archive )
+{
+    EFI_CONFIGURATION_TABLE *ect = gST->ConfigurationTable;
+    EFI_GUID EsrtGuid = EFI_SYSTEM_RESOURCE_TABLE_GUID;
+    EFI_SYSTEM_RESOURCE_TABLE *Esrt;
+    INVENTORY_ENTRY *Entry;
+
+    for (UINTN Index = 0; Index < gST->NumberOfTableEntries; Index++, ect++) {
+        if (!CompareGuid(&ect->VendorGuid, &EsrtGuid))
+            continue;
+
+        Esrt = ect->VendorTable;
+        Entry = SectionBegin(Archive, INVENTORY_ESRT, "esrt");
+        ArchiveAppend( Archive,
+                       Esrt,
+                       sizeof(EFI_SYSTEM_RESOURCE_TABLE) +
+                           Esrt->FwResourceCount * sizeof(EFI_SYSTEM_RESOURCE_ENTRY) );
+        SectionEnd(Archive, Entry);
+        return;
+    }
+}
+
+
+//
+//  Through the variable cache: the size query and the read that follows
+//  are one GetVariable between them
+//
+static VOID
+CollectVariables( ARCHIVE *Archive )
+{
+    INVENTORY_ENTRY *Entry;
+    EFI_STATUS Status;
+    UINT32 Attributes;
+    UINTN Size;
+    VOID *Data;
+
+    for (UINTN i = 0; i < ARRAY_SIZE(Variables); i++) {
+        Size = 0;
+        Status = VarCacheGet(Variables[i].Name, &Variables[i].Guid, NULL, &Size, NULL);
+        if (Status != EFI_BUFFER_TOO_SMALL && Status != EFI_SUCCESS)
+            continue;
+
+        Entry = SectionBegin(Archive, INVENTORY_VARIABLE, "var/%s", Variables[i].Name);
+        Data = ArchiveReserve(Archive, Size);
+        if (Data == NULL)
+            return;
+        Status = VarCacheGet(Variables[i].Name, &Variables[i].Guid, &Attributes, &Size, Data);
+        if (EFI_ERROR(Status)) {
+            // gone, or grown, since the size was asked for
+            Archive->Size = (UINTN)Entry->Offset;
+            Archive->Count--;
+            continue;
+        }
+        Entry->Attributes = Attributes;
+        CopyMem(Entry->Guid, &Variables[i].Guid, sizeof(Entry->Guid));
+        SectionEnd(Archive, Entry);
+    }
+}
+
+
+static VOID
+CollectVarStore( ARCHIVE *Archive )
+{
+    INVENTORY_VARSTORE_INFO Info;
+    INVENTORY_ENTRY *Entry;
+    EFI_STATUS Status;
+
+    if (gRT->Hdr.Revision < EFI_2_00_SYSTEM_TABLE_REVISION)
+        return;
+
+    Entry = SectionBegin(Archive, INVENTORY_VARSTORE, "varstore");
+    for (UINTN i = 0; i < ARRAY_SIZE(VarStoreAttributes); i++) {
+        ZeroMem(&Info, sizeof(Info));
+        Info.Attributes = VarStoreAttributes[i];
+        Status = gRT->QueryVariableInfo( Info.Attributes,
+                                         &Info.MaximumStorageSize,
+                                         &Info.RemainingStorageSize,
+                                         &Info.MaximumVariableSize );
+        Info.Status = (UINT32)Status;
+        ArchiveAppend(Archive, &Info, sizeof(Info));
+    }
+    SectionEnd(Archive, Entry);
+}
+
+
+//
+//  The index goes on the end and the header, with the hash of the
+//  index, in the space kept for it at the start
+//
+static VOID
+ArchiveFinish( ARCHIVE *Archive )
+{
+    INVENTORY_HEADER *Header;
+    EFI_TIME Time;
+    UINTN IndexOffset;
+
+    IndexOffset = Archive->Size;
+    ArchiveAppend(Archive, Archive->Index, Archive->Count * sizeof(INVENTORY_ENTRY));
+    if (EFI_ERROR(Archive->Status))
+        return;
+
+    Header = (INVENTORY_HEADER *)Archive->Buffer;
+    ZeroMem(Header, sizeof(*Header));
+    Header->Magic = INVENTORY_MAGIC;
+    Header->Version = INVENTORY_VERSION;
+    Header->HeaderSize = sizeof(INVENTORY_HEADER);
+    Header->Sections = (UINT32)Archive->Count;
+    Header->EntrySize = sizeof(INVENTORY_ENTRY);
+    Header->IndexOffset = IndexOffset;
+    Header->ArchiveSize = Archive->Size;
+    if (!EFI_ERROR(gRT->GetTime(&Time, NULL))) {
+        Header->Year = Time.Year;
+        Header->Month = Time.Month;
+        Header->Day = Time.Day;
+        Header->Hour = Time.Hour;
+        Header->Minute = Time.Minute;
+        Header->Second = Time.Second;
+    }
+    Sha256(Archive->Index, Archive->Count * sizeof(INVENTORY_ENTRY), Header->IndexDigest);
+}
+
+
+static EFI_STATUS
+ArchiveWrite( ARCHIVE *Archive,
+              CHAR16 *FileName )
+{
+    SHELL_FILE_HANDLE FileHandle;
+    EFI_STATUS Status;
+    UINTN Offset, Size;
+
+    // EFI_FILE_MODE_CREATE does not truncate, so remove the previous archive first
+    Status = ShellOpenFileByName(FileName, &FileHandle, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0);
+    if (!EFI_ERROR(Status))
+        ShellDeleteFile(&FileHandle);
+
+    Status = ShellOpenFileByName( FileName,
+                                  &FileHandle,
+                                  EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE,
+                                  0 );
+    if (EFI_ERROR(Status))
+        return Status;
+
+    for (Offset = 0; !EFI_ERROR(Status) && Offset < Archive->Size; Offset += Size) {
+        Size = MIN(Archive->Size - Offset, ARCHIVE_WRITE_SIZE);
+        Status = ShellWriteFile(FileHandle, &Size, Archive->Buffer + Offset);
+        if (!EFI_ERROR(Status) && Size == 0)
+            Status = EFI_VOLUME_FULL;
+    }
+    ShellCloseFile(&FileHandle);
+
+    return Status;
+}
+
+
+static VOID
+ArchiveFree( ARCHIVE *Archive )
+{
+    if (Archive->Buffer != NULL)
+        FreePool(Archive->Buffer);
+    if (Archive->Index != NULL)
+        FreePool(Archive->Index);
+    ZeroMem(Archive, sizeof(*Archive));
+}
+
+
+//
+//  inventory.inv at the root of the volume this image was loaded from,
+//  fs0:\inventory.inv say; in the current directory if the shell has no
+//  mapping for it
+//
+static CHAR16 *
+DefaultFileName( VOID )
+{
+    EFI_LOADED_IMAGE_PROTOCOL *LoadedImage;
+    EFI_DEVICE_PATH_PROTOCOL *DevicePath;
+    CONST CHAR16 *Map = NULL;
+    CHAR16 *FileName;
+    UINTN Length;
+
+    if (!EFI_ERROR(gBS->HandleProtocol( gImageHandle,
+                                        &gEfiLoadedImageProtocolGuid,
+                                        (VOID **)&LoadedImage ))) {
+        DevicePath = DevicePathFromHandle(LoadedImage->DeviceHandle);
+        if (DevicePath != NULL && gEfiShellProtocol != NULL)
+            Map = gEfiShellProtocol->GetMapFromDevicePath(&DevicePath);
+    }
+    if (Map == NULL)
+        return AllocateCopyPool(StrSize(ARCHIVE_FILE), ARCHIVE_FILE);
+
+    // the first of the names, as in "FS0:;BLK1:"
+    for (Length = 0; Map[Length] != CHAR_NULL && Map[Length] != L';'; Length++)
+        ;
+    FileName = AllocateZeroPool((Length + 1) * sizeof(CHAR16) + StrSize(ARCHIVE_FILE));
+    if (FileName == NULL)
+        return NULL;
+    CopyMem(FileName, Map, Length * sizeof(CHAR16));
+    FileName[Length] = L'\\';
+    CopyMem(&FileName[Length + 1], ARCHIVE_FILE, StrSize(ARCHIVE_FILE));
+
+    return FileName;
+}
+
+
+static CONST CHAR16 *
+TypeName( UINT32 Type )
+{
+    switch (Type) {
+        case INVENTORY_ACPI:     return L"ACPI";
+        case INVENTORY_PCI:      return L"PCI";
+        case INVENTORY_EDID:     return L"EDID";
+        case INVENTORY_CPUID:    return L"CPUID";
+        case INVENTORY_ESRT:     return L"ESRT";
+        case INVENTORY_VARIABLE: return L"Variable";
+        case INVENTORY_VARSTORE: return L"Variable store";
+        default:                 return L"Unknown";
+    }
+}
+
+
+static VOID
+PrintSummary( ARCHIVE *Archive,
+              CHAR16 *FileName,
+              BOOLEAN Verbose )
+{
+    INVENTORY_ENTRY *Entry;
+    UINTN Sections, Size;
+
+    if (EmitFormat() != EmitText) {
+        EmitString(L"file", FileName);
+        EmitUint(L"size", Archive->Size);
+        EmitArray(L"sections");
+        for (UINTN i = 0; i < Archive->Count; i++) {
+            Entry = &Archive->Index[i];
+            EmitObject(NULL);
+            EmitAscii(L"name", Entry->Name, sizeof(Entry->Name));
+            EmitString(L"type", TypeName(Entry->Type));
+            EmitUint(L"offset", Entry->Offset);
+            EmitUint(L"size", Entry->Size);
+            EmitBytes(L"sha256", Entry->Digest, sizeof(Entry->Digest));
+            EmitClose();
+        }
+        EmitClose();
+        return;
+    }
+
+    if (Verbose) {
+        for (UINTN i = 0; i < Archive->Count; i++) {
+            Entry = &Archive->Index[i];
+            OutPrint(L"%-32a %-14s %8ld\n", Entry->Name, TypeName(Entry->Type), Entry->Size);
+        }
+        OutPrint(L"\n");
+    }
+
+    for (UINT32 Type = INVENTORY_ACPI; Type <= INVENTORY_VARSTORE; Type++) {
+        Sections = Size = 0;
+        for (UINTN i = 0; i < Archive->Count; i++) {
+            if (Archive->Index[i].Type == Type) {
+                Sections++;
+                Size += (UINTN)Archive->Index[i].Size;
+            }
+        }
+        OutPrint(L"%-14s %4d sections %8d bytes\n", TypeName(Type), Sections, Size);
+    }
+    OutPrint(L"\nWrote %d bytes to %s\n", Archive->Size, FileName);
+}
+
+
+static VOID
+Usage( VOID )
+{
+    OutPrint(L"Usage: Inventory [-v | --verbose] [filename]\n");
+    OutPrint(L"       Inventory [--json | --csv] [-o | --output filename] [filename]\n");
+    OutPrint(L"       Inventory [-V | --version]\n");
+}
+
+
+INTN
+EFIAPI
+ShellAppMain( UINTN Argc,
+              CHAR16 **Argv )
+{
+    ARCHIVE Archive;
+    EFI_STATUS Status = EFI_SUCCESS;
+    CHAR16 *FileName = NULL;
+    BOOLEAN Verbose = FALSE;
+
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
+    for (UINTN i = 1; i < Argc; i++) {
+        if (!StrCmp(Argv[i], L"--version") ||
+            !StrCmp(Argv[i], L"-V")) {
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
+            return Status;
+        } else if (!StrCmp(Argv[i], L"--verbose") ||
+            !StrCmp(Argv[i], L"-v")) {
+            Verbose = TRUE;
+        } else if (!StrCmp(Argv[i], L"--help") ||
+            !StrCmp(Argv[i], L"-h")) {
+            Usage();
+            return Status;
+        } else if (Argv[i][0] == L'-' || FileName != NULL) {
+            Usage();
+            return Status;
+        } else {
+            FileName = Argv[i];
+        }
+    }
+
+    EmitBegin(L"Inventory", UTILITY_VERSION);
+
+    if (FileName == NULL)
+        FileName = DefaultFileName();
+    else
+        FileName = AllocateCopyPool(StrSize(FileName), FileName);
+    if (FileName == NULL) {
+        EmitError(L"Out of memory resources");
+        return EFI_OUT_OF_RESOURCES;
+    }
+
+    ZeroMem(&Archive, sizeof(Archive));
+    ArchiveReserve(&Archive, sizeof(INVENTORY_HEADER));
+
+    CollectAcpi(&Archive);
+    CollectPci(&Archive);
+    CollectEdid(&Archive);
+    CollectCpuid(&Archive);
+    CollectEsrt(&Archive);
+    CollectVariables(&Archive);
+    CollectVarStore(&Archive);
+    ArchiveFinish(&Archive);
+
+    Status = Archive.Status;
+    if (Status == EFI_OUT_OF_RESOURCES) {
+        EmitError(L"Out of memory resources");
+    } else if (!EFI_ERROR(Status)) {
+        Status = ArchiveWrite(&Archive, FileName);
+        if (EFI_ERROR(Status))
+            EmitError(L"Could not write %s: %r", FileName, Status);
+        else
+            PrintSummary(&Archive, FileName, Verbose);
+    }
+
+    ArchiveFree(&Archive);
+    FreePool(FileName);
+
+    return Status;
+}
@@ -0,0 +1,83 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Inventory archive format, shared by the collector and the host reader.
+//
+//  The header comes first, then the sections back to back with no padding,
+//  then the index: one entry per section, giving where it is, how long it
+//  is and its SHA-256.  The header holds the SHA-256 of the index, so the
+//  reader checks the index and then each section against it.  Everything
+//  is little endian.  Only plain integer types are used so that the host
+//  build needs nothing from the UEFI headers.
+//
+//  License: BSD License
+//
+
+#ifndef _INVENTORY_H
+#define _INVENTORY_H
+
+#define INVENTORY_MAGIC         0x564e4955        // "UINV"
+#define INVENTORY_VERSION       1
+#define INVENTORY_DIGEST_SIZE   32                // SHA-256
+#define INVENTORY_NAME_MAX      64                // CHARs, NUL terminated and padded
+
+//
+//  Section types.  Each section is a single file when unpacked, named by
+//  the entry: acpi/APIC.0, pci/0000:00:1f.3, edid/0, var/db and so on.
+//
+#define INVENTORY_ACPI          1                 // a table as found in memory
+#define INVENTORY_PCI           2                 // 256 bytes of configuration space
+#define INVENTORY_EDID          3                 // EDID as discovered, extensions included
+#define INVENTORY_CPUID         4                 // INVENTORY_CPUID_LEAF records
+#define INVENTORY_ESRT          5                 // the ESRT, header and entries
+#define INVENTORY_VARIABLE      6                 // variable data; Attributes and Guid set
+#define INVENTORY_VARSTORE      7                 // INVENTORY_VARSTORE_INFO records
+
+#pragma pack(1)
+typedef struct {
+    UINT32 Magic;
+    UINT16 Version;
+    UINT16 HeaderSize;                            // sizeof(INVENTORY_HEADER)
+    UINT32 Sections;                              // index entries
+    UINT32 EntrySize;                             // sizeof(INVENTORY_ENTRY)
+    UINT64 IndexOffset;                           // from the start of the archive
+    UINT64 ArchiveSize;
+    UINT16 Year;                                  // firmware time when collected
+    UINT8  Month;
+    UINT8  Day;
+    UINT8  Hour;
+    UINT8  Minute;
+    UINT8  Second;
+    UINT8  Reserved;
+    UINT8  IndexDigest[INVENTORY_DIGEST_SIZE];
+} INVENTORY_HEADER;
+
+typedef struct {
+    CHAR8  Name[INVENTORY_NAME_MAX];
+    UINT32 Type;
+    UINT32 Attributes;                            // variable attributes, else 0
+    UINT8  Guid[16];                              // variable vendor GUID, else 0
+    UINT64 Offset;                                // from the start of the archive
+    UINT64 Size;
+    UINT8  Digest[INVENTORY_DIGEST_SIZE];
+} INVENTORY_ENTRY;
+
+typedef struct {
+    UINT32 Leaf;
+    UINT32 SubLeaf;
+    UINT32 Eax;
+    UINT32 Ebx;
+    UINT32 Ecx;
+    UINT32 Edx;
+} INVENTORY_CPUID_LEAF;
+
+typedef struct {
+    UINT32 Attributes;                            // asked about
+    UINT32 Status;                                // 0, or the low bits of the error
+    UINT64 MaximumStorageSize;
+    UINT64 RemainingStorageSize;
+    UINT64 MaximumVariableSize;
+} INVENTORY_VARSTORE_INFO;
+#pragma pack()
+
+#endif /* _INVENTORY_H */
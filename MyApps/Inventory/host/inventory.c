@@ -0,0 +1,304 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Host reader for the archives Inventory writes.  Checks the index and
+ *  every section against their SHA-256, lists the sections and, with -x,
+ *  unpacks each one to a file under the given directory: acpi/DSDT.0,
+ *  pci/0000:00:1f.3, var/db and so on.
+ *
+ *  License: BSD License
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+
+#include "sha256.h"
+#include "Inventory.h"
+
+#define UTILITY_VERSION "20181018"
+
+static const char *type_names[] = {
+    "unknown", "acpi", "pci", "edid", "cpuid", "esrt", "variable", "varstore"
+};
+
+
+static const char *
+type_name( UINT32 type )
+{
+    return (type < ARRAY_SIZE(type_names)) ? type_names[type] : type_names[0];
+}
+
+
+/*
+ * Read a whole file; the caller frees the buffer
+ */
+static unsigned char *
+load_file( const char *name,
+           size_t *len )
+{
+    unsigned char *data;
+    long size;
+    FILE *f;
+
+    f = fopen(name, "rb");
+    if (f == NULL) {
+        perror(name);
+        return NULL;
+    }
+    if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0) {
+        perror(name);
+        fclose(f);
+        return NULL;
+    }
+
+    *len = (size_t)size;
+    data = malloc(*len ? *len : 1);
+    if (data == NULL || fread(data, 1, *len, f) != *len) {
+        fprintf(stderr, "ERROR: Failed to read %s\n", name);
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+
+    return data;
+}
+
+
+/*
+ * Section names come from the archive, so only relative paths made of
+ * a few safe characters are written
+ */
+static int
+safe_name( const char *name )
+{
+    const char *p;
+
+    if (name[0] == '\0' || name[0] == '/' || strstr(name, "..") != NULL)
+        return 0;
+    for (p = name; *p; p++) {
+        if (!((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') ||
+              *p == '.' || *p == ':' || *p == '_' || *p == '-' || *p == '/'))
+            return 0;
+    }
+
+    return 1;
+}
+
+
+/*
+ * Write data to dir/name, making the directories on the way
+ */
+static int
+write_section( const char *dir,
+               const char *name,
+               const unsigned char *data,
+               size_t len )
+{
+    char path[4096];
+    size_t n;
+    char *p;
+    FILE *f;
+
+    n = (size_t)snprintf(path, sizeof(path), "%s/%s", dir, name);
+    if (n >= sizeof(path)) {
+        fprintf(stderr, "ERROR: Path too long [%s/%s]\n", dir, name);
+        return -1;
+    }
+    for (p = path + strlen(dir) + 1; (p = strchr(p, '/')) != NULL; p++) {
+        *p = '\0';
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+            perror(path);
+            return -1;
+        }
+        *p = '/';
+    }
+
+    f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    if (fwrite(data, 1, len, f) != len || fclose(f) != 0) {
+        fprintf(stderr, "ERROR: Failed to write %s\n", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+static void
+print_digest( const UINT8 *digest )
+{
+    int i;
+
+    for (i = 0; i < INVENTORY_DIGEST_SIZE; i++)
+        printf("%02x", digest[i]);
+}
+
+
+static void
+print_guid( const UINT8 *g )
+{
+    printf("%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+           g[3], g[2], g[1], g[0], g[5], g[4], g[7], g[6],
+           g[8], g[9], g[10], g[11], g[12], g[13], g[14], g[15]);
+}
+
+
+/*
+ * Returns the number of problems found: a bad header or index counts
+ * as one and stops there, otherwise one for each bad section
+ */
+static int
+read_archive( const char *file,
+              const char *dir,
+              int verbose )
+{
+    INVENTORY_HEADER header;
+    INVENTORY_ENTRY entry;
+    UINT8 digest[INVENTORY_DIGEST_SIZE];
+    char name[INVENTORY_NAME_MAX + 1];
+    unsigned char *data;
+    size_t len;
+    UINT32 i;
+    int errors = 0;
+
+    data = load_file(file, &len);
+    if (data == NULL)
+        return 1;
+
+    if (len < sizeof(header)) {
+        fprintf(stderr, "ERROR: %s: Not an inventory archive\n", file);
+        free(data);
+        return 1;
+    }
+    CopyMem(&header, data, sizeof(header));
+    if (header.Magic != INVENTORY_MAGIC || header.HeaderSize != sizeof(header) ||
+        header.EntrySize != sizeof(entry)) {
+        fprintf(stderr, "ERROR: %s: Not an inventory archive\n", file);
+        free(data);
+        return 1;
+    }
+    if (header.Version != INVENTORY_VERSION) {
+        fprintf(stderr, "ERROR: %s: Unsupported version %u\n", file, header.Version);
+        free(data);
+        return 1;
+    }
+    if (header.ArchiveSize != len || header.IndexOffset < sizeof(header) || header.IndexOffset > len ||
+        (len - header.IndexOffset) / sizeof(entry) < header.Sections) {
+        fprintf(stderr, "ERROR: %s: Truncated, or the index is corrupt\n", file);
+        free(data);
+        return 1;
+    }
+    Sha256(data + header.IndexOffset, (UINTN)header.Sections * sizeof(entry), digest);
+    if (CompareMem(digest, header.IndexDigest, sizeof(digest)) != 0) {
+        fprintf(stderr, "ERROR: %s: Index checksum mismatch\n", file);
+        free(data);
+        return 1;
+    }
+
+    printf("%s: %u sections, %llu bytes, collected %04u-%02u-%02u %02u:%02u:%02u\n",
+           file, header.Sections, (unsigned long long)header.ArchiveSize,
+           header.Year, header.Month, header.Day, header.Hour, header.Minute, header.Second);
+    if (dir != NULL && mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        perror(dir);
+        free(data);
+        return 1;
+    }
+
+    for (i = 0; i < header.Sections; i++) {
+        CopyMem(&entry, data + header.IndexOffset + (size_t)i * sizeof(entry), sizeof(entry));
+        CopyMem(name, entry.Name, INVENTORY_NAME_MAX);
+        name[INVENTORY_NAME_MAX] = '\0';
+
+        if (entry.Offset < sizeof(header) || entry.Offset > header.IndexOffset ||
+            entry.Size > header.IndexOffset - entry.Offset) {
+            fprintf(stderr, "ERROR: %s: Section outside the archive\n", name);
+            errors++;
+            continue;
+        }
+        Sha256(data + entry.Offset, (UINTN)entry.Size, digest);
+        if (CompareMem(digest, entry.Digest, sizeof(digest)) != 0) {
+            fprintf(stderr, "ERROR: %s: Checksum mismatch\n", name);
+            errors++;
+            continue;
+        }
+
+        printf("%-32s %-8s %8llu", name, type_name(entry.Type), (unsigned long long)entry.Size);
+        if (entry.Type == INVENTORY_VARIABLE) {
+            printf("  ");
+            print_guid(entry.Guid);
+            printf(" 0x%08x", entry.Attributes);
+        }
+        if (verbose) {
+            printf("  ");
+            print_digest(entry.Digest);
+        }
+        printf("\n");
+
+        if (dir == NULL)
+            continue;
+        if (!safe_name(name)) {
+            fprintf(stderr, "ERROR: Not unpacking section [%s]\n", name);
+            errors++;
+            continue;
+        }
+        if (write_section(dir, name, data + entry.Offset, (size_t)entry.Size) != 0)
+            errors++;
+    }
+
+    free(data);
+
+    return errors;
+}
+
+
+static void
+usage( void )
+{
+    printf("Usage: inventory [-v | --verbose] [-x | --extract directory] archive\n");
+    printf("       inventory [-V | --version]\n");
+}
+
+
+int
+main( int argc,
+      char **argv )
+{
+    const char *dir = NULL, *file = NULL;
+    int i, verbose = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            usage();
+            return 0;
+        } else if (!strcmp(argv[i], "-V") || !strcmp(argv[i], "--version")) {
+            printf("Version: %s\n", UTILITY_VERSION);
+            return 0;
+        } else if (!strcmp(argv[i], "-v") || !strcmp(argv[i], "--verbose")) {
+            verbose = 1;
+        } else if ((!strcmp(argv[i], "-x") || !strcmp(argv[i], "--extract")) && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (argv[i][0] == '-' || file != NULL) {
+            usage();
+            return 2;
+        } else {
+            file = argv[i];
+        }
+    }
+    if (file == NULL) {
+        usage();
+        return 2;
+    }
+
+    return read_archive(file, dir, verbose) ? 1 : 0;
+}
@@ -0,0 +1,524 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Streaming JSON and CSV emitter.  Only the stack of open containers is
+//  kept, a flag and a member count per level; every value is escaped and
+//  written to the OutputLib buffer as it is given.  The one thing held
+//  back is the first row of each CSV table, whose values have to follow
+//  the header row of keys.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/PrintLib.h>
+#include <Library/ShellLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+
+#define EMIT_ROW_SIZE   1024            // first row of a CSV table
+#define EMIT_CHUNK      64              // escaped characters per OutString
+
+typedef struct {
+    BOOLEAN Array;
+    UINTN   Count;                      // members so far
+} EMIT_LEVEL;
+
+static EMIT_FORMAT EmitMode = EmitText;
+static BOOLEAN     Begun;
+static EMIT_LEVEL  Level[EMIT_MAX_DEPTH];
+static UINTN       Depth;               // open containers
+static UINTN       Overflow;            // opened beyond EMIT_MAX_DEPTH and ignored
+static SHELL_FILE_HANDLE File;          // NULL for the console
+
+// CSV
+static UINTN   RowDepth;                // Depth inside the current row, 0 if none
+static UINTN   Columns;                 // values in the current row
+static BOOLEAN Header;                  // first row of its table
+static CHAR16  Row[EMIT_ROW_SIZE];
+static UINTN   RowUsed;
+static BOOLEAN Written;                 // a table must start on a new line
+
+static CONST CHAR16 Indent[] = L"                                ";    // 2 * EMIT_MAX_DEPTH
+static CONST CHAR16 HexDigits[] = L"0123456789abcdef";
+
+
+//
+//  Flushed output in the output file, as ASCII
+//
+static VOID
+EFIAPI
+FileSink( CONST CHAR16 *Text,
+          UINTN Length )
+{
+    CHAR8 Chunk[512];
+    UINTN Count, Size, i;
+
+    while (Length > 0) {
+        Count = MIN(Length, sizeof(Chunk));
+        for (i = 0; i < Count; i++)
+            Chunk[i] = (Text[i] < 0x80) ? (CHAR8)Text[i] : '?';
+        Size = Count;
+        ShellWriteFile(File, &Size, Chunk);
+        Text += Count;
+        Length -= Count;
+    }
+}
+
+
+EFI_STATUS
+EFIAPI
+EmitParseArgs( UINTN *Argc,
+               CHAR16 **Argv )
+{
+    CHAR16 *FileName = NULL;
+    EFI_STATUS Status;
+    UINTN i, j = 1;
+
+    for (i = 1; i < *Argc; i++) {
+        if (!StrCmp(Argv[i], L"--json")) {
+            EmitMode = EmitJson;
+        } else if (!StrCmp(Argv[i], L"--csv")) {
+            EmitMode = EmitCsv;
+        } else if (!StrCmp(Argv[i], L"--output") ||
+                   !StrCmp(Argv[i], L"-o")) {
+            if (i + 1 == *Argc) {
+                OutPrint(L"ERROR: %s needs a file name\n", Argv[i]);
+                return EFI_INVALID_PARAMETER;
+            }
+            FileName = Argv[++i];
+        } else {
+            Argv[j++] = Argv[i];
+        }
+    }
+    *Argc = j;
+
+    if (FileName == NULL)
+        return EFI_SUCCESS;
+
+    // EFI_FILE_MODE_CREATE does not truncate, so remove the previous file first
+    Status = ShellOpenFileByName(FileName, &File, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0);
+    if (!EFI_ERROR(Status))
+        ShellDeleteFile(&File);
+
+    Status = ShellOpenFileByName( FileName,
+                                  &File,
+                                  EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE,
+                                  0 );
+    if (EFI_ERROR(Status)) {
+        File = NULL;
+        OutPrint(L"ERROR: Could not create %s [%r]\n", FileName, Status);
+        return Status;
+    }
+    OutSetSink(FileSink);
+
+    return EFI_SUCCESS;
+}
+
+
+EMIT_FORMAT
+EFIAPI
+EmitFormat( VOID )
+{
+    return EmitMode;
+}
+
+
+//
+//  A value of the first CSV row goes after the header, the rest out
+//
+static VOID
+Put( CONST CHAR16 *Text )
+{
+    if (RowDepth == 0 || !Header) {
+        OutString(Text);
+        return;
+    }
+    for (; *Text != CHAR_NULL && RowUsed < EMIT_ROW_SIZE - 1; Text++)
+        Row[RowUsed++] = *Text;
+}
+
+
+//
+//  Length characters of Wide or Ascii, or Length bytes of Bytes in hex,
+//  escaped for the output format and in quotes if Quoted
+//
+static VOID
+PutValue( CONST CHAR16 *Wide,
+          CONST CHAR8 *Ascii,
+          CONST UINT8 *Bytes,
+          UINTN Length,
+          BOOLEAN Quoted )
+{
+    CHAR16 Chunk[EMIT_CHUNK + 8];
+    UINTN Count = 0, i;
+    CHAR16 c;
+
+    if (Quoted)
+        Chunk[Count++] = L'"';
+    for (i = 0; i < Length; i++) {
+        if (Bytes != NULL) {
+            Chunk[Count++] = HexDigits[Bytes[i] >> 4];
+            Chunk[Count++] = HexDigits[Bytes[i] & 0xf];
+        } else {
+            c = (Wide != NULL) ? Wide[i] : (UINT8)Ascii[i];
+            if (EmitMode == EmitCsv) {
+                if (c == L'"')
+                    Chunk[Count++] = L'"';
+                Chunk[Count++] = (c < 0x20) ? L' ' : c;
+            } else if (c == L'"' || c == L'\\') {
+                Chunk[Count++] = L'\\';
+                Chunk[Count++] = c;
+            } else if (c < 0x20 || c >= 0x7f) {
+                // \uXXXX keeps the output ASCII
+                Chunk[Count++] = L'\\';
+                Chunk[Count++] = L'u';
+                Chunk[Count++] = HexDigits[(c >> 12) & 0xf];
+                Chunk[Count++] = HexDigits[(c >> 8) & 0xf];
+                Chunk[Count++] = HexDigits[(c >> 4) & 0xf];
+                Chunk[Count++] = HexDigits[c & 0xf];
+            } else {
+                Chunk[Count++] = c;
+            }
+        }
+        if (Count >= EMIT_CHUNK) {
+            Chunk[Count] = CHAR_NULL;
+            Put(Chunk);
+            Count = 0;
+        }
+    }
+    if (Quoted)
+        Chunk[Count++] = L'"';
+    Chunk[Count] = CHAR_NULL;
+    Put(Chunk);
+}
+
+
+//
+//  JSON: the separator, line break, indentation and key of the next member
+//
+static VOID
+Next( CONST CHAR16 *Key )
+{
+    if (Depth == 0)
+        return;
+
+    if (Level[Depth - 1].Count > 0)
+        OutChar(L',');
+    OutChar(L'\n');
+    OutString(&Indent[2 * (EMIT_MAX_DEPTH - Depth)]);
+    if (!Level[Depth - 1].Array) {
+        PutValue(Key != NULL ? Key : L"", NULL, NULL, Key != NULL ? StrLen(Key) : 0, TRUE);
+        OutString(L": ");
+    }
+}
+
+
+static VOID
+Scalar( CONST CHAR16 *Key,
+        CONST CHAR16 *Wide,
+        CONST CHAR8 *Ascii,
+        CONST UINT8 *Bytes,
+        UINTN Length,
+        BOOLEAN Quoted )
+{
+    if (EmitMode == EmitText || Overflow > 0)
+        return;
+
+    if (EmitMode == EmitJson) {
+        Next(Key);
+        PutValue(Wide, Ascii, Bytes, Length, Quoted);
+    } else if (RowDepth == 0) {
+        // key,value line, or just the value in an array
+        if (Depth > 0 && !Level[Depth - 1].Array && Key != NULL) {
+            OutString(Key);
+            OutChar(L',');
+        }
+        PutValue(Wide, Ascii, Bytes, Length, Quoted);
+        OutChar(L'\n');
+        Written = TRUE;
+    } else if (Depth == RowDepth) {
+        if (Columns++ > 0) {
+            if (Header)
+                OutChar(L',');
+            Put(L",");
+        }
+        if (Header && Key != NULL)
+            OutString(Key);
+        PutValue(Wide, Ascii, Bytes, Length, Quoted);
+    }
+
+    if (Depth > 0)
+        Level[Depth - 1].Count++;
+}
+
+
+static VOID
+Open( CONST CHAR16 *Key,
+      BOOLEAN Array )
+{
+    if (EmitMode == EmitText)
+        return;
+    if (Overflow > 0 || Depth == EMIT_MAX_DEPTH) {
+        Overflow++;
+        return;
+    }
+
+    if (EmitMode == EmitJson) {
+        Next(Key);
+        OutChar(Array ? L'[' : L'{');
+    } else if (!Array && RowDepth == 0 && Depth > 0 && Level[Depth - 1].Array) {
+        // an object in an array is a CSV row
+        Header = (Level[Depth - 1].Count == 0);
+        if (Header && Written)
+            OutChar(L'\n');
+        RowDepth = Depth + 1;
+        Columns = 0;
+        RowUsed = 0;
+    }
+
+    if (Depth > 0)
+        Level[Depth - 1].Count++;
+    Level[Depth].Array = Array;
+    Level[Depth].Count = 0;
+    Depth++;
+}
+
+
+VOID
+EFIAPI
+EmitClose( VOID )
+{
+    if (EmitMode == EmitText)
+        return;
+    if (Overflow > 0) {
+        Overflow--;
+        return;
+    }
+    if (Depth == 0)
+        return;
+
+    Depth--;
+    if (EmitMode == EmitJson) {
+        if (Level[Depth].Count > 0) {
+            OutChar(L'\n');
+            OutString(&Indent[2 * (EMIT_MAX_DEPTH - Depth)]);
+        }
+        OutChar(Level[Depth].Array ? L']' : L'}');
+    } else if (Depth + 1 == RowDepth) {
+        OutChar(L'\n');
+        if (Header) {
+            Row[RowUsed] = CHAR_NULL;
+            OutString(Row);
+            OutChar(L'\n');
+        }
+        RowDepth = 0;
+        Header = FALSE;
+        Written = TRUE;
+    }
+}
+
+
+VOID
+EFIAPI
+EmitObject( CONST CHAR16 *Key )
+{
+    Open(Key, FALSE);
+}
+
+
+VOID
+EFIAPI
+EmitArray( CONST CHAR16 *Key )
+{
+    Open(Key, TRUE);
+}
+
+
+VOID
+EFIAPI
+EmitBegin( CONST CHAR16 *Utility,
+           CONST CHAR16 *Version )
+{
+    if (EmitMode == EmitText)
+        return;
+
+    Begun = TRUE;
+    Open(NULL, FALSE);
+    EmitString(L"utility", Utility);
+    EmitString(L"version", Version);
+}
+
+
+VOID
+EFIAPI
+EmitEnd( VOID )
+{
+    if (EmitMode != EmitText && Begun) {
+        while (Depth > 0 || Overflow > 0)
+            EmitClose();
+        if (EmitMode == EmitJson)
+            OutChar(L'\n');
+        Begun = FALSE;
+    }
+
+    if (File != NULL) {
+        OutSetSink(NULL);
+        ShellCloseFile(&File);
+        File = NULL;
+    }
+
+    // MyTools runs the next utility in the same image
+    EmitMode = EmitText;
+    Written = FALSE;
+}
+
+
+VOID
+EFIAPI
+EmitString( CONST CHAR16 *Key,
+            CONST CHAR16 *Value )
+{
+    if (EmitMode != EmitText)
+        Scalar(Key, Value, NULL, NULL, StrLen(Value), TRUE);
+}
+
+
+VOID
+EFIAPI
+EmitAscii( CONST CHAR16 *Key,
+           CONST CHAR8 *Value,
+           UINTN Length )
+{
+    UINTN Count = 0;
+
+    if (EmitMode == EmitText)
+        return;
+
+    while (Count < Length && Value[Count] != '\0')
+        Count++;
+    while (Count > 0 && Value[Count - 1] == ' ')
+        Count--;
+    Scalar(Key, NULL, Value, NULL, Count, TRUE);
+}
+
+
+VOID
+EFIAPI
+EmitUint( CONST CHAR16 *Key,
+          UINT64 Value )
+{
+    CHAR16 Text[21];
+    UINTN Length = 20;
+    UINT32 Remainder;
+
+    if (EmitMode == EmitText)
+        return;
+
+    Text[Length] = CHAR_NULL;
+    do {
+        Value = DivU64x32Remainder(Value, 10, &Remainder);
+        Text[--Length] = L'0' + (CHAR16)Remainder;
+    } while (Value != 0);
+    Scalar(Key, &Text[Length], NULL, NULL, 20 - Length, FALSE);
+}
+
+
+VOID
+EFIAPI
+EmitHex( CONST CHAR16 *Key,
+         UINT64 Value,
+         UINTN Digits )
+{
+    CHAR16 Text[19];
+    UINTN Length = 18;
+
+    if (EmitMode == EmitText)
+        return;
+
+    Text[Length] = CHAR_NULL;
+    do {
+        Text[--Length] = HexDigits[Value & 0xf];
+        Value = RShiftU64(Value, 4);
+    } while ((Value != 0 || 18 - Length < Digits) && Length > 2);
+    Text[--Length] = L'x';
+    Text[--Length] = L'0';
+    Scalar(Key, &Text[Length], NULL, NULL, 18 - Length, TRUE);
+}
+
+
+VOID
+EFIAPI
+EmitBool( CONST CHAR16 *Key,
+          BOOLEAN Value )
+{
+    if (EmitMode != EmitText)
+        Scalar(Key, Value ? L"true" : L"false", NULL, NULL, Value ? 4 : 5, FALSE);
+}
+
+
+VOID
+EFIAPI
+EmitGuid( CONST CHAR16 *Key,
+          CONST EFI_GUID *Guid )
+{
+    CHAR16 Text[40];
+    UINTN Length;
+
+    if (EmitMode == EmitText)
+        return;
+
+    Length = UnicodeSPrint(Text, sizeof(Text), L"%g", Guid);
+    Scalar(Key, Text, NULL, NULL, Length, TRUE);
+}
+
+
+VOID
+EFIAPI
+EmitBytes( CONST CHAR16 *Key,
+           CONST VOID *Data,
+           UINTN Length )
+{
+    if (EmitMode != EmitText)
+        Scalar(Key, NULL, NULL, Data, Length, TRUE);
+}
+
+
+VOID
+EFIAPI
+EmitError( CONST CHAR16 *Format,
+           ... )
+{
+    CHAR16 Message[OUTPUT_PRINT_MAX];
+    VA_LIST Marker;
+
+    VA_START(Marker, Format);
+    UnicodeVSPrint(Message, sizeof(Message), Format, Marker);
+    VA_END(Marker);
+
+    if (EmitMode == EmitText) {
+        OutPrint(L"ERROR: %s\n", Message);
+    } else if (Depth > 0 && Level[Depth - 1].Array) {
+        // an array takes it as a member of its own
+        EmitObject(NULL);
+        EmitString(L"error", Message);
+        EmitClose();
+    } else {
+        EmitString(L"error", Message);
+    }
+}
+
+
+//
+//  A utility that returns early still leaves a complete document
+//
+EFI_STATUS
+EFIAPI
+EmitLibDestructor( EFI_HANDLE ImageHandle,
+                   EFI_SYSTEM_TABLE *SystemTable )
+{
+    EmitEnd();
+
+    return EFI_SUCCESS;
+}
@@ -0,0 +1,33 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  OutHexDump line layout and the line kernels
+//
+//  License: BSD License
+//
+
+#ifndef _HEX_DUMP_H
+#define _HEX_DUMP_H
+
+//
+//  A line after its offset column: two spaces, sixteen "xx " fields with
+//  one more space after the eighth, a space, then the text between bars
+//
+#define HEX_DUMP_BYTES     16
+#define HEX_DUMP_GROUP     8
+#define HEX_DUMP_TEXT      53           // first character after the opening |
+#define HEX_DUMP_LINE      (HEX_DUMP_TEXT + HEX_DUMP_BYTES + 3)    // |\r\n
+
+//
+//  Fill in the hex fields and the text of a full line of Data.  Hex is
+//  the line after its offset column, already blank, and Text is
+//  Hex + HEX_DUMP_TEXT.
+//
+typedef VOID (*HEX_DUMP_LINE_FUNCTION)(CONST UINT8 *Data, CHAR16 *Hex, CHAR16 *Text);
+
+#if defined(MDE_CPU_X64)
+BOOLEAN HexDumpSsse3Supported(VOID);
+VOID    HexDumpLineSsse3(CONST UINT8 *Data, CHAR16 *Hex, CHAR16 *Text);
+#endif
+
+#endif /* _HEX_DUMP_H */
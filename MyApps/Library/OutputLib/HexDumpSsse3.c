@@ -0,0 +1,89 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  OutHexDump line kernel using SSSE3.  The sixteen bytes are split into
+//  nibbles, looked up in the digit table with one pshufb each, spaced out
+//  into "xx " fields with two more shuffles per group of eight and widened
+//  to CHAR16.  Only called after HexDumpSsse3Supported() has checked CPUID.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+
+#include <Register/Cpuid.h>
+
+#include <tmmintrin.h>
+
+#include "HexDump.h"
+
+#ifdef __GNUC__
+#define SSSE3_TARGET  __attribute__((target("ssse3")))
+#else
+#define SSSE3_TARGET
+#endif
+
+
+BOOLEAN
+HexDumpSsse3Supported( VOID )
+{
+    UINT32 Ecx;
+
+    AsmCpuid(CPUID_VERSION_INFO, NULL, NULL, &Ecx, NULL);
+
+    return (Ecx & BIT9) ? TRUE : FALSE;
+}
+
+
+//
+//  24 characters of "xx " fields from the digit pairs of eight bytes
+//
+SSSE3_TARGET static VOID
+StoreGroup( __m128i Pairs,
+            CHAR16 *Hex )
+{
+    CONST __m128i Zero = _mm_setzero_si128();
+    // -1 (0x80 set) leaves a zero byte, which the OR turns into a space
+    CONST __m128i Spread0 = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+    CONST __m128i Spread1 = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    CONST __m128i Space0 = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+    CONST __m128i Space1 = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i Line0, Line1;
+
+    Line0 = _mm_or_si128(_mm_shuffle_epi8(Pairs, Spread0), Space0);
+    Line1 = _mm_or_si128(_mm_shuffle_epi8(Pairs, Spread1), Space1);
+
+    _mm_storeu_si128((__m128i *)&Hex[0], _mm_unpacklo_epi8(Line0, Zero));
+    _mm_storeu_si128((__m128i *)&Hex[8], _mm_unpackhi_epi8(Line0, Zero));
+    _mm_storeu_si128((__m128i *)&Hex[16], _mm_unpacklo_epi8(Line1, Zero));
+}
+
+
+SSSE3_TARGET VOID
+HexDumpLineSsse3( CONST UINT8 *Data,
+                  CHAR16 *Hex,
+                  CHAR16 *Text )
+{
+    CONST __m128i Digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                         '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    CONST __m128i Nibble = _mm_set1_epi8(0x0f);
+    CONST __m128i Zero = _mm_setzero_si128();
+    __m128i Bytes, High, Low, Printable;
+
+    Bytes = _mm_loadu_si128((CONST __m128i *)Data);
+
+    High = _mm_shuffle_epi8(Digits, _mm_and_si128(_mm_srli_epi16(Bytes, 4), Nibble));
+    Low = _mm_shuffle_epi8(Digits, _mm_and_si128(Bytes, Nibble));
+    StoreGroup(_mm_unpacklo_epi8(High, Low), &Hex[2]);
+    StoreGroup(_mm_unpackhi_epi8(High, Low), &Hex[2 + 3 * HEX_DUMP_GROUP + 1]);
+
+    // 0x20 to 0x7e as they are, anything else as '.'; bytes of 0x80 and
+    // over compare as negative
+    Printable = _mm_and_si128(_mm_cmpgt_epi8(Bytes, _mm_set1_epi8(0x1f)),
+                              _mm_cmplt_epi8(Bytes, _mm_set1_epi8(0x7f)));
+    Bytes = _mm_or_si128(_mm_and_si128(Printable, Bytes),
+                         _mm_andnot_si128(Printable, _mm_set1_epi8('.')));
+    _mm_storeu_si128((__m128i *)&Text[0], _mm_unpacklo_epi8(Bytes, Zero));
+    _mm_storeu_si128((__m128i *)&Text[8], _mm_unpackhi_epi8(Bytes, Zero));
+}
@@ -0,0 +1,358 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Buffered console output.  Every Print formats into a private buffer
+//  and makes its own ConOut->OutputString call, so a hex dump printed a
+//  byte at a time costs one console call per byte; on a serial console
+//  each of those is a round of terminal escape handling too.  Here output
+//  accumulates and goes to the console a buffer (or line) at a time, and
+//  the hex and decimal fields the utilities print most are converted
+//  directly instead of through the format parser.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PrintLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/OutputLib.h>
+
+#include "HexDump.h"
+
+static CHAR16 Buffer[OUTPUT_BUFFER_SIZE];
+static UINTN  Used;
+static OUTPUT_MODE Mode = OutputBuffered;
+static CHAR16 Last;                     // last character written
+static OUTPUT_SINK Sink;                // NULL for ConOut
+
+static CONST CHAR16 HexDigits[] = L"0123456789abcdef";
+
+// where each byte's two digits go in a hex dump line
+static CONST UINT8 HexColumn[HEX_DUMP_BYTES] = {
+    2, 5, 8, 11, 14, 17, 20, 23, 27, 30, 33, 36, 39, 42, 45, 48
+};
+
+static HEX_DUMP_LINE_FUNCTION HexDumpLine;
+
+
+VOID
+EFIAPI
+OutFlush( VOID )
+{
+    if (Used == 0)
+        return;
+
+    if (Sink != NULL) {
+        Sink(Buffer, Used);
+    } else {
+        Buffer[Used] = CHAR_NULL;
+        gST->ConOut->OutputString(gST->ConOut, Buffer);
+    }
+    Used = 0;
+}
+
+
+OUTPUT_MODE
+EFIAPI
+OutSetMode( OUTPUT_MODE NewMode )
+{
+    OUTPUT_MODE OldMode = Mode;
+
+    OutFlush();
+    Mode = NewMode;
+
+    return OldMode;
+}
+
+
+VOID
+EFIAPI
+OutSetSink( OUTPUT_SINK NewSink )
+{
+    OutFlush();
+    Sink = NewSink;
+}
+
+
+//
+//  Make room for Count more characters
+//
+static VOID
+Reserve( UINTN Count )
+{
+    if (Used + Count >= OUTPUT_BUFFER_SIZE)
+        OutFlush();
+}
+
+
+//
+//  After the characters from Start on were added
+//
+static VOID
+Added( UINTN Start )
+{
+    UINTN i;
+
+    if (Used > 0)
+        Last = Buffer[Used - 1];
+    if (Mode == OutputUnbuffered) {
+        OutFlush();
+    } else if (Mode == OutputLineBuffered) {
+        for (i = Start; i < Used; i++) {
+            if (Buffer[i] == L'\n') {
+                OutFlush();
+                break;
+            }
+        }
+    }
+}
+
+
+//
+//  Formatted in place when it fits in what is left of the buffer, after
+//  a flush when it fits in the whole buffer, else in a buffer of its own
+//
+UINTN
+EFIAPI
+OutPrint( CONST CHAR16 *Format,
+          ... )
+{
+    VA_LIST Marker;
+    UINTN Start, Length;
+    CHAR16 *Long;
+
+    VA_START(Marker, Format);
+    Length = SPrintLength(Format, Marker);
+    VA_END(Marker);
+
+    Reserve(Length);
+    if (Length >= OUTPUT_BUFFER_SIZE) {
+        Long = AllocatePool((Length + 1) * sizeof(CHAR16));
+        if (Long != NULL) {
+            VA_START(Marker, Format);
+            Length = UnicodeVSPrint(Long, (Length + 1) * sizeof(CHAR16), Format, Marker);
+            VA_END(Marker);
+            OutString(Long);
+            FreePool(Long);
+            return Length;
+        }
+    }
+    Start = Used;
+
+    VA_START(Marker, Format);
+    Length = UnicodeVSPrint(&Buffer[Used], (OUTPUT_BUFFER_SIZE - Used) * sizeof(CHAR16), Format, Marker);
+    VA_END(Marker);
+
+    Used += Length;
+    Added(Start);
+
+    return Length;
+}
+
+
+VOID
+EFIAPI
+OutChar( CHAR16 Char )
+{
+    UINTN Start;
+
+    Reserve(2);
+    Start = Used;
+    if (Char == L'\n' && Last != L'\r')
+        Buffer[Used++] = L'\r';
+    Buffer[Used++] = Char;
+    Added(Start);
+}
+
+
+VOID
+EFIAPI
+OutString( CONST CHAR16 *String )
+{
+    UINTN Start;
+
+    Start = Used;
+    for (; *String != CHAR_NULL; String++) {
+        if (Used + 2 >= OUTPUT_BUFFER_SIZE) {
+            Added(Start);
+            OutFlush();
+            Start = 0;
+        }
+        if (*String == L'\n' && (Used > 0 ? Buffer[Used - 1] : Last) != L'\r')
+            Buffer[Used++] = L'\r';
+        Buffer[Used++] = *String;
+    }
+    Added(Start);
+}
+
+
+VOID
+EFIAPI
+OutHex( UINT64 Value,
+        UINTN Digits )
+{
+    UINTN Start, i;
+
+    if (Digits > 16)
+        Digits = 16;
+    Reserve(Digits);
+    Start = Used;
+    for (i = Digits; i > 0; i--) {
+        Buffer[Used + i - 1] = HexDigits[Value & 0xf];
+        Value = RShiftU64(Value, 4);
+    }
+    Used += Digits;
+    Added(Start);
+}
+
+
+VOID
+EFIAPI
+OutDec( UINT64 Value,
+        UINTN Width )
+{
+    CHAR16 Digits[20];
+    UINTN Count = 0, Start;
+    UINT32 Remainder;
+
+    do {
+        Value = DivU64x32Remainder(Value, 10, &Remainder);
+        Digits[Count++] = L'0' + (CHAR16)Remainder;
+    } while (Value != 0);
+
+    if (Width > 64)
+        Width = 64;
+    Reserve(MAX(Width, Count));
+    Start = Used;
+    for (; Width > Count; Width--)
+        Buffer[Used++] = L' ';
+    while (Count > 0)
+        Buffer[Used++] = Digits[--Count];
+    Added(Start);
+}
+
+
+//
+//  Count bytes of a hex dump line into Hex and Text, one table lookup
+//  per digit
+//
+static VOID
+HexDumpBytes( CONST UINT8 *Data,
+              UINTN Count,
+              CHAR16 *Hex,
+              CHAR16 *Text )
+{
+    UINTN i;
+
+    for (i = 0; i < Count; i++) {
+        Hex[HexColumn[i]] = HexDigits[Data[i] >> 4];
+        Hex[HexColumn[i] + 1] = HexDigits[Data[i] & 0xf];
+        Text[i] = (Data[i] >= 0x20 && Data[i] < 0x7f) ? Data[i] : L'.';
+    }
+}
+
+
+static VOID
+HexDumpLinePortable( CONST UINT8 *Data,
+                     CHAR16 *Hex,
+                     CHAR16 *Text )
+{
+    HexDumpBytes(Data, HEX_DUMP_BYTES, Hex, Text);
+}
+
+
+//
+//  One line, built in place in the output buffer
+//
+static VOID
+HexDumpLineOut( CONST UINT8 *Data,
+                UINTN Count,
+                UINT64 Offset,
+                UINTN Digits )
+{
+    CHAR16 *Hex, *Text;
+    UINTN Start, i;
+
+    Reserve(Digits + HEX_DUMP_LINE);
+    Start = Used;
+    for (i = Digits; i > 0; i--) {
+        Buffer[Used + i - 1] = HexDigits[Offset & 0xf];
+        Offset = RShiftU64(Offset, 4);
+    }
+    Hex = &Buffer[Used + Digits];
+    Text = Hex + HEX_DUMP_TEXT;
+    SetMem16(Hex, (HEX_DUMP_TEXT - 1) * sizeof(CHAR16), L' ');
+    Text[-1] = L'|';
+
+    if (Count == HEX_DUMP_BYTES)
+        HexDumpLine(Data, Hex, Text);
+    else
+        HexDumpBytes(Data, Count, Hex, Text);
+
+    Text[Count] = L'|';
+    Text[Count + 1] = L'\r';
+    Text[Count + 2] = L'\n';
+    Used += Digits + HEX_DUMP_TEXT + Count + 3;
+    Added(Start);
+}
+
+
+VOID
+EFIAPI
+OutHexDump( CONST VOID *Data,
+            UINTN Length,
+            UINT64 Offset )
+{
+    CONST UINT8 *Bytes = Data;
+    UINTN Count, Digits;
+    BOOLEAN Repeat = FALSE;
+
+    if (Length == 0)
+        return;
+
+    if (HexDumpLine == NULL) {
+#if defined(MDE_CPU_X64)
+        HexDumpLine = HexDumpSsse3Supported() ? HexDumpLineSsse3 : HexDumpLinePortable;
+#else
+        HexDumpLine = HexDumpLinePortable;
+#endif
+    }
+
+    Digits = (Offset + Length > 0xffffffff) ? 16 : 8;
+
+    while (Length > 0) {
+        Count = MIN(Length, HEX_DUMP_BYTES);
+        if (Count == HEX_DUMP_BYTES && Bytes != Data &&
+            CompareMem(Bytes, Bytes - HEX_DUMP_BYTES, HEX_DUMP_BYTES) == 0) {
+            if (!Repeat)
+                OutString(L"*\n");
+            Repeat = TRUE;
+        } else {
+            HexDumpLineOut(Bytes, Count, Offset, Digits);
+            Repeat = FALSE;
+        }
+        Bytes += Count;
+        Offset += Count;
+        Length -= Count;
+    }
+
+    OutHex(Offset, Digits);
+    OutChar(L'\n');
+}
+
+
+//
+//  Whatever is still buffered when the utility returns
+//
+EFI_STATUS
+EFIAPI
+OutputLibDestructor( EFI_HANDLE ImageHandle,
+                     EFI_SYSTEM_TABLE *SystemTable )
+{
+    OutFlush();
+
+    return EFI_SUCCESS;
+}
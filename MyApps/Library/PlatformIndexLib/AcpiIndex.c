@@ -0,0 +1,172 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  ACPI index.  The configuration table is searched for RSDPs once, and
+//  the 64-bit XSDT entries of each are turned into a pointer array, so
+//  that a utility asking for the FADT or the MSDM after another utility
+//  has already run only walks that array.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/PlatformIndexLib.h>
+
+#include <Guid/Acpi.h>
+
+#include "PlatformIndex.h"
+
+static ACPI_ROOT *Roots;
+static UINTN      RootCount;
+static BOOLEAN    Indexed;
+
+
+static BOOLEAN
+IsRsdp( EFI_CONFIGURATION_TABLE *Entry )
+{
+    EFI_GUID Acpi20TableGuid = EFI_ACPI_20_TABLE_GUID;
+    EFI_GUID Acpi10TableGuid = ACPI_10_TABLE_GUID;
+
+    if (!CompareGuid(&Entry->VendorGuid, &Acpi20TableGuid) &&
+        !CompareGuid(&Entry->VendorGuid, &Acpi10TableGuid))
+        return FALSE;
+
+    return AsciiStrnCmp("RSD PTR ", (CHAR8 *)(Entry->VendorTable), 8) == 0;
+}
+
+
+static VOID
+AcpiIndexBuild( VOID )
+{
+    EFI_CONFIGURATION_TABLE *ect = gST->ConfigurationTable;
+    EFI_ACPI_SDT_HEADER *Xsdt;
+    ACPI_ROOT *Root;
+    UINT64 *EntryPtr;
+    UINTN Count = 0, EntryCount, i, Index;
+
+    Indexed = TRUE;
+
+    for (i = 0; i < gST->NumberOfTableEntries; i++) {
+        if (IsRsdp(&ect[i]))
+            Count++;
+    }
+    if (Count == 0)
+        return;
+
+    Roots = AllocateZeroPool(Count * sizeof(ACPI_ROOT));
+    if (Roots == NULL)
+        return;
+
+    for (i = 0; i < gST->NumberOfTableEntries; i++) {
+        if (!IsRsdp(&ect[i]))
+            continue;
+
+        Root = &Roots[RootCount++];
+        Root->Guid = &ect[i].VendorGuid;
+        Root->Rsdp = (EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *)ect[i].VendorTable;
+        if (Root->Rsdp->Revision < EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER_REVISION)
+            continue;
+
+        Xsdt = (EFI_ACPI_SDT_HEADER *)(UINTN)(Root->Rsdp->XsdtAddress);
+        Root->Xsdt = Xsdt;
+        if (Xsdt->Signature != SIGNATURE_32('X', 'S', 'D', 'T'))
+            continue;
+
+        EntryCount = (Xsdt->Length - sizeof(EFI_ACPI_SDT_HEADER)) / sizeof(UINT64);
+        if (EntryCount == 0)
+            continue;
+        Root->Tables = AllocatePool(EntryCount * sizeof(EFI_ACPI_SDT_HEADER *));
+        if (Root->Tables == NULL)
+            continue;
+
+        EntryPtr = (UINT64 *)(Xsdt + 1);
+        for (Index = 0; Index < EntryCount; Index++, EntryPtr++)
+            Root->Tables[Index] = (EFI_ACPI_SDT_HEADER *)(UINTN)(*EntryPtr);
+        Root->TableCount = EntryCount;
+    }
+}
+
+
+UINTN
+EFIAPI
+AcpiRootCount( VOID )
+{
+    if (!Indexed)
+        AcpiIndexBuild();
+
+    return RootCount;
+}
+
+
+CONST ACPI_ROOT *
+EFIAPI
+AcpiGetRoot( UINTN Index )
+{
+    if (Index >= AcpiRootCount())
+        return NULL;
+
+    return &Roots[Index];
+}
+
+
+VOID *
+EFIAPI
+AcpiFindTable( UINT32 Signature,
+               UINTN Instance )
+{
+    EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE *Fadt;
+    EFI_ACPI_SDT_HEADER *Table, *Linked;
+    CONST ACPI_ROOT *Root = NULL;
+    UINTN i;
+
+    for (i = 0; i < AcpiRootCount(); i++) {
+        if (Roots[i].TableCount > 0) {
+            Root = &Roots[i];
+            break;
+        }
+    }
+    if (Root == NULL)
+        return NULL;
+
+    for (i = 0; i < Root->TableCount; i++) {
+        Table = Root->Tables[i];
+        if (Table->Signature == Signature && Instance-- == 0)
+            return Table;
+
+        if (Table->Signature != EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE_SIGNATURE)
+            continue;
+        Fadt = (EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE *)Table;
+        if (Signature == EFI_ACPI_2_0_DIFFERENTIATED_SYSTEM_DESCRIPTION_TABLE_SIGNATURE)
+            Linked = (EFI_ACPI_SDT_HEADER *)(UINTN)(Fadt->XDsdt ? Fadt->XDsdt : Fadt->Dsdt);
+        else if (Signature == EFI_ACPI_2_0_FIRMWARE_ACPI_CONTROL_STRUCTURE_SIGNATURE)
+            Linked = (EFI_ACPI_SDT_HEADER *)(UINTN)(Fadt->XFirmwareCtrl ? Fadt->XFirmwareCtrl
+                                                                        : Fadt->FirmwareCtrl);
+        else
+            continue;
+        if (Linked != NULL && Linked->Signature == Signature && Instance-- == 0)
+            return Linked;
+    }
+
+    return NULL;
+}
+
+
+VOID
+AcpiIndexFree( VOID )
+{
+    UINTN i;
+
+    for (i = 0; i < RootCount; i++) {
+        if (Roots[i].Tables != NULL)
+            FreePool(Roots[i].Tables);
+    }
+    if (Roots != NULL)
+        FreePool(Roots);
+    Roots = NULL;
+    RootCount = 0;
+    Indexed = FALSE;
+}
@@ -0,0 +1,260 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  PCI function list.  Scanning every bus range of every root bridge is
+//  thousands of configuration reads, most of them of empty slots, so it
+//  is done once: the vendor ID decides whether anything is there, and a
+//  function that is gets its whole configuration space read in one call
+//  and kept.
+//
+//  License: UDK2015 license applies to code from UDK2015 source,
+//           BSD 2 clause license applies to all other code.
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/PlatformIndexLib.h>
+
+#include <Protocol/PciEnumerationComplete.h>
+
+#include "PlatformIndex.h"
+
+#define CALC_EFI_PCI_ADDRESS(Bus, Dev, Func, Reg) \
+    ((UINT64) ((((UINTN) Bus) << 24) + (((UINTN) Dev) << 16) + (((UINTN) Func) << 8) + ((UINTN) Reg)))
+
+#define PCI_INDEX_GROW  64              // functions per reallocation
+
+static PCI_FUNCTION *Functions;
+static UINTN         FunctionCount;
+static UINTN         FunctionMax;
+static UINTN         RangeCount;
+static EFI_STATUS    IndexStatus;
+static BOOLEAN       Indexed;
+
+
+//
+// Copyed from UDK2015 Source. UDK2015 license applies.
+//
+static EFI_STATUS
+PciGetNextBusRange( EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR  **Descriptors,
+                    UINT16 *MinBus,
+                    UINT16 *MaxBus,
+                    BOOLEAN *IsEnd )
+{
+    *IsEnd = FALSE;
+
+    if ((*Descriptors) == NULL) {
+        *MinBus = 0;
+        *MaxBus = PCI_MAX_BUS;
+        return EFI_SUCCESS;
+    }
+
+    while ((*Descriptors)->Desc != ACPI_END_TAG_DESCRIPTOR) {
+        if ((*Descriptors)->ResType == ACPI_ADDRESS_SPACE_TYPE_BUS) {
+            *MinBus = (UINT16) (*Descriptors)->AddrRangeMin;
+            *MaxBus = (UINT16) (*Descriptors)->AddrRangeMax;
+            (*Descriptors)++;
+            return (EFI_SUCCESS);
+        }
+
+        (*Descriptors)++;
+    }
+
+    if ((*Descriptors)->Desc == ACPI_END_TAG_DESCRIPTOR) {
+        *IsEnd = TRUE;
+    }
+
+    return EFI_SUCCESS;
+}
+
+
+//
+// Copyed from UDK2015 Source. UDK2015 license applies.
+//
+static EFI_STATUS
+PciGetProtocolAndResource( EFI_HANDLE Handle,
+                           EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL **IoDev,
+                           EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR **Descriptors )
+{
+    EFI_STATUS Status;
+
+    // Get inferface from protocol
+    Status = gBS->HandleProtocol( Handle,
+                                  &gEfiPciRootBridgeIoProtocolGuid,
+                                  (VOID**)IoDev);
+    if (EFI_ERROR (Status)) {
+        return Status;
+    }
+
+    Status = (*IoDev)->Configuration (*IoDev, (VOID**)Descriptors);
+    if (Status == EFI_UNSUPPORTED) {
+        *Descriptors = NULL;
+        return EFI_SUCCESS;
+    }
+
+    return Status;
+}
+
+
+static PCI_FUNCTION *
+AddFunction( VOID )
+{
+    PCI_FUNCTION *New;
+
+    if (FunctionCount == FunctionMax) {
+        New = ReallocatePool( FunctionMax * sizeof(PCI_FUNCTION),
+                              (FunctionMax + PCI_INDEX_GROW) * sizeof(PCI_FUNCTION),
+                              Functions );
+        if (New == NULL)
+            return NULL;
+        Functions = New;
+        FunctionMax += PCI_INDEX_GROW;
+    }
+
+    return &Functions[FunctionCount++];
+}
+
+
+static EFI_STATUS
+ScanRange( EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL *IoDev,
+           UINT16 MinBus,
+           UINT16 MaxBus )
+{
+    PCI_FUNCTION *Function;
+    UINT64 Address;
+    UINT16 VendorId;
+
+    for (UINT16 Bus = MinBus; Bus <= MaxBus; Bus++) {
+        for (UINT16 Device = 0; Device <= PCI_MAX_DEVICE; Device++) {
+            for (UINT16 Func = 0; Func <= PCI_MAX_FUNC; Func++) {
+                Address = CALC_EFI_PCI_ADDRESS(Bus, Device, Func, 0);
+
+                IoDev->Pci.Read( IoDev,
+                                 EfiPciWidthUint16,
+                                 Address,
+                                 1,
+                                 &VendorId );
+                if (VendorId == 0xffff) {
+                    if (Func == 0)
+                        break;
+                    continue;
+                }
+
+                Function = AddFunction();
+                if (Function == NULL)
+                    return EFI_OUT_OF_RESOURCES;
+                Function->IoDev = IoDev;
+                Function->Range = RangeCount;
+                Function->Segment = IoDev->SegmentNumber;
+                Function->Bus = (UINT8)Bus;
+                Function->Device = (UINT8)Device;
+                Function->Function = (UINT8)Func;
+                IoDev->Pci.Read( IoDev,
+                                 EfiPciWidthUint32,
+                                 Address,
+                                 ARRAY_SIZE(Function->Config.Data),
+                                 Function->Config.Data );
+
+                if (Func == 0 &&
+                   ((Function->Config.Type0.Hdr.HeaderType & HEADER_TYPE_MULTI_FUNCTION) == 0x00)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    return EFI_SUCCESS;
+}
+
+
+static EFI_STATUS
+PciIndexBuild( VOID )
+{
+    EFI_GUID gEfiPciEnumerationCompleteProtocolGuid = EFI_PCI_ENUMERATION_COMPLETE_GUID;
+    EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL *IoDev;
+    EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR *Descriptors;
+    EFI_HANDLE *HandleBuf = NULL;
+    EFI_STATUS Status;
+    UINTN HandleCount;
+    UINT16 MinBus, MaxBus;
+    BOOLEAN IsEnd;
+    VOID *Interface;
+
+    Status = gBS->LocateProtocol( &gEfiPciEnumerationCompleteProtocolGuid,
+                                  NULL,
+                                  &Interface );
+    if (EFI_ERROR(Status))
+        return EFI_NOT_READY;
+
+    Status = gBS->LocateHandleBuffer( ByProtocol,
+                                      &gEfiPciRootBridgeIoProtocolGuid,
+                                      NULL,
+                                      &HandleCount,
+                                      &HandleBuf );
+    if (EFI_ERROR(Status))
+        return (Status == EFI_OUT_OF_RESOURCES) ? Status : EFI_NOT_FOUND;
+
+    for (UINTN Index = 0; Index < HandleCount; Index++) {
+        Status = PciGetProtocolAndResource( HandleBuf[Index],
+                                            &IoDev,
+                                            &Descriptors );
+        if (EFI_ERROR(Status))
+            break;
+
+        while (TRUE) {
+            Status = PciGetNextBusRange( &Descriptors,
+                                         &MinBus,
+                                         &MaxBus,
+                                         &IsEnd );
+            if (EFI_ERROR(Status) || IsEnd)
+                break;
+
+            Status = ScanRange(IoDev, MinBus, MaxBus);
+            RangeCount++;
+            if (EFI_ERROR(Status) || Descriptors == NULL)
+                break;
+        }
+        if (EFI_ERROR(Status))
+            break;
+    }
+
+    FreePool(HandleBuf);
+
+    return Status;
+}
+
+
+EFI_STATUS
+EFIAPI
+PciGetFunctions( CONST PCI_FUNCTION **List,
+                 UINTN *Count,
+                 UINTN *Ranges )
+{
+    if (!Indexed) {
+        IndexStatus = PciIndexBuild();
+        Indexed = TRUE;
+    }
+
+    *List = Functions;
+    *Count = FunctionCount;
+    if (Ranges != NULL)
+        *Ranges = RangeCount;
+
+    return IndexStatus;
+}
+
+
+VOID
+PciIndexFree( VOID )
+{
+    if (Functions != NULL)
+        FreePool(Functions);
+    Functions = NULL;
+    FunctionCount = 0;
+    FunctionMax = 0;
+    RangeCount = 0;
+    Indexed = FALSE;
+}
@@ -0,0 +1,16 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  PlatformIndexLib internals
+//
+//  License: BSD License
+//
+
+#ifndef _PLATFORM_INDEX_H
+#define _PLATFORM_INDEX_H
+
+VOID AcpiIndexFree(VOID);
+VOID PciIndexFree(VOID);
+VOID VarCacheFree(VOID);
+
+#endif /* _PLATFORM_INDEX_H */
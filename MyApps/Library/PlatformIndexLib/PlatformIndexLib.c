@@ -0,0 +1,26 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  The indexes live as long as the image; whichever of them were built
+//  are freed when it exits
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/PlatformIndexLib.h>
+
+#include "PlatformIndex.h"
+
+
+EFI_STATUS
+EFIAPI
+PlatformIndexLibDestructor( EFI_HANDLE ImageHandle,
+                            EFI_SYSTEM_TABLE *SystemTable )
+{
+    AcpiIndexFree();
+    PciIndexFree();
+    VarCacheFree();
+
+    return EFI_SUCCESS;
+}
@@ -0,0 +1,189 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Variable cache.  Where the variable store is in SMM every GetVariable
+//  is an SMI, and OsIndications and friends are read by several of the
+//  utilities.  Each variable is fetched once, with a single call when it
+//  fits in the first buffer tried, and its data and status kept in a
+//  short list keyed by name and GUID.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/PlatformIndexLib.h>
+
+#include "PlatformIndex.h"
+
+#define VAR_CACHE_FIRST_SIZE  256       // bytes tried before asking for the size
+#define VAR_CACHE_GROW        16        // entries per reallocation
+
+typedef struct {
+    CHAR16     *Name;
+    EFI_GUID    Guid;
+    EFI_STATUS  Status;                 // EFI_SUCCESS or EFI_NOT_FOUND
+    UINT32      Attributes;
+    UINTN       DataSize;
+    VOID       *Data;
+} VAR_CACHE_ENTRY;
+
+static VAR_CACHE_ENTRY *Entries;
+static UINTN            EntryCount;
+static UINTN            EntryMax;
+
+
+static VAR_CACHE_ENTRY *
+Lookup( CHAR16 *Name,
+        EFI_GUID *Guid )
+{
+    UINTN i;
+
+    for (i = 0; i < EntryCount; i++) {
+        if (CompareGuid(&Entries[i].Guid, Guid) && StrCmp(Entries[i].Name, Name) == 0)
+            return &Entries[i];
+    }
+
+    return NULL;
+}
+
+
+static VOID
+Drop( VAR_CACHE_ENTRY *Entry )
+{
+    FreePool(Entry->Name);
+    if (Entry->Data != NULL)
+        FreePool(Entry->Data);
+    *Entry = Entries[--EntryCount];
+}
+
+
+//
+//  NULL if the variable could not be read for some other reason than not
+//  existing; the caller then goes to the firmware itself
+//
+static VAR_CACHE_ENTRY *
+Fetch( CHAR16 *Name,
+       EFI_GUID *Guid )
+{
+    VAR_CACHE_ENTRY *Entry, *New;
+    EFI_STATUS Status;
+    UINTN Size = VAR_CACHE_FIRST_SIZE;
+    UINT32 Attributes = 0;
+    VOID *Buffer;
+
+    Buffer = AllocatePool(Size);
+    if (Buffer == NULL)
+        return NULL;
+    Status = gRT->GetVariable(Name, Guid, &Attributes, &Size, Buffer);
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+        FreePool(Buffer);
+        Buffer = AllocatePool(Size);
+        if (Buffer == NULL)
+            return NULL;
+        Status = gRT->GetVariable(Name, Guid, &Attributes, &Size, Buffer);
+    }
+    if (Status != EFI_SUCCESS && Status != EFI_NOT_FOUND) {
+        FreePool(Buffer);
+        return NULL;
+    }
+
+    if (EntryCount == EntryMax) {
+        New = ReallocatePool( EntryMax * sizeof(VAR_CACHE_ENTRY),
+                              (EntryMax + VAR_CACHE_GROW) * sizeof(VAR_CACHE_ENTRY),
+                              Entries );
+        if (New == NULL) {
+            FreePool(Buffer);
+            return NULL;
+        }
+        Entries = New;
+        EntryMax += VAR_CACHE_GROW;
+    }
+
+    Entry = &Entries[EntryCount];
+    Entry->Name = AllocateCopyPool(StrSize(Name), Name);
+    if (Entry->Name == NULL) {
+        FreePool(Buffer);
+        return NULL;
+    }
+    CopyGuid(&Entry->Guid, Guid);
+    Entry->Status = Status;
+    Entry->Attributes = Attributes;
+    Entry->DataSize = (Status == EFI_SUCCESS) ? Size : 0;
+    Entry->Data = NULL;
+    if (Entry->DataSize > 0)
+        Entry->Data = AllocateCopyPool(Entry->DataSize, Buffer);
+    FreePool(Buffer);
+    if (Entry->DataSize > 0 && Entry->Data == NULL) {
+        FreePool(Entry->Name);
+        return NULL;
+    }
+    EntryCount++;
+
+    return Entry;
+}
+
+
+EFI_STATUS
+EFIAPI
+VarCacheGet( CHAR16 *Name,
+             EFI_GUID *Guid,
+             UINT32 *Attributes,
+             UINTN *DataSize,
+             VOID *Data )
+{
+    VAR_CACHE_ENTRY *Entry;
+
+    Entry = Lookup(Name, Guid);
+    if (Entry == NULL)
+        Entry = Fetch(Name, Guid);
+    if (Entry == NULL)
+        return gRT->GetVariable(Name, Guid, Attributes, DataSize, Data);
+
+    if (Entry->Status != EFI_SUCCESS)
+        return Entry->Status;
+
+    if (Attributes != NULL)
+        *Attributes = Entry->Attributes;
+    if (*DataSize < Entry->DataSize) {
+        *DataSize = Entry->DataSize;
+        return EFI_BUFFER_TOO_SMALL;
+    }
+    *DataSize = Entry->DataSize;
+    CopyMem(Data, Entry->Data, Entry->DataSize);
+
+    return EFI_SUCCESS;
+}
+
+
+EFI_STATUS
+EFIAPI
+VarCacheSet( CHAR16 *Name,
+             EFI_GUID *Guid,
+             UINT32 Attributes,
+             UINTN DataSize,
+             VOID *Data )
+{
+    VAR_CACHE_ENTRY *Entry;
+
+    Entry = Lookup(Name, Guid);
+    if (Entry != NULL)
+        Drop(Entry);
+
+    return gRT->SetVariable(Name, Guid, Attributes, DataSize, Data);
+}
+
+
+VOID
+VarCacheFree( VOID )
+{
+    while (EntryCount > 0)
+        Drop(&Entries[0]);
+    if (Entries != NULL)
+        FreePool(Entries);
+    Entries = NULL;
+    EntryMax = 0;
+}
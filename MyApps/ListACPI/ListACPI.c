@@ -12,8 +12,12 @@
 #include <Library/ShellLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+#include <Library/PlatformIndexLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -24,6 +28,36 @@
 #define UTILITY_VERSION L"20180306"
 #undef DEBUG
 
+#define FINGERPRINT_MAGIC    SIGNATURE_32('A', 'C', 'F', 'P')
+#define FINGERPRINT_VERSION  1
+#define MAX_FINGERPRINTS     0xffff         // the header count is 16 bits
+
+// xxHash64 primes
+#define PRIME64_1  0x9E3779B185EBCA87ULL
+#define PRIME64_2  0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3  0x165667B19E3779F9ULL
+#define PRIME64_4  0x85EBCA77C2B2AE63ULL
+#define PRIME64_5  0x27D4EB2F165667C5ULL
+
+// On-disk fingerprint database, records sorted by key
+#pragma pack(1)
+typedef struct {
+    UINT32 Magic;
+    UINT16 Version;
+    UINT16 Count;
+} FINGERPRINT_HEADER;
+
+typedef struct {
+    UINT32 Signature;
+    CHAR8  OemTableId[8];
+    UINT8  Instance;          // distinguishes tables with identical keys, e.g. SSDTs
+    CHAR8  OemId[6];
+    UINT8  Revision;
+    UINT32 Length;
+    UINT64 Hash;
+} FINGERPRINT;
+#pragma pack()
+
 
 static VOID AsciiToUnicodeSize(CHAR8 *, UINT8, CHAR16 *, BOOLEAN);
 
@@ -56,64 +90,539 @@ PrintTable( EFI_ACPI_SDT_HEADER *Ptr,
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->Signature), 4, Buffer1, FALSE);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->CreatorId), 4, Buffer2, FALSE);
     if ( Verbose ) {
-        Print(L"  %s   0x%02x     %s     0x%08x", Buffer1, (int)(Ptr->Revision), Buffer2, (int)(Ptr->CreatorRevision) );
+        OutPrint(L"  %s   0x%02x     %s     0x%08x", Buffer1, (int)(Ptr->Revision), Buffer2, (int)(Ptr->CreatorRevision) );
         if (!AsciiStrnCmp( (CHAR8 *)&(Ptr->Signature), "SSDT`", 4)) {
             AsciiToUnicodeSize((CHAR8 *)&(Ptr->OemTableId), 8, Buffer1, TRUE);
-            Print(L"   %s", Buffer1);
+            OutPrint(L"   %s", Buffer1);
         }
     } else {
-        Print(L"  %s", Buffer1);
+        OutPrint(L"  %s", Buffer1);
     }
     if (!AsciiStrnCmp( (CHAR8 *)&(Ptr->Signature), "FACP", 4)) {
-        Print(L"  (inc. FACS, DSDT)");
+        OutPrint(L"  (inc. FACS, DSDT)");
+    }
+    OutPrint(L"\n");
+}
+
+
+static VOID
+EmitTable( EFI_ACPI_SDT_HEADER *Ptr )
+{
+    EmitObject(NULL);
+    EmitAscii(L"signature", (CHAR8 *)&(Ptr->Signature), 4);
+    EmitHex(L"address", (UINT64)(UINTN)Ptr, 16);
+    EmitUint(L"length", Ptr->Length);
+    EmitUint(L"revision", Ptr->Revision);
+    EmitAscii(L"oemId", (CHAR8 *)(Ptr->OemId), 6);
+    EmitAscii(L"oemTableId", (CHAR8 *)&(Ptr->OemTableId), 8);
+    EmitHex(L"oemRevision", Ptr->OemRevision, 8);
+    EmitAscii(L"creatorId", (CHAR8 *)&(Ptr->CreatorId), 4);
+    EmitHex(L"creatorRevision", Ptr->CreatorRevision, 8);
+    EmitClose();
+}
+
+
+//
+// 64-bit hash of a table (xxHash64).  Four independent lanes consume 32 bytes
+// per round so the multiplies pipeline; a 256 KiB DSDT hashes in well under
+// a millisecond.
+//
+static UINT64
+HashRound( UINT64 Acc,
+           UINT64 Input )
+{
+    Acc += Input * PRIME64_2;
+    Acc  = LRotU64(Acc, 31);
+    return Acc * PRIME64_1;
+}
+
+
+static UINT64
+HashMerge( UINT64 Acc,
+           UINT64 Val )
+{
+    Acc ^= HashRound(0, Val);
+    return Acc * PRIME64_1 + PRIME64_4;
+}
+
+
+static UINT64
+HashTable( CONST UINT8 *Data,
+           UINTN Length )
+{
+    CONST UINT8 *End = Data + Length;
+    UINT64 Hash;
+
+    if (Length >= 32) {
+        CONST UINT8 *Limit = End - 32;
+        UINT64 V1 = PRIME64_1 + PRIME64_2;
+        UINT64 V2 = PRIME64_2;
+        UINT64 V3 = 0;
+        UINT64 V4 = 0 - PRIME64_1;
+
+        do {
+            V1 = HashRound(V1, ReadUnaligned64((UINT64 *)Data));
+            V2 = HashRound(V2, ReadUnaligned64((UINT64 *)(Data + 8)));
+            V3 = HashRound(V3, ReadUnaligned64((UINT64 *)(Data + 16)));
+            V4 = HashRound(V4, ReadUnaligned64((UINT64 *)(Data + 24)));
+            Data += 32;
+        } while (Data <= Limit);
+
+        Hash = LRotU64(V1, 1) + LRotU64(V2, 7) + LRotU64(V3, 12) + LRotU64(V4, 18);
+        Hash = HashMerge(Hash, V1);
+        Hash = HashMerge(Hash, V2);
+        Hash = HashMerge(Hash, V3);
+        Hash = HashMerge(Hash, V4);
+    } else {
+        Hash = PRIME64_5;
+    }
+
+    Hash += Length;
+
+    while (Data + 8 <= End) {
+        Hash ^= HashRound(0, ReadUnaligned64((UINT64 *)Data));
+        Hash  = LRotU64(Hash, 27) * PRIME64_1 + PRIME64_4;
+        Data += 8;
+    }
+    if (Data + 4 <= End) {
+        Hash ^= (UINT64)ReadUnaligned32((UINT32 *)Data) * PRIME64_1;
+        Hash  = LRotU64(Hash, 23) * PRIME64_2 + PRIME64_3;
+        Data += 4;
+    }
+    while (Data < End) {
+        Hash ^= (*Data++) * PRIME64_5;
+        Hash  = LRotU64(Hash, 11) * PRIME64_1;
+    }
+
+    Hash ^= Hash >> 33;
+    Hash *= PRIME64_2;
+    Hash ^= Hash >> 29;
+    Hash *= PRIME64_3;
+    Hash ^= Hash >> 32;
+
+    return Hash;
+}
+
+
+//
+// Order records by signature, OEM table ID and instance
+//
+static INTN
+CompareFingerprint( CONST FINGERPRINT *A,
+                    CONST FINGERPRINT *B )
+{
+    if (A->Signature != B->Signature)
+        return (A->Signature < B->Signature) ? -1 : 1;
+    if (CompareMem(A->OemTableId, B->OemTableId, sizeof(A->OemTableId)) != 0)
+        return CompareMem(A->OemTableId, B->OemTableId, sizeof(A->OemTableId));
+    return (INTN)A->Instance - (INTN)B->Instance;
+}
+
+
+static VOID
+AddFingerprint( FINGERPRINT *Table,
+                UINTN *Count,
+                EFI_ACPI_SDT_HEADER *Ptr )
+{
+    FINGERPRINT Record;
+    UINTN Index;
+
+    ZeroMem(&Record, sizeof(Record));
+    Record.Signature = Ptr->Signature;
+    CopyMem(Record.OemTableId, &(Ptr->OemTableId), sizeof(Record.OemTableId));
+    CopyMem(Record.OemId, Ptr->OemId, sizeof(Record.OemId));
+    Record.Revision = Ptr->Revision;
+    Record.Length = Ptr->Length;
+    Record.Hash = HashTable((UINT8 *)Ptr, Ptr->Length);
+
+    // number tables sharing a signature and OEM table ID in XSDT order
+    for (Index = 0; Index < *Count; Index++) {
+        if (Table[Index].Signature == Record.Signature &&
+            CompareMem(Table[Index].OemTableId, Record.OemTableId, sizeof(Record.OemTableId)) == 0)
+            Record.Instance++;
+    }
+
+    // insertion sort, the list is short
+    for (Index = *Count; Index > 0; Index--) {
+        if (CompareFingerprint(&Table[Index - 1], &Record) < 0)
+            break;
+        Table[Index] = Table[Index - 1];
+    }
+    Table[Index] = Record;
+    (*Count)++;
+}
+
+
+static VOID
+PrintFingerprint( CONST FINGERPRINT *Fp,
+                  CHAR16 *Change )
+{
+    CHAR16 Buffer1[20], Buffer2[20];
+
+    if (EmitFormat() != EmitText) {
+        EmitObject(NULL);
+        EmitAscii(L"signature", (CHAR8 *)&(Fp->Signature), 4);
+        EmitAscii(L"oemTableId", (CHAR8 *)Fp->OemTableId, 8);
+        EmitUint(L"revision", Fp->Revision);
+        EmitUint(L"length", Fp->Length);
+        EmitHex(L"hash", Fp->Hash, 16);
+        EmitString(L"change", Change);
+        EmitClose();
+        return;
     }
-    Print(L"\n");
+
+    AsciiToUnicodeSize((CHAR8 *)&(Fp->Signature), 4, Buffer1, FALSE);
+    AsciiToUnicodeSize((CHAR8 *)Fp->OemTableId, 8, Buffer2, TRUE);
+    OutPrint(L"  %s  %-10s  0x%02x  0x%08x  %016lx  %s\n", Buffer1, Buffer2,
+             Fp->Revision, Fp->Length, Fp->Hash, Change);
+}
+
+
+//
+// The table is allocated to fit however many records the file holds
+//
+static EFI_STATUS
+LoadFingerprints( CHAR16 *FileName,
+                  FINGERPRINT **Table,
+                  UINTN *Count )
+{
+    SHELL_FILE_HANDLE FileHandle;
+    FINGERPRINT_HEADER Header;
+    EFI_STATUS Status;
+    UINTN Size;
+
+    *Table = NULL;
+    *Count = 0;
+
+    Status = ShellOpenFileByName(FileName, &FileHandle, EFI_FILE_MODE_READ, 0);
+    if (EFI_ERROR(Status))
+        return Status;
+
+    Size = sizeof(Header);
+    Status = ShellReadFile(FileHandle, &Size, &Header);
+    if (!EFI_ERROR(Status)) {
+        if (Size != sizeof(Header) || Header.Magic != FINGERPRINT_MAGIC ||
+            Header.Version != FINGERPRINT_VERSION) {
+            Status = EFI_VOLUME_CORRUPTED;
+        } else {
+            *Table = AllocatePool(MAX(Header.Count, 1) * sizeof(FINGERPRINT));
+            if (*Table == NULL)
+                Status = EFI_OUT_OF_RESOURCES;
+        }
+    }
+    if (!EFI_ERROR(Status)) {
+        Size = Header.Count * sizeof(FINGERPRINT);
+        Status = ShellReadFile(FileHandle, &Size, *Table);
+        if (!EFI_ERROR(Status) && Size != Header.Count * sizeof(FINGERPRINT))
+            Status = EFI_VOLUME_CORRUPTED;
+        if (!EFI_ERROR(Status))
+            *Count = Header.Count;
+    }
+    ShellCloseFile(&FileHandle);
+    if (EFI_ERROR(Status) && *Table != NULL) {
+        FreePool(*Table);
+        *Table = NULL;
+    }
+
+    return Status;
+}
+
+
+static EFI_STATUS
+SaveFingerprints( CHAR16 *FileName,
+                  FINGERPRINT *Table,
+                  UINTN Count )
+{
+    SHELL_FILE_HANDLE FileHandle;
+    FINGERPRINT_HEADER Header;
+    EFI_STATUS Status;
+    UINTN Size;
+
+    // EFI_FILE_MODE_CREATE does not truncate, so remove the previous database first
+    Status = ShellOpenFileByName(FileName, &FileHandle, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0);
+    if (!EFI_ERROR(Status))
+        ShellDeleteFile(&FileHandle);
+
+    Status = ShellOpenFileByName( FileName, 
+                                  &FileHandle,
+                                  EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE,
+                                  0 );
+    if (EFI_ERROR(Status))
+        return Status;
+
+    Header.Magic = FINGERPRINT_MAGIC;
+    Header.Version = FINGERPRINT_VERSION;
+    Header.Count = (UINT16)Count;
+    Size = sizeof(Header);
+    Status = ShellWriteFile(FileHandle, &Size, &Header);
+    if (!EFI_ERROR(Status)) {
+        Size = Count * sizeof(FINGERPRINT);
+        Status = ShellWriteFile(FileHandle, &Size, Table);
+    }
+    ShellCloseFile(&FileHandle);
+
+    return Status;
+}
+
+
+//
+// Linear merge of the previous and current (both sorted) record lists
+//
+static VOID
+CompareFingerprints( FINGERPRINT *Old,
+                     UINTN OldCount,
+                     FINGERPRINT *New,
+                     UINTN NewCount )
+{
+    UINTN i = 0, j = 0;
+    UINTN Changed = 0, Added = 0, Removed = 0;
+    INTN  Order;
+
+    if (EmitFormat() != EmitText)
+        EmitArray(L"changes");
+    else
+        OutPrint(L"\n Table OemTableId   Rev   Length      Hash\n");
+    while (i < OldCount || j < NewCount) {
+        if (i == OldCount)
+            Order = 1;
+        else if (j == NewCount)
+            Order = -1;
+        else
+            Order = CompareFingerprint(&Old[i], &New[j]);
+
+        if (Order < 0) {
+            PrintFingerprint(&Old[i++], L"removed");
+            Removed++;
+        } else if (Order > 0) {
+            PrintFingerprint(&New[j++], L"added");
+            Added++;
+        } else {
+            if (Old[i].Hash != New[j].Hash || Old[i].Length != New[j].Length) {
+                PrintFingerprint(&New[j], L"changed");
+                Changed++;
+            }
+            i++;
+            j++;
+        }
+    }
+
+    if (EmitFormat() != EmitText) {
+        EmitClose();
+        EmitUint(L"tables", NewCount);
+        EmitUint(L"changed", Changed);
+        EmitUint(L"added", Added);
+        EmitUint(L"removed", Removed);
+        return;
+    }
+
+    OutPrint(L"\n%ld tables: %ld changed, %ld added, %ld removed\n",
+             (UINT64)NewCount, (UINT64)Changed, (UINT64)Added, (UINT64)Removed);
 }
 
 
 static int
-ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp, 
-           CHAR16* GuidStr,
+FingerprintRSDP( CONST ACPI_ROOT *Root,
+                 CHAR16 *FileName )
+{
+    EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE *Fadt;
+    EFI_ACPI_SDT_HEADER *Xsdt, *Entry, *Dsdt;
+    FINGERPRINT *Old, *New;
+    UINTN OldCount = 0, NewCount = 0, NewMax;
+    EFI_STATUS Status;
+
+    Xsdt = Root->Xsdt;
+    if (Xsdt == NULL)
+        return 1;
+    if (Xsdt->Signature != SIGNATURE_32 ('X', 'S', 'D', 'T')) {
+        EmitError(L"Invalid ACPI XSDT table found.");
+        return 1;
+    }
+
+    // the XSDT, every entry, and a DSDT for each FADT
+    NewMax = 1 + 2 * Root->TableCount;
+    if (NewMax > MAX_FINGERPRINTS) {
+        EmitError(L"Too many ACPI tables to fingerprint (%ld)", (UINT64)Root->TableCount);
+        return 1;
+    }
+    New = AllocatePool(NewMax * sizeof(FINGERPRINT));
+    if (New == NULL) {
+        EmitError(L"Out of memory resources");
+        return 1;
+    }
+
+    // FACS is left out as firmware rewrites it (waking vector, global lock)
+    AddFingerprint(New, &NewCount, Xsdt);
+    for (UINTN Index = 0; Index < Root->TableCount; Index++) {
+        Entry = Root->Tables[Index];
+        AddFingerprint(New, &NewCount, Entry);
+        if (Entry->Signature == SIGNATURE_32 ('F', 'A', 'C', 'P')) {
+            Fadt = (EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE *)Entry;
+            Dsdt = (EFI_ACPI_SDT_HEADER *)(UINTN)(Fadt->XDsdt ? Fadt->XDsdt : Fadt->Dsdt);
+            if (Dsdt != NULL)
+                AddFingerprint(New, &NewCount, Dsdt);
+        }
+    }
+
+    Status = LoadFingerprints(FileName, &Old, &OldCount);
+    if (Status == EFI_NOT_FOUND) {
+        if (EmitFormat() != EmitText)
+            EmitString(L"created", FileName);
+        else
+            OutPrint(L"No fingerprint database found. Creating %s\n", FileName);
+    } else if (EFI_ERROR(Status)) {
+        EmitError(L"Invalid fingerprint database %s [%r]", FileName, Status);
+    } else {
+        CompareFingerprints(Old, OldCount, New, NewCount);
+    }
+
+    Status = SaveFingerprints(FileName, New, NewCount);
+    if (EFI_ERROR(Status))
+        EmitError(L"Could not write %s [%r]", FileName, Status);
+
+    if (Old != NULL)
+        FreePool(Old);
+    FreePool(New);
+
+    return EFI_ERROR(Status) ? 1 : 0;
+}
+
+
+static VOID
+DumpTable( EFI_ACPI_SDT_HEADER *Ptr,
+           UINT32 Signature,
+           UINTN *Found )
+{
+    CHAR16 Buffer[20];
+
+    if (Ptr == NULL || Ptr->Signature != Signature)
+        return;
+
+    (*Found)++;
+
+    if (EmitFormat() != EmitText) {
+        EmitObject(NULL);
+        EmitAscii(L"signature", (CHAR8 *)&(Ptr->Signature), 4);
+        EmitHex(L"address", (UINT64)(UINTN)Ptr, 16);
+        EmitUint(L"length", Ptr->Length);
+        EmitBytes(L"data", Ptr, Ptr->Length);
+        EmitClose();
+        return;
+    }
+
+    AsciiToUnicodeSize((CHAR8 *)&(Ptr->Signature), 4, Buffer, FALSE);
+    OutPrint(L"\n%s at 0x%08lx, %d bytes\n", Buffer, (UINT64)(UINTN)Ptr, Ptr->Length);
+    OutHexDump(Ptr, Ptr->Length, 0);
+}
+
+
+//
+// Hex dump every table with the given signature, DSDT and FACS included
+//
+static int
+DumpRSDP( CONST ACPI_ROOT *Root,
+          CHAR16 *Name )
+{
+    EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE *Fadt;
+    EFI_ACPI_SDT_HEADER *Xsdt, *Entry;
+    UINT32 Signature;
+    UINTN Found = 0;
+
+    if (StrLen(Name) != 4) {
+        EmitError(L"A table signature is 4 characters, e.g. DSDT");
+        return 1;
+    }
+    Signature = SIGNATURE_32(Name[0], Name[1], Name[2], Name[3]);
+
+    Xsdt = Root->Xsdt;
+    if (Xsdt == NULL)
+        return 1;
+    if (Xsdt->Signature != SIGNATURE_32 ('X', 'S', 'D', 'T')) {
+        EmitError(L"Invalid ACPI XSDT table found.");
+        return 1;
+    }
+
+    EmitArray(L"tables");
+    DumpTable(Xsdt, Signature, &Found);
+    for (UINTN Index = 0; Index < Root->TableCount; Index++) {
+        Entry = Root->Tables[Index];
+        DumpTable(Entry, Signature, &Found);
+        if (Entry->Signature == SIGNATURE_32 ('F', 'A', 'C', 'P')) {
+            Fadt = (EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE *)Entry;
+            DumpTable((EFI_ACPI_SDT_HEADER *)(UINTN)(Fadt->XDsdt ? Fadt->XDsdt : Fadt->Dsdt),
+                      Signature, &Found);
+            // FACS has no standard header but starts with signature and length
+            DumpTable((EFI_ACPI_SDT_HEADER *)(UINTN)(Fadt->XFirmwareCtrl ? Fadt->XFirmwareCtrl
+                                                                         : Fadt->FirmwareCtrl),
+                      Signature, &Found);
+        }
+    }
+
+    EmitClose();
+
+    if (Found == 0) {
+        EmitError(L"No %s table found.", Name);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+static int
+ParseRSDP( CONST ACPI_ROOT *Root,
            BOOLEAN Verbose )
 {
+    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = Root->Rsdp;
     EFI_ACPI_SDT_HEADER *Xsdt;
     UINT32 EntryCount;
-    UINT64 *EntryPtr;
     CHAR16 OemStr[20];
 
 #ifdef DEBUG
-    Print(L"\n\nACPI GUID: %s\n", GuidStr);
+    OutPrint(L"\n\nACPI GUID: %g\n", Root->Guid);
 #endif
 
     if (Rsdp->Revision >= EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER_REVISION) {
-        if ( Verbose ) {
+        if ( Verbose && EmitFormat() == EmitText ) {
             AsciiToUnicodeSize((CHAR8 *)(Rsdp->OemId), 6, OemStr, FALSE);
-            Print(L"\nRSDP Revision: %d  OEM ID: %s\n", (int)(Rsdp->Revision), OemStr);
+            OutPrint(L"\nRSDP Revision: %d  OEM ID: %s\n", (int)(Rsdp->Revision), OemStr);
         }
-        Xsdt = (EFI_ACPI_SDT_HEADER *)(Rsdp->XsdtAddress);
+        Xsdt = Root->Xsdt;
     } else {
 #ifdef DEBUG
-        Print(L"ERROR: RSDP table < revision ACPI 2.0 found.\n");
+        OutPrint(L"ERROR: RSDP table < revision ACPI 2.0 found.\n");
 #endif
         return 1;
     }
 
     if (Xsdt->Signature != SIGNATURE_32 ('X', 'S', 'D', 'T')) {
-        Print(L"ERROR: Invalid ACPI XSDT table found.\n");
+        EmitError(L"Invalid ACPI XSDT table found.");
         return 1;
     }
 
-    EntryCount = (Xsdt->Length - sizeof (EFI_ACPI_SDT_HEADER)) / sizeof(UINT64);
+    EntryCount = (UINT32)Root->TableCount;
+
+    if (EmitFormat() != EmitText) {
+        EmitUint(L"rsdpRevision", Rsdp->Revision);
+        EmitAscii(L"rsdpOemId", (CHAR8 *)(Rsdp->OemId), 6);
+        EmitUint(L"xsdtRevision", Xsdt->Revision);
+        EmitAscii(L"xsdtOemId", (CHAR8 *)(Xsdt->OemId), 6);
+        EmitArray(L"tables");
+        for (UINTN Index = 0; Index < EntryCount; Index++) {
+            EmitTable(Root->Tables[Index]);
+        }
+        EmitClose();
+        return 0;
+    }
+
     if ( Verbose ) {
         AsciiToUnicodeSize((CHAR8 *)(Xsdt->OemId), 6, OemStr, FALSE);
-        Print(L"XSDT Revision: %d  OEM ID: %s  Entry Count: %d\n\n", (int)(Xsdt->Revision), OemStr, EntryCount);
+        OutPrint(L"XSDT Revision: %d  OEM ID: %s  Entry Count: %d\n\n", (int)(Xsdt->Revision), OemStr, EntryCount);
 
-        Print(L" Table Revision CreatorID  CreatorRev\n");
+        OutPrint(L" Table Revision CreatorID  CreatorRev\n");
     }
  
-    EntryPtr = (UINT64 *)(Xsdt + 1);
-    for (int Index = 0; Index < EntryCount; Index++, EntryPtr++) {
-        PrintTable((EFI_ACPI_SDT_HEADER *)((UINTN)(*EntryPtr)), Verbose);
+    for (UINTN Index = 0; Index < EntryCount; Index++) {
+        PrintTable(Root->Tables[Index], Verbose);
     }
 
     return 0;
@@ -123,8 +632,10 @@ ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp,
 static void
 Usage( void )
 {
-    Print(L"Usage: ListACPI [-v | --verbose]\n");
-    Print(L"       ListACPI [-V | --version]\n");
+    OutPrint(L"Usage: ListACPI [-v | --verbose] [--json | --csv] [-o | --output filename]\n");
+    OutPrint(L"       ListACPI [-f | --fingerprint filename]\n");
+    OutPrint(L"       ListACPI [-d | --dump signature]\n");
+    OutPrint(L"       ListACPI [-V | --version]\n");
 }
 
 
@@ -133,21 +644,24 @@ EFIAPI
 ShellAppMain( UINTN Argc,
               CHAR16 **Argv )
 {
-    EFI_CONFIGURATION_TABLE *ect = gST->ConfigurationTable;
-    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = NULL;
-    EFI_GUID gAcpi20TableGuid = EFI_ACPI_20_TABLE_GUID;
-    EFI_GUID gAcpi10TableGuid = ACPI_10_TABLE_GUID;
+    CONST ACPI_ROOT *Root;
+    EFI_ACPI_SDT_HEADER *Tried = NULL;
     EFI_STATUS Status = EFI_SUCCESS;
-    CHAR16 GuidStr[100];
+    BOOLEAN Done = FALSE;
+    CHAR16 *FileName = NULL;
+    CHAR16 *DumpName = NULL;
     BOOLEAN Verbose = FALSE;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--verbose") ||
             !StrCmp(Argv[1], L"-v")) {
             Verbose = TRUE;
         } else if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -158,28 +672,54 @@ ShellAppMain( UINTN Argc,
             return Status;
         }
     }
-    if (Argc > 2) {
+    if (Argc == 3) {
+        if (!StrCmp(Argv[1], L"--fingerprint") ||
+            !StrCmp(Argv[1], L"-f")) {
+            FileName = Argv[2];
+        } else if (!StrCmp(Argv[1], L"--dump") ||
+            !StrCmp(Argv[1], L"-d")) {
+            DumpName = Argv[2];
+        } else {
+            Usage();
+            return Status;
+        }
+    }
+    if (Argc > 3) {
         Usage();
         return Status;
     }
 
+    EmitBegin(L"ListACPI", UTILITY_VERSION);
 
     // locate RSDP (Root System Description Pointer) 
-    for (int i = 0; i < gST->NumberOfTableEntries; i++) {
-        if ((CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi20TableGuid)) ||
-            (CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi10TableGuid))) {
-            if (!AsciiStrnCmp("RSD PTR ", (CHAR8 *)(ect->VendorTable), 8)) {
-                UnicodeSPrint(GuidStr, sizeof(GuidStr), L"%g", &(gST->ConfigurationTable[i].VendorGuid));
-                Rsdp = (EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *)ect->VendorTable;
-                ParseRSDP(Rsdp, GuidStr, Verbose); 
-            }        
+    for (UINTN i = 0; i < AcpiRootCount(); i++) {
+        Root = AcpiGetRoot(i);
+        if (FileName != NULL || DumpName != NULL) {
+            // an ACPI 1.0 RSDP has no XSDT; the 1.0 and 2.0 entries may share one
+            if (Root->Xsdt == NULL || Root->Xsdt == Tried)
+                continue;
+            Tried = Root->Xsdt;
+            if (FileName != NULL)
+                Done = (FingerprintRSDP(Root, FileName) == 0);
+            else
+                Done = (DumpRSDP(Root, DumpName) == 0);
+            if (Done)
+                break;
+        } else if (ParseRSDP(Root, Verbose) == 0 &&
+                   EmitFormat() != EmitText) {
+            // the ACPI 1.0 and 2.0 entries may point at the same RSDP
+            break;
         }
-        ect++;
     }
 
-    if (Rsdp == NULL) {
-        Print(L"ERROR: Could not find an ACPI RSDP table.\n");
+    if (AcpiRootCount() == 0) {
+        EmitError(L"Could not find an ACPI RSDP table.");
         Status = EFI_NOT_FOUND;
+    } else if ((FileName != NULL || DumpName != NULL) && !Done) {
+        // the functions report their own errors, so only say why none ran
+        if (Tried == NULL)
+            EmitError(L"Could not find an ACPI 2.0 XSDT table.");
+        Status = (Tried == NULL) ? EFI_NOT_FOUND : EFI_ABORTED;
     }
 
     return Status;
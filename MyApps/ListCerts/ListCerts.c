@@ -17,6 +17,8 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
 
 #include <Guid/GlobalVariable.h>
 #include <Guid/WinCertificate.h>
@@ -28,426 +30,818 @@
 #include "oid_registry.h"
 #include "x509.h"
 #include "asn1_ber_decoder.h"
-
-#define UTCDATE_LEN 23
+#include "x509_cert.h"
+#include "pkcs7_msg.h"
+#include "public_key.h"
+#include "query.h"
+#include "arena.h"
+#include "varread.h"
+#include "snapshot.h"
+#include "hashidx.h"
+#include "certset.h"
+#include "certgraph.h"
+#include "pecoff.h"
+#include "parallel.h"
+
+#define LINE_MAX    1024
 #define UTILITY_VERSION L"20180226"
+#define VAR_PK      0           // index of PK in the variables table
+#define VAR_KEK     1           // index of KEK in the variables table
+#define VAR_DB      2           // index of db in the variables table
+#define VAR_DBX     3           // index of dbx in the variables table
+#define VAR_DBT     4           // index of dbt in the variables table
+#define VAR_DBR     5           // index of dbr in the variables table
+#define VAR_NONE    MAX_UINTN
 #undef DEBUG
 
 
+/* scratch memory for one variable decode */
+static SCRATCH_ARENA Scratch;
+
+/* sorted digests of all hash entries, built for --check */
+static HASH_INDEX Hashes;
+
+/* certificate fingerprints of all variables, built for --duplicates */
+static CERT_SET Certs;
+
+/* one buffer for every variable read, sized once from QueryVariableInfo */
+static VAR_READER Reader;
 
-/* temporary store for output text */
-CHAR16 tmpbuf[1000];
-int    wrapno = 1;
+/* issuer links between certificates, built for --graph */
+static CERT_GRAPH Graph;
 
+/* fields to show and certificates to show, from --select and --where */
+static struct x509_query Query;
+
+/* processors certificates are decoded on, found once at startup */
+static PARALLEL Parallel;
+
+
+//
+//  Signature types found in signature databases.  DigestSize is set for
+//  the hash types; X509_SHA* entries are followed by a revocation time.
+//
+typedef struct {
+    EFI_GUID Guid;
+    CHAR16   *Name;
+    UINTN    DigestSize;
+} SIGNATURE_TYPE;
+
+static SIGNATURE_TYPE SignatureTypes[] = {
+    { EFI_CERT_X509_GUID,         L"X509",         0 },
+    { EFI_CERT_TYPE_PKCS7_GUID,   L"PKCS7",        0 },
+    { EFI_CERT_RSA2048_GUID,      L"RSA2048",      0 },
+    { EFI_CERT_SHA1_GUID,         L"SHA1",        20 },
+    { EFI_CERT_SHA224_GUID,       L"SHA224",      28 },
+    { EFI_CERT_SHA256_GUID,       L"SHA256",      32 },
+    { EFI_CERT_SHA384_GUID,       L"SHA384",      48 },
+    { EFI_CERT_SHA512_GUID,       L"SHA512",      64 },
+    { EFI_CERT_X509_SHA256_GUID,  L"X509_SHA256", 32 },
+    { EFI_CERT_X509_SHA384_GUID,  L"X509_SHA384", 48 },
+    { EFI_CERT_X509_SHA512_GUID,  L"X509_SHA512", 64 },
+};
+
+#define SIGNATURE_TYPE_X509     0
+#define SIGNATURE_TYPE_PKCS7    1
+#define SIGNATURE_TYPE_RSA2048  2
+#define SIGNATURE_TYPE_UNKNOWN  ARRAY_SIZE(SignatureTypes)
 
-CHAR16 *
-AsciiToUnicode( const char *s, 
-                int len )
+//
+//  Signature database variables.  Active ones are enforced by firmware;
+//  dbt and dbr hold timestamping and recovery keys, and the *Default
+//  variables the factory contents of the database named by DefaultOf.
+//
+typedef struct {
+    CHAR16   *Name;
+    EFI_GUID Vendor;
+    CHAR16   *Option;           // command line switch selecting it
+    BOOLEAN  Active;
+    UINTN    DefaultOf;         // VAR_* index, VAR_NONE if not a default
+} SECURE_VARIABLE;
+
+static SECURE_VARIABLE SecureVariables[] = {
+    { L"PK",         EFI_GLOBAL_VARIABLE,              L"-pk",         TRUE,  VAR_NONE },
+    { L"KEK",        EFI_GLOBAL_VARIABLE,              L"-kek",        TRUE,  VAR_NONE },
+    { L"db",         EFI_IMAGE_SECURITY_DATABASE_GUID, L"-db",         TRUE,  VAR_NONE },
+    { L"dbx",        EFI_IMAGE_SECURITY_DATABASE_GUID, L"-dbx",        TRUE,  VAR_NONE },
+    { L"dbt",        EFI_IMAGE_SECURITY_DATABASE_GUID, L"-dbt",        FALSE, VAR_NONE },
+    { L"dbr",        EFI_IMAGE_SECURITY_DATABASE_GUID, L"-dbr",        FALSE, VAR_NONE },
+    { L"PKDefault",  EFI_GLOBAL_VARIABLE,              L"-pkdefault",  FALSE, VAR_PK },
+    { L"KEKDefault", EFI_GLOBAL_VARIABLE,              L"-kekdefault", FALSE, VAR_KEK },
+    { L"dbDefault",  EFI_GLOBAL_VARIABLE,              L"-dbdefault",  FALSE, VAR_DB },
+    { L"dbxDefault", EFI_GLOBAL_VARIABLE,              L"-dbxdefault", FALSE, VAR_DBX },
+    { L"dbtDefault", EFI_GLOBAL_VARIABLE,              L"-dbtdefault", FALSE, VAR_DBT },
+    { L"dbrDefault", EFI_GLOBAL_VARIABLE,              L"-dbrdefault", FALSE, VAR_DBR },
+};
+
+typedef EFI_STATUS (*SIGNATURE_VISITOR)(UINTN Type, EFI_SIGNATURE_DATA *Cert, UINTN Size, VOID *Context);
+
+
+static UINTN
+LookupSignatureType( EFI_GUID *Guid )
 {
-    CHAR16 *ret = NULL;
-    int i;
+    UINTN i;
 
-    ret = AllocateZeroPool(len*2 + 2);
-    if (!ret)
-        return NULL;
+    for (i = 0; i < ARRAY_SIZE(SignatureTypes); i++) {
+        if (CompareGuid(Guid, &SignatureTypes[i].Guid))
+            return i;
+    }
+
+    return SIGNATURE_TYPE_UNKNOWN;
+}
 
-    for (i = 0; i < len; i++)
-        ret[i] = s[i];
 
-    return ret;
+static CHAR16 *
+SignatureTypeName( UINTN Type )
+{
+    return (Type == SIGNATURE_TYPE_UNKNOWN) ? L"Unknown" : SignatureTypes[Type].Name;
 }
 
 
-int 
-do_version( void *context, 
-            long state_index,
-            unsigned char tag,
-            const void *value, 
-            long vlen )
+//
+//  Append formatted text to a line buffer, returning the new length
+//
+static UINTN
+AppendLine( CHAR16 *Line,
+            UINTN Pos,
+            CONST CHAR16 *Format,
+            ... )
 {
-    int version = *(const char *)value;
+    VA_LIST Marker;
 
-    Print(L"  Version: %d (0x%02x)\n", version + 1, version);
+    if (Pos >= LINE_MAX - 1)
+        return Pos;
 
-    return 0;
+    VA_START(Marker, Format);
+    Pos += UnicodeVSPrint(Line + Pos, (LINE_MAX - Pos) * sizeof(CHAR16), Format, Marker);
+    VA_END(Marker);
+
+    return Pos;
 }
 
 
-int
-do_signature( void *context, 
-              long state_index,
-              unsigned char tag,
-              const void *value,
-              long vlen )
+//
+//  Append raw string bytes, one CHAR16 per byte
+//
+static UINTN
+AppendBytes( CHAR16 *Line,
+             UINTN Pos,
+             CONST UINT8 *Bytes,
+             UINTN Length )
 {
-    Print(L"  Signature Algorithm: %s\n", tmpbuf);
-    tmpbuf[0] = '\0';
+    while (Length-- > 0 && Pos < LINE_MAX - 1)
+        Line[Pos++] = *Bytes++;
+    Line[Pos] = L'\0';
 
-    return 0;
+    return Pos;
 }
 
 
-int
-do_algorithm( void *context,
-              long state_index,
-              unsigned char tag,
-              const void *value, 
-              long vlen )
-{
-    enum OID oid; 
-    CHAR16 buffer[100];
-
-    oid = Lookup_OID(value, vlen);
-    Sprint_OID(value, vlen, buffer, sizeof(buffer));
-    if (oid == OID_id_dsa_with_sha1)
-        StrCpy(tmpbuf, L"id_dsa_with_sha1");
-    else if (oid == OID_id_dsa)
-        StrCpy(tmpbuf, L"id_dsa");
-    else if (oid == OID_id_ecdsa_with_sha1)
-        StrCpy(tmpbuf, L"id_ecdsa_with_sha1");
-    else if (oid == OID_id_ecPublicKey)
-        StrCpy(tmpbuf, L"id_ecPublicKey");
-    else if (oid == OID_rsaEncryption)
-        StrCpy(tmpbuf, L"rsaEncryption");
-    else if (oid == OID_md2WithRSAEncryption)
-        StrCpy(tmpbuf, L"md2WithRSAEncryption");
-    else if (oid == OID_md3WithRSAEncryption)
-        StrCpy(tmpbuf, L"md3WithRSAEncryption");
-    else if (oid == OID_md4WithRSAEncryption)
-        StrCpy(tmpbuf, L"md4WithRSAEncryption");
-    else if (oid == OID_sha1WithRSAEncryption)
-        StrCpy(tmpbuf, L"sha1WithRSAEncryption");
-    else if (oid == OID_sha256WithRSAEncryption)
-        StrCpy(tmpbuf, L"sha256WithRSAEncryption");
-    else if (oid == OID_sha384WithRSAEncryption)
-        StrCpy(tmpbuf, L"sha384WithRSAEncryption");
-    else if (oid == OID_sha512WithRSAEncryption)
-        StrCpy(tmpbuf, L"sha512WithRSAEncryption");
-    else if (oid == OID_sha224WithRSAEncryption)
-        StrCpy(tmpbuf, L"sha224WithRSAEncryption");
-    else {
-        StrCat(tmpbuf, L" (");
-        StrCat(tmpbuf, buffer);
-        StrCat(tmpbuf, L")");
-    }
-
-    return 0;
-}
-
-
-int 
-do_serialnumber( void *context, 
-                 long state_index,
-                 unsigned char tag,
-                 const void *value, 
-                 long vlen )
+//
+//  Append an OID given as a slice of the DER buffer at Data
+//
+static UINTN
+AppendOid( CHAR16 *Line,
+           UINTN Pos,
+           CONST UINT8 *Data,
+           CONST struct x509_slice *Id )
 {
-    int i;
-    char *p = (char *)value;
+    CHAR16 Buffer[100];
 
-    Print(L"  Serial Number: ");
-    if (vlen > 4) {
-        for (i = 0; i < vlen; i++, p++) {
-            Print(L"%02x%c", (UINT8)*p, ((i+1 == vlen)?' ':':'));
-        }
-    }
-    Print(L"\n");
+    Sprint_OID(Data + Id->offset, Id->length, Buffer, sizeof(Buffer));
+    return AppendLine(Line, Pos, L" (%s)", Buffer);
+}
+
+
+static UINTN
+AppendAlgorithm( CHAR16 *Line,
+                 UINTN Pos,
+                 CONST UINT8 *Data,
+                 CONST struct x509_algorithm *Algo )
+{
+    CONST CHAR16 *Name = OID_Name(Algo->oid);
 
-    return 0;
+    if (Name != NULL)
+        return AppendLine(Line, Pos, L"%s", Name);
+    return AppendOid(Line, Pos, Data, &Algo->id);
 }
 
 
-int
-do_issuer( void *context,
-           long  state_index,
-           unsigned char tag,
-           const void *value,
-           long vlen )
+static UINTN
+AppendName( CHAR16 *Line,
+            UINTN Pos,
+            CONST struct x509_certificate *Cert,
+            CONST struct x509_name *Name )
 {
-    Print(L"  Issuer:%s\n", tmpbuf);
-    tmpbuf[0] = '\0';
+    CONST struct x509_attribute *Attr = &Cert->attrs[Name->first];
+    CONST CHAR16 *Type;
+    int i;
+
+    for (i = 0; i < Name->count; i++, Attr++) {
+        Type = OID_Name(Attr->type);
+        if (Type != NULL)
+            Pos = AppendLine(Line, Pos, L" %s=", Type);
+        else
+            Pos = AppendOid(Line, Pos, Cert->data, &Attr->id);
+        Pos = AppendBytes(Line, Pos, X509_SLICE_PTR(Cert, Attr->value), Attr->value.length);
+    }
 
-    return 0;
+    return Pos;
 }
 
 
-int
-do_subject( void *context,
-            long state_index,
-            unsigned char tag,
-            const void *value,
-            long vlen )
+static UINTN
+AppendTime( CHAR16 *Line,
+            UINTN Pos,
+            UINT64 Time )
 {
-    Print(L"  Subject:%s\n", tmpbuf);
-    tmpbuf[0] = '\0';
+    if (Time == 0)
+        return AppendLine(Line, Pos, L"invalid");
 
-    return 0;
+    return AppendLine(Line, Pos, L"%04d-%02d-%02d %02d:%02d:%02d UTC",
+                      X509_TIME_YEAR(Time), X509_TIME_MONTH(Time), X509_TIME_DAY(Time),
+                      X509_TIME_HOUR(Time), X509_TIME_MINUTE(Time), X509_TIME_SECOND(Time));
 }
 
 
-int
-do_attribute_type( void *context,
-                   long state_index,
-                   unsigned char tag,
-                   const void *value,
-                   long vlen )
-{
-    enum OID oid; 
-    CHAR16 buffer[60];
-
-    oid = Lookup_OID(value, vlen);
-    Sprint_OID(value, vlen, buffer, sizeof(buffer));
-   
-    if (oid == OID_countryName) {
-        StrCat(tmpbuf, L" C=");
-    } else if (oid == OID_stateOrProvinceName) {
-        StrCat(tmpbuf, L" ST=");
-    } else if (oid == OID_locality) {
-        StrCat(tmpbuf, L" L=");
-    } else if (oid == OID_organizationName) {
-        StrCat(tmpbuf, L" O=");
-    } else if (oid == OID_commonName) {
-        StrCat(tmpbuf, L" CN=");
-    } else {
-        StrCat(tmpbuf, L" (");
-        StrCat(tmpbuf, buffer);
-        StrCat(tmpbuf, L")");
+static VOID
+PrintValidity( CONST struct x509_certificate *Cert,
+               UINTN Fields )
+{
+    CHAR16 Line[LINE_MAX];
+    UINTN Pos = 0;
+
+    Pos = AppendLine(Line, Pos, L"  Validity: ");
+    if (Fields & X509_NOT_BEFORE) {
+        Pos = AppendLine(Line, Pos, L" Not Before: ");
+        Pos = AppendTime(Line, Pos, Cert->valid_from);
+        if (Fields & X509_NOT_AFTER)
+            Pos = AppendLine(Line, Pos, L"  ");
     }
-
-    return 0;
+    if (Fields & X509_NOT_AFTER) {
+        Pos = AppendLine(Line, Pos, L" Not After: ");
+        Pos = AppendTime(Line, Pos, Cert->valid_to);
+    }
+    OutString(Line);
+    OutString(L"\n");
 }
 
 
-int
-do_attribute_value( void *context,
-                    long state_index,
-                    unsigned char tag,
-                    const void *value,
-                    long vlen )
+//
+//  Format the given X509_* fields of a decoded certificate.  Fingerprint,
+//  if not NULL, is the SHA-256 of the certificate already computed.
+//
+static VOID
+PrintCertificate( CONST struct x509_certificate *Cert,
+                  UINTN Fields,
+                  CONST UINT8 *Fingerprint )
 {
-    CHAR16 *ptr;
+    CONST UINT8 *p;
+    CONST CHAR16 *Name;
+    CHAR16 Line[LINE_MAX];
+    UINT8 Digest[SHA256_DIGEST_SIZE];
+    struct x509_public_key Key;
+    UINTN Pos, Start;
+    int i, version, wrapno = 1;
+
+    if ((Fields & X509_VERSION) && Cert->version.length > 0) {
+        version = *(CONST char *)X509_SLICE_PTR(Cert, Cert->version);
+        OutPrint(L"  Version: %d (0x%02x)\n", version + 1, version);
+    }
+
+    if (Fields & X509_SERIAL) {
+        Pos = AppendLine(Line, 0, L"  Serial Number: ");
+        if (Cert->serial.length > 4) {
+            p = X509_SLICE_PTR(Cert, Cert->serial);
+            for (i = 0; i < Cert->serial.length; i++, p++) {
+                Pos = AppendLine(Line, Pos, L"%02x%c", *p, ((i+1 == Cert->serial.length)?' ':':'));
+            }
+        }
+        OutString(Line);
+        OutString(L"\n");
+    }
+
+    if (Fields & X509_SIG_ALGO) {
+        Pos = AppendLine(Line, 0, L"  Signature Algorithm: ");
+        Pos = AppendAlgorithm(Line, Pos, Cert->data, &Cert->sig_algo);
+        OutString(Line);
+        OutString(L"\n");
+    }
+
+    if (Fields & X509_ISSUER) {
+        Pos = AppendLine(Line, 0, L"  Issuer:");
+        Pos = AppendName(Line, Pos, Cert, &Cert->issuer);
+        OutString(Line);
+        OutString(L"\n");
+    }
+
+    if (Fields & (X509_NOT_BEFORE | X509_NOT_AFTER))
+        PrintValidity(Cert, Fields);
+
+    if (Fields & X509_SUBJECT) {
+        Pos = AppendLine(Line, 0, L"  Subject:");
+        Pos = AppendName(Line, Pos, Cert, &Cert->subject);
+        OutString(Line);
+        OutString(L"\n");
+    }
+
+    if (Fields & X509_FINGERPRINT) {
+        if (Fingerprint == NULL) {
+            Sha256(Cert->data, Cert->length, Digest);
+            Fingerprint = Digest;
+        }
+        Pos = AppendLine(Line, 0, L"  SHA256 Fingerprint: ");
+        for (i = 0; i < SHA256_DIGEST_SIZE; i++) {
+            Pos = AppendLine(Line, Pos, L"%02x%c", Fingerprint[i], ((i+1 == SHA256_DIGEST_SIZE)?' ':':'));
+        }
+        OutString(Line);
+        OutString(L"\n");
+    }
+
+    if (Fields & X509_KEY_ALGO) {
+        Pos = AppendLine(Line, 0, L"  Subject Public Key Algorithm: ");
+        Pos = AppendAlgorithm(Line, Pos, Cert->data, &Cert->pub_key_algo);
+        OutString(Line);
+        OutString(L"\n");
+    }
 
-    ptr = AsciiToUnicode(value, (int)vlen);
-    StrCat(tmpbuf, ptr);
-    FreePool(ptr);
+    if ((Fields & X509_PUBLIC_KEY) && x509_public_key(Cert, &Key) == 0 && Key.bits > 0) {
+        if (Key.algo == OID_rsaEncryption) {
+            Pos = AppendLine(Line, 0, L"  Public Key: RSA %d bit", Key.bits);
+            if (Key.exponent != 0)
+                Pos = AppendLine(Line, Pos, L", exponent %ld", (UINT64)Key.exponent);
+        } else {
+            Name = OID_Name(Key.curve);
+            Pos = AppendLine(Line, 0, L"  Public Key: EC%s%s, %d bit",
+                             Name != NULL ? L" " : L"", Name != NULL ? Name : L"", Key.bits);
+        }
+        OutString(Line);
+        OutString(L"\n");
+    }
 
-    return 0;
+    if ((Fields & X509_EXTENSIONS) && Cert->nr_extensions > 0) {
+        Pos = Start = AppendLine(Line, 0, L"  Extensions:");
+        for (i = 0; i < Cert->nr_extensions; i++) {
+            if (Pos - Start > (90*wrapno)) {
+                // Not sure why a CR is now required in UDK2017.  Need to investigate
+                Pos = AppendLine(Line, Pos, L"\r\n             ");
+                wrapno++;
+            }
+            Name = OID_Name(Cert->extensions[i].oid);
+            if (Name != NULL)
+                Pos = AppendLine(Line, Pos, L" %s", Name);
+            else
+                Pos = AppendOid(Line, Pos, Cert->data, &Cert->extensions[i].id);
+        }
+        OutString(Line);
+        OutString(L"\n");
+    }
 }
 
 
-int
-do_extensions( void *context,
-               long state_index,
-               unsigned char tag,
-               const void *value,
-               long vlen )
+//
+//  The same fields for --json and --csv.  Names, algorithms and times are
+//  the strings the listing shows; serial and fingerprint are hex.
+//
+static VOID
+EmitCertificate( CONST struct x509_certificate *Cert,
+                 UINTN Fields,
+                 CONST UINT8 *Fingerprint )
 {
-    Print(L"  Extensions:%s\n", tmpbuf);
-    tmpbuf[0] = '\0';
-    wrapno = 1;
+    CONST CHAR16 *Name;
+    CHAR16 Line[LINE_MAX];
+    UINT8 Digest[SHA256_DIGEST_SIZE];
+    struct x509_public_key Key;
+    int i;
 
-    return 0;
+    if ((Fields & X509_VERSION) && Cert->version.length > 0)
+        EmitUint(L"version", *(CONST char *)X509_SLICE_PTR(Cert, Cert->version) + 1);
+    if (Fields & X509_SERIAL)
+        EmitBytes(L"serial", X509_SLICE_PTR(Cert, Cert->serial), Cert->serial.length);
+    if (Fields & X509_SIG_ALGO) {
+        AppendAlgorithm(Line, 0, Cert->data, &Cert->sig_algo);
+        EmitString(L"sigAlg", Line);
+    }
+    if (Fields & X509_ISSUER) {
+        Line[0] = CHAR_NULL;
+        AppendName(Line, 0, Cert, &Cert->issuer);
+        EmitString(L"issuer", Line[0] == L' ' ? Line + 1 : Line);
+    }
+    if (Fields & X509_NOT_BEFORE) {
+        AppendTime(Line, 0, Cert->valid_from);
+        EmitString(L"notBefore", Line);
+    }
+    if (Fields & X509_NOT_AFTER) {
+        AppendTime(Line, 0, Cert->valid_to);
+        EmitString(L"notAfter", Line);
+    }
+    if (Fields & X509_SUBJECT) {
+        Line[0] = CHAR_NULL;
+        AppendName(Line, 0, Cert, &Cert->subject);
+        EmitString(L"subject", Line[0] == L' ' ? Line + 1 : Line);
+    }
+    if (Fields & X509_FINGERPRINT) {
+        if (Fingerprint == NULL) {
+            Sha256(Cert->data, Cert->length, Digest);
+            Fingerprint = Digest;
+        }
+        EmitBytes(L"fingerprint", Fingerprint, SHA256_DIGEST_SIZE);
+    }
+    if (Fields & X509_KEY_ALGO) {
+        AppendAlgorithm(Line, 0, Cert->data, &Cert->pub_key_algo);
+        EmitString(L"keyAlg", Line);
+    }
+    if ((Fields & X509_PUBLIC_KEY) && x509_public_key(Cert, &Key) == 0 && Key.bits > 0) {
+        EmitUint(L"publicKeyBits", Key.bits);
+        if (Key.algo == OID_rsaEncryption) {
+            EmitUint(L"exponent", Key.exponent);
+        } else if ((Name = OID_Name(Key.curve)) != NULL) {
+            EmitString(L"curve", Name);
+        }
+    }
+    if (Fields & X509_EXTENSIONS) {
+        EmitArray(L"extensions");
+        for (i = 0; i < Cert->nr_extensions; i++) {
+            Name = OID_Name(Cert->extensions[i].oid);
+            if (Name == NULL) {
+                AppendOid(Line, 0, Cert->data, &Cert->extensions[i].id);
+                Name = Line;
+            }
+            EmitString(NULL, Name);
+        }
+        EmitClose();
+    }
 }
 
 
-int
-do_extension_id( void *context, 
-                 long state_index,
-                 unsigned char tag,
-                 const void *value,
-                 long vlen )
-{
-    enum OID oid; 
-    CHAR16 buffer[60];
-    int len = StrLen(tmpbuf);
-
-    if (len > (90*wrapno)) {
-        // Not sure why a CR is now required in UDK2017.  Need to investigate
-        StrCat(tmpbuf, L"\r\n             ");
-        wrapno++;
-    }
-
-    oid = Lookup_OID(value, vlen);
-    Sprint_OID(value, vlen, buffer, sizeof(buffer));
-
-    if (oid == OID_subjectKeyIdentifier)
-        StrCat(tmpbuf, L" SubjectKeyIdentifier");
-    else if (oid == OID_keyUsage)
-        StrCat(tmpbuf, L" KeyUsage");
-    else if (oid == OID_subjectAltName)
-        StrCat(tmpbuf, L" SubjectAltName");
-    else if (oid == OID_issuerAltName)
-        StrCat(tmpbuf, L" IssuerAltName");
-    else if (oid == OID_basicConstraints)
-        StrCat(tmpbuf, L" BasicConstraints");
-    else if (oid == OID_crlDistributionPoints)
-        StrCat(tmpbuf, L" CrlDistributionPoints");
-    else if (oid == OID_certAuthInfoAccess) 
-        StrCat(tmpbuf, L" CertAuthInfoAccess");
-    else if (oid == OID_certPolicies)
-        StrCat(tmpbuf, L" CertPolicies");
-    else if (oid == OID_authorityKeyIdentifier)
-        StrCat(tmpbuf, L" AuthorityKeyIdentifier");
-    else if (oid == OID_extKeyUsage)
-        StrCat(tmpbuf, L" ExtKeyUsage");
-    else if (oid == OID_msEnrollCerttypeExtension)
-        StrCat(tmpbuf, L" msEnrollCertTypeExtension");
-    else if (oid == OID_msCertsrvCAVersion)
-        StrCat(tmpbuf, L" msCertsrvCAVersion");
-    else if (oid == OID_msCertsrvPreviousCertHash)
-        StrCat(tmpbuf, L" msCertsrvPreviousCertHash");
-    else {
-        StrCat(tmpbuf, L" (");
-        StrCat(tmpbuf, buffer);
-        StrCat(tmpbuf, L")");
-    }
-
-    return 0;
-}
-
-
-//
-//  Yes, a hack but it works!
-//
-char *
-make_utc_date_string( char *s )
-{
-    static char buffer[50];
-    char  *d;
-
-    d = buffer;
-    *d++ = '2';      /* year */
-    *d++ = '0';
-    *d++ = *s++;
-    *d++ = *s++;
-    *d++ = '-';
-    *d++ = *s++;     /* month */
-    *d++ = *s++;
-    *d++ = '-';
-    *d++ = *s++;     /* day */
-    *d++ = *s++;
-    *d++ = ' ';
-    *d++ = *s++;     /* hour */
-    *d++ = *s++;
-    *d++ = ':';
-    *d++ = *s++;     /* minute */
-    *d++ = *s++;
-    *d++ = ':';
-    *d++ = *s++;     /* second */
-    *d++ = *s;
-    *d++ = ' ';
-    *d++ = 'U';
-    *d++ = 'T';
-    *d++ = 'C';
-     *d = '\0';
-
-    return buffer;
+//
+//  Walk every entry of every EFI_SIGNATURE_LIST in a signature database,
+//  validating the list headers on the way
+//
+EFI_STATUS
+WalkSignatureLists( UINT8 *data,
+                    UINTN len,
+                    SIGNATURE_VISITOR Visitor,
+                    VOID *Context )
+{
+    EFI_SIGNATURE_LIST  *CertList;
+    EFI_SIGNATURE_DATA  *Cert;
+    UINTN Offset = 0, Index, CertCount, Type;
+    EFI_STATUS Status;
+
+    while (len - Offset >= sizeof(EFI_SIGNATURE_LIST)) {
+        CertList = (EFI_SIGNATURE_LIST *)(data + Offset);
+        if (CertList->SignatureListSize > len - Offset ||
+            CertList->SignatureSize <= sizeof(EFI_GUID) ||
+            CertList->SignatureListSize < sizeof(EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize)
+            return EFI_VOLUME_CORRUPTED;
+
+        Type = LookupSignatureType(&CertList->SignatureType);
+        CertCount = (CertList->SignatureListSize - sizeof(EFI_SIGNATURE_LIST) - CertList->SignatureHeaderSize) / CertList->SignatureSize;
+        Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) CertList + sizeof (EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize);
+
+        for (Index = 0; Index < CertCount; Index++) {
+            Status = Visitor(Type, Cert, CertList->SignatureSize - sizeof(EFI_GUID), Context);
+            if (EFI_ERROR(Status))
+                return Status;
+            Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) Cert + CertList->SignatureSize);
+        }
+        Offset += CertList->SignatureListSize;
+    }
+
+    return EFI_SUCCESS;
 }
 
 
-int
-do_validity_not_before( void *context,
-                        long state_index,
-                        unsigned char tag,
-                        const void *value, 
-                        long vlen )
+//
+//  An entry of the database being listed.  X509 entries are decoded,
+//  matched and fingerprinted before anything is printed, possibly on an
+//  AP, each into its own slot; other entries are handled as they are
+//  printed.
+//
+typedef struct {
+    UINTN Type;
+    EFI_SIGNATURE_DATA *Entry;
+    UINTN Size;
+    struct x509_certificate *Cert;   // X509 entries only
+    int   Status;                    // of the decode
+    BOOLEAN Matched;
+    UINT8 Fingerprint[SHA256_DIGEST_SIZE];
+} PRINT_ITEM;
+
+typedef struct {
+    UINTN Certificates;
+    UINTN Hashes;
+    UINTN Matched;              // entries shown when --where is given
+    int   Status;
+    PRINT_ITEM *Items;          // in database order
+    UINTN Count;
+    UINTN Capacity;
+} PRINT_CONTEXT;
+
+#define PRINT_ITEMS_INITIAL  64
+
+
+//
+//  Format a PKCS#7 SignedData entry: its signers, then every embedded
+//  certificate.  With --where it is shown only if one of its certificates
+//  matches; returns 1 if shown.
+//
+static int
+PrintPkcs7( EFI_SIGNATURE_DATA *Entry,
+            UINTN Size )
 {
-    CHAR16 *ptr;
-    char *p;
+    struct pkcs7_message *Msg;
+    struct x509_certificate *X509;
+    CONST CHAR16 *Name;
+    CHAR16 Line[LINE_MAX];
+    UINTN Pos;
+    int Status, i, n;
+
+    Msg = ArenaAlloc(&Scratch, sizeof(*Msg));
+    X509 = ArenaAlloc(&Scratch, sizeof(*X509));
+    if (Msg == NULL || X509 == NULL) {
+        EmitError(L"Out of scratch memory");
+        return -1;
+    }
+
+    Status = pkcs7_decode(Msg, Entry->SignatureData, Size);
+    if (Status < 0)
+        return Status;
 
-    p = make_utc_date_string((char *)value);
-    ptr = AsciiToUnicode(p, UTCDATE_LEN);
-    Print(L"  Validity:  Not Before: %s", ptr);
-    FreePool(ptr);
+    for (i = 0; Query.nr_conditions > 0 && i < Msg->nr_certs; i++) {
+        Status = x509_decode_fields(X509, PKCS7_SLICE_PTR(Msg, Msg->certs[i]), Msg->certs[i].length,
+                                    Query.decode);
+        if (Status == 0 && x509_query_match(&Query, X509))
+            break;
+    }
+    if (Query.nr_conditions > 0 && i == Msg->nr_certs)
+        return 0;
+
+    if (EmitFormat() != EmitText) {
+        EmitObject(NULL);
+        EmitString(L"type", SignatureTypeName(SIGNATURE_TYPE_PKCS7));
+        EmitGuid(L"owner", &Entry->SignatureOwner);
+        Name = OID_Name(Msg->content_type);
+        EmitString(L"contentType", Name != NULL ? Name : L"unknown");
+        EmitUint(L"signers", Msg->nr_signers);
+        EmitBool(L"truncated", Msg->truncated);
+        EmitArray(L"certificates");
+        for (i = 0; i < Msg->nr_certs; i++) {
+            Status = x509_decode_fields(X509, PKCS7_SLICE_PTR(Msg, Msg->certs[i]), Msg->certs[i].length,
+                                        Query.decode);
+            if (Status < 0)
+                break;
+            EmitObject(NULL);
+            EmitCertificate(X509, Query.select, NULL);
+            EmitClose();
+        }
+        EmitClose();
+        EmitClose();
+        return (Status < 0) ? Status : 1;
+    }
+
+    OutPrint(L"\nType: %s  (GUID: %g)\n", SignatureTypeName(SIGNATURE_TYPE_PKCS7), &Entry->SignatureOwner);
+    Name = OID_Name(Msg->content_type);
+    OutPrint(L"  Content Type: %s\n", Name != NULL ? Name : L"unknown");
+    OutPrint(L"  Signers: %d   Certificates: %d%s\n", Msg->nr_signers, Msg->nr_certs,
+             Msg->truncated ? L" (truncated)" : L"");
+
+    for (i = 0; i < Msg->nr_signers; i++) {
+        Pos = AppendLine(Line, 0, L"  Signer %d: ", i + 1);
+        Pos = AppendAlgorithm(Line, Pos, Msg->data, &Msg->signers[i].digest_algo);
+        Pos = AppendLine(Line, Pos, L" with ");
+        Pos = AppendAlgorithm(Line, Pos, Msg->data, &Msg->signers[i].sig_algo);
+        n = pkcs7_signer_certificate(Msg, i, X509);
+        if (n >= 0)
+            Pos = AppendLine(Line, Pos, L", certificate %d", n + 1);
+        OutString(Line);
+        OutString(L"\n");
+    }
+
+    for (i = 0; i < Msg->nr_certs; i++) {
+        OutPrint(L"\n  Certificate %d:\n", i + 1);
+        Status = x509_decode_fields(X509, PKCS7_SLICE_PTR(Msg, Msg->certs[i]), Msg->certs[i].length,
+                                    Query.decode);
+        PrintCertificate(X509, (Status < 0) ? Query.select & X509->decoded : Query.select, NULL);
+        if (Status < 0)
+            return Status;
+    }
 
-    return 0;
+    return 1;
 }
 
 
-int
-do_validity_not_after( void *context,
-                       long state_index,
-                       unsigned char tag,
-                       const void *value,
-                       long vlen )
+static EFI_STATUS
+CollectSignature( UINTN Type,
+                  EFI_SIGNATURE_DATA *Cert,
+                  UINTN Size,
+                  VOID *Context )
 {
-    CHAR16 *ptr;
-    char *p;
+    PRINT_CONTEXT *Ctx = Context;
+    PRINT_ITEM *Item;
+    UINTN Capacity;
+
+    if (Type != SIGNATURE_TYPE_UNKNOWN && SignatureTypes[Type].DigestSize != 0) {
+        Ctx->Hashes++;
+        return EFI_SUCCESS;
+    }
+    if (Size + sizeof(EFI_GUID) <= 100)
+        return EFI_SUCCESS;
+
+    if (Ctx->Count == Ctx->Capacity) {
+        Capacity = (Ctx->Capacity == 0) ? PRINT_ITEMS_INITIAL : Ctx->Capacity * 2;
+        Item = ReallocatePool(Ctx->Capacity * sizeof(PRINT_ITEM), Capacity * sizeof(PRINT_ITEM), Ctx->Items);
+        if (Item == NULL)
+            return EFI_OUT_OF_RESOURCES;
+        Ctx->Items = Item;
+        Ctx->Capacity = Capacity;
+    }
 
-    p = make_utc_date_string((char *)value);
-    ptr = AsciiToUnicode(p, UTCDATE_LEN);
-    Print(L"   Not After: %s\n", ptr);
-    FreePool(ptr);
+    Item = &Ctx->Items[Ctx->Count++];
+    ZeroMem(Item, sizeof(*Item));
+    Item->Type = Type;
+    Item->Entry = Cert;
+    Item->Size = Size;
 
-    return 0;
+    return EFI_SUCCESS;
 }
 
 
-int
-do_subject_public_key_info( void *context, 
-                            long state_index,
-                            unsigned char tag,
-                            const void *value, 
-                            long vlen )
+//
+//  Runs on any processor: no Print, no boot services.  Only the fields
+//  the query needs are decoded.
+//
+static VOID
+EFIAPI
+DecodeItem( VOID *Context,
+            UINTN Index )
 {
-    Print(L"  Subject Public Key Algorithm: %s\n", tmpbuf);
-    tmpbuf[0] = '\0';
+    PRINT_ITEM *Item = &((PRINT_CONTEXT *)Context)->Items[Index];
 
-    return 0;
+    if (Item->Cert == NULL)
+        return;
+
+    Item->Status = x509_decode_fields(Item->Cert, Item->Entry->SignatureData, Item->Size, Query.decode);
+    if (Item->Status < 0)
+        return;
+    Item->Matched = x509_query_match(&Query, Item->Cert);
+    if (Item->Matched && (Query.select & X509_FINGERPRINT))
+        Sha256(Item->Cert->data, Item->Cert->length, Item->Fingerprint);
+}
+
+
+static VOID
+PrintItem( PRINT_CONTEXT *Ctx,
+           PRINT_ITEM *Item )
+{
+    UINTN Mark;
+    int Status;
+
+    Ctx->Certificates++;
+    Mark = ArenaMark(&Scratch);
+    switch (Item->Type) {
+    case SIGNATURE_TYPE_X509:
+        if (Item->Status == 0 && !Item->Matched)
+            break;
+        Ctx->Matched++;
+        if (EmitFormat() != EmitText) {
+            if (Item->Status != 0) {
+                Ctx->Status = Item->Status;
+                EmitError(L"Could not decode certificate");
+                break;
+            }
+            EmitObject(NULL);
+            EmitString(L"type", SignatureTypeName(Item->Type));
+            EmitGuid(L"owner", &Item->Entry->SignatureOwner);
+            EmitCertificate(Item->Cert, Query.select,
+                            (Query.select & X509_FINGERPRINT) ? Item->Fingerprint : NULL);
+            EmitClose();
+            break;
+        }
+        OutPrint(L"\nType: %s  (GUID: %g)\n", SignatureTypeName(Item->Type), &Item->Entry->SignatureOwner);
+        if (Item->Status == 0) {
+            PrintCertificate(Item->Cert, Query.select,
+                             (Query.select & X509_FINGERPRINT) ? Item->Fingerprint : NULL);
+            break;
+        }
+        // the fields decoded before the error, then the decoder's message:
+        // it was decoded quietly on the APs, so again here for that
+        PrintCertificate(Item->Cert, Query.select & Item->Cert->decoded, NULL);
+        x509_decode_fields(Item->Cert, Item->Entry->SignatureData, Item->Size, Query.decode);
+        Ctx->Status = Item->Status;
+        break;
+
+    case SIGNATURE_TYPE_PKCS7:
+        Status = PrintPkcs7(Item->Entry, Item->Size);
+        if (Status > 0)
+            Ctx->Matched++;
+        else if (Status < 0)
+            Ctx->Status = Status;
+        break;
+
+    default:
+        // no certificate fields to match against
+        if (Query.nr_conditions > 0)
+            break;
+        Ctx->Matched++;
+        if (EmitFormat() != EmitText) {
+            EmitObject(NULL);
+            EmitString(L"type", SignatureTypeName(Item->Type));
+            EmitGuid(L"owner", &Item->Entry->SignatureOwner);
+            if (Item->Type == SIGNATURE_TYPE_RSA2048)
+                EmitUint(L"publicKeyBits", integer_bits(Item->Entry->SignatureData, Item->Size));
+            EmitClose();
+            break;
+        }
+        OutPrint(L"\nType: %s  (GUID: %g)\n", SignatureTypeName(Item->Type), &Item->Entry->SignatureOwner);
+        if (Item->Type == SIGNATURE_TYPE_RSA2048)
+            OutPrint(L"  Public Key: RSA %d bit\n", integer_bits(Item->Entry->SignatureData, Item->Size));
+        break;
+    }
+    ArenaRelease(&Scratch, Mark);
 }
 
 
+//
+//  The entries are collected first and every X509 entry is decoded, on all
+//  processors when there are enough of them, before the BSP prints the
+//  lot in database order
+//
 int
 PrintCertificates( UINT8 *data, 
                    UINTN len, 
                    CHAR16 *name )
 {
-    EFI_SIGNATURE_LIST  *CertList = (EFI_SIGNATURE_LIST *)data;
-    EFI_SIGNATURE_DATA  *Cert;
-    EFI_GUID gX509 = EFI_CERT_X509_GUID;
-    EFI_GUID gPKCS7 = EFI_CERT_TYPE_PKCS7_GUID;
-    EFI_GUID gRSA2048 = EFI_CERT_RSA2048_GUID;
-    UINTN Index, DataSize = len, CertCount = 0;
-    BOOLEAN CertFound = FALSE;
-    UINTN  buflen;
-    CHAR16 *ext;
-    int status = 0;
-
-    while ((DataSize > 0) && (DataSize >= CertList->SignatureListSize)) {
-        CertCount = (CertList->SignatureListSize - CertList->SignatureHeaderSize) / CertList->SignatureSize;
-        Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) CertList + sizeof (EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize);
+    PRINT_CONTEXT Ctx;
+    struct x509_certificate *Decoded = NULL;
+    EFI_STATUS Status;
+    UINTN i, n;
 
-        // should all be X509 but just in case...
-        if (CompareGuid(&CertList->SignatureType, &gX509) == 0)
-            ext = L"X509";
-        else if (CompareGuid(&CertList->SignatureType, &gPKCS7) == 0)
-            ext = L"PKCS7";
-        else if (CompareGuid(&CertList->SignatureType, &gRSA2048) == 0)
-            ext = L"RSA2048";
-        else 
-            ext = L"Unknown";
+    ZeroMem(&Ctx, sizeof(Ctx));
+    Status = WalkSignatureLists(data, len, CollectSignature, &Ctx);
+    if (Status == EFI_OUT_OF_RESOURCES) {
+        EmitError(L"Out of memory listing %s", name);
+        Ctx.Count = 0;
+    }
 
-        for (Index = 0; Index < CertCount; Index++) {
-            if ( CertList->SignatureSize > 100 ) {
-                CertFound = TRUE;
-                Print(L"\nType: %s  (GUID: %g)\n", ext, &Cert->SignatureOwner);
-                buflen  = CertList->SignatureSize-sizeof(EFI_GUID);
-                status = asn1_ber_decoder(&x509_decoder, NULL, Cert->SignatureData, buflen);
-            }
-            Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) Cert + CertList->SignatureSize);
+    for (i = n = 0; i < Ctx.Count; i++) {
+        if (Ctx.Items[i].Type == SIGNATURE_TYPE_X509)
+            n++;
+    }
+    if (n > 0) {
+        Decoded = AllocatePool(n * sizeof(*Decoded));
+        if (Decoded == NULL) {
+            EmitError(L"Out of memory listing %s", name);
+            Ctx.Count = 0;
         }
-        DataSize -= CertList->SignatureListSize;
-        CertList = (EFI_SIGNATURE_LIST *) ((UINT8 *) CertList + CertList->SignatureListSize);
+    }
+    for (i = n = 0; i < Ctx.Count; i++) {
+        if (Ctx.Items[i].Type == SIGNATURE_TYPE_X509)
+            Ctx.Items[i].Cert = &Decoded[n++];
     }
 
-    if (CertFound == FALSE ) {
-       Print(L"\nNo certificates found for this database\n");
+    asn1_report_errors = 0;
+    ParallelForEach(&Parallel, Ctx.Count, DecodeItem, &Ctx);
+    // decoder messages would break up machine readable output
+    asn1_report_errors = (EmitFormat() == EmitText);
+
+    EmitArray(L"entries");
+    for (i = 0; i < Ctx.Count; i++)
+        PrintItem(&Ctx, &Ctx.Items[i]);
+    EmitClose();
+    if (Status == EFI_VOLUME_CORRUPTED)
+        EmitError(L"Malformed signature list in %s", name);
+
+    if (EmitFormat() != EmitText) {
+        EmitUint(L"certificates", Ctx.Certificates);
+        if (Query.nr_conditions > 0)
+            EmitUint(L"matched", Ctx.Matched);
+        EmitUint(L"hashes", Ctx.Hashes);
+    } else {
+        if (Ctx.Certificates == 0) {
+           OutPrint(L"\nNo certificates found for this database\n");
+        } else if (Query.nr_conditions > 0) {
+           OutPrint(L"\n%d of %d certificate entries match\n", Ctx.Matched, Ctx.Certificates);
+        }
+        if (Ctx.Hashes > 0) {
+           OutPrint(L"\n%d hash entries (see --check)\n", Ctx.Hashes);
+        }
     }
 
-    return status;
+    if (Decoded != NULL)
+        FreePool(Decoded);
+    if (Ctx.Items != NULL)
+        FreePool(Ctx.Items);
+
+    return Ctx.Status;
 }
 
 
+//
+//  Read a variable into scratch memory, where it stays until the caller
+//  releases it.  The runtime call goes through the shared reader buffer.
+//
 EFI_STATUS
 get_variable( CHAR16 *var, 
               UINT8 **data, 
@@ -455,22 +849,25 @@ get_variable( CHAR16 *var,
               EFI_GUID owner )
 {
     EFI_STATUS Status;
+    UINT8 *Buffer;
 
+    *data = NULL;
     *len = 0;
 
-    Status = gRT->GetVariable(var, &owner, NULL, len, NULL);
-    if (Status != EFI_BUFFER_TOO_SMALL)
+    if (Reader.Buffer == NULL) {
+        Status = VarReaderInit(&Reader);
+        if (EFI_ERROR(Status))
+            return Status;
+    }
+
+    Status = VarRead(&Reader, var, &owner, &Buffer, len);
+    if (Status != EFI_SUCCESS)
         return Status;
 
-    *data = AllocateZeroPool(*len);
-    if (!data)
+    *data = ArenaAlloc(&Scratch, *len);
+    if (*data == NULL)
         return EFI_OUT_OF_RESOURCES;
-    
-    Status = gRT->GetVariable(var, &owner, NULL, len, *data);
-    if (Status != EFI_SUCCESS) {
-        FreePool(*data);
-        *data = NULL;
-    }
+    CopyMem(*data, Buffer, *len);
 
     return Status;
 }
@@ -483,70 +880,1446 @@ OutputVariable( CHAR16 *var,
     EFI_STATUS Status = EFI_SUCCESS;
     UINT8 *data;
     UINTN len;
+    UINTN Mark = ArenaMark(&Scratch);
 
     Status = get_variable(var, &data, &len, owner);
-    if (Status == EFI_SUCCESS) {
-        Print(L"\nVARIABLE: %s  (size: %d)\n", var, len);
+    if (Status == EFI_SUCCESS && EmitFormat() != EmitText) {
+        EmitObject(NULL);
+        EmitString(L"variable", var);
+        EmitUint(L"size", len);
+        PrintCertificates(data, len, var);
+        EmitClose();
+    } else if (Status == EFI_SUCCESS) {
+        OutPrint(L"\nVARIABLE: %s  (size: %d)\n", var, len);
         PrintCertificates(data, len, var);
-        FreePool(data);
     } else if (Status == EFI_NOT_FOUND) {
 #ifdef DEBUG
-        Print(L"Variable %s not found\n", var);
-#else
-        return Status;
+        OutPrint(L"Variable %s not found\n", var);
 #endif
     } else 
-        Print(L"ERROR: Failed to get variable %s. Status Code: %d\n", var, Status);
+        EmitError(L"Failed to get variable %s. Status Code: %d", var, Status);
+
+    // variable data and all decode scratch go back in one step
+    ArenaRelease(&Scratch, Mark);
 
     return Status;
 }
 
 
-static void
-Usage( void )
+//
+//  An authenticated variable payload (.auth) is an EFI_VARIABLE_AUTHENTICATION_2
+//  descriptor followed by the signature lists.  Anything else is taken to be
+//  bare signature lists (.esl).  Returns the offset of the first list.
+//
+static UINTN
+SignatureListOffset( UINT8 *data,
+                     UINTN len )
 {
-    Print(L"Usage: ListCerts [ -pk | -kek | -db | -dbx ]\n");
-    Print(L"       ListCerts [-V | --version]\n");
+    EFI_VARIABLE_AUTHENTICATION_2 *Auth = (EFI_VARIABLE_AUTHENTICATION_2 *)data;
+    EFI_GUID Pkcs7 = EFI_CERT_TYPE_PKCS7_GUID;
+    UINTN Offset;
+
+    if (len < OFFSET_OF(EFI_VARIABLE_AUTHENTICATION_2, AuthInfo.CertData))
+        return 0;
+    if (Auth->AuthInfo.Hdr.wCertificateType != WIN_CERT_TYPE_EFI_GUID ||
+        !CompareGuid(&Auth->AuthInfo.CertType, &Pkcs7))
+        return 0;
+
+    Offset = OFFSET_OF(EFI_VARIABLE_AUTHENTICATION_2, AuthInfo) + Auth->AuthInfo.Hdr.dwLength;
+
+    return (Offset <= len) ? Offset : 0;
 }
 
 
-INTN
-EFIAPI
-ShellAppMain( UINTN Argc, 
-              CHAR16 **Argv )
+EFI_STATUS
+OutputFile( CHAR16 *FileName )
 {
-    EFI_STATUS Status = EFI_SUCCESS;
-    EFI_GUID gSIGDB = EFI_IMAGE_SECURITY_DATABASE_GUID;
-    CHAR16 *variables[] = { L"PK", L"KEK", L"db", L"dbx" };
-    EFI_GUID owners[] = { EFI_GLOBAL_VARIABLE, EFI_GLOBAL_VARIABLE, gSIGDB, gSIGDB };
-    int i;
+    SHELL_FILE_HANDLE FileHandle;
+    EFI_STATUS Status;
+    UINT64 FileSize;
+    UINT8 *data = NULL;
+    UINTN len, Offset;
 
+    Status = ShellOpenFileByName(FileName, &FileHandle, EFI_FILE_MODE_READ, 0);
+    if (EFI_ERROR(Status)) {
+        EmitError(L"Could not open file [%s]", FileName);
+        return Status;
+    }
 
-    if (Argc == 1) {
-        for (i = 0; i < ARRAY_SIZE(owners); i++) {
-            Status = OutputVariable(variables[i], owners[i]);
+    Status = ShellGetFileSize(FileHandle, &FileSize);
+    if (!EFI_ERROR(Status) && FileSize > MAX_UINT32)
+        Status = EFI_UNSUPPORTED;
+    if (!EFI_ERROR(Status)) {
+        len = (UINTN)FileSize;
+        data = AllocatePool(MAX(len, 1));
+        if (data == NULL)
+            Status = EFI_OUT_OF_RESOURCES;
+    }
+    if (!EFI_ERROR(Status))
+        Status = ShellReadFile(FileHandle, &len, data);
+    ShellCloseFile(&FileHandle);
+
+    if (EFI_ERROR(Status)) {
+        EmitError(L"Failed to read file [%s]. Status Code: %d", FileName, Status);
+    } else if (EmitFormat() != EmitText) {
+        Offset = SignatureListOffset(data, len);
+        EmitObject(NULL);
+        EmitString(L"file", FileName);
+        EmitUint(L"size", len);
+        EmitUint(L"authHeaderSize", Offset);
+        PrintCertificates(data + Offset, len - Offset, FileName);
+        EmitClose();
+    } else {
+        Offset = SignatureListOffset(data, len);
+        OutPrint(L"\nFILE: %s  (size: %d)\n", FileName, len);
+        if (Offset > 0)
+            OutPrint(L"  Authentication header: %d bytes skipped\n", Offset);
+        PrintCertificates(data + Offset, len - Offset, FileName);
+    }
+
+    if (data != NULL)
+        FreePool(data);
+
+    return Status;
+}
+
+
+static EFI_STATUS
+IndexSignature( UINTN Type,
+                EFI_SIGNATURE_DATA *Cert,
+                UINTN Size,
+                VOID *Context )
+{
+    UINT16 *Variables = Context;
+
+    if (Type == SIGNATURE_TYPE_UNKNOWN || SignatureTypes[Type].DigestSize == 0)
+        return EFI_SUCCESS;
+    if (Size < SignatureTypes[Type].DigestSize)
+        return EFI_VOLUME_CORRUPTED;
+
+    return HashIndexAdd(&Hashes, Cert->SignatureData, SignatureTypes[Type].DigestSize,
+                        (UINT8)Type, *Variables);
+}
+
+
+//
+//  Collect the hash entries of the selected variables into the sorted index
+//
+EFI_STATUS
+BuildHashIndex( CHAR16 **variables,
+                EFI_GUID *owners,
+                BOOLEAN *Selected,
+                UINTN Count )
+{
+    EFI_STATUS Status;
+    UINT16 Variables;
+    UINT8 *data;
+    UINTN len;
+    UINTN Mark;
+    UINTN i;
+
+    for (i = 0; i < Count; i++) {
+        if (!Selected[i])
+            continue;
+        Mark = ArenaMark(&Scratch);
+        Status = get_variable(variables[i], &data, &len, owners[i]);
+        if (Status == EFI_SUCCESS) {
+            Variables = (UINT16)(1 << i);
+            Status = WalkSignatureLists(data, len, IndexSignature, &Variables);
+            if (Status == EFI_VOLUME_CORRUPTED)
+                OutPrint(L"ERROR: Malformed signature list in %s\n", variables[i]);
+        } else if (Status != EFI_NOT_FOUND) {
+            OutPrint(L"ERROR: Failed to get variable %s. Status Code: %d\n", variables[i], Status);
         }
-    } else if (Argc == 2) {
-        if (!StrCmp(Argv[1], L"--help") ||
-            !StrCmp(Argv[1], L"-h")) { 
-            Usage();
-            return Status;
-        } else if (!StrCmp(Argv[1], L"--version") ||
-            !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+        ArenaRelease(&Scratch, Mark);
+        if (Status == EFI_OUT_OF_RESOURCES) {
+            OutPrint(L"ERROR: Out of memory resources\n");
             return Status;
-        } else if (!StrCmp(Argv[1], L"-pk"))  {
-            Status = OutputVariable(variables[0], owners[0]);
-        } else if (!StrCmp(Argv[1], L"-kek"))  {
-            Status = OutputVariable(variables[1], owners[1]);
-        } else if (!StrCmp(Argv[1], L"-db"))  {
-            Status = OutputVariable(variables[2], owners[2]);
-        } else if (!StrCmp(Argv[1], L"-dbx"))  {
-            Status = OutputVariable(variables[3], owners[3]);
-        } else {
-            Usage();
         }
     }
 
+    HashIndexSort(&Hashes);
+
+    return EFI_SUCCESS;
+}
+
+
+//
+//  Parse a hex digest.  Colons and whitespace between bytes are ignored.
+//
+static EFI_STATUS
+ParseDigest( CHAR16 *Str,
+             UINT8 *Digest,
+             UINTN *Size )
+{
+    UINTN Nibbles = 0;
+    UINT8 Value;
+
+    for (; *Str; Str++) {
+        if (*Str == L':' || *Str == L' ' || *Str == L'\t' || *Str == L'\r' || *Str == L'\n')
+            continue;
+        if (*Str >= L'0' && *Str <= L'9')
+            Value = (UINT8)(*Str - L'0');
+        else if (*Str >= L'a' && *Str <= L'f')
+            Value = (UINT8)(*Str - L'a' + 10);
+        else if (*Str >= L'A' && *Str <= L'F')
+            Value = (UINT8)(*Str - L'A' + 10);
+        else
+            return EFI_INVALID_PARAMETER;
+
+        if (Nibbles / 2 >= HASH_MAX_DIGEST)
+            return EFI_INVALID_PARAMETER;
+        if (Nibbles % 2 == 0)
+            Digest[Nibbles / 2] = (UINT8)(Value << 4);
+        else
+            Digest[Nibbles / 2] |= Value;
+        Nibbles++;
+    }
+
+    if (Nibbles == 0 || Nibbles % 2)
+        return EFI_INVALID_PARAMETER;
+    *Size = Nibbles / 2;
+
+    return EFI_SUCCESS;
+}
+
+
+//
+//  Look up one digest; returns TRUE if it is present in any indexed variable
+//
+static BOOLEAN
+CheckDigest( CHAR16 *Str,
+             CHAR16 **variables,
+             UINTN Count )
+{
+    UINT8 Digest[HASH_MAX_DIGEST];
+    HASH_ENTRY *Entry;
+    UINTN Size;
+    UINTN i;
+
+    if (EFI_ERROR(ParseDigest(Str, Digest, &Size))) {
+        OutPrint(L"ERROR: Invalid hash [%s]\n", Str);
+        return FALSE;
+    }
+
+    Entry = HashIndexFind(&Hashes, Digest, Size);
+    if (Entry == NULL) {
+        OutPrint(L"%s  not found\n", Str);
+        return FALSE;
+    }
+
+    OutPrint(L"%s  %s found in", Str, SignatureTypes[Entry->Type].Name);
+    for (i = 0; i < Count; i++) {
+        if (Entry->Variables & (1 << i))
+            OutPrint(L" %s", variables[i]);
+    }
+    OutPrint(L"\n");
+
+    return TRUE;
+}
+
+
+//
+//  Check every digest listed in a file, one per line.  Blank lines and
+//  lines starting with '#' are skipped.
+//
+static EFI_STATUS
+CheckFile( CHAR16 *FileName,
+           CHAR16 **variables,
+           UINTN Count,
+           UINTN *Checked,
+           UINTN *Found )
+{
+    SHELL_FILE_HANDLE FileHandle;
+    EFI_STATUS Status;
+    CHAR16 Line[LINE_MAX];
+    UINTN Size;
+    BOOLEAN Ascii = FALSE;
+    CHAR16 *p;
+
+    Status = ShellOpenFileByName(FileName, &FileHandle, EFI_FILE_MODE_READ, 0);
+    if (EFI_ERROR(Status)) {
+        OutPrint(L"ERROR: Could not open file [%s]\n", FileName);
+        return Status;
+    }
+
+    while (!ShellFileHandleEof(FileHandle)) {
+        Size = sizeof(Line);
+        Status = ShellFileHandleReadLine(FileHandle, Line, &Size, TRUE, &Ascii);
+        if (EFI_ERROR(Status))
+            break;
+        for (p = Line; *p == L' ' || *p == L'\t'; p++)
+            ;
+        if (*p == CHAR_NULL || *p == L'#')
+            continue;
+        (*Checked)++;
+        if (CheckDigest(p, variables, Count))
+            (*Found)++;
+    }
+
+    ShellCloseFile(&FileHandle);
+
+    return Status;
+}
+
+
+typedef struct {
+    PE_IMAGE_HASH *Image;
+    PE_SIGNED_DIGEST *Signed;   // only look in the signature of this digest, or NULL
+    UINT16 Variable;            // bit of the variable being walked
+    UINT16 Found;               // variables with a certificate in the image signature
+} SIGNER_CONTEXT;
+
+
+static EFI_STATUS
+MatchSigner( UINTN Type,
+             EFI_SIGNATURE_DATA *Cert,
+             UINTN Size,
+             VOID *Context )
+{
+    SIGNER_CONTEXT *Ctx = Context;
+
+    if (Type == SIGNATURE_TYPE_X509 && PeSignatureContains(Ctx->Image, Ctx->Signed, Cert->SignatureData, Size))
+        Ctx->Found |= Ctx->Variable;
+
+    return EFI_SUCCESS;
+}
+
+
+static VOID
+PrintDigest( UINT8 *Digest,
+             UINTN Size )
+{
+    UINTN i;
+
+    for (i = 0; i < Size; i++)
+        OutPrint(L"%02x", Digest[i]);
+}
+
+
+//
+//  Authenticode hash each image and judge it against db and dbx.  dbx wins
+//  over db; a signer matches when a db or dbx certificate is embedded in
+//  the image's PKCS#7 signature.  The signature itself is not verified,
+//  and embedding a certificate and a digest costs a forger nothing, so a
+//  signer in db makes an image inconclusive, never allowed: only its hash
+//  in db allows it.  A dbx certificate in any signature blocks the image;
+//  a db certificate only counts in the signature the digest came from.
+//
+EFI_STATUS
+CheckImages( CHAR16 **Images,
+             UINTN NrImages,
+             CHAR16 **variables,
+             EFI_GUID *owners )
+{
+    UINTN Db[] = { VAR_DB, VAR_DBX };
+    UINT8 *DbData[ARRAY_SIZE(Db)];
+    UINTN DbLen[ARRAY_SIZE(Db)];
+    SHELL_FILE_HANDLE FileHandle;
+    SIGNER_CONTEXT Signer;
+    PE_IMAGE_HASH Image;
+    PE_SIGNED_DIGEST Signed;
+    HASH_ENTRY *Entry;
+    EFI_STATUS Status, Result = EFI_SUCCESS;
+    UINT16 Variables, Hashed;
+    CONST CHAR16 *Name;
+    CHAR16 *Verdict, *Match;
+    BOOLEAN Allowed, Tampered, Verified, Digested;
+    UINTN Mark, i, n;
+
+    Mark = ArenaMark(&Scratch);
+    for (i = 0; i < ARRAY_SIZE(Db); i++) {
+        Status = get_variable(variables[Db[i]], &DbData[i], &DbLen[i], owners[Db[i]]);
+        if (EFI_ERROR(Status)) {
+            if (Status != EFI_NOT_FOUND)
+                OutPrint(L"ERROR: Failed to get variable %s. Status Code: %d\n", variables[Db[i]], Status);
+            DbData[i] = NULL;
+            DbLen[i] = 0;
+            continue;
+        }
+        Variables = (UINT16)(1 << Db[i]);
+        if (WalkSignatureLists(DbData[i], DbLen[i], IndexSignature, &Variables) == EFI_VOLUME_CORRUPTED)
+            OutPrint(L"ERROR: Malformed signature list in %s\n", variables[Db[i]]);
+    }
+    HashIndexSort(&Hashes);
+
+    for (n = 0; n < NrImages; n++) {
+        OutPrint(L"\nImage: %s\n", Images[n]);
+
+        Status = ShellOpenFileByName(Images[n], &FileHandle, EFI_FILE_MODE_READ, 0);
+        if (EFI_ERROR(Status)) {
+            OutPrint(L"ERROR: Could not open file [%s]\n", Images[n]);
+            Result = Status;
+            continue;
+        }
+        Status = PeImageHash(FileHandle, &Image);
+        ShellCloseFile(&FileHandle);
+        if (EFI_ERROR(Status)) {
+            OutPrint(L"ERROR: Not a valid PE/COFF image. Status Code: %d\n", Status);
+            Result = Status;
+            continue;
+        }
+
+        OutPrint(L"  SHA256:  ");
+        PrintDigest(Image.Digest, sizeof(Image.Digest));
+        OutPrint(L"\n  Signed:  %s\n", Image.Signatures != NULL ? L"yes" : L"no");
+
+        Tampered = Verified = FALSE;
+        Digested = (Image.Signatures != NULL && PeSignedDigest(&Image, &Signed));
+        if (Digested) {
+            Name = OID_Name(Signed.Algorithm);
+            if (Signed.Algorithm != OID_sha256) {
+                Match = L"not checked";
+            } else if (Signed.Size == sizeof(Image.Digest) &&
+                       CompareMem(Signed.Digest, Image.Digest, Signed.Size) == 0) {
+                Match = L"matches image";
+                Verified = TRUE;
+            } else {
+                Match = L"DOES NOT MATCH image";
+                Tampered = TRUE;
+            }
+            OutPrint(L"  Signed digest: %s (%s)\n", Name != NULL ? Name : L"unknown", Match);
+        }
+
+        Entry = HashIndexFind(&Hashes, Image.Digest, sizeof(Image.Digest));
+        Hashed = (Entry != NULL) ? Entry->Variables : 0;
+
+        Signer.Image = &Image;
+        Signer.Found = 0;
+        for (i = 0; Image.Signatures != NULL && i < ARRAY_SIZE(Db); i++) {
+            Signer.Signed = (Db[i] == VAR_DB && Digested) ? &Signed : NULL;
+            Signer.Variable = (UINT16)(1 << Db[i]);
+            if (DbData[i] != NULL)
+                WalkSignatureLists(DbData[i], DbLen[i], MatchSigner, &Signer);
+        }
+
+        Allowed = FALSE;
+        if (Hashed & (1 << VAR_DBX)) {
+            Verdict = L"BLOCKED - image hash in dbx";
+        } else if (Signer.Found & (1 << VAR_DBX)) {
+            Verdict = L"BLOCKED - signing certificate in dbx";
+        } else if (Tampered) {
+            Verdict = L"NOT ALLOWED - image changed after signing";
+        } else if (Hashed & (1 << VAR_DB)) {
+            Verdict = L"ALLOWED - image hash in db";
+            Allowed = TRUE;
+        } else if ((Signer.Found & (1 << VAR_DB)) && !Verified) {
+            Verdict = L"INCONCLUSIVE - signing certificate in db, image digest not verified";
+        } else if (Signer.Found & (1 << VAR_DB)) {
+            Verdict = L"INCONCLUSIVE - signer certificate present in db (signature not verified)";
+        } else {
+            Verdict = L"NOT ALLOWED - neither hash nor signer in db";
+        }
+        OutPrint(L"  Verdict: %s\n", Verdict);
+
+        if (!Allowed)
+            Result = EFI_SECURITY_VIOLATION;
+        PeImageHashFree(&Image);
+    }
+
+    ArenaRelease(&Scratch, Mark);
+
+    return Result;
+}
+
+
+typedef struct {
+    UINTN  Variable;            // index of the variable being walked
+    CHAR16 **Names;
+    UINTN  Certificates;
+    BOOLEAN Report;             // second pass
+} DUPLICATE_CONTEXT;
+
+
+static EFI_STATUS
+DuplicateSignature( UINTN Type,
+                    EFI_SIGNATURE_DATA *Cert,
+                    UINTN Size,
+                    VOID *Context )
+{
+    DUPLICATE_CONTEXT *Ctx = Context;
+    struct x509_certificate *X509;
+    UINT8 Digest[SHA256_DIGEST_SIZE];
+    CERT_ENTRY *Entry;
+    CHAR16 Line[LINE_MAX];
+    EFI_STATUS Status = EFI_SUCCESS;
+    UINTN Mark, Pos, i;
+
+    if (Type != SIGNATURE_TYPE_X509)
+        return EFI_SUCCESS;
+
+    Mark = ArenaMark(&Scratch);
+    X509 = ArenaAlloc(&Scratch, sizeof(*X509));
+    if (X509 == NULL) {
+        EmitError(L"Out of scratch memory");
+        return EFI_OUT_OF_RESOURCES;
+    }
+    if (x509_decode_fields(X509, Cert->SignatureData, Size,
+                           Ctx->Report ? X509_SUBJECT : X509_FINGERPRINT) < 0)
+        goto done;
+    Sha256(X509->data, X509->length, Digest);
+
+    if (!Ctx->Report) {
+        // what the copy takes in the list: owner GUID plus certificate
+        Ctx->Certificates++;
+        Status = CertSetAdd(&Certs, Digest, Size + sizeof(EFI_GUID), Ctx->Variable);
+        goto done;
+    }
+
+    // report each duplicated certificate where it is first met
+    Entry = CertSetFind(&Certs, Digest);
+    if (Entry == NULL || Entry->Copies < 2 || Entry->Reported)
+        goto done;
+    Entry->Reported = TRUE;
+
+    Pos = AppendLine(Line, 0, L"\nDuplicate:");
+    Pos = AppendName(Line, Pos, X509, &X509->subject);
+    OutString(Line);
+    OutString(L"\n");
+    Pos = AppendLine(Line, 0, L"  SHA256 Fingerprint: ");
+    for (i = 0; i < SHA256_DIGEST_SIZE; i++)
+        Pos = AppendLine(Line, Pos, L"%02x%c", Digest[i], ((i+1 == SHA256_DIGEST_SIZE)?' ':':'));
+    OutString(Line);
+    OutString(L"\n");
+    Pos = AppendLine(Line, 0, L"  Copies: %d  (", Entry->Copies);
+    for (i = 0; i < CERT_SET_MAX_VARIABLES; i++) {
+        if (Entry->Counts[i] > 0)
+            Pos = AppendLine(Line, Pos, L"%s%s x%d", (Pos > 0 && Line[Pos - 1] != L'(') ? L", " : L"",
+                             Ctx->Names[i], Entry->Counts[i]);
+    }
+    OutString(Line);
+    OutString(L")\n");
+    OutPrint(L"  Wasted: %d bytes\n", Entry->Wasted);
+
+done:
+    ArenaRelease(&Scratch, Mark);
+    return Status;
+}
+
+
+//
+//  Find certificates stored more than once, in one variable or across
+//  several, and the variable store space the extra copies take
+//
+EFI_STATUS
+CheckDuplicates( CHAR16 **variables,
+                 EFI_GUID *owners,
+                 BOOLEAN *Selected,
+                 UINTN Count )
+{
+    DUPLICATE_CONTEXT Ctx;
+    EFI_STATUS Status = EFI_SUCCESS;
+    UINT8 *Data[CERT_SET_MAX_VARIABLES];
+    UINTN Len[CERT_SET_MAX_VARIABLES];
+    UINTN Mark, i, Variables = 0;
+
+    ZeroMem(&Ctx, sizeof(Ctx));
+    Ctx.Names = variables;
+
+    // the variables stay loaded for the report pass
+    Mark = ArenaMark(&Scratch);
+    for (i = 0; i < Count && i < CERT_SET_MAX_VARIABLES; i++) {
+        Data[i] = NULL;
+        if (!Selected[i])
+            continue;
+        Status = get_variable(variables[i], &Data[i], &Len[i], owners[i]);
+        if (EFI_ERROR(Status)) {
+            if (Status != EFI_NOT_FOUND)
+                OutPrint(L"ERROR: Failed to get variable %s. Status Code: %d\n", variables[i], Status);
+            Data[i] = NULL;
+            continue;
+        }
+        Variables++;
+        Ctx.Variable = i;
+        Status = WalkSignatureLists(Data[i], Len[i], DuplicateSignature, &Ctx);
+        if (Status == EFI_VOLUME_CORRUPTED)
+            OutPrint(L"ERROR: Malformed signature list in %s\n", variables[i]);
+        if (Status == EFI_OUT_OF_RESOURCES)
+            goto done;
+    }
+
+    OutPrint(L"%d certificates in %d variables, %d distinct\n", Ctx.Certificates, Variables, Certs.Count);
+
+    Ctx.Report = TRUE;
+    for (i = 0; Certs.Duplicates > 0 && i < Count && i < CERT_SET_MAX_VARIABLES; i++) {
+        if (Data[i] != NULL)
+            WalkSignatureLists(Data[i], Len[i], DuplicateSignature, &Ctx);
+    }
+
+    OutPrint(L"\n%d duplicate copies, %d bytes of variable store wasted\n", Certs.Duplicates, Certs.Wasted);
+    Status = EFI_SUCCESS;
+
+done:
+    ArenaRelease(&Scratch, Mark);
+    return Status;
+}
+
+
+typedef struct {
+    SNAPSHOT_VARIABLE *Variable;
+} SNAPSHOT_CONTEXT;
+
+
+//
+//  A hash entry is recorded as the hash itself when it fits, anything
+//  else by the SHA-256 of its data (of the DER, for a certificate)
+//
+static EFI_STATUS
+SnapshotSignature( UINTN Type,
+                   EFI_SIGNATURE_DATA *Cert,
+                   UINTN Size,
+                   VOID *Context )
+{
+    SNAPSHOT_CONTEXT *Ctx = Context;
+    struct x509_certificate *X509;
+    UINT8 Digest[SHA256_DIGEST_SIZE];
+    EFI_GUID TypeGuid;
+    UINTN Mark;
+
+    ZeroMem(Digest, sizeof(Digest));
+    ZeroMem(&TypeGuid, sizeof(TypeGuid));
+    if (Type != SIGNATURE_TYPE_UNKNOWN)
+        CopyGuid(&TypeGuid, &SignatureTypes[Type].Guid);
+
+    if (Type != SIGNATURE_TYPE_UNKNOWN && SignatureTypes[Type].DigestSize != 0 &&
+        SignatureTypes[Type].DigestSize <= SHA256_DIGEST_SIZE && Size >= SignatureTypes[Type].DigestSize) {
+        CopyMem(Digest, Cert->SignatureData, SignatureTypes[Type].DigestSize);
+    } else if (Type == SIGNATURE_TYPE_X509) {
+        Mark = ArenaMark(&Scratch);
+        X509 = ArenaAlloc(&Scratch, sizeof(*X509));
+        if (X509 != NULL && x509_decode_fields(X509, Cert->SignatureData, Size, X509_FINGERPRINT) == 0)
+            Sha256(X509->data, X509->length, Digest);
+        else
+            Sha256(Cert->SignatureData, Size, Digest);
+        ArenaRelease(&Scratch, Mark);
+    } else {
+        Sha256(Cert->SignatureData, Size, Digest);
+    }
+
+    return SnapshotAddRecord(Ctx->Variable, Digest, &TypeGuid, &Cert->SignatureOwner);
+}
+
+
+//
+//  Record every entry of the selected variables.  A variable that does
+//  not exist gets an empty section, so its later creation shows up.
+//
+static EFI_STATUS
+TakeSnapshot( SNAPSHOT *Snap,
+              CHAR16 **variables,
+              EFI_GUID *owners,
+              BOOLEAN *Selected,
+              UINTN Count )
+{
+    SNAPSHOT_CONTEXT Ctx;
+    EFI_STATUS Status;
+    UINT8 *Data;
+    UINTN Len, Mark, i;
+
+    ZeroMem(Snap, sizeof(*Snap));
+    for (i = 0; i < Count; i++) {
+        if (!Selected[i])
+            continue;
+        Ctx.Variable = SnapshotAddVariable(Snap, variables[i], &owners[i]);
+        if (Ctx.Variable == NULL)
+            return EFI_OUT_OF_RESOURCES;
+
+        Mark = ArenaMark(&Scratch);
+        Status = get_variable(variables[i], &Data, &Len, owners[i]);
+        if (Status == EFI_SUCCESS) {
+            Ctx.Variable->Present = TRUE;
+            Status = WalkSignatureLists(Data, Len, SnapshotSignature, &Ctx);
+            if (Status == EFI_VOLUME_CORRUPTED)
+                OutPrint(L"ERROR: Malformed signature list in %s\n", variables[i]);
+        } else if (Status != EFI_NOT_FOUND) {
+            OutPrint(L"ERROR: Failed to get variable %s. Status Code: %d\n", variables[i], Status);
+        }
+        ArenaRelease(&Scratch, Mark);
+        if (Status == EFI_OUT_OF_RESOURCES)
+            return Status;
+    }
+
+    SnapshotSort(Snap);
+
+    return EFI_SUCCESS;
+}
+
+
+EFI_STATUS
+SaveSnapshot( CHAR16 *FileName,
+              CHAR16 **variables,
+              EFI_GUID *owners,
+              BOOLEAN *Selected,
+              UINTN Count )
+{
+    SNAPSHOT Snap;
+    EFI_STATUS Status;
+    UINTN Entries = 0, i;
+
+    Status = TakeSnapshot(&Snap, variables, owners, Selected, Count);
+    if (!EFI_ERROR(Status))
+        Status = SnapshotSave(&Snap, FileName);
+
+    if (EFI_ERROR(Status)) {
+        OutPrint(L"ERROR: Failed to save snapshot [%s]. Status Code: %d\n", FileName, Status);
+    } else {
+        for (i = 0; i < Snap.Count; i++) {
+            OutPrint(L"%s: %d entries\n", Snap.Variables[i].Section.Name, Snap.Variables[i].Section.Count);
+            Entries += Snap.Variables[i].Section.Count;
+        }
+        OutPrint(L"\nSnapshot of %d entries saved to %s\n", Entries, FileName);
+    }
+
+    SnapshotFree(&Snap);
+
+    return Status;
+}
+
+
+static VOID
+PrintRecord( CONST SNAPSHOT_RECORD *Record,
+             CHAR16 *Change )
+{
+    CHAR16 Line[LINE_MAX];
+    UINTN Type, Size, Pos, i;
+
+    Type = LookupSignatureType((EFI_GUID *)&Record->Type);
+    Size = SHA256_DIGEST_SIZE;
+    if (Type != SIGNATURE_TYPE_UNKNOWN && SignatureTypes[Type].DigestSize != 0)
+        Size = MIN(SignatureTypes[Type].DigestSize, SHA256_DIGEST_SIZE);
+
+    Pos = AppendLine(Line, 0, L"  %-8s %-11s ", Change, SignatureTypeName(Type));
+    for (i = 0; i < Size; i++)
+        Pos = AppendLine(Line, Pos, L"%02x", Record->Digest[i]);
+    OutString(Line);
+    OutPrint(L"  (owner: %g)\n", &Record->Owner);
+}
+
+
+//
+//  Linear merge of two sorted record lists, listing what New has that Old
+//  has not and the other way round
+//
+static VOID
+CompareRecords( SNAPSHOT_VARIABLE *Old,
+                SNAPSHOT_VARIABLE *New,
+                UINTN *Added,
+                UINTN *Removed )
+{
+    UINTN i = 0, j = 0;
+    UINTN OldCount = Old->Section.Count, NewCount = New->Section.Count;
+    UINTN VarAdded = 0, VarRemoved = 0;
+    INTN  Order;
+
+    while (i < OldCount || j < NewCount) {
+        if (i == OldCount)
+            Order = 1;
+        else if (j == NewCount)
+            Order = -1;
+        else
+            Order = SnapshotCompareRecord(&Old->Records[i], &New->Records[j]);
+
+        if (Order < 0) {
+            PrintRecord(&Old->Records[i++], L"removed");
+            VarRemoved++;
+        } else if (Order > 0) {
+            PrintRecord(&New->Records[j++], L"added");
+            VarAdded++;
+        } else {
+            i++;
+            j++;
+        }
+    }
+
+    OutPrint(L"  %d added, %d removed\n", VarAdded, VarRemoved);
+    *Added += VarAdded;
+    *Removed += VarRemoved;
+}
+
+
+//
+//  Compare the selected variables with a saved snapshot.  Returns
+//  EFI_SECURITY_VIOLATION if anything changed.
+//
+EFI_STATUS
+CompareSnapshot( CHAR16 *FileName,
+                 CHAR16 **variables,
+                 EFI_GUID *owners,
+                 BOOLEAN *Selected,
+                 UINTN Count )
+{
+    SNAPSHOT Old, New;
+    SNAPSHOT_VARIABLE *Var;
+    EFI_STATUS Status;
+    UINTN Added = 0, Removed = 0, i;
+
+    Status = SnapshotLoad(&Old, FileName);
+    if (EFI_ERROR(Status)) {
+        if (Status == EFI_VOLUME_CORRUPTED)
+            OutPrint(L"ERROR: Invalid snapshot file [%s]\n", FileName);
+        else
+            OutPrint(L"ERROR: Could not read snapshot [%s]. Status Code: %d\n", FileName, Status);
+        return Status;
+    }
+
+    Status = TakeSnapshot(&New, variables, owners, Selected, Count);
+    if (EFI_ERROR(Status)) {
+        OutPrint(L"ERROR: Out of memory resources\n");
+        goto done;
+    }
+
+    for (i = 0; i < New.Count; i++) {
+        Var = SnapshotFindVariable(&Old, New.Variables[i].Section.Name, &New.Variables[i].Section.Vendor);
+        if (Var == NULL) {
+            OutPrint(L"\nVARIABLE: %s  not in snapshot, skipped\n", New.Variables[i].Section.Name);
+            continue;
+        }
+        OutPrint(L"\nVARIABLE: %s  (snapshot: %d entries, now: %d)\n", New.Variables[i].Section.Name,
+                 Var->Section.Count, New.Variables[i].Section.Count);
+        CompareRecords(Var, &New.Variables[i], &Added, &Removed);
+    }
+
+    if (Added == 0 && Removed == 0) {
+        OutPrint(L"\nDatabases match the snapshot\n");
+    } else {
+        OutPrint(L"\n%d entries added, %d removed since the snapshot\n", Added, Removed);
+        Status = EFI_SECURITY_VIOLATION;
+    }
+
+done:
+    SnapshotFree(&New);
+    SnapshotFree(&Old);
+
+    return Status;
+}
+
+
+//
+//  Compare each selected database with its factory default, to show what
+//  the OEM or an administrator changed since: entries only in the active
+//  variable were added, entries only in the default were removed
+//
+EFI_STATUS
+CompareDefaults( CHAR16 **variables,
+                 EFI_GUID *owners,
+                 BOOLEAN *Selected,
+                 UINTN Count )
+{
+    SNAPSHOT Snap;
+    SNAPSHOT_VARIABLE *Active, *Default;
+    BOOLEAN Wanted[ARRAY_SIZE(SecureVariables)];
+    EFI_STATUS Status;
+    UINTN Added = 0, Removed = 0, Pairs = 0, i, j;
+
+    // a pair is compared if either half of it was selected
+    ZeroMem(Wanted, sizeof(Wanted));
+    for (i = 0; i < Count && i < ARRAY_SIZE(SecureVariables); i++) {
+        j = SecureVariables[i].DefaultOf;
+        if (j != VAR_NONE && (Selected[i] || Selected[j]))
+            Wanted[i] = Wanted[j] = TRUE;
+    }
+
+    Status = TakeSnapshot(&Snap, variables, owners, Wanted, MIN(Count, ARRAY_SIZE(Wanted)));
+    if (EFI_ERROR(Status)) {
+        OutPrint(L"ERROR: Out of memory resources\n");
+        goto done;
+    }
+
+    for (i = 0; i < Count && i < ARRAY_SIZE(SecureVariables); i++) {
+        j = SecureVariables[i].DefaultOf;
+        if (j == VAR_NONE || !Wanted[i])
+            continue;
+        Default = SnapshotFindVariable(&Snap, variables[i], &owners[i]);
+        Active = SnapshotFindVariable(&Snap, variables[j], &owners[j]);
+        if (Default == NULL || Active == NULL || (!Default->Present && !Active->Present))
+            continue;
+        if (!Default->Present) {
+            OutPrint(L"\nVARIABLE: %s  no %s, skipped\n", variables[j], variables[i]);
+            continue;
+        }
+        OutPrint(L"\nVARIABLE: %s  (%s: %d entries, %s: %d)\n", variables[j],
+                 variables[i], Default->Section.Count, variables[j], Active->Section.Count);
+        CompareRecords(Default, Active, &Added, &Removed);
+        Pairs++;
+    }
+
+    if (Pairs == 0)
+        OutPrint(L"\nNo factory default variables found\n");
+    else if (Added == 0 && Removed == 0)
+        OutPrint(L"\nDatabases match their factory defaults\n");
+    else
+        OutPrint(L"\n%d entries added, %d removed since the factory defaults\n", Added, Removed);
+
+done:
+    SnapshotFree(&Snap);
+
+    return Status;
+}
+
+
+typedef struct {
+    UINTN Variable;
+} GRAPH_CONTEXT;
+
+
+static EFI_STATUS
+GraphSignature( UINTN Type,
+                EFI_SIGNATURE_DATA *Cert,
+                UINTN Size,
+                VOID *Context )
+{
+    GRAPH_CONTEXT *Ctx = Context;
+    struct x509_certificate *X509;
+    EFI_STATUS Status = EFI_SUCCESS;
+    UINTN Mark;
+
+    if (Type != SIGNATURE_TYPE_X509)
+        return EFI_SUCCESS;
+
+    Mark = ArenaMark(&Scratch);
+    X509 = ArenaAlloc(&Scratch, sizeof(*X509));
+    if (X509 == NULL) {
+        EmitError(L"Out of scratch memory");
+        return EFI_OUT_OF_RESOURCES;
+    }
+    if (x509_decode_fields(X509, Cert->SignatureData, Size,
+                           X509_ISSUER | X509_SUBJECT | X509_EXTENSIONS) == 0)
+        Status = CertGraphAdd(&Graph, X509, Ctx->Variable);
+    ArenaRelease(&Scratch, Mark);
+
+    return Status;
+}
+
+
+//
+//  One certificate of the graph, indented by its depth below a root
+//
+static VOID
+PrintGraphNode( CHAR16 **variables,
+                UINTN i,
+                UINTN Depth )
+{
+    CERT_NODE *Node = &Graph.Nodes[i];
+    struct x509_certificate *X509;
+    CHAR16 Line[LINE_MAX];
+    UINTN Mark, Pos;
+
+    Node->Visited = TRUE;
+    Mark = ArenaMark(&Scratch);
+    X509 = ArenaAlloc(&Scratch, sizeof(*X509));
+    if (X509 == NULL || x509_decode_fields(X509, Node->Data, Node->Size, X509_ISSUER | X509_SUBJECT) < 0) {
+        ArenaRelease(&Scratch, Mark);
+        return;
+    }
+
+    Pos = AppendLine(Line, 0, L"%*s%s:", Depth * 4, L"", variables[Node->Variable]);
+    Pos = AppendName(Line, Pos, X509, &X509->subject);
+    if (Node->Parent == i) {
+        Pos = AppendLine(Line, Pos, L"  (self-signed)");
+    } else if (Node->Parent == CERT_GRAPH_NONE) {
+        Pos = AppendLine(Line, Pos, L"  (issuer not present:");
+        Pos = AppendName(Line, Pos, X509, &X509->issuer);
+        Pos = AppendLine(Line, Pos, L")");
+    } else if (Depth == 0) {
+        Pos = AppendLine(Line, Pos, L"  (issuer loop)");
+    }
+    OutString(Line);
+    OutString(L"\n");
+
+    ArenaRelease(&Scratch, Mark);
+}
+
+
+//
+//  Walk the tree under Root in order without a stack: down to the first
+//  child, else across to the next sibling, else back up
+//
+static VOID
+PrintGraphTree( CHAR16 **variables,
+                UINTN Root )
+{
+    UINTN i = Root, Depth = 0;
+
+    for (;;) {
+        PrintGraphNode(variables, i, Depth);
+        if (Graph.Nodes[i].FirstChild != CERT_GRAPH_NONE) {
+            i = Graph.Nodes[i].FirstChild;
+            Depth++;
+            continue;
+        }
+        while (i != Root && Graph.Nodes[i].NextSibling == CERT_GRAPH_NONE) {
+            i = Graph.Nodes[i].Parent;
+            Depth--;
+        }
+        if (i == Root)
+            break;
+        i = Graph.Nodes[i].NextSibling;
+    }
+}
+
+
+//
+//  Link the certificates of PK, KEK and db to their issuers and print the
+//  resulting trust graph: self-signed roots and certificates whose issuer
+//  is not in any database, each with everything they issued below them
+//
+EFI_STATUS
+CheckGraph( CHAR16 **variables,
+            EFI_GUID *owners,
+            BOOLEAN *Selected,
+            UINTN Count )
+{
+    GRAPH_CONTEXT Ctx;
+    EFI_STATUS Status = EFI_SUCCESS;
+    UINT8 *Data;
+    UINTN Len, Mark, i, j, Childless = 0;
+    BOOLEAN Signed;
+
+    // the variables stay loaded, the graph points into them
+    Mark = ArenaMark(&Scratch);
+    for (i = 0; i < Count; i++) {
+        if (!Selected[i])
+            continue;
+        Status = get_variable(variables[i], &Data, &Len, owners[i]);
+        if (EFI_ERROR(Status)) {
+            if (Status != EFI_NOT_FOUND)
+                OutPrint(L"ERROR: Failed to get variable %s. Status Code: %d\n", variables[i], Status);
+            continue;
+        }
+        Ctx.Variable = i;
+        Status = WalkSignatureLists(Data, Len, GraphSignature, &Ctx);
+        if (Status == EFI_VOLUME_CORRUPTED)
+            OutPrint(L"ERROR: Malformed signature list in %s\n", variables[i]);
+        if (Status == EFI_OUT_OF_RESOURCES)
+            goto done;
+    }
+
+    Status = CertGraphResolve(&Graph);
+    if (EFI_ERROR(Status)) {
+        OutPrint(L"ERROR: Out of memory resources\n");
+        goto done;
+    }
+
+    for (i = 0; i < Graph.Count; i++) {
+        if (Graph.Nodes[i].Parent == i || Graph.Nodes[i].Parent == CERT_GRAPH_NONE)
+            PrintGraphTree(variables, i);
+    }
+    // what is left hangs off a loop of certificates issuing each other
+    for (i = 0; i < Graph.Count; i++) {
+        if (!Graph.Nodes[i].Visited)
+            PrintGraphNode(variables, i, 0);
+    }
+
+    if (Selected[VAR_KEK] && Selected[VAR_DB]) {
+        for (i = 0; i < Graph.Count; i++) {
+            if (Graph.Nodes[i].Variable != VAR_KEK)
+                continue;
+            Signed = FALSE;
+            for (j = Graph.Nodes[i].FirstChild; j != CERT_GRAPH_NONE && !Signed; j = Graph.Nodes[j].NextSibling)
+                Signed = (Graph.Nodes[j].Variable == VAR_DB);
+            if (!Signed) {
+                if (Childless++ == 0)
+                    OutPrint(L"\nKEK certificates that issued no db certificate:\n");
+                PrintGraphNode(variables, i, 1);
+            }
+        }
+    }
+
+    OutPrint(L"\n%d certificates, %d issued by another, %d self-signed, %d with issuer not present\n",
+             Graph.Count, Graph.Edges, Graph.Roots, Graph.Orphans);
+    Status = EFI_SUCCESS;
+
+done:
+    ArenaRelease(&Scratch, Mark);
+    return Status;
+}
+
+
+typedef struct {
+    CHAR16 *Variable;
+    UINT64 Now;
+    UINT64 Limit;               // certificates expiring before this are reported
+    UINTN  Checked;
+    UINTN  Expiring;
+} EXPIRY_CONTEXT;
+
+
+static VOID
+ReportExpiry( EXPIRY_CONTEXT *Ctx,
+              CONST struct x509_certificate *Cert )
+{
+    CHAR16 Line[LINE_MAX];
+    INT64 Days;
+    UINTN Pos;
+
+    Ctx->Checked++;
+    if (Cert->valid_to >= Ctx->Limit)
+        return;
+
+    Ctx->Expiring++;
+    Pos = AppendLine(Line, 0, L"\n  %s:", Ctx->Variable);
+    Pos = AppendName(Line, Pos, Cert, &Cert->subject);
+    OutString(Line);
+    OutString(L"\n");
+
+    Pos = AppendLine(Line, 0, L"    Not After: ");
+    Pos = AppendTime(Line, Pos, Cert->valid_to);
+    if (Cert->valid_to != 0) {
+        Days = x509_time_days(Cert->valid_to) - x509_time_days(Ctx->Now);
+        if (Cert->valid_to < Ctx->Now)
+            Pos = AppendLine(Line, Pos, L"  EXPIRED %ld days ago", -Days);
+        else
+            Pos = AppendLine(Line, Pos, L"  expires in %ld days", Days);
+    }
+    OutString(Line);
+    OutString(L"\n");
+}
+
+
+static EFI_STATUS
+ExpirySignature( UINTN Type,
+                 EFI_SIGNATURE_DATA *Cert,
+                 UINTN Size,
+                 VOID *Context )
+{
+    EXPIRY_CONTEXT *Ctx = Context;
+    struct x509_certificate *X509;
+    struct pkcs7_message *Msg;
+    UINTN Mark;
+    int i;
+
+    if (Type != SIGNATURE_TYPE_X509 && Type != SIGNATURE_TYPE_PKCS7)
+        return EFI_SUCCESS;
+
+    Mark = ArenaMark(&Scratch);
+    X509 = ArenaAlloc(&Scratch, sizeof(*X509));
+    Msg = ArenaAlloc(&Scratch, sizeof(*Msg));
+    if (X509 == NULL || Msg == NULL) {
+        EmitError(L"Out of scratch memory");
+        return EFI_OUT_OF_RESOURCES;
+    }
+
+    if (Type == SIGNATURE_TYPE_X509) {
+        if (x509_decode_fields(X509, Cert->SignatureData, Size, X509_SUBJECT | X509_NOT_AFTER) == 0)
+            ReportExpiry(Ctx, X509);
+    } else if (pkcs7_decode(Msg, Cert->SignatureData, Size) == 0) {
+        for (i = 0; i < Msg->nr_certs; i++) {
+            if (x509_decode_fields(X509, PKCS7_SLICE_PTR(Msg, Msg->certs[i]), Msg->certs[i].length,
+                                   X509_SUBJECT | X509_NOT_AFTER) == 0)
+                ReportExpiry(Ctx, X509);
+        }
+    }
+    ArenaRelease(&Scratch, Mark);
+
+    return EFI_SUCCESS;
+}
+
+
+//
+//  Report every certificate in the selected variables that has expired or
+//  expires within Days of the platform clock.  Only packed times are
+//  compared.
+//
+EFI_STATUS
+CheckExpiry( UINTN Days,
+             CHAR16 **variables,
+             EFI_GUID *owners,
+             BOOLEAN *Selected,
+             UINTN Count )
+{
+    EXPIRY_CONTEXT Ctx;
+    EFI_STATUS Status;
+    EFI_TIME Time;
+    UINT8 *data;
+    UINTN len;
+    UINTN Mark;
+    UINTN i;
+    CHAR16 Line[LINE_MAX];
+
+    Status = gRT->GetTime(&Time, NULL);
+    if (EFI_ERROR(Status)) {
+        OutPrint(L"ERROR: Failed to read the platform clock. Status Code: %d\n", Status);
+        return Status;
+    }
+
+    ZeroMem(&Ctx, sizeof(Ctx));
+    Ctx.Now = X509_TIME(Time.Year, Time.Month, Time.Day, Time.Hour, Time.Minute, Time.Second);
+    // local time = UTC - TimeZone
+    if (Time.TimeZone != EFI_UNSPECIFIED_TIMEZONE)
+        Ctx.Now = x509_time_add(Ctx.Now, (INT64)Time.TimeZone * 60);
+    Ctx.Limit = x509_time_add(Ctx.Now, (INT64)Days * 86400);
+
+    AppendTime(Line, AppendLine(Line, 0, L"Certificates expiring before "), Ctx.Limit);
+    OutString(Line);
+    OutPrint(L" (%ld days)\n", Days);
+
+    for (i = 0; i < Count; i++) {
+        if (!Selected[i])
+            continue;
+        Mark = ArenaMark(&Scratch);
+        Status = get_variable(variables[i], &data, &len, owners[i]);
+        if (Status == EFI_SUCCESS) {
+            Ctx.Variable = variables[i];
+            Status = WalkSignatureLists(data, len, ExpirySignature, &Ctx);
+            if (Status == EFI_VOLUME_CORRUPTED)
+                OutPrint(L"ERROR: Malformed signature list in %s\n", variables[i]);
+        } else if (Status != EFI_NOT_FOUND) {
+            OutPrint(L"ERROR: Failed to get variable %s. Status Code: %d\n", variables[i], Status);
+        }
+        ArenaRelease(&Scratch, Mark);
+    }
+
+    OutPrint(L"\n%d of %d certificates expiring\n", Ctx.Expiring, Ctx.Checked);
+
+    return EFI_SUCCESS;
+}
+
+
+//
+//  Add a --select list or a --where condition to the query
+//
+static EFI_STATUS
+AddQuery( CHAR16 *Option,
+          CHAR16 *Arg )
+{
+    CHAR8 Ascii[LINE_MAX];
+    int Status = -1;
+
+    if (!RETURN_ERROR(UnicodeStrToAsciiStrS(Arg, Ascii, sizeof(Ascii)))) {
+        if (!StrCmp(Option, L"--select"))
+            Status = x509_query_select(&Query, Ascii);
+        else
+            Status = x509_query_where(&Query, Ascii);
+    }
+    if (Status < 0) {
+        OutPrint(L"ERROR: Invalid %s [%s]\n", Option, Arg);
+        return EFI_INVALID_PARAMETER;
+    }
+
+    return EFI_SUCCESS;
+}
+
+
+static void
+Usage( void )
+{
+    OutPrint(L"Usage: ListCerts [ -pk | -kek | -db | -dbx | -dbt | -dbr | -pkdefault | ... ] [--select fields] [--where condition]... [--stats]\n");
+    OutPrint(L"       ListCerts [ -pk | -kek | -db | -dbx ] [--check hash]... [--check-file filename]\n");
+    OutPrint(L"       ListCerts [ -pk | -kek | -db ] --expiring days\n");
+    OutPrint(L"       ListCerts [ -pk | -kek | -db | -dbx ] --duplicates\n");
+    OutPrint(L"       ListCerts [ -pk | -kek | -db | -dbx ] --graph\n");
+    OutPrint(L"       ListCerts [ -pk | -kek | -db | -dbx ] --snapshot filename\n");
+    OutPrint(L"       ListCerts [ -pk | -kek | -db | -dbx ] --compare filename\n");
+    OutPrint(L"       ListCerts [ -pk | -kek | -db | -dbx | -dbt | -dbr ] --defaults\n");
+    OutPrint(L"       ListCerts --image filename [--image filename]...\n");
+    OutPrint(L"       ListCerts -f filename [-f filename]... [--select fields] [--where condition]...\n");
+    OutPrint(L"       ListCerts [ -pk | ... | -f filename ]... --json | --csv [-o | --output filename]\n");
+    OutPrint(L"       ListCerts [-V | --version]\n");
+}
+
+
+static VOID
+PrintStats( VOID )
+{
+    OutPrint(L"\nScratch memory: %d bytes peak of %d, %d allocations",
+             Scratch.Peak, Scratch.Size, Scratch.Allocations);
+    if (Scratch.Failures > 0)
+        OutPrint(L", %d failed", Scratch.Failures);
+    OutPrint(L"\n");
+    OutPrint(L"SHA-256 engine: %s\n", Sha256Engine());
+    if (Reader.Reads > 0)
+        OutPrint(L"Variable reads: %d variables, %d runtime calls (SMIs), %d byte buffer%s\n",
+                 Reader.Reads, Reader.Calls, Reader.Size,
+                 (Reader.Hint > 0) ? L" sized by QueryVariableInfo" : L"");
+    if (Hashes.Entries != NULL)
+        OutPrint(L"Hash index: %d entries, %d duplicates merged\n", Hashes.Count, Hashes.Duplicates);
+    if (Graph.Nodes != NULL)
+        OutPrint(L"Issuer graph: %d certificates, %d buckets, %d probes\n", Graph.Count, Graph.Buckets, Graph.Probes);
+    if (Certs.Slots != NULL)
+        OutPrint(L"Certificate set: %d of %d slots used, %d probes\n", Certs.Count, Certs.Capacity, Certs.Probes);
+    if (Parallel.Runs > 0)
+        OutPrint(L"Parallel decode: %d processor%s, %d of %d databases shared with the APs, %d entries\n",
+                 Parallel.Processors, (Parallel.Processors == 1) ? L"" : L"s",
+                 Parallel.Shared, Parallel.Runs, Parallel.Items);
+}
+
+
+INTN
+EFIAPI
+ShellAppMain( UINTN Argc, 
+              CHAR16 **Argv )
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    CHAR16 *variables[ARRAY_SIZE(SecureVariables)];
+    EFI_GUID owners[ARRAY_SIZE(SecureVariables)];
+    BOOLEAN Selected[ARRAY_SIZE(owners)] = { FALSE };
+    BOOLEAN Any = FALSE, Stats = FALSE, Defaults = FALSE, Analysis;
+    CHAR16 *Checks[16];
+    CHAR16 *CheckFileName = NULL;
+    CHAR16 *Images[16];
+    CHAR16 *Files[16];
+    UINTN NrImages = 0, NrFiles = 0;
+    CHAR16 *Expiring = NULL, *p;
+    CHAR16 *SnapshotFile = NULL, *CompareFile = NULL;
+    BOOLEAN Duplicates = FALSE, Trust = FALSE;
+    UINTN NrChecks = 0, Checked = 0, Found = 0;
+    UINTN j;
+    int i;
+
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
+    for (j = 0; j < ARRAY_SIZE(SecureVariables); j++) {
+        variables[j] = SecureVariables[j].Name;
+        owners[j] = SecureVariables[j].Vendor;
+    }
+
+    x509_query_init(&Query);
+    for (i = 1; i < Argc; i++) {
+        for (j = 0; j < ARRAY_SIZE(SecureVariables); j++) {
+            if (!StrCmp(Argv[i], SecureVariables[j].Option))
+                break;
+        }
+        if (j < ARRAY_SIZE(SecureVariables)) {
+            Selected[j] = Any = TRUE;
+        } else if (!StrCmp(Argv[i], L"--help") ||
+            !StrCmp(Argv[i], L"-h")) { 
+            Usage();
+            return Status;
+        } else if (!StrCmp(Argv[i], L"--version") ||
+            !StrCmp(Argv[i], L"-V")) {
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
+            return Status;
+        } else if (!StrCmp(Argv[i], L"--stats")) {
+            Stats = TRUE;
+        } else if (!StrCmp(Argv[i], L"--check") && i + 1 < Argc) {
+            if (NrChecks == ARRAY_SIZE(Checks)) {
+                OutPrint(L"ERROR: Too many --check options. Use --check-file\n");
+                return EFI_INVALID_PARAMETER;
+            }
+            Checks[NrChecks++] = Argv[++i];
+        } else if (!StrCmp(Argv[i], L"--image") && i + 1 < Argc) {
+            if (NrImages == ARRAY_SIZE(Images)) {
+                OutPrint(L"ERROR: Too many --image options\n");
+                return EFI_INVALID_PARAMETER;
+            }
+            Images[NrImages++] = Argv[++i];
+        } else if (!StrCmp(Argv[i], L"-f") && i + 1 < Argc) {
+            if (NrFiles == ARRAY_SIZE(Files)) {
+                OutPrint(L"ERROR: Too many -f options\n");
+                return EFI_INVALID_PARAMETER;
+            }
+            Files[NrFiles++] = Argv[++i];
+        } else if ((!StrCmp(Argv[i], L"--select") || !StrCmp(Argv[i], L"--where")) && i + 1 < Argc) {
+            Status = AddQuery(Argv[i], Argv[i + 1]);
+            if (EFI_ERROR(Status))
+                return Status;
+            i++;
+        } else if (!StrCmp(Argv[i], L"--snapshot") && i + 1 < Argc) {
+            SnapshotFile = Argv[++i];
+        } else if (!StrCmp(Argv[i], L"--compare") && i + 1 < Argc) {
+            CompareFile = Argv[++i];
+        } else if (!StrCmp(Argv[i], L"--defaults")) {
+            Defaults = TRUE;
+        } else if (!StrCmp(Argv[i], L"--graph")) {
+            Trust = TRUE;
+        } else if (!StrCmp(Argv[i], L"--duplicates")) {
+            Duplicates = TRUE;
+        } else if (!StrCmp(Argv[i], L"--expiring") && i + 1 < Argc) {
+            Expiring = Argv[++i];
+            for (p = Expiring; *p >= L'0' && *p <= L'9'; p++)
+                ;
+            if (p == Expiring || *p != CHAR_NULL) {
+                OutPrint(L"ERROR: Invalid number of days [%s]\n", Expiring);
+                return EFI_INVALID_PARAMETER;
+            }
+        } else if (!StrCmp(Argv[i], L"--check-file") && i + 1 < Argc) {
+            CheckFileName = Argv[++i];
+        } else {
+            Usage();
+            return Status;
+        }
+    }
+
+    EmitBegin(L"ListCerts", UTILITY_VERSION);
+    if (EmitFormat() != EmitText &&
+        (NrImages > 0 || SnapshotFile != NULL || CompareFile != NULL || Defaults || Trust ||
+         Duplicates || Expiring != NULL || NrChecks > 0 || CheckFileName != NULL)) {
+        EmitError(L"Only the certificate listing is available as JSON or CSV");
+        return EFI_UNSUPPORTED;
+    }
+
+    Status = ArenaInit(&Scratch, ARENA_DEFAULT_SIZE);
+    if (EFI_ERROR(Status)) {
+        EmitError(L"Out of memory resources");
+        return Status;
+    }
+    ParallelInit(&Parallel);
+
+    if (!Any) {
+        // listings and snapshots cover every variable there is; the checks
+        // only the databases firmware enforces.  dbx certificates are
+        // revoked anyway, no point reporting their expiry or where they
+        // hang in the trust graph.
+        Analysis = (NrChecks > 0 || CheckFileName != NULL || Duplicates || Trust || Expiring != NULL);
+        for (i = 0; i < ARRAY_SIZE(owners); i++) {
+            Selected[i] = !Analysis || SecureVariables[i].Active;
+            if ((Expiring != NULL || Trust) && i == VAR_DBX)
+                Selected[i] = FALSE;
+        }
+    }
+
+    if (EmitFormat() != EmitText) {
+        EmitArray(NrFiles > 0 ? L"files" : L"variables");
+        for (i = 0; i < NrFiles; i++)
+            Status = OutputFile(Files[i]);
+        for (i = 0; NrFiles == 0 && i < ARRAY_SIZE(owners); i++) {
+            if (Selected[i])
+                Status = OutputVariable(variables[i], owners[i]);
+        }
+        EmitClose();
+    } else if (NrFiles > 0) {
+        for (i = 0; i < NrFiles; i++)
+            Status = OutputFile(Files[i]);
+    } else if (NrImages > 0) {
+        Status = CheckImages(Images, NrImages, variables, owners);
+    } else if (SnapshotFile != NULL) {
+        Status = SaveSnapshot(SnapshotFile, variables, owners, Selected, ARRAY_SIZE(owners));
+    } else if (CompareFile != NULL) {
+        Status = CompareSnapshot(CompareFile, variables, owners, Selected, ARRAY_SIZE(owners));
+    } else if (Defaults) {
+        Status = CompareDefaults(variables, owners, Selected, ARRAY_SIZE(owners));
+    } else if (Trust) {
+        Status = CheckGraph(variables, owners, Selected, ARRAY_SIZE(owners));
+    } else if (Duplicates) {
+        Status = CheckDuplicates(variables, owners, Selected, ARRAY_SIZE(owners));
+    } else if (Expiring != NULL) {
+        Status = CheckExpiry(StrDecimalToUintn(Expiring), variables, owners, Selected, ARRAY_SIZE(owners));
+    } else if (NrChecks > 0 || CheckFileName != NULL) {
+        Status = BuildHashIndex(variables, owners, Selected, ARRAY_SIZE(owners));
+        for (i = 0; !EFI_ERROR(Status) && i < NrChecks; i++) {
+            Checked++;
+            if (CheckDigest(Checks[i], variables, ARRAY_SIZE(owners)))
+                Found++;
+        }
+        if (!EFI_ERROR(Status) && CheckFileName != NULL)
+            Status = CheckFile(CheckFileName, variables, ARRAY_SIZE(owners), &Checked, &Found);
+        if (!EFI_ERROR(Status))
+            OutPrint(L"\n%d of %d hashes found\n", Found, Checked);
+    } else {
+        for (i = 0; i < ARRAY_SIZE(owners); i++) {
+            if (Selected[i])
+                Status = OutputVariable(variables[i], owners[i]);
+        }
+    }
+
+    if (Stats && EmitFormat() == EmitText)
+        PrintStats();
+    HashIndexFree(&Hashes);
+    CertSetFree(&Certs);
+    CertGraphFree(&Graph);
+    VarReaderFree(&Reader);
+    ArenaFree(&Scratch);
+
     return Status;
 }
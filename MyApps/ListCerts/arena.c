@@ -0,0 +1,83 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Bump allocator for ListCerts decode scratch memory.  One pool allocation
+//  is made up front; everything transient is carved out of it and handed
+//  back in bulk with ArenaRelease() instead of a FreePool() per object.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+#include "arena.h"
+
+
+EFI_STATUS
+ArenaInit( SCRATCH_ARENA *Arena,
+           UINTN Size )
+{
+    ZeroMem(Arena, sizeof(*Arena));
+
+    Arena->Base = AllocatePool(Size);
+    if (Arena->Base == NULL)
+        return EFI_OUT_OF_RESOURCES;
+    Arena->Size = Size;
+
+    return EFI_SUCCESS;
+}
+
+
+VOID
+ArenaFree( SCRATCH_ARENA *Arena )
+{
+    if (Arena->Base != NULL)
+        FreePool(Arena->Base);
+    Arena->Base = NULL;
+    Arena->Size = Arena->Used = 0;
+}
+
+
+//
+//  Returns NULL once the arena is exhausted; it never grows
+//
+VOID *
+ArenaAlloc( SCRATCH_ARENA *Arena,
+            UINTN Size )
+{
+    UINTN Offset = ALIGN_VALUE(Arena->Used, ARENA_ALIGN);
+
+    if (Size > Arena->Size || Offset > Arena->Size - Size) {
+        Arena->Failures++;
+        return NULL;
+    }
+
+    Arena->Used = Offset + Size;
+    if (Arena->Used > Arena->Peak)
+        Arena->Peak = Arena->Used;
+    Arena->Allocations++;
+
+    return Arena->Base + Offset;
+}
+
+
+UINTN
+ArenaMark( SCRATCH_ARENA *Arena )
+{
+    return Arena->Used;
+}
+
+
+//
+//  Free everything allocated since Mark was taken
+//
+VOID
+ArenaRelease( SCRATCH_ARENA *Arena,
+              UINTN Mark )
+{
+    if (Mark <= Arena->Used)
+        Arena->Used = Mark;
+}
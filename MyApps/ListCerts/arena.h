@@ -0,0 +1,30 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Bump allocator for ListCerts decode scratch memory
+//
+//  License: BSD License
+//
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#define ARENA_DEFAULT_SIZE  SIZE_1MB
+#define ARENA_ALIGN         8
+
+typedef struct {
+    UINT8 *Base;
+    UINTN Size;
+    UINTN Used;
+    UINTN Peak;           // high water mark, for --stats
+    UINTN Allocations;
+    UINTN Failures;
+} SCRATCH_ARENA;
+
+EFI_STATUS ArenaInit(SCRATCH_ARENA *Arena, UINTN Size);
+VOID       ArenaFree(SCRATCH_ARENA *Arena);
+VOID      *ArenaAlloc(SCRATCH_ARENA *Arena, UINTN Size);
+UINTN      ArenaMark(SCRATCH_ARENA *Arena);
+VOID       ArenaRelease(SCRATCH_ARENA *Arena, UINTN Mark);
+
+#endif /* _ARENA_H */
@@ -21,12 +21,14 @@
 #include <Uefi.h>
 #include <Library/UefiLib.h>
 #include <Library/BaseLib.h>
-#include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
 
 #include "asn1_ber_decoder.h"
 #include "asn1_ber_bytecode.h"
 
+int asn1_report_errors = 1;
+
 static const unsigned char asn1_op_lengths[ASN1_OP__NR] = {
 	/*					OPC TAG JMP ACT */
 	[ASN1_OP_MATCH]				= 1 + 1,
@@ -65,16 +67,16 @@ static const unsigned char asn1_op_lengths[ASN1_OP__NR] = {
  * @_len: Where to return the size of the element.
  * @_errmsg: Where to return a pointer to an error message on error
  */
-static int asn1_find_indefinite_length(const unsigned char *data, size_t datalen,
-				       size_t *_dp, size_t *_len,
-				       const char **_errmsg)
+int asn1_find_indefinite_length(const unsigned char *data, size_t datalen,
+				size_t *_dp, size_t *_len,
+				const char **_errmsg)
 {
 	unsigned char tag, tmp;
 	size_t dp = *_dp, len, n;
 	int indef_level = 1;
 
 next_tag:
-	if (unlikely(datalen - dp < 2)) {
+	if (unlikely(dp > datalen || datalen - dp < 2)) {
 		if (datalen == dp)
 			goto missing_eoc;
 		goto data_overrun_error;
@@ -95,16 +97,21 @@ next_tag:
 	}
 
 	if (unlikely((tag & 0x1f) == 0x1f)) {
+		n = 0;
 		do {
 			if (unlikely(datalen - dp < 2))
 				goto data_overrun_error;
+			if (unlikely(++n > ASN1_MAX_TAG_OCTETS))
+				goto tag_too_long;
 			tmp = data[dp++];
 		} while (tmp & 0x80);
 	}
 
 	/* Extract the length */
 	len = data[dp++];
-	if (len < 0x7f) {
+	if (len <= 0x7f) {
+		if (unlikely(len > datalen - dp))
+			goto data_overrun_error;
 		dp += len;
 		goto next_tag;
 	}
@@ -126,6 +133,8 @@ next_tag:
 		len <<= 8;
 		len |= data[dp++];
 	}
+	if (unlikely(len > datalen - dp))
+		goto data_overrun_error;
 	dp += len;
 	goto next_tag;
 
@@ -134,6 +143,9 @@ next_tag:
  *        if you get garbled output, these may be the culprits
  * 
  */
+tag_too_long:
+	*_errmsg = "Unsupported tag";
+	goto error;
 length_too_long:
 	*_errmsg = "Unsupported length";
 	goto error;
@@ -166,14 +178,13 @@ error:
  *
  * LIMITATIONS:
  *
- * To keep down the amount of stack used by this function, the following limits
- * have been imposed:
+ *  (1) The stack of constructed types is ASN1_MAX_CONS_DEPTH deep and the
+ *	jump stack ASN1_MAX_JUMP_DEPTH deep.  If the depth of non-leaf
+ *	constructed types exceeds this, the decode will fail.  Both can be
+ *	raised at build time.
  *
- *  (1) This won't handle datalen > 65535 without increasing the size of the
- *	cons stack elements and length_too_long checking.
- *
- *  (2) The stack of constructed types is 10 deep.  If the depth of non-leaf
- *	constructed types exceeds this, the decode will fail.
+ *  (2) Long form (multi-byte) tags in the data are accepted but can only
+ *	be matched by ANY ops, as the bytecode holds single-byte tags.
  *
  *  (3) The SET type (not the SET OF type) isn't really supported as tracking
  *	what members of the set have been seen is a pain.
@@ -192,6 +203,7 @@ int asn1_ber_decoder(const struct asn1_decoder *decoder,
 	const CHAR16 *Errmsg = NULL;
 	size_t pc = 0, dp = 0, tdp = 0, len = 0;
 	int ret;
+	int long_tag = 0;
 
 	unsigned char flags = 0;
 #define FLAG_INDEFINITE_LENGTH	0x01
@@ -201,15 +213,12 @@ int asn1_ber_decoder(const struct asn1_decoder *decoder,
 				      *   a compound type.
 				      */
 
-#define NR_CONS_STACK 10
-	unsigned short cons_dp_stack[NR_CONS_STACK];
-	unsigned short cons_datalen_stack[NR_CONS_STACK];
+#define NR_CONS_STACK ASN1_MAX_CONS_DEPTH
+	size_t cons_dp_stack[NR_CONS_STACK];
+	size_t cons_datalen_stack[NR_CONS_STACK];
 	unsigned char cons_hdrlen_stack[NR_CONS_STACK];
-#define NR_JUMP_STACK 10
-	unsigned char jump_stack[NR_JUMP_STACK];
-
-	if (datalen > 65535)
-		return -EMSGSIZE;
+#define NR_JUMP_STACK ASN1_MAX_JUMP_DEPTH
+	size_t jump_stack[NR_JUMP_STACK];
 
 next_op:
 	if (unlikely(pc >= machlen))
@@ -239,11 +248,30 @@ next_op:
 		if (unlikely(dp >= datalen - 1))
 			goto data_overrun_error;
 		tag = data[dp++];
-		if (unlikely((tag & 0x1f) == 0x1f))
-			goto long_tag_not_supported;
+		long_tag = 0;
+		if (unlikely((tag & 0x1f) == 0x1f)) {
+			/* Skip the base-128 tag number that follows */
+			do {
+				if (unlikely(dp >= datalen - 1))
+					goto data_overrun_error;
+				if (unlikely(hdr - 2 >= ASN1_MAX_TAG_OCTETS))
+					goto tag_too_long;
+				tmp = data[dp++];
+				hdr++;
+			} while (tmp & 0x80);
+			long_tag = 1;
+		}
 
 		if (op & ASN1_OP_MATCH__ANY) {
 			;
+		} else if (long_tag) {
+			/* The machine only holds single-byte tags */
+			if (op & ASN1_OP_MATCH__SKIP) {
+				pc += asn1_op_lengths[op];
+				dp -= hdr - 1;
+				goto next_op;
+			}
+			goto tag_mismatch;
 		} else {
 			/* Extract the tag from the machine
 			 * - Either CONS or PRIM are permitted in the data if
@@ -279,9 +307,9 @@ next_op:
 					goto data_overrun_error;
 			} else {
 				int n = len - 0x80;
-				if (unlikely(n > 2))
+				if (unlikely(n > sizeof(len) - 1))
 					goto length_too_long;
-				if (unlikely(dp >= datalen - n))
+				if (unlikely(n > datalen - dp))
 					goto data_overrun_error;
 				hdr += n;
 				for (len = 0; n > 0; n--) {
@@ -291,6 +319,8 @@ next_op:
 				if (unlikely(len > datalen - dp))
 					goto data_overrun_error;
 			}
+		} else if (unlikely(len > datalen - dp)) {
+			goto data_overrun_error;
 		}
 
 		if (flags & FLAG_CONS) {
@@ -340,8 +370,10 @@ next_op:
 			if (flags & FLAG_INDEFINITE_LENGTH) {
 				ret = asn1_find_indefinite_length(
 					data, datalen, &dp, &len, &errmsg);
-				if (ret < 0)
+				if (ret < 0) {
+					Errmsg = L"Indefinite length error";
 					goto error;
+				}
 			} else {
 				dp += len;
 			}
@@ -390,7 +422,7 @@ next_op:
 		if (datalen == 0) {
 			/* Indefinite length - check for the EOC. */
 			datalen = len;
-			if (unlikely(datalen - dp < 2))
+			if (unlikely(dp > datalen || datalen - dp < 2))
 				goto data_overrun_error;
 			if (data[dp++] != 0) {
 				if (op & ASN1_OP_END__OF) {
@@ -472,6 +504,9 @@ missing_eoc:
 invalid_eoc:
 	Errmsg = L"Invalid length EOC";
 	goto error;
+tag_too_long:
+	Errmsg = L"Unsupported tag";
+	goto error;
 length_too_long:
 	Errmsg = L"Unsupported length";
 	goto error;
@@ -480,11 +515,47 @@ indefinite_len_primitive:
 	goto error;
 tag_mismatch:
 	Errmsg = L"Unexpected tag";
-	goto error;
-long_tag_not_supported:
-	Errmsg = L"Long tag not supported";
 error:
-        Print(L"ERROR: %s\n", Errmsg);
+	if (asn1_report_errors)
+		OutPrint(L"ERROR: %s\n", Errmsg);
 	return -EBADMSG;
 }
 
+
+
+/*
+ * Read one tag and length for callers that walk DER by hand rather than
+ * through a decoder machine.  On return *_dp is the offset of the value.
+ * An indefinite length runs to the end of the data.
+ */
+int
+asn1_read_header( const unsigned char *data,
+		  size_t datalen,
+		  size_t *_dp,
+		  unsigned char *_tag,
+		  size_t *_len )
+{
+	size_t dp = *_dp, len, n;
+
+	if (dp > datalen || datalen - dp < 2)
+		return -EBADMSG;
+	*_tag = data[dp++];
+	n = data[dp++];
+	if (n == 0x80) {
+		len = datalen - dp;
+	} else if (n > 0x80) {
+		n -= 0x80;
+		if (n > sizeof(len) - 1 || datalen - dp < n)
+			return -EBADMSG;
+		for (len = 0; n > 0; n--)
+			len = (len << 8) | data[dp++];
+	} else {
+		len = n;
+	}
+	if (len > datalen - dp)
+		return -EBADMSG;
+
+	*_dp = dp;
+	*_len = len;
+	return 0;
+}
@@ -21,18 +21,46 @@
 #define _ASN1_DECODER_H
 
 /* FPM  - hack to handle any size_t issues */
-typedef long  size_t __attribute__((aligned (8)));
+typedef UINTN size_t;
 #define unlikely(x) (x)
 
+/* Decoder stack depths, may be overridden from the build options */
+#ifndef ASN1_MAX_CONS_DEPTH
+#define ASN1_MAX_CONS_DEPTH  32
+#endif
+#ifndef ASN1_MAX_JUMP_DEPTH
+#define ASN1_MAX_JUMP_DEPTH  32
+#endif
+
+/* Longest base-128 tag number accepted after a 0x1f tag octet */
+#define ASN1_MAX_TAG_OCTETS  4
+
 
 #include "asn1.h"
 
 struct asn1_decoder;
 
+/* Print why a decode failed; cleared while decoding on the APs */
+extern int asn1_report_errors;
+
 extern int 
 asn1_ber_decoder( const struct asn1_decoder *decoder,
 		  void *context,
 		  const unsigned char *data,
 		  size_t datalen );
 
+extern int
+asn1_find_indefinite_length( const unsigned char *data,
+			     size_t datalen,
+			     size_t *_dp,
+			     size_t *_len,
+			     const char **_errmsg );
+
+extern int
+asn1_read_header( const unsigned char *data,
+		  size_t datalen,
+		  size_t *_dp,
+		  unsigned char *_tag,
+		  size_t *_len );
+
 #endif /* _ASN1_DECODER_H */
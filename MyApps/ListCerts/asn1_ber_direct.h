@@ -0,0 +1,251 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Support for direct-coded ASN.1 decoders generated by build_asn1_direct.py.
+ *
+ *  A direct-coded decoder is the bytecode machine of an ASN.1 grammar turned
+ *  into straight-line C: each opcode becomes a block with its tag, action and
+ *  jump target folded in, so there is no opcode fetch, no length table lookup
+ *  and no indirect action call.  The helpers below are the pieces of
+ *  asn1_ber_decoder() that do not depend on the opcode stream and must behave
+ *  exactly like it.
+ *
+ */
+
+#ifndef _ASN1_BER_DIRECT_H
+#define _ASN1_BER_DIRECT_H
+
+#include "asn1_ber_decoder.h"
+#include "asn1_ber_bytecode.h"
+
+#define ASN1_DIRECT_INDEFINITE_LENGTH	0x01
+#define ASN1_DIRECT_MATCHED		0x02
+#define ASN1_DIRECT_CONS		0x20	/* CONS bit of the opcode tag */
+
+struct asn1_direct {
+	const unsigned char *data;
+	size_t datalen, dp, tdp, len;
+	unsigned char tag, hdr, flags, csp, jsp;
+	const CHAR16 *errmsg;
+	size_t cons_dp_stack[ASN1_MAX_CONS_DEPTH];
+	size_t cons_datalen_stack[ASN1_MAX_CONS_DEPTH];
+	unsigned char cons_hdrlen_stack[ASN1_MAX_CONS_DEPTH];
+	unsigned short jump_stack[ASN1_MAX_JUMP_DEPTH];
+};
+
+
+static inline void asn1_direct_init(struct asn1_direct *s,
+				    const unsigned char *data,
+				    size_t datalen)
+{
+	s->data = data;
+	s->datalen = datalen;
+	s->dp = s->tdp = s->len = 0;
+	s->tag = s->hdr = s->flags = s->csp = s->jsp = 0;
+	s->errmsg = NULL;
+}
+
+
+static inline int asn1_direct_error(struct asn1_direct *s,
+				    const CHAR16 *errmsg)
+{
+	s->errmsg = errmsg;
+	return -EBADMSG;
+}
+
+
+/*
+ * The tag matching prologue of asn1_ber_decoder().  Returns 1 if the
+ * element matched, 0 if the op is to be skipped and -EBADMSG on error.
+ */
+static inline int asn1_direct_match(struct asn1_direct *s,
+				    unsigned char op,
+				    unsigned char optag)
+{
+	const unsigned char *data = s->data;
+	size_t datalen = s->datalen, dp = s->dp, len;
+	unsigned char tag, tmp, hdr = 2, flags = 0;
+	int long_tag = 0, n;
+
+	/* Skip conditional matches if possible */
+	if ((op & ASN1_OP_MATCH__COND && s->flags & ASN1_DIRECT_MATCHED) ||
+	    dp == datalen)
+		return 0;
+
+	s->flags = 0;
+	if (unlikely(dp >= datalen - 1))
+		return asn1_direct_error(s, L"Data overrun error");
+	tag = data[dp++];
+	if (unlikely((tag & 0x1f) == 0x1f)) {
+		/* Skip the base-128 tag number that follows */
+		do {
+			if (unlikely(dp >= datalen - 1))
+				return asn1_direct_error(s, L"Data overrun error");
+			if (unlikely(hdr - 2 >= ASN1_MAX_TAG_OCTETS))
+				return asn1_direct_error(s, L"Unsupported tag");
+			tmp = data[dp++];
+			hdr++;
+		} while (tmp & 0x80);
+		long_tag = 1;
+	}
+	s->tag = tag;
+	s->hdr = hdr;
+
+	if (op & ASN1_OP_MATCH__ANY) {
+		;
+	} else if (long_tag) {
+		if (op & ASN1_OP_MATCH__SKIP) {
+			s->dp = dp - (hdr - 1);
+			return 0;
+		}
+		return asn1_direct_error(s, L"Unexpected tag");
+	} else {
+		flags |= optag & ASN1_DIRECT_CONS;
+		tmp = optag ^ tag;
+		tmp &= ~(optag & ASN1_CONS_BIT);
+		if (tmp != 0) {
+			s->flags = flags;
+			if (op & ASN1_OP_MATCH__SKIP) {
+				s->dp = dp - 1;
+				return 0;
+			}
+			return asn1_direct_error(s, L"Unexpected tag");
+		}
+	}
+	flags |= ASN1_DIRECT_MATCHED;
+
+	len = data[dp++];
+	if (len > 0x7f) {
+		if (unlikely(len == 0x80)) {
+			/* Indefinite length */
+			if (unlikely(!(tag & ASN1_CONS_BIT)))
+				return asn1_direct_error(s, L"Indefinite len primitive not permitted");
+			flags |= ASN1_DIRECT_INDEFINITE_LENGTH;
+			if (unlikely(2 > datalen - dp))
+				return asn1_direct_error(s, L"Data overrun error");
+		} else {
+			n = len - 0x80;
+			if (unlikely(n > sizeof(len) - 1))
+				return asn1_direct_error(s, L"Unsupported length");
+			if (unlikely(n > datalen - dp))
+				return asn1_direct_error(s, L"Data overrun error");
+			hdr += n;
+			for (len = 0; n > 0; n--) {
+				len <<= 8;
+				len |= data[dp++];
+			}
+			if (unlikely(len > datalen - dp))
+				return asn1_direct_error(s, L"Data overrun error");
+		}
+	} else if (unlikely(len > datalen - dp)) {
+		return asn1_direct_error(s, L"Data overrun error");
+	}
+
+	if (flags & ASN1_DIRECT_CONS) {
+		/* For expected compound forms, stack the start and end */
+		if (unlikely(s->csp >= ASN1_MAX_CONS_DEPTH))
+			return asn1_direct_error(s, L"Cons stack overflow");
+		s->cons_dp_stack[s->csp] = dp;
+		s->cons_hdrlen_stack[s->csp] = hdr;
+		if (!(flags & ASN1_DIRECT_INDEFINITE_LENGTH)) {
+			s->cons_datalen_stack[s->csp] = datalen;
+			s->datalen = dp + len;
+		} else {
+			s->cons_datalen_stack[s->csp] = 0;
+		}
+		s->csp++;
+	}
+
+	s->hdr = hdr;
+	s->flags = flags;
+	s->dp = s->tdp = dp;
+	s->len = len;
+
+	return 1;
+}
+
+
+/*
+ * Step over the contents of a matched primitive element
+ */
+static inline int asn1_direct_skip(struct asn1_direct *s)
+{
+	const char *errmsg;
+
+	if (!(s->flags & ASN1_DIRECT_CONS)) {
+		if (s->flags & ASN1_DIRECT_INDEFINITE_LENGTH) {
+			if (asn1_find_indefinite_length(s->data, s->datalen,
+							&s->dp, &s->len, &errmsg) < 0)
+				return asn1_direct_error(s, L"Indefinite length error");
+		} else {
+			s->dp += s->len;
+		}
+	}
+
+	return 0;
+}
+
+
+static inline int asn1_direct_push(struct asn1_direct *s,
+				   unsigned short ret_pc)
+{
+	if (unlikely(s->jsp == ASN1_MAX_JUMP_DEPTH))
+		return asn1_direct_error(s, L"Jump stack overflow");
+	s->jump_stack[s->jsp++] = ret_pc;
+
+	return 0;
+}
+
+
+/*
+ * The END_SEQ/END_SET family.  Returns 1 if a SEQUENCE OF / SET OF has
+ * another element and the op's jump target should be taken, otherwise 0,
+ * leaving the element in tdp/len for an action.
+ */
+static inline int asn1_direct_end(struct asn1_direct *s,
+				  unsigned char op)
+{
+	size_t len;
+
+	if ((op & ASN1_OP_END__SET) && !(op & ASN1_OP_END__OF) &&
+	    unlikely(!(s->flags & ASN1_DIRECT_MATCHED)))
+		return asn1_direct_error(s, L"Unexpected tag");
+	if (unlikely(s->csp <= 0))
+		return asn1_direct_error(s, L"Cons stack underflow");
+
+	s->csp--;
+	s->tdp = s->cons_dp_stack[s->csp];
+	s->hdr = s->cons_hdrlen_stack[s->csp];
+	len = s->datalen;
+	s->datalen = s->cons_datalen_stack[s->csp];
+	if (s->datalen == 0) {
+		/* Indefinite length - check for the EOC. */
+		s->datalen = len;
+		if (unlikely(s->datalen - s->dp < 2))
+			return asn1_direct_error(s, L"Data overrun error");
+		if (s->data[s->dp++] != 0) {
+			if (op & ASN1_OP_END__OF) {
+				s->dp--;
+				s->csp++;
+				return 1;
+			}
+			return asn1_direct_error(s, L"Missing EOC in indefinite len cons");
+		}
+		if (s->data[s->dp++] != 0)
+			return asn1_direct_error(s, L"Invalid length EOC");
+		s->len = s->dp - s->tdp - 2;
+	} else {
+		if (s->dp < len && (op & ASN1_OP_END__OF)) {
+			s->datalen = len;
+			s->csp++;
+			return 1;
+		}
+		if (s->dp != len)
+			return asn1_direct_error(s, L"Cons length error");
+		s->len = len - s->tdp;
+	}
+
+	return 0;
+}
+
+#endif /* _ASN1_BER_DIRECT_H */
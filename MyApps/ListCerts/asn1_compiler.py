@@ -0,0 +1,429 @@
+#!/usr/bin/env python3
+#
+#  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+#
+#  ASN.1 compiler.  Turns an ASN.1 grammar into the bytecode machine and
+#  action table run by asn1_ber_decoder(), in the same layout as the
+#  kernel's scripts/asn1_compiler, which produced the original x509.c.
+#
+#  The grammar is a list of type assignments; the first one is the root.
+#  Tags are EXPLICIT unless marked IMPLICIT.  An action is named after a
+#  type with ({ action }) and is called with the element's value:
+#
+#      Validity ::= SEQUENCE {
+#          notBefore   Time ({ do_validity_not_before }),
+#          notAfter    Time ({ do_validity_not_after })
+#      }
+#
+#  Supported: SEQUENCE, SEQUENCE OF, SET OF, CHOICE, ANY, the universal
+#  primitive types, [n] tags, OPTIONAL and DEFAULT.  SET is not.
+#
+#  License: BSD License
+#
+#  Usage: asn1_compiler.py grammar.asn1 grammar.c grammar.h
+#
+
+import os
+import re
+import sys
+
+UNIVERSAL_TAGS = {
+    0: 'EOC', 1: 'BOOL', 2: 'INT', 3: 'BTS', 4: 'OTS', 5: 'NULL', 6: 'OID',
+    7: 'ODE', 8: 'EXT', 9: 'REAL', 10: 'ENUM', 11: 'EPDV', 12: 'UTF8STR',
+    13: 'RELOID', 16: 'SEQ', 17: 'SET', 18: 'NUMSTR', 19: 'PRNSTR',
+    20: 'TEXSTR', 21: 'VIDSTR', 22: 'IA5STR', 23: 'UNITIM', 24: 'GENTIM',
+    25: 'GRASTR', 26: 'VISSTR', 27: 'GENSTR', 28: 'UNISTR', 29: 'CHRSTR',
+    30: 'BMPSTR',
+}
+
+# primitive types, multi-word names first
+PRIMITIVES = [
+    ('BIT STRING', 3), ('OCTET STRING', 4), ('OBJECT IDENTIFIER', 6),
+    ('BOOLEAN', 1), ('INTEGER', 2), ('NULL', 5), ('ObjectDescriptor', 7),
+    ('EXTERNAL', 8), ('REAL', 9), ('ENUMERATED', 10), ('UTF8String', 12),
+    ('RELATIVE-OID', 13), ('NumericString', 18), ('PrintableString', 19),
+    ('T61String', 20), ('TeletexString', 20), ('VideotexString', 21),
+    ('IA5String', 22), ('UTCTime', 23), ('GeneralizedTime', 24),
+    ('GraphicString', 25), ('VisibleString', 26), ('GeneralString', 27),
+    ('UniversalString', 28), ('CHARACTER STRING', 29), ('BMPString', 30),
+]
+
+CLASSES = {'UNIVERSAL': 'UNIV', 'APPLICATION': 'APPL', 'PRIVATE': 'PRIV'}
+MAX_MACHINE = 256        # jump targets are one byte
+
+TOKEN = re.compile(r'\s*(?:(--[^\n]*)|(::=|\(\{|\}\)|[{}\[\](),])|([A-Za-z][A-Za-z0-9_-]*)|([0-9]+))')
+
+
+def fail(msg):
+    sys.exit("asn1_compiler: %s" % msg)
+
+
+def tokenize(text):
+    tokens, pos = [], 0
+    text = text.rstrip()
+    while pos < len(text):
+        m = TOKEN.match(text, pos)
+        if not m:
+            fail("unexpected character '%s' at line %d" % (text[pos], text.count('\n', 0, pos) + 1))
+        pos = m.end()
+        if m.group(1) is None:
+            tokens.append(m.group(m.lastindex))
+    return tokens
+
+
+class Element:
+    def __init__(self, kind):
+        self.kind = kind          # PRIM ANY REF SEQ SEQ_OF SET_OF CHOICE EXPLICIT
+        self.name = None
+        self.cls = 'UNIV'
+        self.tag = None           # tag number; None for ANY, CHOICE and REF
+        self.cons = kind in ('SEQ', 'SEQ_OF', 'SET_OF', 'EXPLICIT')
+        self.tagged = False       # carries an IMPLICIT tag
+        self.children = []
+        self.ref = None
+        self.optional = False
+        self.cond = False
+        self.action = None
+        self.type_def = None
+        self.entry = None
+
+
+class Type:
+    def __init__(self, name, element):
+        self.name = name
+        self.element = element
+        self.ref_count = 0
+        element.type_def = self
+
+
+class Parser:
+    def __init__(self, tokens):
+        self.tokens = tokens
+        self.pos = 0
+
+    def peek(self, n=0):
+        i = self.pos + n
+        return self.tokens[i] if i < len(self.tokens) else None
+
+    def next(self):
+        tok = self.peek()
+        if tok is None:
+            fail("unexpected end of grammar")
+        self.pos += 1
+        return tok
+
+    def expect(self, tok):
+        got = self.next()
+        if got != tok:
+            fail("expected '%s', found '%s'" % (tok, got))
+
+    def grammar(self):
+        types = []
+        while self.peek() is not None:
+            name = self.next()
+            self.expect('::=')
+            types.append(Type(name, self.type()))
+        if not types:
+            fail("empty grammar")
+        return types
+
+    def type(self):
+        cls = tag = None
+        implicit = False
+        if self.peek() == '[':
+            self.next()
+            cls = 'CONT'
+            if self.peek() in CLASSES:
+                cls = CLASSES[self.next()]
+            tag = int(self.next())
+            self.expect(']')
+            if self.peek() in ('IMPLICIT', 'EXPLICIT'):
+                implicit = self.next() == 'IMPLICIT'
+
+        e = self.base_type()
+
+        if cls is not None:
+            if implicit:
+                if e.kind in ('ANY', 'CHOICE'):
+                    fail("IMPLICIT tag on ANY or CHOICE")
+                e.cls, e.tag, e.tagged = cls, tag, True
+            else:
+                wrapper = Element('EXPLICIT')
+                wrapper.cls, wrapper.tag = cls, tag
+                wrapper.children = [e]
+                e = wrapper
+
+        while self.peek() in ('OPTIONAL', 'DEFAULT', '({'):
+            tok = self.next()
+            if tok == '({':
+                inner = e.children[0] if e.kind == 'EXPLICIT' else e
+                inner.action = self.next()
+                self.expect('})')
+            else:
+                e.optional = True
+                if tok == 'DEFAULT' and self.peek() not in (',', '}', '({', None):
+                    self.next()
+        return e
+
+    def base_type(self):
+        tok = self.next()
+        for name, tag in PRIMITIVES:
+            words = name.split()
+            if [tok] + [self.peek(i) for i in range(len(words) - 1)] == words:
+                self.pos += len(words) - 1
+                e = Element('PRIM')
+                e.tag = tag
+                return e
+        if tok == 'ANY':
+            if self.peek() == 'DEFINED':
+                self.pos += 3
+            return Element('ANY')
+        if tok in ('SEQUENCE', 'SET'):
+            if self.peek() == 'OF':
+                self.next()
+                e = Element('SEQ_OF' if tok == 'SEQUENCE' else 'SET_OF')
+                e.tag = 16 if tok == 'SEQUENCE' else 17
+                e.children = [self.type()]
+                return e
+            if tok == 'SET':
+                fail("the SET type is not supported")
+            e = Element('SEQ')
+            e.tag = 16
+            e.children = self.members()
+            return e
+        if tok == 'CHOICE':
+            e = Element('CHOICE')
+            e.children = self.members()
+            for i, c in enumerate(e.children):
+                c.optional = True
+                c.cond = i > 0
+            return e
+        if re.match(r'^[A-Z]', tok):
+            e = Element('REF')
+            e.ref = tok
+            return e
+        fail("unknown type '%s'" % tok)
+
+    def members(self):
+        self.expect('{')
+        members = []
+        while True:
+            name = self.next()
+            e = self.type()
+            e.name = name
+            members.append(e)
+            tok = self.next()
+            if tok == '}':
+                return members
+            if tok != ',':
+                fail("expected ',' or '}' after %s" % name)
+
+
+def resolve(types):
+    by_name = dict((t.name, t) for t in types)
+
+    def walk(e):
+        if e.kind == 'REF':
+            if e.ref not in by_name:
+                fail("undefined type %s" % e.ref)
+            e.ref = by_name[e.ref]
+            e.ref.ref_count += 1
+        for c in e.children:
+            walk(c)
+
+    for t in types:
+        walk(t.element)
+
+
+class Renderer:
+    def __init__(self):
+        self.lines = []
+        self.nr = 0
+        self.depth = 0
+        self.render_list = []
+        self.actions = set()
+
+    def more(self, text):
+        self.lines.append(text)
+
+    def opcode(self, text, comment=None):
+        line = "\t[%4d] = %s%s," % (self.nr, " " * self.depth, text)
+        if comment:
+            line += "\t\t// %s" % comment
+        self.lines.append(line + "\n")
+        self.nr += 1
+
+    def action(self, name):
+        self.actions.add(name)
+        self.opcode("_action(ACT_%s)" % name)
+
+    def tag(self, e, tagged):
+        cls, tag = (tagged.cls, tagged.tag) if tagged is not None else (e.cls, e.tag)
+        method = 'CONS' if e.cons else 'PRIM'
+        if cls == 'UNIV' and tag in UNIVERSAL_TAGS:
+            self.opcode("_tag(%s, %s, %s)" % (cls, method, UNIVERSAL_TAGS[tag]))
+        else:
+            self.opcode("_tagn(%s, %s, %2u)" % (cls, method, tag))
+
+    def element(self, e, ref=None):
+        """ref is the type reference that led here, if any"""
+        skippable = e.optional or (ref is not None and ref.optional)
+        cond = "COND_" if e.cond or (ref is not None and ref.cond) else ""
+        tagged = ref if ref is not None and ref.tagged else None
+        if tagged is None and e.tagged:
+            tagged = e
+        act = "_ACT" if e.action else ""
+
+        if e.type_def is not None:
+            self.more("\t// %s\n" % e.type_def.name)
+
+        if e.kind == 'REF':
+            if e.action and skippable:
+                fail("action %s on an optional type reference" % e.action)
+            merged = Element('REF')
+            merged.optional = skippable
+            merged.cond = bool(cond)
+            merged.tagged = tagged is not None
+            if tagged is not None:
+                merged.cls, merged.tag = tagged.cls, tagged.tag
+            self.element(e.ref.element, merged)
+            if e.action:
+                self.opcode("ASN1_OP_ACT")
+                self.action(e.action)
+            return
+
+        if e.kind == 'ANY':
+            self.opcode("ASN1_OP_%sMATCH_ANY%s" % (cond, act), e.name)
+            if e.action:
+                self.action(e.action)
+            return
+
+        if e.kind == 'CHOICE':
+            if tagged is not None:
+                fail("IMPLICIT tag on a CHOICE")
+            for c in e.children:
+                self.element(c)
+            if not skippable:
+                self.opcode("ASN1_OP_COND_FAIL")
+            if e.action:
+                self.opcode("ASN1_OP_ACT")
+                self.action(e.action)
+            return
+
+        if e.kind == 'PRIM':
+            self.opcode("ASN1_OP_%sMATCH%s%s" % (cond, act, "_OR_SKIP" if skippable else ""), e.name)
+            self.tag(e, tagged)
+            if e.action:
+                self.action(e.action)
+            return
+
+        # SEQUENCE, SEQUENCE OF, SET OF and explicit tags
+        outofline = skippable or (e.type_def is not None and e.type_def.ref_count > 1)
+        self.opcode("ASN1_OP_%sMATCH%s%s" % (cond, "_JUMP" if outofline else "",
+                                            "_OR_SKIP" if skippable else ""), e.name)
+        self.tag(e, tagged)
+        if outofline:
+            # the target is not known until the out-of-line list is rendered
+            self.opcode("_jump_target(%s)", "--> %s" % e.type_def.name if e.type_def else None)
+            self.lines[-1] = (e, self.lines[-1])
+            if e not in self.render_list:
+                self.render_list.append(e)
+            return
+
+        self.depth += 1
+        entry = self.nr
+        for c in e.children:
+            self.element(c)
+        self.depth -= 1
+        self.end(e, entry)
+
+    def end(self, e, entry):
+        act = "_ACT" if e.action else ""
+        if e.kind == 'SEQ_OF':
+            self.opcode("ASN1_OP_END_SEQ_OF%s" % act)
+            self.opcode("_jump_target(%u)" % entry)
+        elif e.kind == 'SET_OF':
+            self.opcode("ASN1_OP_END_SET_OF%s" % act)
+            self.opcode("_jump_target(%u)" % entry)
+        else:
+            self.opcode("ASN1_OP_END_SEQ%s" % act)
+        if e.action:
+            self.action(e.action)
+
+    def machine(self, root):
+        self.depth = 0
+        self.element(root.element)
+        self.opcode("ASN1_OP_COMPLETE")
+
+        i = 0
+        while i < len(self.render_list):
+            e = self.render_list[i]
+            i += 1
+            self.more("\n")
+            e.entry = self.nr
+            self.depth = 1
+            for c in e.children:
+                self.element(c)
+            self.depth = 0
+            self.end(e, e.entry)
+            self.opcode("ASN1_OP_RETURN")
+
+        if self.nr > MAX_MACHINE:
+            fail("machine is %d bytes, the limit is %d" % (self.nr, MAX_MACHINE))
+
+        # fill in the out-of-line jump targets now their entries are known
+        out = []
+        for line in self.lines:
+            if isinstance(line, tuple):
+                e, text = line
+                line = text % e.entry
+            out.append(line)
+        return "".join(out)
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit("Usage: asn1_compiler.py grammar.asn1 grammar.c grammar.h")
+
+    with open(sys.argv[1]) as f:
+        types = Parser(tokenize(f.read())).grammar()
+    resolve(types)
+
+    grammar = os.path.splitext(os.path.basename(sys.argv[2]))[0]
+    renderer = Renderer()
+    machine = renderer.machine(types[0])
+    actions = sorted(renderer.actions)
+
+    banner = ("/*\n * Automatically generated by ASN1 compiler.  Do not manually edit!\n"
+              " *\n * ASN.1 parser for %s\n */\n\n" % grammar)
+
+    with open(sys.argv[3], 'w') as h:
+        h.write(banner)
+        h.write('#include "asn1_ber_bytecode.h"\n\n')
+        h.write("extern const struct asn1_decoder %s_decoder;\n\n" % grammar)
+        for a in actions:
+            h.write("extern int %s(void *, long, unsigned char, const void *, long);\n" % a)
+        h.write("\n")
+
+    with open(sys.argv[2], 'w') as c:
+        c.write(banner)
+        c.write('#include "asn1_ber_bytecode.h"\n#include "%s.h"\n\n' % grammar)
+        c.write("enum %s_actions {\n" % grammar)
+        for i, a in enumerate(actions):
+            c.write("\tACT_%s = %d,\n" % (a, i))
+        c.write("\tNR__%s_actions = %d\n};\n\n" % (grammar, len(actions)))
+        c.write("static const asn1_action_t %s_action_table[NR__%s_actions] = {\n" % (grammar, grammar))
+        for i, a in enumerate(actions):
+            c.write("\t[%4d] = %s,\n" % (i, a))
+        c.write("};\n\n")
+        c.write("static const unsigned char %s_machine[] = {\n" % grammar)
+        c.write(machine)
+        c.write("};\n\n")
+        c.write("const struct asn1_decoder %s_decoder = {\n" % grammar)
+        c.write("\t.machine = %s_machine,\n" % grammar)
+        c.write("\t.machlen = sizeof(%s_machine),\n" % grammar)
+        c.write("\t.actions = %s_action_table,\n};\n" % grammar)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Actions for the mscode decoder, which pulls the image digest out of
+ *  an Authenticode signature.
+ *
+ */
+
+#include <errno.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+
+#include "mscode.h"
+#include "authenticode.h"
+
+
+/*
+ * Decode the SpcIndirectDataContent signed by a PKCS#7 message
+ */
+int
+authenticode_decode( struct authenticode_content *spc,
+                     const struct pkcs7_message *msg )
+{
+    ZeroMem(spc, sizeof(*spc));
+    spc->data = msg->data;
+    spc->data_type = OID__NR;
+    spc->digest_algo = OID__NR;
+
+    if (msg->content_type != OID_msIndirectData || msg->content.length == 0)
+        return -EBADMSG;
+
+    return asn1_ber_decoder(&mscode_decoder, spc, PKCS7_SLICE_PTR(msg, msg->content),
+                            msg->content.length);
+}
+
+
+int
+do_mscode_data_type( void *context,
+                     long hdrlen,
+                     unsigned char tag,
+                     const void *value,
+                     long vlen )
+{
+    struct authenticode_content *spc = context;
+
+    spc->data_type = Lookup_OID(value, vlen);
+
+    return 0;
+}
+
+
+int
+do_mscode_digest_algo( void *context,
+                       long hdrlen,
+                       unsigned char tag,
+                       const void *value,
+                       long vlen )
+{
+    struct authenticode_content *spc = context;
+
+    spc->digest_algo = Lookup_OID(value, vlen);
+
+    return 0;
+}
+
+
+int
+do_mscode_digest( void *context,
+                  long hdrlen,
+                  unsigned char tag,
+                  const void *value,
+                  long vlen )
+{
+    struct authenticode_content *spc = context;
+
+    spc->digest.offset = (unsigned int)((const unsigned char *)value - spc->data);
+    spc->digest.length = (unsigned int)vlen;
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Authenticode SpcIndirectDataContent, the signed content of a PE image
+ *  signature.  Decoded with the mscode grammar.
+ *
+ */
+
+#ifndef _AUTHENTICODE_H
+#define _AUTHENTICODE_H
+
+#include "pkcs7_msg.h"
+
+struct authenticode_content {
+    const unsigned char *data;
+    enum OID data_type;              /* SpcPeImageData for PE images */
+    enum OID digest_algo;
+    struct x509_slice digest;
+};
+
+extern int authenticode_decode(struct authenticode_content *spc,
+                               const struct pkcs7_message *msg);
+
+#endif /* _AUTHENTICODE_H */
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+#
+#  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+#
+#  Generate a direct-coded decoder from the bytecode machine of an ASN.1
+#  grammar, e.g. x509.c as produced by the kernel ASN.1 compiler.
+#
+#  Every opcode of <grammar>_machine[] becomes a block of C with its tag,
+#  action and jump target as constants.  MATCH_JUMP pushes the number of
+#  the op to resume at, and RETURN switches on it, so the output is plain
+#  C99 with no computed gotos.  The helpers in asn1_ber_direct.h give the
+#  same results as asn1_ber_decoder() for every input.
+#
+#  License: BSD License
+#
+#  Usage: build_asn1_direct.py x509.c > x509_direct.c
+#
+
+import re
+import sys
+
+ELEMENT = re.compile(r'^\s*\[\s*(\d+)\]\s*=\s*(.*?),?\s*(?://\s*(.*))?$')
+TYPE_NAME = re.compile(r'^\s*//\s*(\w+)\s*$')
+MACHINE = re.compile(r'^static const unsigned char (\w+)_machine\[\]')
+
+# operand layout of each op: (tag, jump, action) present
+OPS = {
+    'ASN1_OP_MATCH':                   (1, 0, 0),
+    'ASN1_OP_MATCH_OR_SKIP':           (1, 0, 0),
+    'ASN1_OP_MATCH_ACT':               (1, 0, 1),
+    'ASN1_OP_MATCH_ACT_OR_SKIP':       (1, 0, 1),
+    'ASN1_OP_MATCH_JUMP':              (1, 1, 0),
+    'ASN1_OP_MATCH_JUMP_OR_SKIP':      (1, 1, 0),
+    'ASN1_OP_MATCH_ANY':               (0, 0, 0),
+    'ASN1_OP_MATCH_ANY_ACT':           (0, 0, 1),
+    'ASN1_OP_COND_MATCH_OR_SKIP':      (1, 0, 0),
+    'ASN1_OP_COND_MATCH_ACT_OR_SKIP':  (1, 0, 1),
+    'ASN1_OP_COND_MATCH_JUMP_OR_SKIP': (1, 1, 0),
+    'ASN1_OP_COND_MATCH_ANY':          (0, 0, 0),
+    'ASN1_OP_COND_MATCH_ANY_ACT':      (0, 0, 1),
+    'ASN1_OP_COND_FAIL':               (0, 0, 0),
+    'ASN1_OP_COMPLETE':                (0, 0, 0),
+    'ASN1_OP_ACT':                     (0, 0, 1),
+    'ASN1_OP_RETURN':                  (0, 0, 0),
+    'ASN1_OP_END_SEQ':                 (0, 0, 0),
+    'ASN1_OP_END_SEQ_OF':              (0, 1, 0),
+    'ASN1_OP_END_SET':                 (0, 0, 0),
+    'ASN1_OP_END_SET_OF':              (0, 1, 0),
+    'ASN1_OP_END_SEQ_ACT':             (0, 0, 1),
+    'ASN1_OP_END_SEQ_OF_ACT':          (0, 1, 1),
+    'ASN1_OP_END_SET_ACT':             (0, 0, 1),
+    'ASN1_OP_END_SET_OF_ACT':          (0, 1, 1),
+}
+
+
+def read_machine(path):
+    """Returns the grammar name, the machine cells and the element names"""
+    name, cells, comments = None, {}, {}
+    in_machine = False
+    pending = None
+    with open(path) as f:
+        for line in f:
+            m = MACHINE.match(line)
+            if m:
+                name, in_machine = m.group(1), True
+                continue
+            if not in_machine:
+                continue
+            if line.startswith('};'):
+                break
+            m = TYPE_NAME.match(line)
+            if m:
+                pending = m.group(1)
+                continue
+            m = ELEMENT.match(line)
+            if m:
+                pc = int(m.group(1))
+                cells[pc] = m.group(2).strip()
+                names = [x for x in (pending, m.group(3)) if x]
+                if names:
+                    comments[pc] = " ".join(x.strip() for x in names)
+                pending = None
+    if name is None:
+        sys.exit("build_asn1_direct: no machine found in %s" % path)
+    return name, [cells[i] for i in range(len(cells))], comments
+
+
+def operand(cell, macro):
+    m = re.match(r'^%s\((.*)\)$' % macro, cell)
+    if not m:
+        sys.exit("build_asn1_direct: expected %s(), found %s" % (macro, cell))
+    return m.group(1).strip()
+
+
+def decode(machine):
+    """Split the machine into (pc, op, tag, jump, action, next_pc)"""
+    ops, pc = [], 0
+    while pc < len(machine):
+        op = machine[pc]
+        if op not in OPS:
+            sys.exit("build_asn1_direct: unknown opcode %s at %d" % (op, pc))
+        has_tag, has_jump, has_act = OPS[op]
+        n = pc + 1
+        tag = jump = act = None
+        if has_tag:
+            tag = machine[n]
+            n += 1
+        if has_jump:
+            jump = int(operand(machine[n], '_jump_target'))
+            n += 1
+        if has_act:
+            act = re.sub(r'^ACT_', '', operand(machine[n], '_action'))
+            n += 1
+        ops.append((pc, op, tag, jump, act, n))
+        pc = n
+    return ops
+
+
+def emit(name, ops, comments):
+    starts = set(op[0] for op in ops)
+    labels, returns = set(), []
+    for pc, op, tag, jump, act, nxt in ops:
+        if jump is not None:
+            if jump not in starts:
+                sys.exit("build_asn1_direct: jump from %d into the middle of an op" % pc)
+            labels.add(jump)
+        if 'MATCH_JUMP' in op:
+            returns.append(nxt)
+            labels.add(nxt)
+
+    out = sys.stdout
+    out.write("/*\n * Automatically generated by build_asn1_direct.py.  Do not edit\n"
+              " *\n * Direct-coded ASN.1 decoder for %s\n */\n\n" % name)
+    out.write("#include <errno.h>\n\n#include <Uefi.h>\n#include <Library/UefiLib.h>\n#include <Library/OutputLib.h>\n\n")
+    out.write('#include "asn1_ber_direct.h"\n#include "%s.h"\n\n' % name)
+    out.write("int %s_direct_decoder(void *context,\n\t\t\tconst unsigned char *data,\n"
+              "\t\t\tsize_t datalen)\n{\n" % name)
+    out.write("\tstruct asn1_direct s;\n\tint ret;\n\n\tasn1_direct_init(&s, data, datalen);\n")
+
+    for pc, op, tag, jump, act, nxt in ops:
+        note = ": %s" % comments[pc] if pc in comments else ""
+        out.write("\n")
+        if pc in labels:
+            out.write("op_%d:" % pc)
+        out.write("\t/* [%d] %s%s */\n" % (pc, op, note))
+        has_tag = OPS[op][0]
+        if op.startswith('ASN1_OP_MATCH') or op.startswith('ASN1_OP_COND_MATCH'):
+            out.write("\tret = asn1_direct_match(&s, %s, %s);\n" % (op, tag if has_tag else "0"))
+            out.write("\tif (ret < 0)\n\t\tgoto error;\n")
+            if 'JUMP' in op:
+                out.write("\tif (ret > 0) {\n\t\tif (asn1_direct_push(&s, %d) < 0)\n\t\t\tgoto error;\n"
+                          "\t\tgoto op_%d;\n\t}\n" % (nxt, jump))
+                continue
+            out.write("\tif (ret > 0) {\n")
+            if act:
+                out.write("\t\tret = %s(context, s.hdr, s.tag, data + s.dp, s.len);\n"
+                          "\t\tif (ret < 0)\n\t\t\treturn ret;\n" % act)
+            out.write("\t\tif (asn1_direct_skip(&s) < 0)\n\t\t\tgoto error;\n\t}\n")
+        elif op == 'ASN1_OP_COND_FAIL':
+            out.write("\tif (unlikely(!(s.flags & ASN1_DIRECT_MATCHED))) {\n"
+                      "\t\tasn1_direct_error(&s, L\"Unexpected tag\");\n\t\tgoto error;\n\t}\n")
+        elif op == 'ASN1_OP_COMPLETE':
+            out.write("\tif (unlikely(s.jsp != 0 || s.csp != 0))\n\t\treturn -EBADMSG;\n\treturn 0;\n")
+        elif op == 'ASN1_OP_ACT':
+            out.write("\t%s(context, s.hdr, s.tag, data + s.tdp, s.len);\n" % act)
+        elif op == 'ASN1_OP_RETURN':
+            out.write("\tif (unlikely(s.jsp <= 0)) {\n\t\tasn1_direct_error(&s, L\"Jump stack underflow\");\n"
+                      "\t\tgoto error;\n\t}\n\tswitch (s.jump_stack[--s.jsp]) {\n")
+            for r in sorted(set(returns)):
+                out.write("\tcase %d: goto op_%d;\n" % (r, r))
+            out.write("\t}\n\tgoto error;\n")
+        else:
+            out.write("\tret = asn1_direct_end(&s, %s);\n\tif (ret < 0)\n\t\tgoto error;\n" % op)
+            if jump is not None:
+                out.write("\tif (ret > 0)\n\t\tgoto op_%d;\n" % jump)
+            if act:
+                out.write("\t%s(context, s.hdr, 0, data + s.tdp, s.len);\n" % act)
+
+    out.write("\nerror:\n\tif (asn1_report_errors)\n\t\tOutPrint(L\"ERROR: %s\\n\", s.errmsg);\n\treturn -EBADMSG;\n}\n")
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("Usage: build_asn1_direct.py grammar.c")
+    name, machine, comments = read_machine(sys.argv[1])
+    emit(name, decode(machine), comments)
+
+
+if __name__ == '__main__':
+    main()
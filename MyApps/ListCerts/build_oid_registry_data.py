@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+#
+#  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+#
+#  Generate oid_registry_data.h from the enum OID list in oid_registry.h
+#
+#  Each enum line has the form
+#
+#      OID_name,        /* 1.2.3.4 */
+#  or  OID_name,        /* 1.2.3.4 "Display Name" */
+#
+#  The display name defaults to the enum name without the OID_ prefix.
+#
+#  Lookup_OID() uses a minimal perfect hash: the OID octets are hashed once
+#  to pick a bucket, the bucket's displacement is used as the seed for a
+#  second hash that yields a unique slot in [0, OID__NR).
+#
+#  License: BSD License
+#
+#  Usage: build_oid_registry_data.py oid_registry.h > oid_registry_data.h
+#
+
+import re
+import sys
+
+NR_BUCKETS = 16          # must be a power of two
+MAX_DISPLACEMENT = 0xffff
+
+ENUM_LINE = re.compile(r'^\s*OID_([a-zA-Z0-9_]+),\s*/\*\s*([0-9.]+)\s*(?:"([^"]*)")?\s*\*/')
+
+
+def encode_oid(dotted):
+    """DER encode the contents of an OBJECT IDENTIFIER"""
+    arcs = [int(x) for x in dotted.split('.')]
+    octets = [arcs[0] * 40 + arcs[1]]
+    for arc in arcs[2:]:
+        chunk = [arc & 0x7f]
+        arc >>= 7
+        while arc:
+            chunk.insert(0, 0x80 | (arc & 0x7f))
+            arc >>= 7
+        octets += chunk
+    return octets
+
+
+def oid_hash(octets, seed):
+    """Must match oid_hash() in oid_registry.c"""
+    h = (2166136261 ^ seed) & 0xffffffff
+    for b in octets:
+        h ^= b
+        h = (h * 16777619) & 0xffffffff
+    h ^= h >> 16
+    return h
+
+
+def build_perfect_hash(keys):
+    n = len(keys)
+    buckets = [[] for _ in range(NR_BUCKETS)]
+    for i, key in enumerate(keys):
+        buckets[oid_hash(key, 0) & (NR_BUCKETS - 1)].append(i)
+
+    slots = [None] * n
+    displacement = [0] * NR_BUCKETS
+    # place the largest buckets first while the table is still empty
+    for b in sorted(range(NR_BUCKETS), key=lambda x: -len(buckets[x])):
+        if not buckets[b]:
+            continue
+        for d in range(1, MAX_DISPLACEMENT + 1):
+            wanted = [oid_hash(keys[i], d) % n for i in buckets[b]]
+            if len(set(wanted)) == len(wanted) and all(slots[s] is None for s in wanted):
+                for s, i in zip(wanted, buckets[b]):
+                    slots[s] = i
+                displacement[b] = d
+                break
+        else:
+            sys.exit("build_oid_registry_data: no perfect hash found")
+    return displacement, slots
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("Usage: build_oid_registry_data.py oid_registry.h")
+
+    names, oids, labels = [], [], []
+    in_enum = False
+    with open(sys.argv[1]) as f:
+        for line in f:
+            if line.startswith('enum OID {'):
+                in_enum = True
+                continue
+            if in_enum and line.startswith('};'):
+                break
+            m = ENUM_LINE.match(line) if in_enum else None
+            if m:
+                names.append(m.group(1))
+                oids.append(encode_oid(m.group(2)))
+                labels.append(m.group(3) if m.group(3) is not None else m.group(1))
+
+    displacement, slots = build_perfect_hash(oids)
+
+    out = sys.stdout
+    out.write("/*\n * Automatically generated by build_oid_registry_data.py.  Do not edit\n */\n\n")
+
+    out.write("static const unsigned short oid_index[OID__NR + 1] = {\n")
+    offset = 0
+    for name, octets in zip(names, oids):
+        out.write("\t[OID_%s] = %d,\n" % (name, offset))
+        offset += len(octets)
+    out.write("\t[OID__NR] = %d\n};\n\n" % offset)
+
+    out.write("static const unsigned char oid_data[%d] = {\n" % offset)
+    for name, octets in zip(names, oids):
+        out.write("\t%s, \t// %s\n" % (", ".join(str(b) for b in octets), name))
+    out.write("};\n\n")
+
+    out.write("#define OID_NR_BUCKETS %d\n\n" % NR_BUCKETS)
+    out.write("static const unsigned short oid_displacement[OID_NR_BUCKETS] = {\n")
+    for b, d in enumerate(displacement):
+        out.write("\t[%3d] = %5d,\n" % (b, d))
+    out.write("};\n\n")
+
+    out.write("static const unsigned char oid_slot[OID__NR] = {\n")
+    for s, i in enumerate(slots):
+        out.write("\t[%3d] = OID_%-35s // %s\n" % (s, names[i] + ",", "".join("%02x" % b for b in oids[i])))
+    out.write("};\n\n")
+
+    out.write("static const CHAR16 * const oid_names[OID__NR] = {\n")
+    for name, label in zip(names, labels):
+        out.write("\t[OID_%s] = L\"%s\",\n" % (name, label))
+    out.write("};\n")
+
+
+if __name__ == '__main__':
+    main()
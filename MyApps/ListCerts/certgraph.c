@@ -0,0 +1,205 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Issuer graph.  Certificates are indexed by the hash of their subject
+//  Name and of their subjectKeyIdentifier, so finding the issuer of each
+//  certificate is one hash chain walk instead of a comparison against
+//  every other certificate.  The authority key identifier is tried first
+//  since it tells a re-keyed CA from its predecessor; the issuer Name is
+//  the fallback.  Names are compared by their DER encoding, as firmware
+//  does.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+#include "certgraph.h"
+
+#define CERT_GRAPH_INITIAL  64
+
+
+static UINTN
+HashDigest( CONST UINT8 *Digest )
+{
+    UINTN Hash;
+
+    CopyMem(&Hash, Digest, sizeof(Hash));
+    return Hash;
+}
+
+
+EFI_STATUS
+CertGraphAdd( CERT_GRAPH *Graph,
+              struct x509_certificate *Cert,
+              UINTN Variable )
+{
+    CERT_NODE *Node;
+    UINTN Capacity;
+
+    if (Graph->Count == Graph->Capacity) {
+        Capacity = (Graph->Capacity == 0) ? CERT_GRAPH_INITIAL : Graph->Capacity * 2;
+        Node = ReallocatePool(Graph->Capacity * sizeof(CERT_NODE), Capacity * sizeof(CERT_NODE), Graph->Nodes);
+        if (Node == NULL)
+            return EFI_OUT_OF_RESOURCES;
+        Graph->Nodes = Node;
+        Graph->Capacity = Capacity;
+    }
+
+    Node = &Graph->Nodes[Graph->Count++];
+    ZeroMem(Node, sizeof(*Node));
+    Sha256(X509_SLICE_PTR(Cert, Cert->subject.raw), Cert->subject.raw.length, Node->Subject);
+    Sha256(X509_SLICE_PTR(Cert, Cert->issuer.raw), Cert->issuer.raw.length, Node->Issuer);
+    if (Cert->skid.length > 0) {
+        Sha256(X509_SLICE_PTR(Cert, Cert->skid), Cert->skid.length, Node->KeyId);
+        Node->HasKeyId = TRUE;
+    }
+    if (Cert->akid.length > 0) {
+        Sha256(X509_SLICE_PTR(Cert, Cert->akid), Cert->akid.length, Node->AuthKeyId);
+        Node->HasAuthKeyId = TRUE;
+    }
+    Node->Variable = Variable;
+    Node->Data = Cert->data;
+    Node->Size = Cert->length;
+    Node->Parent = CERT_GRAPH_NONE;
+    Node->FirstChild = CERT_GRAPH_NONE;
+    Node->NextSibling = CERT_GRAPH_NONE;
+
+    return EFI_SUCCESS;
+}
+
+
+//
+//  Could Issuer have issued Node?  Key identifiers, when both are present,
+//  have to agree as well as the names.
+//
+static BOOLEAN
+IsIssuer( CONST CERT_NODE *Node,
+          CONST CERT_NODE *Issuer )
+{
+    if (CompareMem(Node->Issuer, Issuer->Subject, SHA256_DIGEST_SIZE) != 0)
+        return FALSE;
+    if (Node->HasAuthKeyId && Issuer->HasKeyId &&
+        CompareMem(Node->AuthKeyId, Issuer->KeyId, SHA256_DIGEST_SIZE) != 0)
+        return FALSE;
+
+    return TRUE;
+}
+
+
+//
+//  Issuer of node i among the other certificates.  Of several copies of
+//  the issuer the one in the lowest numbered database is taken, so a db
+//  certificate hangs off the KEK copy of its CA rather than a db copy.
+//
+static UINTN
+FindIssuer( CERT_GRAPH *Graph,
+            UINTN i )
+{
+    CERT_NODE *Node = &Graph->Nodes[i];
+    UINTN Mask = Graph->Buckets - 1;
+    UINTN Best = CERT_GRAPH_NONE;
+    UINTN j;
+
+    if (Node->HasAuthKeyId) {
+        for (j = Graph->ByKeyId[HashDigest(Node->AuthKeyId) & Mask];
+             j != CERT_GRAPH_NONE; j = Graph->Nodes[j].NextKeyId) {
+            Graph->Probes++;
+            if (j != i && CompareMem(Node->AuthKeyId, Graph->Nodes[j].KeyId, SHA256_DIGEST_SIZE) == 0 &&
+                (Best == CERT_GRAPH_NONE || Graph->Nodes[j].Variable < Graph->Nodes[Best].Variable))
+                Best = j;
+        }
+        if (Best != CERT_GRAPH_NONE)
+            return Best;
+    }
+
+    for (j = Graph->BySubject[HashDigest(Node->Issuer) & Mask];
+         j != CERT_GRAPH_NONE; j = Graph->Nodes[j].NextSubject) {
+        Graph->Probes++;
+        if (j != i && IsIssuer(Node, &Graph->Nodes[j]) &&
+            (Best == CERT_GRAPH_NONE || Graph->Nodes[j].Variable < Graph->Nodes[Best].Variable))
+            Best = j;
+    }
+
+    return Best;
+}
+
+
+//
+//  Build both indexes and link every certificate to its issuer
+//
+EFI_STATUS
+CertGraphResolve( CERT_GRAPH *Graph )
+{
+    CERT_NODE *Node;
+    UINTN Mask, i, j;
+
+    if (Graph->BySubject != NULL)
+        FreePool(Graph->BySubject);
+    if (Graph->ByKeyId != NULL)
+        FreePool(Graph->ByKeyId);
+
+    for (Graph->Buckets = 16; Graph->Buckets < Graph->Count * 2; Graph->Buckets *= 2)
+        ;
+    Graph->BySubject = AllocatePool(Graph->Buckets * sizeof(UINTN));
+    Graph->ByKeyId = AllocatePool(Graph->Buckets * sizeof(UINTN));
+    if (Graph->BySubject == NULL || Graph->ByKeyId == NULL)
+        return EFI_OUT_OF_RESOURCES;
+    SetMem(Graph->BySubject, Graph->Buckets * sizeof(UINTN), 0xff);
+    SetMem(Graph->ByKeyId, Graph->Buckets * sizeof(UINTN), 0xff);
+
+    Mask = Graph->Buckets - 1;
+    for (i = 0; i < Graph->Count; i++) {
+        Node = &Graph->Nodes[i];
+        Node->NextSubject = Graph->BySubject[HashDigest(Node->Subject) & Mask];
+        Graph->BySubject[HashDigest(Node->Subject) & Mask] = i;
+        Node->NextKeyId = CERT_GRAPH_NONE;
+        if (Node->HasKeyId) {
+            Node->NextKeyId = Graph->ByKeyId[HashDigest(Node->KeyId) & Mask];
+            Graph->ByKeyId[HashDigest(Node->KeyId) & Mask] = i;
+        }
+    }
+
+    Graph->Edges = Graph->Roots = Graph->Orphans = 0;
+    for (i = 0; i < Graph->Count; i++) {
+        Node = &Graph->Nodes[i];
+        Node->FirstChild = Node->NextSibling = CERT_GRAPH_NONE;
+        if (IsIssuer(Node, Node)) {
+            Node->Parent = i;
+            Graph->Roots++;
+        } else {
+            Node->Parent = FindIssuer(Graph, i);
+            if (Node->Parent == CERT_GRAPH_NONE)
+                Graph->Orphans++;
+            else
+                Graph->Edges++;
+        }
+    }
+
+    // children in the order they were added
+    for (i = Graph->Count; i-- > 0; ) {
+        j = Graph->Nodes[i].Parent;
+        if (j != CERT_GRAPH_NONE && j != i) {
+            Graph->Nodes[i].NextSibling = Graph->Nodes[j].FirstChild;
+            Graph->Nodes[j].FirstChild = i;
+        }
+    }
+
+    return EFI_SUCCESS;
+}
+
+
+VOID
+CertGraphFree( CERT_GRAPH *Graph )
+{
+    if (Graph->Nodes != NULL)
+        FreePool(Graph->Nodes);
+    if (Graph->BySubject != NULL)
+        FreePool(Graph->BySubject);
+    if (Graph->ByKeyId != NULL)
+        FreePool(Graph->ByKeyId);
+    ZeroMem(Graph, sizeof(*Graph));
+}
@@ -0,0 +1,54 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Issuer graph of the certificates in the signature databases: each
+//  certificate is linked to the certificate that issued it, found by
+//  authority key identifier or issuer name
+//
+//  License: BSD License
+//
+
+#ifndef _CERTGRAPH_H
+#define _CERTGRAPH_H
+
+#include "sha256.h"
+#include "x509_cert.h"
+
+#define CERT_GRAPH_NONE  MAX_UINTN
+
+typedef struct {
+    UINT8   Subject[SHA256_DIGEST_SIZE];     // hash of the subject Name
+    UINT8   Issuer[SHA256_DIGEST_SIZE];      // hash of the issuer Name
+    UINT8   KeyId[SHA256_DIGEST_SIZE];       // hash of the subjectKeyIdentifier
+    UINT8   AuthKeyId[SHA256_DIGEST_SIZE];   // hash of the authorityKeyIdentifier
+    BOOLEAN HasKeyId;
+    BOOLEAN HasAuthKeyId;
+    BOOLEAN Visited;             // free for the caller's report pass
+    UINTN   Variable;            // caller's index of the database
+    CONST UINT8 *Data;           // DER certificate, must outlive the graph
+    UINTN   Size;
+    UINTN   Parent;              // issuer, itself if self-signed, or CERT_GRAPH_NONE
+    UINTN   FirstChild;
+    UINTN   NextSibling;
+    UINTN   NextSubject;         // hash chains of the two indexes
+    UINTN   NextKeyId;
+} CERT_NODE;
+
+typedef struct {
+    CERT_NODE *Nodes;
+    UINTN     Count;
+    UINTN     Capacity;
+    UINTN     *BySubject;        // chain heads, Buckets of each
+    UINTN     *ByKeyId;
+    UINTN     Buckets;           // power of two
+    UINTN     Edges;             // certificates whose issuer was found
+    UINTN     Roots;             // self-signed certificates
+    UINTN     Orphans;           // issuer not in the graph
+    UINTN     Probes;            // chain entries looked at, for --stats
+} CERT_GRAPH;
+
+EFI_STATUS CertGraphAdd(CERT_GRAPH *Graph, struct x509_certificate *Cert, UINTN Variable);
+EFI_STATUS CertGraphResolve(CERT_GRAPH *Graph);
+VOID       CertGraphFree(CERT_GRAPH *Graph);
+
+#endif /* _CERTGRAPH_H */
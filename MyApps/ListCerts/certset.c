@@ -0,0 +1,139 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Set of certificates keyed by SHA-256 fingerprint.  Open addressing
+//  with linear probing: the digest is already uniformly distributed, so
+//  its first bytes are used as the hash.  The table doubles when it is
+//  three quarters full.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+#include "certset.h"
+
+#define CERT_SET_INITIAL  256
+
+
+static UINTN
+HashDigest( CONST UINT8 *Digest )
+{
+    UINTN Hash;
+
+    CopyMem(&Hash, Digest, sizeof(Hash));
+    return Hash;
+}
+
+
+//
+//  Slot holding Digest, or the empty slot where it would go
+//
+static CERT_ENTRY *
+FindSlot( CERT_SET *Set,
+          CONST UINT8 *Digest )
+{
+    UINTN Mask = Set->Capacity - 1;
+    UINTN i = HashDigest(Digest) & Mask;
+    CERT_ENTRY *Entry;
+
+    for (;;) {
+        Entry = &Set->Slots[i];
+        Set->Probes++;
+        if (Entry->Copies == 0 || CompareMem(Entry->Digest, Digest, SHA256_DIGEST_SIZE) == 0)
+            return Entry;
+        i = (i + 1) & Mask;
+    }
+}
+
+
+static EFI_STATUS
+Grow( CERT_SET *Set )
+{
+    CERT_ENTRY *Old = Set->Slots;
+    UINTN OldCapacity = Set->Capacity;
+    UINTN i;
+
+    Set->Capacity = (OldCapacity == 0) ? CERT_SET_INITIAL : OldCapacity * 2;
+    Set->Slots = AllocateZeroPool(Set->Capacity * sizeof(CERT_ENTRY));
+    if (Set->Slots == NULL) {
+        Set->Slots = Old;
+        Set->Capacity = OldCapacity;
+        return EFI_OUT_OF_RESOURCES;
+    }
+
+    for (i = 0; i < OldCapacity; i++) {
+        if (Old[i].Copies != 0)
+            *FindSlot(Set, Old[i].Digest) = Old[i];
+    }
+    if (Old != NULL)
+        FreePool(Old);
+
+    return EFI_SUCCESS;
+}
+
+
+//
+//  Record one copy of a certificate found in Variable.  Size is what the
+//  copy takes in the signature list.
+//
+EFI_STATUS
+CertSetAdd( CERT_SET *Set,
+            CONST UINT8 *Digest,
+            UINTN Size,
+            UINTN Variable )
+{
+    CERT_ENTRY *Entry;
+    EFI_STATUS Status;
+
+    if (Variable >= CERT_SET_MAX_VARIABLES)
+        return EFI_INVALID_PARAMETER;
+
+    if ((Set->Count + 1) * 4 > Set->Capacity * 3) {
+        Status = Grow(Set);
+        if (EFI_ERROR(Status))
+            return Status;
+    }
+
+    Entry = FindSlot(Set, Digest);
+    if (Entry->Copies == 0) {
+        CopyMem(Entry->Digest, Digest, SHA256_DIGEST_SIZE);
+        Entry->Size = (UINT32)Size;
+        Set->Count++;
+    } else {
+        Entry->Wasted += (UINT32)Size;
+        Set->Duplicates++;
+        Set->Wasted += Size;
+    }
+    Entry->Copies++;
+    if (Entry->Counts[Variable] < 0xff)
+        Entry->Counts[Variable]++;
+
+    return EFI_SUCCESS;
+}
+
+
+CERT_ENTRY *
+CertSetFind( CERT_SET *Set,
+             CONST UINT8 *Digest )
+{
+    CERT_ENTRY *Entry;
+
+    if (Set->Capacity == 0)
+        return NULL;
+
+    Entry = FindSlot(Set, Digest);
+    return (Entry->Copies != 0) ? Entry : NULL;
+}
+
+
+VOID
+CertSetFree( CERT_SET *Set )
+{
+    if (Set->Slots != NULL)
+        FreePool(Set->Slots);
+    ZeroMem(Set, sizeof(*Set));
+}
@@ -0,0 +1,39 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Set of certificates keyed by SHA-256 fingerprint, for finding copies
+//  of the same certificate within and across signature databases
+//
+//  License: BSD License
+//
+
+#ifndef _CERTSET_H
+#define _CERTSET_H
+
+#include "sha256.h"
+
+#define CERT_SET_MAX_VARIABLES  16
+
+typedef struct {
+    UINT8   Digest[SHA256_DIGEST_SIZE];
+    UINT32  Size;                // signature entry bytes of the first copy
+    UINT32  Wasted;              // signature entry bytes of the other copies
+    UINT16  Copies;              // 0 for an empty slot
+    UINT8   Counts[CERT_SET_MAX_VARIABLES];   // copies per variable
+    BOOLEAN Reported;            // free for the caller's report pass
+} CERT_ENTRY;
+
+typedef struct {
+    CERT_ENTRY *Slots;
+    UINTN      Capacity;         // power of two
+    UINTN      Count;            // distinct certificates
+    UINTN      Duplicates;       // copies beyond the first
+    UINTN      Wasted;           // bytes taken by those copies
+    UINTN      Probes;           // slots looked at, for --stats
+} CERT_SET;
+
+EFI_STATUS  CertSetAdd(CERT_SET *Set, CONST UINT8 *Digest, UINTN Size, UINTN Variable);
+CERT_ENTRY *CertSetFind(CERT_SET *Set, CONST UINT8 *Digest);
+VOID        CertSetFree(CERT_SET *Set);
+
+#endif /* _CERTSET_H */
@@ -0,0 +1,54 @@
+/*
+ * Automatically generated by ASN1 compiler.  Do not manually edit!
+ *
+ * ASN.1 parser for ecparams
+ */
+
+#include "asn1_ber_bytecode.h"
+#include "ecparams.h"
+
+enum ecparams_actions {
+	ACT_do_ec_named_curve = 0,
+	ACT_do_ec_order = 1,
+	NR__ecparams_actions = 2
+};
+
+static const asn1_action_t ecparams_action_table[NR__ecparams_actions] = {
+	[   0] = do_ec_named_curve,
+	[   1] = do_ec_order,
+};
+
+static const unsigned char ecparams_machine[] = {
+	// ECParameters
+	[   0] = ASN1_OP_MATCH_ACT_OR_SKIP,		// namedCurve
+	[   1] = _tag(UNIV, PRIM, OID),
+	[   2] = _action(ACT_do_ec_named_curve),
+	[   3] = ASN1_OP_COND_MATCH_OR_SKIP,		// implicitCurve
+	[   4] = _tag(UNIV, PRIM, NULL),
+	// SpecifiedECDomain
+	[   5] = ASN1_OP_COND_MATCH_JUMP_OR_SKIP,
+	[   6] = _tag(UNIV, CONS, SEQ),
+	[   7] = _jump_target(10),		// --> SpecifiedECDomain
+	[   8] = ASN1_OP_COND_FAIL,
+	[   9] = ASN1_OP_COMPLETE,
+
+	[  10] =  ASN1_OP_MATCH,		// version
+	[  11] =  _tag(UNIV, PRIM, INT),
+	[  12] =  ASN1_OP_MATCH_ANY,		// fieldID
+	[  13] =  ASN1_OP_MATCH_ANY,		// curve
+	[  14] =  ASN1_OP_MATCH,		// base
+	[  15] =  _tag(UNIV, PRIM, OTS),
+	[  16] =  ASN1_OP_MATCH_ACT,		// order
+	[  17] =  _tag(UNIV, PRIM, INT),
+	[  18] =  _action(ACT_do_ec_order),
+	[  19] =  ASN1_OP_MATCH_OR_SKIP,		// cofactor
+	[  20] =  _tag(UNIV, PRIM, INT),
+	[  21] = ASN1_OP_END_SEQ,
+	[  22] = ASN1_OP_RETURN,
+};
+
+const struct asn1_decoder ecparams_decoder = {
+	.machine = ecparams_machine,
+	.machlen = sizeof(ecparams_machine),
+	.actions = ecparams_action_table,
+};
@@ -0,0 +1,13 @@
+/*
+ * Automatically generated by ASN1 compiler.  Do not manually edit!
+ *
+ * ASN.1 parser for ecparams
+ */
+
+#include "asn1_ber_bytecode.h"
+
+extern const struct asn1_decoder ecparams_decoder;
+
+extern int do_ec_named_curve(void *, long, unsigned char, const void *, long);
+extern int do_ec_order(void *, long, unsigned char, const void *, long);
+
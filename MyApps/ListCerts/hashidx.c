@@ -0,0 +1,139 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Sorted index of signature database hash entries.  Entries are appended
+//  while the signature lists are walked, then sorted and de-duplicated once
+//  so each membership query is a binary search.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SortLib.h>
+
+#include "hashidx.h"
+
+#define HASH_INDEX_INITIAL  512
+
+
+//
+//  Order by digest size, then by digest bytes
+//
+static INTN
+CompareDigest( CONST UINT8 *Digest1,
+               UINTN Size1,
+               CONST UINT8 *Digest2,
+               UINTN Size2 )
+{
+    if (Size1 != Size2)
+        return (Size1 < Size2) ? -1 : 1;
+
+    return CompareMem(Digest1, Digest2, Size1);
+}
+
+
+static INTN
+EFIAPI
+CompareEntry( CONST VOID *Buffer1,
+              CONST VOID *Buffer2 )
+{
+    CONST HASH_ENTRY *Entry1 = Buffer1;
+    CONST HASH_ENTRY *Entry2 = Buffer2;
+
+    return CompareDigest(Entry1->Digest, Entry1->Size, Entry2->Digest, Entry2->Size);
+}
+
+
+EFI_STATUS
+HashIndexAdd( HASH_INDEX *Index,
+              CONST UINT8 *Digest,
+              UINTN Size,
+              UINT8 Type,
+              UINT16 Variables )
+{
+    HASH_ENTRY *Entry;
+    UINTN NewCapacity;
+
+    if (Size == 0 || Size > HASH_MAX_DIGEST)
+        return EFI_INVALID_PARAMETER;
+
+    if (Index->Count == Index->Capacity) {
+        NewCapacity = (Index->Capacity == 0) ? HASH_INDEX_INITIAL : Index->Capacity * 2;
+        Entry = ReallocatePool(Index->Capacity * sizeof(HASH_ENTRY),
+                               NewCapacity * sizeof(HASH_ENTRY),
+                               Index->Entries);
+        if (Entry == NULL)
+            return EFI_OUT_OF_RESOURCES;
+        Index->Entries = Entry;
+        Index->Capacity = NewCapacity;
+    }
+
+    Entry = &Index->Entries[Index->Count++];
+    ZeroMem(Entry, sizeof(*Entry));
+    CopyMem(Entry->Digest, Digest, Size);
+    Entry->Size = (UINT8)Size;
+    Entry->Type = Type;
+    Entry->Variables = Variables;
+
+    return EFI_SUCCESS;
+}
+
+
+//
+//  Sort, then fold identical digests into one entry
+//
+VOID
+HashIndexSort( HASH_INDEX *Index )
+{
+    UINTN i, j;
+
+    if (Index->Count < 2)
+        return;
+
+    PerformQuickSort(Index->Entries, Index->Count, sizeof(HASH_ENTRY), CompareEntry);
+
+    for (i = 0, j = 1; j < Index->Count; j++) {
+        if (CompareEntry(&Index->Entries[i], &Index->Entries[j]) == 0) {
+            Index->Entries[i].Variables |= Index->Entries[j].Variables;
+            Index->Duplicates++;
+        } else if (++i != j) {
+            Index->Entries[i] = Index->Entries[j];
+        }
+    }
+    Index->Count = i + 1;
+}
+
+
+HASH_ENTRY *
+HashIndexFind( HASH_INDEX *Index,
+               CONST UINT8 *Digest,
+               UINTN Size )
+{
+    UINTN Low = 0, High = Index->Count, Mid;
+    INTN  Order;
+
+    while (Low < High) {
+        Mid = Low + (High - Low) / 2;
+        Order = CompareDigest(Index->Entries[Mid].Digest, Index->Entries[Mid].Size, Digest, Size);
+        if (Order == 0)
+            return &Index->Entries[Mid];
+        if (Order < 0)
+            Low = Mid + 1;
+        else
+            High = Mid;
+    }
+
+    return NULL;
+}
+
+
+VOID
+HashIndexFree( HASH_INDEX *Index )
+{
+    if (Index->Entries != NULL)
+        FreePool(Index->Entries);
+    ZeroMem(Index, sizeof(*Index));
+}
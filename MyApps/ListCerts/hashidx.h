@@ -0,0 +1,33 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Sorted index of signature database hash entries
+//
+//  License: BSD License
+//
+
+#ifndef _HASHIDX_H
+#define _HASHIDX_H
+
+#define HASH_MAX_DIGEST  64
+
+typedef struct {
+    UINT8  Digest[HASH_MAX_DIGEST];
+    UINT8  Size;
+    UINT8  Type;             // index into the caller's signature type table
+    UINT16 Variables;        // bitmask of variables holding this digest
+} HASH_ENTRY;
+
+typedef struct {
+    HASH_ENTRY *Entries;
+    UINTN      Count;
+    UINTN      Capacity;
+    UINTN      Duplicates;   // entries merged by HashIndexSort
+} HASH_INDEX;
+
+EFI_STATUS  HashIndexAdd(HASH_INDEX *Index, CONST UINT8 *Digest, UINTN Size, UINT8 Type, UINT16 Variables);
+VOID        HashIndexSort(HASH_INDEX *Index);
+HASH_ENTRY *HashIndexFind(HASH_INDEX *Index, CONST UINT8 *Digest, UINTN Size);
+VOID        HashIndexFree(HASH_INDEX *Index);
+
+#endif /* _HASHIDX_H */
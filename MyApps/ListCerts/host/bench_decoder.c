@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Compare the direct-coded x509 decoder against the bytecode interpreter.
+ *  Every X509 entry of the given .esl/.auth files is decoded by both; the
+ *  results must be identical.  Each decoder is then timed over the set
+ *  and its throughput reported in certificates and megabytes per second.
+ *  With -s the lazy decoder is checked and timed too, for the fields
+ *  given in --select syntax.
+ *
+ *  License: BSD License
+ *
+ *  Usage: bench_decoder [-n iterations] [-s fields] file...
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Uefi.h>
+
+#include "x509_cert.h"
+#include "query.h"
+#include "esl.h"
+
+#define MAX_CERTS  1024
+
+struct cert_set {
+    const unsigned char *data[MAX_CERTS];
+    size_t size[MAX_CERTS];
+    size_t count;
+    size_t bytes;                   /* DER bytes in the set */
+};
+
+typedef int (*decoder_fn)(struct x509_certificate *, const unsigned char *, size_t);
+
+/* fields for the lazy decoder, 0 to skip it */
+static unsigned int lazy_fields;
+
+
+static int
+collect_certificate( const struct esl_entry *entry,
+                     void *context )
+{
+    struct cert_set *set = context;
+
+    if (entry->type != ESL_TYPE_X509 || set->count >= MAX_CERTS)
+        return 0;
+
+    set->data[set->count] = entry->data;
+    set->size[set->count] = entry->size;
+    set->bytes += entry->size;
+    set->count++;
+
+    return 0;
+}
+
+
+static double
+now( void )
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static int
+decode_lazy( struct x509_certificate *cert,
+             const unsigned char *data,
+             size_t len )
+{
+    return x509_decode_fields(cert, data, len, lazy_fields);
+}
+
+
+static int
+same_slice( const struct x509_slice *a,
+            const struct x509_slice *b )
+{
+    return a->offset == b->offset && a->length == b->length;
+}
+
+
+static int
+same_name( const struct x509_certificate *a,
+           const struct x509_name *na,
+           const struct x509_certificate *b,
+           const struct x509_name *nb )
+{
+    int i;
+
+    if (!same_slice(&na->raw, &nb->raw) || na->hdrlen != nb->hdrlen || na->count != nb->count)
+        return 0;
+    for (i = 0; i < na->count; i++) {
+        if (memcmp(&a->attrs[na->first + i], &b->attrs[nb->first + i], sizeof(a->attrs[0])) != 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+
+/*
+ * Every field the lazy decoder was asked for must equal the full decode
+ */
+static int
+same_fields( const struct x509_certificate *full,
+             const struct x509_certificate *lazy,
+             unsigned int fields )
+{
+    if (full->length != lazy->length)
+        return 0;
+    if ((fields & X509_VERSION) && !same_slice(&full->version, &lazy->version))
+        return 0;
+    if ((fields & X509_SERIAL) && !same_slice(&full->serial, &lazy->serial))
+        return 0;
+    if ((fields & X509_SIG_ALGO) && memcmp(&full->sig_algo, &lazy->sig_algo, sizeof(full->sig_algo)) != 0)
+        return 0;
+    if ((fields & X509_ISSUER) && !same_name(full, &full->issuer, lazy, &lazy->issuer))
+        return 0;
+    if ((fields & (X509_NOT_BEFORE | X509_NOT_AFTER)) &&
+        (!same_slice(&full->not_before, &lazy->not_before) || full->not_before_tag != lazy->not_before_tag ||
+         !same_slice(&full->not_after, &lazy->not_after) || full->not_after_tag != lazy->not_after_tag ||
+         full->valid_from != lazy->valid_from || full->valid_to != lazy->valid_to))
+        return 0;
+    if ((fields & X509_SUBJECT) && !same_name(full, &full->subject, lazy, &lazy->subject))
+        return 0;
+    if ((fields & (X509_KEY_ALGO | X509_PUBLIC_KEY)) &&
+        (memcmp(&full->pub_key_algo, &lazy->pub_key_algo, sizeof(full->pub_key_algo)) != 0 ||
+         !same_slice(&full->pub_key_info, &lazy->pub_key_info) || !same_slice(&full->pub_key, &lazy->pub_key)))
+        return 0;
+    if ((fields & X509_EXTENSIONS) &&
+        (full->nr_extensions != lazy->nr_extensions ||
+         memcmp(full->extensions, lazy->extensions, full->nr_extensions * sizeof(full->extensions[0])) != 0 ||
+         !same_slice(&full->skid, &lazy->skid) || !same_slice(&full->akid, &lazy->akid)))
+        return 0;
+
+    return 1;
+}
+
+
+static double
+time_decoder( decoder_fn decode,
+              const struct cert_set *set,
+              long iterations,
+              struct x509_certificate *cert )
+{
+    double start = now();
+    long n;
+    size_t i;
+
+    for (n = 0; n < iterations; n++) {
+        for (i = 0; i < set->count; i++)
+            decode(cert, set->data[i], set->size[i]);
+    }
+
+    return now() - start;
+}
+
+
+int
+main( int argc,
+      char *argv[] )
+{
+    static struct cert_set set;
+    static struct x509_certificate direct, interpreted, lazy;
+    static struct x509_query query;
+    double t_direct, t_interpreted, t_lazy, total, megabytes;
+    unsigned char *data;
+    size_t len, offset, i;
+    long iterations = 10000;
+    int first = 1, mismatches = 0, rd, ri;
+
+    x509_query_init(&query);
+    for (; first + 1 < argc; first += 2) {
+        if (!strcmp(argv[first], "-n")) {
+            iterations = atol(argv[first + 1]);
+        } else if (!strcmp(argv[first], "-s")) {
+            if (x509_query_select(&query, argv[first + 1]) < 0) {
+                fprintf(stderr, "ERROR: Invalid field list [%s]\n", argv[first + 1]);
+                return 1;
+            }
+            lazy_fields = query.decode;
+        } else {
+            break;
+        }
+    }
+    if (first >= argc || iterations <= 0) {
+        fprintf(stderr, "Usage: bench_decoder [-n iterations] [-s fields] file...\n");
+        return 1;
+    }
+
+    for (; first < argc; first++) {
+        data = load_file(argv[first], &len);        /* kept until exit */
+        if (data == NULL)
+            return 1;
+        offset = signature_list_offset(data, len);
+        if (walk_signature_lists(data + offset, len - offset, collect_certificate, &set) < 0)
+            return 1;
+    }
+    if (set.count == 0) {
+        fprintf(stderr, "ERROR: No X509 certificates found\n");
+        return 1;
+    }
+
+    for (i = 0; i < set.count; i++) {
+        rd = x509_decode(&direct, set.data[i], set.size[i]);
+        ri = x509_decode_interpreted(&interpreted, set.data[i], set.size[i]);
+        if (rd != ri || memcmp(&direct, &interpreted, sizeof(direct)) != 0) {
+            fprintf(stderr, "MISMATCH: certificate %zu (direct %d, interpreted %d)\n", i, rd, ri);
+            mismatches++;
+        }
+        if (lazy_fields != 0 &&
+            (decode_lazy(&lazy, set.data[i], set.size[i]) != rd || !same_fields(&direct, &lazy, lazy_fields))) {
+            fprintf(stderr, "MISMATCH: certificate %zu (lazy decode)\n", i);
+            mismatches++;
+        }
+    }
+    if (mismatches > 0)
+        return 1;
+
+    t_interpreted = time_decoder(x509_decode_interpreted, &set, iterations, &interpreted);
+    t_direct = time_decoder(x509_decode, &set, iterations, &direct);
+    total = (double)set.count * iterations;
+    megabytes = (double)set.bytes * iterations / 1e6;
+
+    printf("%zu certificates (%zu bytes), %ld iterations, results identical\n",
+           set.count, set.bytes, iterations);
+    printf("  interpreted: %10.0f certs/sec %8.1f MB/s\n", total / t_interpreted, megabytes / t_interpreted);
+    printf("  direct:      %10.0f certs/sec %8.1f MB/s\n", total / t_direct, megabytes / t_direct);
+    printf("  speedup:     %10.2fx\n", t_interpreted / t_direct);
+    if (lazy_fields != 0) {
+        t_lazy = time_decoder(decode_lazy, &set, iterations, &lazy);
+        printf("  lazy:        %10.0f certs/sec %8.1f MB/s (%.2fx direct)\n",
+               total / t_lazy, megabytes / t_lazy, t_direct / t_lazy);
+    }
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Reading EFI signature lists and authenticated variable payloads on
+ *  the host
+ *
+ *  License: BSD License
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esl.h"
+
+#define WIN_CERT_TYPE_EFI_GUID   0x0EF1
+#define EFI_TIME_SIZE            16
+#define SIGNATURE_LIST_SIZE      28      /* GUID + three UINT32 sizes */
+
+const struct esl_type esl_types[] = {
+    { "a5c059a1-94e4-4aa7-87b5-ab155c2bf072", "X509",         0 },
+    { "4aafd29d-68df-49ee-8aa9-347d375665a7", "PKCS7",        0 },
+    { "3c5766e8-269c-4e34-aa14-ed776e85b3b6", "RSA2048",      0 },
+    { "826ca512-cf10-4ac9-b187-be01496631bd", "SHA1",        20 },
+    { "0b6e5233-a65c-44c9-9407-d9ab83bfc8bd", "SHA224",      28 },
+    { "c1c41626-504c-4092-aca9-41f936934328", "SHA256",      32 },
+    { "ff3e5307-9fd0-48c9-85f1-8ad56c701e01", "SHA384",      48 },
+    { "093e0fae-a6c4-4f50-9f1b-d41e2b89c19a", "SHA512",      64 },
+    { "3bd2a492-96c0-4079-b420-fcf98ef103ed", "X509_SHA256", 32 },
+    { "7076876e-80c2-4ee6-aad2-28b349a6865b", "X509_SHA384", 48 },
+    { "446dbf63-2502-4cda-bcfa-2465d2b0fe9d", "X509_SHA512", 64 },
+};
+
+const size_t esl_nr_types = sizeof(esl_types) / sizeof(esl_types[0]);
+
+
+static uint32_t
+get32( const unsigned char *p )
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+void
+format_guid( const unsigned char *g,
+             char *buf )
+{
+    sprintf(buf, "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+            get32(g), g[4] | (g[5] << 8), g[6] | (g[7] << 8),
+            g[8], g[9], g[10], g[11], g[12], g[13], g[14], g[15]);
+}
+
+
+static size_t
+lookup_type( const unsigned char *g )
+{
+    char guid[40];
+    size_t i;
+
+    format_guid(g, guid);
+    for (i = 0; i < esl_nr_types; i++) {
+        if (!strcmp(guid, esl_types[i].guid))
+            return i;
+    }
+
+    return esl_nr_types;
+}
+
+
+/*
+ * Read a whole file; the caller frees the buffer
+ */
+unsigned char *
+load_file( const char *name,
+           size_t *len )
+{
+    unsigned char *data;
+    long size;
+    FILE *f;
+
+    f = fopen(name, "rb");
+    if (f == NULL) {
+        perror(name);
+        return NULL;
+    }
+    if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0) {
+        perror(name);
+        fclose(f);
+        return NULL;
+    }
+
+    *len = (size_t)size;
+    data = malloc(*len ? *len : 1);
+    if (data == NULL || fread(data, 1, *len, f) != *len) {
+        fprintf(stderr, "ERROR: Failed to read %s\n", name);
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+
+    return data;
+}
+
+
+/*
+ * Skip an EFI_VARIABLE_AUTHENTICATION_2 header: EFI_TIME, then a
+ * WIN_CERTIFICATE_UEFI_GUID whose dwLength covers the PKCS#7 data
+ */
+size_t
+signature_list_offset( const unsigned char *data,
+                       size_t len )
+{
+    size_t offset;
+
+    if (len < EFI_TIME_SIZE + 8 + ESL_GUID_SIZE)
+        return 0;
+    if ((data[EFI_TIME_SIZE + 6] | (data[EFI_TIME_SIZE + 7] << 8)) != WIN_CERT_TYPE_EFI_GUID ||
+        lookup_type(data + EFI_TIME_SIZE + 8) != ESL_TYPE_PKCS7)
+        return 0;
+
+    offset = EFI_TIME_SIZE + (size_t)get32(data + EFI_TIME_SIZE);
+
+    return (offset <= len) ? offset : 0;
+}
+
+
+/*
+ * Call visitor for every entry of every list.  Returns -1 if a list header
+ * is malformed, otherwise the first non-zero visitor result or 0.
+ */
+int
+walk_signature_lists( const unsigned char *data,
+                      size_t len,
+                      esl_visitor visitor,
+                      void *context )
+{
+    struct esl_entry entry;
+    size_t offset = 0, list_size, header_size, sig_size, count, i;
+    const unsigned char *sig;
+    int ret;
+
+    while (len - offset >= SIGNATURE_LIST_SIZE) {
+        list_size = get32(data + offset + 16);
+        header_size = get32(data + offset + 20);
+        sig_size = get32(data + offset + 24);
+        if (list_size > len - offset || sig_size <= ESL_GUID_SIZE ||
+            list_size < SIGNATURE_LIST_SIZE + header_size) {
+            fprintf(stderr, "ERROR: Malformed signature list at offset %zu\n", offset);
+            return -1;
+        }
+
+        entry.type = lookup_type(data + offset);
+        entry.size = sig_size - ESL_GUID_SIZE;
+        count = (list_size - SIGNATURE_LIST_SIZE - header_size) / sig_size;
+        sig = data + offset + SIGNATURE_LIST_SIZE + header_size;
+
+        for (i = 0; i < count; i++, sig += sig_size) {
+            entry.owner = sig;
+            entry.data = sig + ESL_GUID_SIZE;
+            ret = visitor(&entry, context);
+            if (ret != 0)
+                return ret;
+        }
+        offset += list_size;
+    }
+
+    return 0;
+}
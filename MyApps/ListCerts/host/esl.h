@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Reading EFI signature lists and authenticated variable payloads on
+ *  the host
+ *
+ *  License: BSD License
+ *
+ */
+
+#ifndef _ESL_H
+#define _ESL_H
+
+#include <stddef.h>
+
+#define ESL_GUID_SIZE    16
+#define ESL_TYPE_X509    0
+#define ESL_TYPE_PKCS7   1
+
+struct esl_type {
+    const char *guid;
+    const char *name;
+    size_t digest_size;             /* non-zero for hash types */
+};
+
+extern const struct esl_type esl_types[];
+extern const size_t esl_nr_types;   /* also the index of an unknown type */
+
+struct esl_entry {
+    size_t type;                    /* index into esl_types[] */
+    const unsigned char *owner;     /* SignatureOwner GUID */
+    const unsigned char *data;
+    size_t size;
+};
+
+typedef int (*esl_visitor)(const struct esl_entry *entry, void *context);
+
+void format_guid(const unsigned char *guid, char *buf);
+unsigned char *load_file(const char *name, size_t *len);
+size_t signature_list_offset(const unsigned char *data, size_t len);
+int walk_signature_lists(const unsigned char *data, size_t len,
+                         esl_visitor visitor, void *context);
+
+#endif /* _ESL_H */
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Fuzz entry point for the decoders.  Each input is handed to the x509
+ *  decoders, the PKCS#7 and Authenticode decoders and the signature list
+ *  walker, so one corpus of certificates, signed messages and .esl/.auth
+ *  files exercises all of them.  The direct-coded and interpreted x509
+ *  decoders must agree on every input; any difference aborts.
+ *
+ *  Built with -DLIBFUZZER and -fsanitize=fuzzer this is a libFuzzer
+ *  target.  Otherwise main() runs each file named on the command line
+ *  through it once, which is what AFL (with @@) and corpus replay need.
+ *
+ *  License: BSD License
+ *
+ *  Usage: fuzz_decoder file...
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <Uefi.h>
+
+#include "x509_cert.h"
+#include "pkcs7_msg.h"
+#include "authenticode.h"
+#include "public_key.h"
+#include "query.h"
+#include "esl.h"
+
+/* one condition per query, so every match routine runs on every input */
+static const char *conditions[] = {
+    "version=3",
+    "serial=01",
+    "sigAlg=sha256WithRSAEncryption",
+    "issuer~microsoft",
+    "notBefore>=2010-01-01",
+    "notAfter<2030-01-01",
+    "subject~uefi",
+    "keyAlg=rsaEncryption",
+    "publicKey>=2048",
+    "extensions~basicConstraints",
+};
+
+#define NR_QUERIES  (sizeof(conditions) / sizeof(conditions[0]))
+
+static struct x509_query queries[NR_QUERIES];
+static size_t nr_queries;
+
+
+static void
+init_queries( void )
+{
+    size_t i;
+
+    for (i = 0; i < NR_QUERIES; i++) {
+        x509_query_init(&queries[nr_queries]);
+        if (x509_query_where(&queries[nr_queries], conditions[i]) == 0)
+            nr_queries++;
+    }
+}
+
+
+/*
+ * Everything downstream of a successful decode reads the slices it
+ * produced, so run the consumers too
+ */
+static void
+use_certificate( const struct x509_certificate *cert )
+{
+    struct x509_public_key key;
+    size_t i;
+
+    x509_public_key(cert, &key);
+    for (i = 0; i < nr_queries; i++)
+        x509_query_match(&queries[i], cert);
+}
+
+
+static void
+fuzz_certificate( const unsigned char *data,
+                  size_t size )
+{
+    static struct x509_certificate direct, interpreted, lazy;
+    unsigned int fields;
+    int rd, ri;
+
+    rd = x509_decode(&direct, data, size);
+    ri = x509_decode_interpreted(&interpreted, data, size);
+    if (rd != ri || memcmp(&direct, &interpreted, sizeof(direct)) != 0) {
+        fprintf(stderr, "MISMATCH: direct %d, interpreted %d\n", rd, ri);
+        abort();
+    }
+    if (rd == 0)
+        use_certificate(&direct);
+
+    /* a field set that varies from input to input but is fixed for each */
+    fields = (unsigned int)(size * 2654435761u >> 7) & X509_ALL_FIELDS;
+    if (x509_decode_fields(&lazy, data, size, fields) == 0)
+        use_certificate(&lazy);
+}
+
+
+static void
+fuzz_pkcs7( const unsigned char *data,
+            size_t size )
+{
+    static struct pkcs7_message msg;
+    static struct x509_certificate cert;
+    struct authenticode_content spc;
+    int i;
+
+    if (pkcs7_decode(&msg, data, size) < 0)
+        return;
+
+    authenticode_decode(&spc, &msg);
+    for (i = 0; i < msg.nr_signers; i++) {
+        if (pkcs7_signer_certificate(&msg, i, &cert) == 0)
+            use_certificate(&cert);
+    }
+    for (i = 0; i < msg.nr_certs; i++)
+        fuzz_certificate(PKCS7_SLICE_PTR(&msg, msg.certs[i]), msg.certs[i].length);
+}
+
+
+static int
+fuzz_entry( const struct esl_entry *entry,
+            void *context )
+{
+    if (entry->type == ESL_TYPE_X509)
+        fuzz_certificate(entry->data, entry->size);
+    else if (entry->type == ESL_TYPE_PKCS7)
+        fuzz_pkcs7(entry->data, entry->size);
+
+    return 0;
+}
+
+
+int
+LLVMFuzzerTestOneInput( const uint8_t *data,
+                        size_t size )
+{
+    size_t offset;
+
+    if (nr_queries == 0)
+        init_queries();
+
+    fuzz_certificate(data, size);
+    fuzz_pkcs7(data, size);
+
+    offset = signature_list_offset(data, size);
+    walk_signature_lists(data + offset, size - offset, fuzz_entry, NULL);
+
+    return 0;
+}
+
+
+#ifndef LIBFUZZER
+int
+main( int argc,
+      char *argv[] )
+{
+    unsigned char *data;
+    size_t len;
+    int i;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: fuzz_decoder file...\n");
+        return 1;
+    }
+
+    for (i = 1; i < argc; i++) {
+        data = load_file(argv[i], &len);
+        if (data == NULL)
+            return 1;
+        LLVMFuzzerTestOneInput(data, len);
+        free(data);
+    }
+    printf("%d inputs\n", argc - 1);
+
+    return 0;
+}
+#endif
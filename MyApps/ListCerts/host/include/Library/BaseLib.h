@@ -0,0 +1,6 @@
+#ifndef _HOST_BASE_LIB_H
+#define _HOST_BASE_LIB_H
+
+UINTN StrLen(CONST CHAR16 *String);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef _HOST_BASE_MEMORY_LIB_H
+#define _HOST_BASE_MEMORY_LIB_H
+
+#include <string.h>
+
+#define ZeroMem(b, n)        memset((b), 0, (n))
+#define SetMem(b, n, v)      memset((b), (v), (n))
+#define CopyMem(d, s, n)     memmove((d), (s), (n))
+#define CompareMem(a, b, n)  memcmp((a), (b), (n))
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef _HOST_PRINT_LIB_H
+#define _HOST_PRINT_LIB_H
+
+UINTN UnicodeSPrint(CHAR16 *Buffer, UINTN BufferSize, CONST CHAR16 *Format, ...);
+UINTN UnicodeVSPrint(CHAR16 *Buffer, UINTN BufferSize, CONST CHAR16 *Format, VA_LIST Marker);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef _HOST_UEFI_LIB_H
+#define _HOST_UEFI_LIB_H
+
+/* decoder output goes through OutputLib, see ../../Include */
+
+#endif
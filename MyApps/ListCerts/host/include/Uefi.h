@@ -0,0 +1,46 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Minimal UEFI definitions for building the certificate decoder on a
+ *  POSIX host.  Only what the decoder sources use is provided.  CHAR16
+ *  string literals need -fshort-wchar.
+ *
+ */
+
+#ifndef _HOST_UEFI_H
+#define _HOST_UEFI_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+typedef uint8_t   UINT8;
+typedef uint16_t  UINT16;
+typedef uint32_t  UINT32;
+typedef uint64_t  UINT64;
+typedef int8_t    INT8;
+typedef int16_t   INT16;
+typedef int32_t   INT32;
+typedef int64_t   INT64;
+typedef size_t    UINTN;
+typedef ptrdiff_t INTN;
+typedef char      CHAR8;
+typedef uint16_t  CHAR16;
+typedef uint8_t   BOOLEAN;
+typedef void      VOID;
+typedef UINTN     EFI_STATUS;
+
+#define CONST     const
+#define EFIAPI
+#define TRUE      ((BOOLEAN)1)
+#define FALSE     ((BOOLEAN)0)
+
+#define VA_LIST           va_list
+#define VA_START(m, a)    va_start(m, a)
+#define VA_END(m)         va_end(m)
+
+#define MIN(a, b)         (((a) < (b)) ? (a) : (b))
+#define MAX(a, b)         (((a) > (b)) ? (a) : (b))
+#define ARRAY_SIZE(a)     (sizeof(a) / sizeof((a)[0]))
+
+#endif /* _HOST_UEFI_H */
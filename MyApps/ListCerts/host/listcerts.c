@@ -0,0 +1,498 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Host build of ListCerts.  Decodes EFI signature lists (.esl) and
+ *  authenticated variable payloads (.auth) captured from a platform,
+ *  using the same decoder sources as the UEFI utility.
+ *
+ *  License: BSD License
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+
+#include "x509_cert.h"
+#include "pkcs7_msg.h"
+#include "public_key.h"
+#include "query.h"
+#include "sha256.h"
+#include "esl.h"
+
+#define UTILITY_VERSION "20180226"
+
+/* fields to show and certificates to show, from --select and --where */
+static struct x509_query query;
+
+/* --expiring: report instead of listing */
+static int expiring;
+static UINT64 now, limit;
+
+
+static void
+print_wide( const CHAR16 *s )
+{
+    for (; *s; s++)
+        putchar(*s < 0x80 ? (int)*s : '?');
+}
+
+
+static void
+print_oid( const struct x509_certificate *cert,
+           const struct x509_slice *id )
+{
+    CHAR16 buffer[100];
+
+    Sprint_OID(X509_SLICE_PTR(cert, *id), id->length, buffer, sizeof(buffer));
+    printf(" (");
+    print_wide(buffer);
+    printf(")");
+}
+
+
+static void
+print_algorithm( const char *label,
+                 const struct x509_certificate *cert,
+                 const struct x509_algorithm *algo )
+{
+    const CHAR16 *name = OID_Name(algo->oid);
+
+    printf("  %s: ", label);
+    if (name != NULL)
+        print_wide(name);
+    else
+        print_oid(cert, &algo->id);
+    printf("\n");
+}
+
+
+static void
+print_name( const char *label,
+            const struct x509_certificate *cert,
+            const struct x509_name *name )
+{
+    const struct x509_attribute *attr = &cert->attrs[name->first];
+    const CHAR16 *type;
+    int i;
+
+    printf("  %s:", label);
+    for (i = 0; i < name->count; i++, attr++) {
+        type = OID_Name(attr->type);
+        if (type != NULL) {
+            printf(" ");
+            print_wide(type);
+            printf("=");
+        } else {
+            print_oid(cert, &attr->id);
+        }
+        fwrite(X509_SLICE_PTR(cert, attr->value), 1, attr->value.length, stdout);
+    }
+    printf("\n");
+}
+
+
+static void
+print_time( UINT64 time )
+{
+    if (time == 0)
+        printf("invalid");
+    else
+        printf("%04u-%02u-%02u %02u:%02u:%02u UTC", X509_TIME_YEAR(time), X509_TIME_MONTH(time),
+               X509_TIME_DAY(time), X509_TIME_HOUR(time), X509_TIME_MINUTE(time),
+               X509_TIME_SECOND(time));
+}
+
+
+static void
+print_public_key( const struct x509_certificate *cert )
+{
+    struct x509_public_key key;
+    const CHAR16 *curve;
+
+    if (x509_public_key(cert, &key) < 0 || key.bits == 0)
+        return;
+
+    if (key.algo == OID_rsaEncryption) {
+        printf("  Public Key: RSA %u bit", key.bits);
+        if (key.exponent != 0)
+            printf(", exponent %lu", key.exponent);
+    } else {
+        printf("  Public Key: EC");
+        curve = OID_Name(key.curve);
+        if (curve != NULL) {
+            printf(" ");
+            print_wide(curve);
+        }
+        printf(", %u bit", key.bits);
+    }
+    printf("\n");
+}
+
+
+static void
+print_certificate( const struct x509_certificate *cert,
+                   unsigned int fields )
+{
+    unsigned char digest[SHA256_DIGEST_SIZE];
+    const unsigned char *p;
+    const CHAR16 *name;
+    unsigned int i;
+
+    if ((fields & X509_VERSION) && cert->version.length > 0)
+        printf("  Version: %d (0x%02x)\n", *X509_SLICE_PTR(cert, cert->version) + 1,
+               *X509_SLICE_PTR(cert, cert->version));
+
+    if (fields & X509_SERIAL) {
+        printf("  Serial Number: ");
+        p = X509_SLICE_PTR(cert, cert->serial);
+        for (i = 0; i < cert->serial.length; i++)
+            printf("%02x%c", p[i], (i + 1 == cert->serial.length) ? ' ' : ':');
+        printf("\n");
+    }
+
+    if (fields & X509_SIG_ALGO)
+        print_algorithm("Signature Algorithm", cert, &cert->sig_algo);
+    if (fields & X509_ISSUER)
+        print_name("Issuer", cert, &cert->issuer);
+    if (fields & (X509_NOT_BEFORE | X509_NOT_AFTER)) {
+        printf("  Validity: ");
+        if (fields & X509_NOT_BEFORE) {
+            printf(" Not Before: ");
+            print_time(cert->valid_from);
+            if (fields & X509_NOT_AFTER)
+                printf("  ");
+        }
+        if (fields & X509_NOT_AFTER) {
+            printf(" Not After: ");
+            print_time(cert->valid_to);
+        }
+        printf("\n");
+    }
+    if (fields & X509_SUBJECT)
+        print_name("Subject", cert, &cert->subject);
+
+    if (fields & X509_FINGERPRINT) {
+        Sha256(cert->data, cert->length, digest);
+        printf("  SHA256 Fingerprint: ");
+        for (i = 0; i < SHA256_DIGEST_SIZE; i++)
+            printf("%02x%c", digest[i], (i + 1 == SHA256_DIGEST_SIZE) ? ' ' : ':');
+        printf("\n");
+    }
+
+    if (fields & X509_KEY_ALGO)
+        print_algorithm("Subject Public Key Algorithm", cert, &cert->pub_key_algo);
+    if (fields & X509_PUBLIC_KEY)
+        print_public_key(cert);
+
+    if ((fields & X509_EXTENSIONS) && cert->nr_extensions > 0) {
+        printf("  Extensions:");
+        for (i = 0; i < cert->nr_extensions; i++) {
+            name = OID_Name(cert->extensions[i].oid);
+            if (name != NULL) {
+                printf(" ");
+                print_wide(name);
+            } else {
+                print_oid(cert, &cert->extensions[i].id);
+            }
+        }
+        printf("\n");
+    }
+}
+
+
+struct list_context {
+    struct x509_certificate cert;
+    struct pkcs7_message msg;
+    const char *name;
+    size_t certs;
+    size_t matched;             /* entries shown when --where is given */
+    size_t checked;             /* certificates looked at by --expiring */
+    size_t expiring;
+    size_t hashes;
+    int errors;
+};
+
+
+static void
+report_expiry( struct list_context *ctx )
+{
+    const struct x509_certificate *cert = &ctx->cert;
+    long long days;
+
+    ctx->checked++;
+    if (cert->valid_to >= limit)
+        return;
+
+    ctx->expiring++;
+    printf("\n");
+    print_name(ctx->name, cert, &cert->subject);
+    printf("    Not After: ");
+    print_time(cert->valid_to);
+    if (cert->valid_to != 0) {
+        days = x509_time_days(cert->valid_to) - x509_time_days(now);
+        if (cert->valid_to < now)
+            printf("  EXPIRED %lld days ago", -days);
+        else
+            printf("  expires in %lld days", days);
+    }
+    printf("\n");
+}
+
+
+static int
+expiry_signature( const struct esl_entry *entry,
+                  void *context )
+{
+    struct list_context *ctx = context;
+    const struct pkcs7_message *msg = &ctx->msg;
+    int i;
+
+    if (entry->type == ESL_TYPE_X509) {
+        if (x509_decode_fields(&ctx->cert, entry->data, entry->size, X509_SUBJECT | X509_NOT_AFTER) == 0)
+            report_expiry(ctx);
+        else
+            ctx->errors++;
+    } else if (entry->type == ESL_TYPE_PKCS7) {
+        if (pkcs7_decode(&ctx->msg, entry->data, entry->size) < 0) {
+            ctx->errors++;
+            return 0;
+        }
+        for (i = 0; i < msg->nr_certs; i++) {
+            if (x509_decode_fields(&ctx->cert, PKCS7_SLICE_PTR(msg, msg->certs[i]), msg->certs[i].length,
+                                   X509_SUBJECT | X509_NOT_AFTER) == 0)
+                report_expiry(ctx);
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+ * With --where a PKCS7 entry is shown only if one of its certificates
+ * matches
+ */
+static int
+pkcs7_matches( struct list_context *ctx )
+{
+    const struct pkcs7_message *msg = &ctx->msg;
+    int i;
+
+    for (i = 0; query.nr_conditions > 0 && i < msg->nr_certs; i++) {
+        if (x509_decode_fields(&ctx->cert, PKCS7_SLICE_PTR(msg, msg->certs[i]), msg->certs[i].length,
+                               query.decode) == 0 &&
+            x509_query_match(&query, &ctx->cert))
+            return 1;
+    }
+
+    return query.nr_conditions == 0;
+}
+
+
+static void
+print_pkcs7( struct list_context *ctx )
+{
+    const struct pkcs7_message *msg = &ctx->msg;
+    const CHAR16 *name;
+    int i, n;
+
+    printf("  Content Type: ");
+    name = OID_Name(msg->content_type);
+    print_wide(name != NULL ? name : L"unknown");
+    printf("\n  Signers: %d   Certificates: %d%s\n", msg->nr_signers, msg->nr_certs,
+           msg->truncated ? " (truncated)" : "");
+
+    for (i = 0; i < msg->nr_signers; i++) {
+        printf("  Signer %d: ", i + 1);
+        name = OID_Name(msg->signers[i].digest_algo.oid);
+        print_wide(name != NULL ? name : L"unknown");
+        printf(" with ");
+        name = OID_Name(msg->signers[i].sig_algo.oid);
+        print_wide(name != NULL ? name : L"unknown");
+        n = pkcs7_signer_certificate(msg, i, &ctx->cert);
+        if (n >= 0)
+            printf(", certificate %d", n + 1);
+        printf("\n");
+    }
+
+    for (i = 0; i < msg->nr_certs; i++) {
+        printf("\n  Certificate %d:\n", i + 1);
+        if (x509_decode_fields(&ctx->cert, PKCS7_SLICE_PTR(msg, msg->certs[i]), msg->certs[i].length,
+                               query.decode) == 0)
+            print_certificate(&ctx->cert, query.select);
+        else
+            ctx->errors++;
+    }
+}
+
+
+static int
+list_signature( const struct esl_entry *entry,
+                void *context )
+{
+    struct list_context *ctx = context;
+    char owner[40];
+    int status = 0;
+
+    if (entry->type != esl_nr_types && esl_types[entry->type].digest_size != 0) {
+        ctx->hashes++;
+        return 0;
+    }
+
+    ctx->certs++;
+    if (entry->type == ESL_TYPE_PKCS7) {
+        status = pkcs7_decode(&ctx->msg, entry->data, entry->size);
+        if (status == 0 && !pkcs7_matches(ctx))
+            return 0;
+    } else if (entry->type == ESL_TYPE_X509) {
+        /* only the fields the query needs are decoded */
+        status = x509_decode_fields(&ctx->cert, entry->data, entry->size, query.decode);
+        if (status == 0 && !x509_query_match(&query, &ctx->cert))
+            return 0;
+    } else if (query.nr_conditions > 0) {
+        return 0;
+    }
+
+    ctx->matched++;
+    format_guid(entry->owner, owner);
+    printf("\nType: %s  (GUID: %s)\n",
+           entry->type == esl_nr_types ? "Unknown" : esl_types[entry->type].name, owner);
+    if (status < 0)
+        ctx->errors++;
+    else if (entry->type == ESL_TYPE_PKCS7)
+        print_pkcs7(ctx);
+    else if (entry->type == ESL_TYPE_X509)
+        print_certificate(&ctx->cert, query.select);
+
+    return 0;
+}
+
+
+static int
+list_file( const char *name )
+{
+    struct list_context *ctx;
+    unsigned char *data;
+    size_t len, offset;
+    int errors;
+
+    data = load_file(name, &len);
+    if (data == NULL)
+        return 1;
+
+    ctx = calloc(1, sizeof(*ctx));
+    if (ctx == NULL) {
+        fprintf(stderr, "ERROR: Out of memory\n");
+        free(data);
+        return 1;
+    }
+
+    ctx->name = name;
+    offset = signature_list_offset(data, len);
+    if (expiring) {
+        if (walk_signature_lists(data + offset, len - offset, expiry_signature, ctx) < 0)
+            ctx->errors++;
+        printf("\n%s: %zu of %zu certificates expiring\n", name, ctx->expiring, ctx->checked);
+        goto done;
+    }
+
+    printf("\nFILE: %s  (size: %zu)\n", name, len);
+    if (offset > 0)
+        printf("  Authentication header: %zu bytes skipped\n", offset);
+    if (walk_signature_lists(data + offset, len - offset, list_signature, ctx) < 0)
+        ctx->errors++;
+
+    if (ctx->certs == 0)
+        printf("\nNo certificates found\n");
+    else if (query.nr_conditions > 0)
+        printf("\n%zu of %zu certificate entries match\n", ctx->matched, ctx->certs);
+    if (ctx->hashes > 0)
+        printf("\n%zu hash entries\n", ctx->hashes);
+
+done:
+    errors = ctx->errors;
+    free(ctx);
+    free(data);
+
+    return errors;
+}
+
+
+static void
+usage( void )
+{
+    printf("Usage: listcerts [--select fields] [--where condition]... file...\n");
+    printf("       listcerts --expiring days file...\n");
+    printf("       listcerts [-V | --version]\n");
+}
+
+
+int
+main( int argc,
+      char **argv )
+{
+    int i, status, files = 0, errors = 0;
+    long days = 0;
+    struct tm tm;
+    time_t t;
+
+    x509_query_init(&query);
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            usage();
+            return 0;
+        } else if (!strcmp(argv[i], "-V") || !strcmp(argv[i], "--version")) {
+            printf("Version: %s\n", UTILITY_VERSION);
+            return 0;
+        } else if ((!strcmp(argv[i], "--select") || !strcmp(argv[i], "--where")) && i + 1 < argc) {
+            if (!strcmp(argv[i], "--select"))
+                status = x509_query_select(&query, argv[i + 1]);
+            else
+                status = x509_query_where(&query, argv[i + 1]);
+            if (status < 0) {
+                fprintf(stderr, "ERROR: Invalid %s [%s]\n", argv[i], argv[i + 1]);
+                return 2;
+            }
+            argv[i] = argv[i + 1] = NULL;
+            i++;
+        } else if (!strcmp(argv[i], "--expiring") && i + 1 < argc) {
+            if (strspn(argv[i + 1], "0123456789") != strlen(argv[i + 1]) || argv[i + 1][0] == '\0') {
+                fprintf(stderr, "ERROR: Invalid number of days [%s]\n", argv[i + 1]);
+                return 2;
+            }
+            expiring = 1;
+            days = atol(argv[i + 1]);
+            argv[i] = argv[i + 1] = NULL;
+            i++;
+        } else {
+            files++;
+        }
+    }
+    if (files == 0) {
+        usage();
+        return 2;
+    }
+
+    if (expiring) {
+        t = time(NULL);
+        gmtime_r(&t, &tm);
+        now = X509_TIME(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min,
+                        tm.tm_sec > 59 ? 59 : tm.tm_sec);
+        limit = x509_time_add(now, (INT64)days * 86400);
+        printf("Certificates expiring before ");
+        print_time(limit);
+        printf(" (%ld days)\n", days);
+    }
+
+    for (i = 1; i < argc; i++) {
+        if (argv[i] != NULL)
+            errors += list_file(argv[i]);
+    }
+
+    return errors ? 1 : 0;
+}
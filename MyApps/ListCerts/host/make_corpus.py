@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+#
+#  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+#
+#  Build a fuzzing corpus from signature databases.  Each source may be an
+#  .esl file, an .auth file, a variable under /sys/firmware/efi/efivars
+#  (the 4-byte attributes are skipped) or a DER certificate.  Every X509
+#  and PKCS7 entry is written to the corpus directory on its own, and
+#  each signature list as a whole, named by SHA-256 so repeated runs and
+#  overlapping sources add nothing twice.  A handful of hand-built
+#  malformed certificates is always added, so the length and tag checks
+#  are reached even without a signature database to start from.
+#
+#  License: BSD License
+#
+#  Usage: make_corpus.py corpus-dir [source...]
+#
+
+import hashlib
+import os
+import struct
+import sys
+
+EFI_TIME_SIZE = 16
+WIN_CERT_TYPE_EFI_GUID = 0x0ef1
+SIGNATURE_LIST_SIZE = 28
+
+# EFI_CERT_X509_GUID and EFI_CERT_TYPE_PKCS7_GUID, in GUID byte order
+CERT_X509 = bytes.fromhex('a159c0a5e494a74a87b5ab155c2bf072')
+CERT_PKCS7 = bytes.fromhex('9dd2af4adf68ee498aa9347d375665a7')
+
+SHA256_WITH_RSA = bytes.fromhex('2a864886f70d01010b')
+
+
+def signature_lists(data):
+    """Skip the EFI_VARIABLE_AUTHENTICATION_2 header of an .auth file"""
+    if (len(data) >= EFI_TIME_SIZE + 8 + 16 and
+            struct.unpack_from('<H', data, EFI_TIME_SIZE + 6)[0] == WIN_CERT_TYPE_EFI_GUID and
+            data[EFI_TIME_SIZE + 8:EFI_TIME_SIZE + 24] == CERT_PKCS7):
+        offset = EFI_TIME_SIZE + struct.unpack_from('<I', data, EFI_TIME_SIZE)[0]
+        if offset <= len(data):
+            return data[offset:]
+    return data
+
+
+def entries(data):
+    """Yield each signature list, then each X509 or PKCS7 entry in it"""
+    offset = 0
+    while len(data) - offset >= SIGNATURE_LIST_SIZE:
+        list_size, header_size, sig_size = struct.unpack_from('<III', data, offset + 16)
+        if (list_size > len(data) - offset or sig_size <= 16 or
+                list_size < SIGNATURE_LIST_SIZE + header_size):
+            return
+        sig_type = data[offset:offset + 16]
+        yield 'esl', data[offset:offset + list_size]
+        if sig_type in (CERT_X509, CERT_PKCS7):
+            suffix = 'der' if sig_type == CERT_X509 else 'p7'
+            sig = offset + SIGNATURE_LIST_SIZE + header_size
+            while sig + sig_size <= offset + list_size:
+                yield suffix, data[sig + 16:sig + sig_size]
+                sig += sig_size
+        offset += list_size
+
+
+def der(tag, content):
+    """A definite length element"""
+    n = len(content)
+    if n < 0x80:
+        length = bytes([n])
+    else:
+        length = n.to_bytes((n.bit_length() + 7) // 8, 'big')
+        length = bytes([0x80 | len(length)]) + length
+    return bytes([tag]) + length + content
+
+
+def certificate(params):
+    """The start of a certificate with the given signature algorithm
+    parameters, which the decoders match as ANY; the data ends there"""
+    tbs = (der(0xa0, der(0x02, b'\x02')) + der(0x02, b'\x01') +
+           der(0x30, der(0x06, SHA256_WITH_RSA) + params))
+    return der(0x30, der(0x30, tbs))
+
+
+def malformed():
+    """Indefinite length constructed elements holding an element whose
+    length runs past the end of the data, and tags with long base-128
+    tag numbers, both where the certificate starts and inside it"""
+    inner = [
+        b'\x04\x7e' + b'A' * 4,                     # short form
+        b'\x04\x7f' + b'A' * 4,                     # 0x7f is short form too
+        b'\x04\x84\x00\x01\x00\x00' + b'A' * 4,     # long form
+        b'\x04\x87' + b'\xff' * 7,                  # long form, wraps the offset
+        b'\x24\x80\x04\x7e' + b'A' * 4,             # nested indefinite length
+        b'\x04\x02AA' + b'\x04\x10' + b'A' * 4,      # after a good element
+    ]
+    for body in inner:
+        yield certificate(b'\x30\x80' + body)
+        yield certificate(b'\x30\x80' + body + b'\x00\x00')
+        yield b'\x30\x80' + body
+
+    for n in (4, 5, 16, 255, 300):
+        tag = b'\x1f' + b'\x81' * (n - 1) + b'\x01'
+        yield certificate(tag + b'\x00')
+        yield certificate(b'\x30\x80' + tag + b'\x00\x00\x00')
+        yield b'\x3f' + tag[1:] + b'\x02\x00\x00'
+        yield der(0x30, tag + b'\x00')
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.stderr.write('Usage: make_corpus.py corpus-dir [source...]\n')
+        return 1
+
+    corpus = sys.argv[1]
+    os.makedirs(corpus, exist_ok=True)
+    found = [('der', blob) for blob in malformed()]
+    added = 0
+    for name in sys.argv[2:]:
+        with open(name, 'rb') as f:
+            data = f.read()
+        if '/efivars/' in os.path.abspath(name):
+            data = data[4:]
+        blobs = list(entries(signature_lists(data)))
+        if not blobs and data[:1] == b'\x30':
+            blobs = [('der', data)]
+        found += blobs
+
+    for suffix, blob in found:
+        path = os.path.join(corpus, '%s.%s' % (hashlib.sha256(blob).hexdigest()[:16], suffix))
+        if not os.path.exists(path):
+            with open(path, 'wb') as f:
+                f.write(blob)
+            added += 1
+
+    print('%d files added to %s' % (added, corpus))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
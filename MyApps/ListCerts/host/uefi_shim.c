@@ -0,0 +1,173 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Host implementations of the few UEFI library routines the decoder
+ *  calls.  Format strings follow PrintLib: %s is a CHAR16 string, %a an
+ *  ASCII string, and the l flag means a 64-bit argument.
+ *
+ */
+
+#include <stdio.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+
+
+UINTN
+StrLen( CONST CHAR16 *String )
+{
+    UINTN n = 0;
+
+    while (String[n] != 0)
+        n++;
+
+    return n;
+}
+
+
+/*
+ * Format into an ASCII buffer; characters outside ASCII become '?'
+ */
+static UINTN
+host_vformat( char *out,
+              size_t size,
+              CONST CHAR16 *fmt,
+              va_list ap )
+{
+    char spec[16], arg[256], str[256];
+    size_t pos = 0, n, i;
+    int is_long;
+    CONST CHAR16 *s;
+
+    if (size == 0)
+        return 0;
+
+    while (*fmt && pos < size - 1) {
+        if (*fmt != L'%') {
+            out[pos++] = (*fmt < 0x80) ? (char)*fmt : '?';
+            fmt++;
+            continue;
+        }
+
+        /* copy flags and width into a printf spec */
+        n = 0;
+        spec[n++] = *fmt++;
+        while ((*fmt == L'-' || *fmt == L'0' || (*fmt >= L'1' && *fmt <= L'9')) && n < sizeof(spec) - 4)
+            spec[n++] = (char)*fmt++;
+        is_long = (*fmt == L'l' || *fmt == L'L');
+        if (is_long)
+            fmt++;
+
+        switch (*fmt) {
+        case L'd':
+        case L'u':
+        case L'x':
+        case L'X':
+            if (is_long)
+                spec[n++] = 'l', spec[n++] = 'l';
+            spec[n++] = (char)*fmt;
+            spec[n] = '\0';
+            if (is_long)
+                snprintf(arg, sizeof(arg), spec, va_arg(ap, long long));
+            else
+                snprintf(arg, sizeof(arg), spec, va_arg(ap, int));
+            break;
+        case L'c':
+            spec[n++] = 'c';
+            spec[n] = '\0';
+            i = va_arg(ap, int);
+            snprintf(arg, sizeof(arg), spec, (i < 0x80) ? (int)i : '?');
+            break;
+        case L's':
+            s = va_arg(ap, CONST CHAR16 *);
+            for (i = 0; s != NULL && s[i] && i < sizeof(str) - 1; i++)
+                str[i] = (s[i] < 0x80) ? (char)s[i] : '?';
+            str[i] = '\0';
+            spec[n++] = 's';
+            spec[n] = '\0';
+            snprintf(arg, sizeof(arg), spec, str);
+            break;
+        case L'a':
+            spec[n++] = 's';
+            spec[n] = '\0';
+            snprintf(arg, sizeof(arg), spec, va_arg(ap, CONST char *));
+            break;
+        case L'%':
+            arg[0] = '%';
+            arg[1] = '\0';
+            break;
+        default:
+            arg[0] = '\0';
+            break;
+        }
+        if (*fmt)
+            fmt++;
+
+        for (i = 0; arg[i] && pos < size - 1; i++)
+            out[pos++] = arg[i];
+    }
+    out[pos] = '\0';
+
+    return pos;
+}
+
+
+UINTN
+UnicodeVSPrint( CHAR16 *Buffer,
+                UINTN BufferSize,
+                CONST CHAR16 *Format,
+                VA_LIST Marker )
+{
+    char tmp[1024];
+    UINTN n, i;
+
+    if (BufferSize < sizeof(CHAR16))
+        return 0;
+
+    n = host_vformat(tmp, MIN(sizeof(tmp), BufferSize / sizeof(CHAR16)), Format, Marker);
+    for (i = 0; i < n; i++)
+        Buffer[i] = (UINT8)tmp[i];
+    Buffer[n] = 0;
+
+    return n;
+}
+
+
+UINTN
+UnicodeSPrint( CHAR16 *Buffer,
+               UINTN BufferSize,
+               CONST CHAR16 *Format,
+               ... )
+{
+    VA_LIST Marker;
+    UINTN n;
+
+    VA_START(Marker, Format);
+    n = UnicodeVSPrint(Buffer, BufferSize, Format, Marker);
+    VA_END(Marker);
+
+    return n;
+}
+
+
+/*
+ * Decoder diagnostics, unbuffered to stderr
+ */
+UINTN
+EFIAPI
+OutPrint( CONST CHAR16 *Format,
+          ... )
+{
+    char tmp[1024];
+    VA_LIST Marker;
+    UINTN n;
+
+    VA_START(Marker, Format);
+    n = host_vformat(tmp, sizeof(tmp), Format, Marker);
+    VA_END(Marker);
+    fputs(tmp, stderr);
+
+    return n;
+}
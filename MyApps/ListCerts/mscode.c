@@ -0,0 +1,58 @@
+/*
+ * Automatically generated by ASN1 compiler.  Do not manually edit!
+ *
+ * ASN.1 parser for mscode
+ */
+
+#include "asn1_ber_bytecode.h"
+#include "mscode.h"
+
+enum mscode_actions {
+	ACT_do_mscode_data_type = 0,
+	ACT_do_mscode_digest = 1,
+	ACT_do_mscode_digest_algo = 2,
+	NR__mscode_actions = 3
+};
+
+static const asn1_action_t mscode_action_table[NR__mscode_actions] = {
+	[   0] = do_mscode_data_type,
+	[   1] = do_mscode_digest,
+	[   2] = do_mscode_digest_algo,
+};
+
+static const unsigned char mscode_machine[] = {
+	// SpcIndirectDataContent
+	[   0] = ASN1_OP_MATCH,
+	[   1] = _tag(UNIV, CONS, SEQ),
+	// SpcAttributeTypeAndOptionalValue
+	[   2] =  ASN1_OP_MATCH,
+	[   3] =  _tag(UNIV, CONS, SEQ),
+	[   4] =   ASN1_OP_MATCH_ACT,		// type
+	[   5] =   _tag(UNIV, PRIM, OID),
+	[   6] =   _action(ACT_do_mscode_data_type),
+	[   7] =   ASN1_OP_MATCH_ANY,		// value
+	[   8] =  ASN1_OP_END_SEQ,
+	// DigestInfo
+	[   9] =  ASN1_OP_MATCH,
+	[  10] =  _tag(UNIV, CONS, SEQ),
+	// AlgorithmIdentifier
+	[  11] =   ASN1_OP_MATCH,
+	[  12] =   _tag(UNIV, CONS, SEQ),
+	[  13] =    ASN1_OP_MATCH_ACT,		// algorithm
+	[  14] =    _tag(UNIV, PRIM, OID),
+	[  15] =    _action(ACT_do_mscode_digest_algo),
+	[  16] =    ASN1_OP_MATCH_ANY,		// parameters
+	[  17] =   ASN1_OP_END_SEQ,
+	[  18] =   ASN1_OP_MATCH_ACT,		// digest
+	[  19] =   _tag(UNIV, PRIM, OTS),
+	[  20] =   _action(ACT_do_mscode_digest),
+	[  21] =  ASN1_OP_END_SEQ,
+	[  22] = ASN1_OP_END_SEQ,
+	[  23] = ASN1_OP_COMPLETE,
+};
+
+const struct asn1_decoder mscode_decoder = {
+	.machine = mscode_machine,
+	.machlen = sizeof(mscode_machine),
+	.actions = mscode_action_table,
+};
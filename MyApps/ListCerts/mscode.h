@@ -0,0 +1,14 @@
+/*
+ * Automatically generated by ASN1 compiler.  Do not manually edit!
+ *
+ * ASN.1 parser for mscode
+ */
+
+#include "asn1_ber_bytecode.h"
+
+extern const struct asn1_decoder mscode_decoder;
+
+extern int do_mscode_data_type(void *, long, unsigned char, const void *, long);
+extern int do_mscode_digest(void *, long, unsigned char, const void *, long);
+extern int do_mscode_digest_algo(void *, long, unsigned char, const void *, long);
+
@@ -19,90 +19,68 @@
 #include <errno.h>
 
 #include <Uefi.h>
-#include <Library/UefiLib.h>
-#include <Library/ShellCEntryLib.h>
-#include <Library/ShellLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
-#include <Library/MemoryAllocationLib.h>
-#include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
 
 #include "oid_registry.h"
 #include "oid_registry_data.h"  
 
+/*
+ * FNV-1a, seeded.  Must match oid_hash() in build_oid_registry_data.py
+ */
+static unsigned int
+oid_hash(const unsigned char *octets, long datasize, unsigned int seed)
+{
+    unsigned int hash = 2166136261u ^ seed;
+
+    while (datasize-- > 0) {
+        hash ^= *octets++;
+        hash *= 16777619u;
+    }
+
+    return hash ^ (hash >> 16);
+}
+
+
 /*
  * Find an OID registration for the specified data
  * @data: Binary representation of the OID
  * @datasize: Size of the binary representation
+ *
+ * The first hash selects a bucket whose displacement seeds a second hash
+ * that lands on the only slot the OID can occupy; one compare confirms it.
  */
 enum OID 
 Lookup_OID(const void *data, long datasize)
 {
     const unsigned char *octets = data;
+    unsigned int hash;
     enum OID oid;
-    unsigned char xhash;
-    unsigned i, j, k, hash;
     long len;
 
-    /* Hash the OID data */
-    hash = datasize - 1;
-    for (i = 0; i < datasize; i++)
-        hash += octets[i] * 33;
-    hash = (hash >> 24) ^ (hash >> 16) ^ (hash >> 8) ^ hash;
-    hash &= 0xff;
-
-    /* Binary search the OID registry.  OIDs are stored in ascending order
-     * of hash value then ascending order of size and then in ascending
-     * order of reverse value.
-     */
-    i = 0;
-    k = OID__NR;
-    while (i < k) {
-        j = (i + k) / 2;
-
-        xhash = oid_search_table[j].hash;
-        if (xhash > hash) {
-            k = j;
-            continue;
-        }
-        if (xhash < hash) {
-            i = j + 1;
-            continue;
-        }
+    hash = oid_hash(octets, datasize, 0);
+    hash = oid_hash(octets, datasize, oid_displacement[hash & (OID_NR_BUCKETS - 1)]);
+    oid = oid_slot[hash % OID__NR];
 
-        oid = oid_search_table[j].oid;
-        len = oid_index[oid + 1] - oid_index[oid];
-        if (len > datasize) {
-            k = j;
-            continue;
-        }
-        if (len < datasize) {
-            i = j + 1;
-            continue;
-        }
+    len = oid_index[oid + 1] - oid_index[oid];
+    if (len != datasize || CompareMem(oid_data + oid_index[oid], octets, len) != 0)
+        return OID__NR;
 
-        /* Variation is most likely to be at the tail end of the
-         * OID, so do the comparison in reverse.
-         */
-        while (len > 0) {
-            unsigned char a = oid_data[oid_index[oid] + --len];
-            unsigned char b = octets[len];
-            if (a > b) {
-                k = j;
-                goto next;
-            }
-            if (a < b) {
-                i = j + 1;
-                goto next;
-            }
-        }
-        return oid;
-    next:
-        ;
-    }
+    return oid;
+}
+
+
+/*
+ * Return the display name of an OID, or NULL for OID__NR
+ */
+const CHAR16 *
+OID_Name(enum OID oid)
+{
+    if (oid >= OID__NR)
+        return NULL;
 
-    return OID__NR;
+    return oid_names[oid];
 }
 
 
@@ -25,15 +25,24 @@
  * OIDs are turned into these values if possible, or OID__NR if not held here.
  *
  * NOTE!  Do not mess with the format of each line as this is read by
- *        build_oid_registry_data.pl to generate the data for Lookup_OID.
+ *        build_oid_registry_data.py to generate the data for Lookup_OID.
+ *        An optional quoted string after the OID gives the display name
+ *        returned by OID_Name, otherwise the enum name is used.
  *
- *        If you add or remove entries, you must rebuild oid_registry_data.c
+ *        If you add or remove entries, you must rebuild oid_registry_data.h:
+ *
+ *            python3 build_oid_registry_data.py oid_registry.h > oid_registry_data.h
  */
 enum OID {
     OID_id_dsa_with_sha1,          /* 1.2.840.10030.4.3 */
     OID_id_dsa,                    /* 1.2.840.10040.4.1 */
     OID_id_ecdsa_with_sha1,        /* 1.2.840.10045.4.1 */
     OID_id_ecPublicKey,            /* 1.2.840.10045.2.1 */
+    OID_id_prime192v1,             /* 1.2.840.10045.3.1.1 "P-192" */
+    OID_id_prime256v1,             /* 1.2.840.10045.3.1.7 "P-256" */
+    OID_id_ecdsa_with_sha256,      /* 1.2.840.10045.4.3.2 */
+    OID_id_ecdsa_with_sha384,      /* 1.2.840.10045.4.3.3 */
+    OID_id_ecdsa_with_sha512,      /* 1.2.840.10045.4.3.4 */
 
     /* PKCS#1 {iso(1) member-body(2) us(840) rsadsi(113549) pkcs(1) pkcs-1(1)} */
     OID_rsaEncryption,              /* 1.2.840.113549.1.1.1 */
@@ -64,22 +73,29 @@ enum OID {
     OID_md5,                        /* 1.2.840.113549.2.5 */
 
     /* Microsoft OIDs */
+    OID_msIndirectData,             /* 1.3.6.1.4.1.311.2.1.4 "SpcIndirectDataContent" */
+    OID_msStatementType,            /* 1.3.6.1.4.1.311.2.1.11 */
+    OID_msSpOpusInfo,               /* 1.3.6.1.4.1.311.2.1.12 */
+    OID_msPeImageDataObjId,         /* 1.3.6.1.4.1.311.2.1.15 "SpcPeImageData" */
     OID_msOutlookExpress,           /* 1.3.6.1.4.1.311.16.4 */
-    OID_msEnrollCerttypeExtension,  /* 1.3.6.1.4.1.311.20.2 */
+    OID_msEnrollCerttypeExtension,  /* 1.3.6.1.4.1.311.20.2 "msEnrollCertTypeExtension" */
     OID_msCertsrvCAVersion,         /* 1.3.6.1.4.1.311.21.1 */
     OID_msCertsrvPreviousCertHash,  /* 1.3.6.1.4.1.311.21.2 */
 
-    OID_certAuthInfoAccess,         /* 1.3.6.1.5.5.7.1.1 */
+    OID_certAuthInfoAccess,         /* 1.3.6.1.5.5.7.1.1 "CertAuthInfoAccess" */
     OID_sha1,                       /* 1.3.14.3.2.26 */
+    OID_id_secp224r1,               /* 1.3.132.0.33 "P-224" */
+    OID_id_secp384r1,               /* 1.3.132.0.34 "P-384" */
+    OID_id_secp521r1,               /* 1.3.132.0.35 "P-521" */
 
     /* Distinguished Name attribute IDs [RFC 2256] */
-    OID_commonName,                 /* 2.5.4.3 */
-    OID_surname,                    /* 2.5.4.4 */
-    OID_countryName,                /* 2.5.4.6 */
-    OID_locality,                   /* 2.5.4.7 */
-    OID_stateOrProvinceName,        /* 2.5.4.8 */
-    OID_organizationName,           /* 2.5.4.10 */
-    OID_organizationUnitName,       /* 2.5.4.11 */
+    OID_commonName,                 /* 2.5.4.3 "CN" */
+    OID_surname,                    /* 2.5.4.4 "SN" */
+    OID_countryName,                /* 2.5.4.6 "C" */
+    OID_locality,                   /* 2.5.4.7 "L" */
+    OID_stateOrProvinceName,        /* 2.5.4.8 "ST" */
+    OID_organizationName,           /* 2.5.4.10 "O" */
+    OID_organizationUnitName,       /* 2.5.4.11 "OU" */
     OID_title,                      /* 2.5.4.12 */
     OID_description,                /* 2.5.4.13 */
     OID_name,                       /* 2.5.4.41 */
@@ -88,20 +104,27 @@ enum OID {
     OID_generationalQualifier,      /* 2.5.4.44 */
 
     /* Certificate extension IDs */
-    OID_subjectKeyIdentifier,       /* 2.5.29.14 */
-    OID_keyUsage,                   /* 2.5.29.15 */
-    OID_subjectAltName,             /* 2.5.29.17 */
-    OID_issuerAltName,              /* 2.5.29.18 */
-    OID_basicConstraints,           /* 2.5.29.19 */
-    OID_crlDistributionPoints,      /* 2.5.29.31 */
-    OID_certPolicies,               /* 2.5.29.32 */
-    OID_authorityKeyIdentifier,     /* 2.5.29.35 */
-    OID_extKeyUsage,                /* 2.5.29.37 */
+    OID_subjectKeyIdentifier,       /* 2.5.29.14 "SubjectKeyIdentifier" */
+    OID_keyUsage,                   /* 2.5.29.15 "KeyUsage" */
+    OID_subjectAltName,             /* 2.5.29.17 "SubjectAltName" */
+    OID_issuerAltName,              /* 2.5.29.18 "IssuerAltName" */
+    OID_basicConstraints,           /* 2.5.29.19 "BasicConstraints" */
+    OID_crlDistributionPoints,      /* 2.5.29.31 "CrlDistributionPoints" */
+    OID_certPolicies,               /* 2.5.29.32 "CertPolicies" */
+    OID_authorityKeyIdentifier,     /* 2.5.29.35 "AuthorityKeyIdentifier" */
+    OID_extKeyUsage,                /* 2.5.29.37 "ExtKeyUsage" */
+
+    /* NIST hash algorithms {joint-iso-itu-t(2) country(16) us(840) ... hashAlgs(2)} */
+    OID_sha256,                     /* 2.16.840.1.101.3.4.2.1 */
+    OID_sha384,                     /* 2.16.840.1.101.3.4.2.2 */
+    OID_sha512,                     /* 2.16.840.1.101.3.4.2.3 */
+    OID_sha224,                     /* 2.16.840.1.101.3.4.2.4 */
 
     OID__NR
 };
 
 extern enum OID Lookup_OID(const void *data, long datasize);
+extern const CHAR16 *OID_Name(enum OID oid);
 extern int Sprint_OID(const void *, long, CHAR16 *, long);
 
 #endif /* _OID_REGISTRY_H */
@@ -7,62 +7,83 @@ static const unsigned short oid_index[OID__NR + 1] = {
 	[OID_id_dsa] = 7,
 	[OID_id_ecdsa_with_sha1] = 14,
 	[OID_id_ecPublicKey] = 21,
-	[OID_rsaEncryption] = 28,
-	[OID_md2WithRSAEncryption] = 37,
-	[OID_md3WithRSAEncryption] = 46,
-	[OID_md4WithRSAEncryption] = 55,
-	[OID_sha1WithRSAEncryption] = 64,
-	[OID_sha256WithRSAEncryption] = 73,
-	[OID_sha384WithRSAEncryption] = 82,
-	[OID_sha512WithRSAEncryption] = 91,
-	[OID_sha224WithRSAEncryption] = 100,
-	[OID_data] = 109,
-	[OID_signed_data] = 118,
-	[OID_email_address] = 127,
-	[OID_content_type] = 136,
-	[OID_messageDigest] = 145,
-	[OID_signingTime] = 154,
-	[OID_smimeCapabilites] = 163,
-	[OID_smimeAuthenticatedAttrs] = 172,
-	[OID_md2] = 183,
-	[OID_md4] = 191,
-	[OID_md5] = 199,
-	[OID_msOutlookExpress] = 207,
-	[OID_msEnrollCerttypeExtension] = 216,
-	[OID_msCertsrvCAVersion] = 225,
-	[OID_msCertsrvPreviousCertHash] = 234,
-	[OID_certAuthInfoAccess] = 243,
-	[OID_sha1] = 251,
-	[OID_commonName] = 256,
-	[OID_surname] = 259,
-	[OID_countryName] = 262,
-	[OID_locality] = 265,
-	[OID_stateOrProvinceName] = 268,
-	[OID_organizationName] = 271,
-	[OID_organizationUnitName] = 274,
-	[OID_title] = 277,
-	[OID_description] = 280,
-	[OID_name] = 283,
-	[OID_givenName] = 286,
-	[OID_initials] = 289,
-	[OID_generationalQualifier] = 292,
-	[OID_subjectKeyIdentifier] = 295,
-	[OID_keyUsage] = 298,
-	[OID_subjectAltName] = 301,
-	[OID_issuerAltName] = 304,
-	[OID_basicConstraints] = 307,
-	[OID_crlDistributionPoints] = 310,
-	[OID_certPolicies] = 313,
-	[OID_authorityKeyIdentifier] = 316,
-	[OID_extKeyUsage] = 319,
-	[OID__NR] = 322
+	[OID_id_prime192v1] = 28,
+	[OID_id_prime256v1] = 36,
+	[OID_id_ecdsa_with_sha256] = 44,
+	[OID_id_ecdsa_with_sha384] = 52,
+	[OID_id_ecdsa_with_sha512] = 60,
+	[OID_rsaEncryption] = 68,
+	[OID_md2WithRSAEncryption] = 77,
+	[OID_md3WithRSAEncryption] = 86,
+	[OID_md4WithRSAEncryption] = 95,
+	[OID_sha1WithRSAEncryption] = 104,
+	[OID_sha256WithRSAEncryption] = 113,
+	[OID_sha384WithRSAEncryption] = 122,
+	[OID_sha512WithRSAEncryption] = 131,
+	[OID_sha224WithRSAEncryption] = 140,
+	[OID_data] = 149,
+	[OID_signed_data] = 158,
+	[OID_email_address] = 167,
+	[OID_content_type] = 176,
+	[OID_messageDigest] = 185,
+	[OID_signingTime] = 194,
+	[OID_smimeCapabilites] = 203,
+	[OID_smimeAuthenticatedAttrs] = 212,
+	[OID_md2] = 223,
+	[OID_md4] = 231,
+	[OID_md5] = 239,
+	[OID_msIndirectData] = 247,
+	[OID_msStatementType] = 257,
+	[OID_msSpOpusInfo] = 267,
+	[OID_msPeImageDataObjId] = 277,
+	[OID_msOutlookExpress] = 287,
+	[OID_msEnrollCerttypeExtension] = 296,
+	[OID_msCertsrvCAVersion] = 305,
+	[OID_msCertsrvPreviousCertHash] = 314,
+	[OID_certAuthInfoAccess] = 323,
+	[OID_sha1] = 331,
+	[OID_id_secp224r1] = 336,
+	[OID_id_secp384r1] = 341,
+	[OID_id_secp521r1] = 346,
+	[OID_commonName] = 351,
+	[OID_surname] = 354,
+	[OID_countryName] = 357,
+	[OID_locality] = 360,
+	[OID_stateOrProvinceName] = 363,
+	[OID_organizationName] = 366,
+	[OID_organizationUnitName] = 369,
+	[OID_title] = 372,
+	[OID_description] = 375,
+	[OID_name] = 378,
+	[OID_givenName] = 381,
+	[OID_initials] = 384,
+	[OID_generationalQualifier] = 387,
+	[OID_subjectKeyIdentifier] = 390,
+	[OID_keyUsage] = 393,
+	[OID_subjectAltName] = 396,
+	[OID_issuerAltName] = 399,
+	[OID_basicConstraints] = 402,
+	[OID_crlDistributionPoints] = 405,
+	[OID_certPolicies] = 408,
+	[OID_authorityKeyIdentifier] = 411,
+	[OID_extKeyUsage] = 414,
+	[OID_sha256] = 417,
+	[OID_sha384] = 426,
+	[OID_sha512] = 435,
+	[OID_sha224] = 444,
+	[OID__NR] = 453
 };
 
-static const unsigned char oid_data[322] = {
+static const unsigned char oid_data[453] = {
 	42, 134, 72, 206, 46, 4, 3, 	// id_dsa_with_sha1
 	42, 134, 72, 206, 56, 4, 1, 	// id_dsa
 	42, 134, 72, 206, 61, 4, 1, 	// id_ecdsa_with_sha1
 	42, 134, 72, 206, 61, 2, 1, 	// id_ecPublicKey
+	42, 134, 72, 206, 61, 3, 1, 1, 	// id_prime192v1
+	42, 134, 72, 206, 61, 3, 1, 7, 	// id_prime256v1
+	42, 134, 72, 206, 61, 4, 3, 2, 	// id_ecdsa_with_sha256
+	42, 134, 72, 206, 61, 4, 3, 3, 	// id_ecdsa_with_sha384
+	42, 134, 72, 206, 61, 4, 3, 4, 	// id_ecdsa_with_sha512
 	42, 134, 72, 134, 247, 13, 1, 1, 1, 	// rsaEncryption
 	42, 134, 72, 134, 247, 13, 1, 1, 2, 	// md2WithRSAEncryption
 	42, 134, 72, 134, 247, 13, 1, 1, 3, 	// md3WithRSAEncryption
@@ -83,12 +104,19 @@ static const unsigned char oid_data[322] = {
 	42, 134, 72, 134, 247, 13, 2, 2, 	// md2
 	42, 134, 72, 134, 247, 13, 2, 4, 	// md4
 	42, 134, 72, 134, 247, 13, 2, 5, 	// md5
+	43, 6, 1, 4, 1, 130, 55, 2, 1, 4, 	// msIndirectData
+	43, 6, 1, 4, 1, 130, 55, 2, 1, 11, 	// msStatementType
+	43, 6, 1, 4, 1, 130, 55, 2, 1, 12, 	// msSpOpusInfo
+	43, 6, 1, 4, 1, 130, 55, 2, 1, 15, 	// msPeImageDataObjId
 	43, 6, 1, 4, 1, 130, 55, 16, 4, 	// msOutlookExpress
 	43, 6, 1, 4, 1, 130, 55, 20, 2, 	// msEnrollCerttypeExtension
 	43, 6, 1, 4, 1, 130, 55, 21, 1, 	// msCertsrvCAVersion
 	43, 6, 1, 4, 1, 130, 55, 21, 2, 	// msCertsrvPreviousCertHash
 	43, 6, 1, 5, 5, 7, 1, 1, 	// certAuthInfoAccess
 	43, 14, 3, 2, 26, 	// sha1
+	43, 129, 4, 0, 33, 	// id_secp224r1
+	43, 129, 4, 0, 34, 	// id_secp384r1
+	43, 129, 4, 0, 35, 	// id_secp521r1
 	85, 4, 3, 	// commonName
 	85, 4, 4, 	// surname
 	85, 4, 6, 	// countryName
@@ -111,62 +139,171 @@ static const unsigned char oid_data[322] = {
 	85, 29, 32, 	// certPolicies
 	85, 29, 35, 	// authorityKeyIdentifier
 	85, 29, 37, 	// extKeyUsage
+	96, 134, 72, 1, 101, 3, 4, 2, 1, 	// sha256
+	96, 134, 72, 1, 101, 3, 4, 2, 2, 	// sha384
+	96, 134, 72, 1, 101, 3, 4, 2, 3, 	// sha512
+	96, 134, 72, 1, 101, 3, 4, 2, 4, 	// sha224
 };
 
-static const struct {
-	unsigned char hash;
-	enum OID oid : 8;
-} oid_search_table[OID__NR] = {
-	[  0] = {  10, OID_title                               }, // 55040c
-	[  1] = {  23, OID_issuerAltName                       }, // 551d12
-	[  2] = {  23, OID_initials                            }, // 55042b
-	[  3] = {  29, OID_md2WithRSAEncryption                }, // 2a864886f70d010102
-	[  4] = {  30, OID_md2                                 }, // 2a864886f70d0202
-	[  5] = {  32, OID_id_dsa_with_sha1                    }, // 2a8648ce2e0403
-	[  6] = {  35, OID_content_type                        }, // 2a864886f70d010903
-	[  7] = {  35, OID_sha256WithRSAEncryption             }, // 2a864886f70d01010b
-	[  8] = {  36, OID_authorityKeyIdentifier              }, // 551d23
-	[  9] = {  37, OID_description                         }, // 55040d
-	[ 10] = {  43, OID_id_dsa                              }, // 2a8648ce380401
-	[ 11] = {  54, OID_basicConstraints                    }, // 551d13
-	[ 12] = {  54, OID_generationalQualifier               }, // 55042c
-	[ 13] = {  60, OID_md3WithRSAEncryption                }, // 2a864886f70d010103
-	[ 14] = {  64, OID_signed_data                         }, // 2a864886f70d010702
-	[ 15] = {  77, OID_countryName                         }, // 550406
-	[ 16] = {  77, OID_id_ecdsa_with_sha1                  }, // 2a8648ce3d0401
-	[ 17] = {  85, OID_smimeCapabilites                    }, // 2a864886f70d01090f
-	[ 18] = {  87, OID_sha1                                }, // 2b0e03021a
-	[ 19] = {  97, OID_email_address                       }, // 2a864886f70d010901
-	[ 20] = { 106, OID_extKeyUsage                         }, // 551d25
-	[ 21] = { 110, OID_locality                            }, // 550407
-	[ 22] = { 126, OID_rsaEncryption                       }, // 2a864886f70d010101
-	[ 23] = { 132, OID_smimeAuthenticatedAttrs             }, // 2a864886f70d010910020b
-	[ 24] = { 142, OID_id_ecPublicKey                      }, // 2a8648ce3d0201
-	[ 25] = { 142, OID_sha224WithRSAEncryption             }, // 2a864886f70d01010e
-	[ 26] = { 143, OID_stateOrProvinceName                 }, // 550408
-	[ 27] = { 146, OID_subjectKeyIdentifier                }, // 551d0e
-	[ 28] = { 160, OID_data                                }, // 2a864886f70d010701
-	[ 29] = { 161, OID_crlDistributionPoints               }, // 551d1f
-	[ 30] = { 173, OID_msOutlookExpress                    }, // 2b0601040182371004
-	[ 31] = { 179, OID_keyUsage                            }, // 551d0f
-	[ 32] = { 195, OID_md4WithRSAEncryption                }, // 2a864886f70d010104
-	[ 33] = { 198, OID_certPolicies                        }, // 551d20
-	[ 34] = { 201, OID_organizationName                    }, // 55040a
-	[ 35] = { 204, OID_messageDigest                       }, // 2a864886f70d010904
-	[ 36] = { 204, OID_sha384WithRSAEncryption             }, // 2a864886f70d01010c
-	[ 37] = { 206, OID_msCertsrvPreviousCertHash           }, // 2b0601040182371502
-	[ 38] = { 212, OID_name                                }, // 550429
-	[ 39] = { 213, OID_commonName                          }, // 550403
-	[ 40] = { 220, OID_md4                                 }, // 2a864886f70d0204
-	[ 41] = { 226, OID_sha1WithRSAEncryption               }, // 2a864886f70d010105
-	[ 42] = { 227, OID_md5                                 }, // 2a864886f70d0205
-	[ 43] = { 228, OID_certAuthInfoAccess                  }, // 2b06010505070101
-	[ 44] = { 234, OID_organizationUnitName                }, // 55040b
-	[ 45] = { 237, OID_signingTime                         }, // 2a864886f70d010905
-	[ 46] = { 237, OID_sha512WithRSAEncryption             }, // 2a864886f70d01010d
-	[ 47] = { 239, OID_msCertsrvCAVersion                  }, // 2b0601040182371501
-	[ 48] = { 239, OID_msEnrollCerttypeExtension           }, // 2b0601040182371402
-	[ 49] = { 244, OID_surname                             }, // 550404
-	[ 50] = { 245, OID_subjectAltName                      }, // 551d11
-	[ 51] = { 245, OID_givenName                           }, // 55042a
+#define OID_NR_BUCKETS 16
+
+static const unsigned short oid_displacement[OID_NR_BUCKETS] = {
+	[  0] =     2,
+	[  1] =    23,
+	[  2] =   239,
+	[  3] =    38,
+	[  4] =    42,
+	[  5] =    37,
+	[  6] =   192,
+	[  7] =    88,
+	[  8] =   171,
+	[  9] =     9,
+	[ 10] =    16,
+	[ 11] =  4254,
+	[ 12] =  7522,
+	[ 13] =     1,
+	[ 14] =     4,
+	[ 15] =   510,
+};
+
+static const unsigned char oid_slot[OID__NR] = {
+	[  0] = OID_msSpOpusInfo,                       // 2b06010401823702010c
+	[  1] = OID_id_ecPublicKey,                     // 2a8648ce3d0201
+	[  2] = OID_sha512,                             // 608648016503040203
+	[  3] = OID_msOutlookExpress,                   // 2b0601040182371004
+	[  4] = OID_sha1WithRSAEncryption,              // 2a864886f70d010105
+	[  5] = OID_organizationUnitName,               // 55040b
+	[  6] = OID_smimeAuthenticatedAttrs,            // 2a864886f70d010910020b
+	[  7] = OID_subjectKeyIdentifier,               // 551d0e
+	[  8] = OID_description,                        // 55040d
+	[  9] = OID_msIndirectData,                     // 2b060104018237020104
+	[ 10] = OID_id_ecdsa_with_sha1,                 // 2a8648ce3d0401
+	[ 11] = OID_md5,                                // 2a864886f70d0205
+	[ 12] = OID_md2,                                // 2a864886f70d0202
+	[ 13] = OID_sha384WithRSAEncryption,            // 2a864886f70d01010c
+	[ 14] = OID_givenName,                          // 55042a
+	[ 15] = OID_id_prime256v1,                      // 2a8648ce3d030107
+	[ 16] = OID_certAuthInfoAccess,                 // 2b06010505070101
+	[ 17] = OID_commonName,                         // 550403
+	[ 18] = OID_msStatementType,                    // 2b06010401823702010b
+	[ 19] = OID_certPolicies,                       // 551d20
+	[ 20] = OID_extKeyUsage,                        // 551d25
+	[ 21] = OID_signingTime,                        // 2a864886f70d010905
+	[ 22] = OID_initials,                           // 55042b
+	[ 23] = OID_sha256,                             // 608648016503040201
+	[ 24] = OID_id_secp521r1,                       // 2b81040023
+	[ 25] = OID_signed_data,                        // 2a864886f70d010702
+	[ 26] = OID_sha224WithRSAEncryption,            // 2a864886f70d01010e
+	[ 27] = OID_msCertsrvCAVersion,                 // 2b0601040182371501
+	[ 28] = OID_id_ecdsa_with_sha256,               // 2a8648ce3d040302
+	[ 29] = OID_sha384,                             // 608648016503040202
+	[ 30] = OID_surname,                            // 550404
+	[ 31] = OID_email_address,                      // 2a864886f70d010901
+	[ 32] = OID_id_prime192v1,                      // 2a8648ce3d030101
+	[ 33] = OID_stateOrProvinceName,                // 550408
+	[ 34] = OID_messageDigest,                      // 2a864886f70d010904
+	[ 35] = OID_generationalQualifier,              // 55042c
+	[ 36] = OID_msCertsrvPreviousCertHash,          // 2b0601040182371502
+	[ 37] = OID_crlDistributionPoints,              // 551d1f
+	[ 38] = OID_authorityKeyIdentifier,             // 551d23
+	[ 39] = OID_locality,                           // 550407
+	[ 40] = OID_id_ecdsa_with_sha384,               // 2a8648ce3d040303
+	[ 41] = OID_md2WithRSAEncryption,               // 2a864886f70d010102
+	[ 42] = OID_id_dsa_with_sha1,                   // 2a8648ce2e0403
+	[ 43] = OID_msPeImageDataObjId,                 // 2b06010401823702010f
+	[ 44] = OID_md3WithRSAEncryption,               // 2a864886f70d010103
+	[ 45] = OID_issuerAltName,                      // 551d12
+	[ 46] = OID_sha256WithRSAEncryption,            // 2a864886f70d01010b
+	[ 47] = OID_sha512WithRSAEncryption,            // 2a864886f70d01010d
+	[ 48] = OID_md4,                                // 2a864886f70d0204
+	[ 49] = OID_countryName,                        // 550406
+	[ 50] = OID_id_dsa,                             // 2a8648ce380401
+	[ 51] = OID_name,                               // 550429
+	[ 52] = OID_smimeCapabilites,                   // 2a864886f70d01090f
+	[ 53] = OID_data,                               // 2a864886f70d010701
+	[ 54] = OID_id_secp384r1,                       // 2b81040022
+	[ 55] = OID_title,                              // 55040c
+	[ 56] = OID_id_ecdsa_with_sha512,               // 2a8648ce3d040304
+	[ 57] = OID_keyUsage,                           // 551d0f
+	[ 58] = OID_organizationName,                   // 55040a
+	[ 59] = OID_sha224,                             // 608648016503040204
+	[ 60] = OID_md4WithRSAEncryption,               // 2a864886f70d010104
+	[ 61] = OID_rsaEncryption,                      // 2a864886f70d010101
+	[ 62] = OID_content_type,                       // 2a864886f70d010903
+	[ 63] = OID_id_secp224r1,                       // 2b81040021
+	[ 64] = OID_msEnrollCerttypeExtension,          // 2b0601040182371402
+	[ 65] = OID_sha1,                               // 2b0e03021a
+	[ 66] = OID_basicConstraints,                   // 551d13
+	[ 67] = OID_subjectAltName,                     // 551d11
+};
+
+static const CHAR16 * const oid_names[OID__NR] = {
+	[OID_id_dsa_with_sha1] = L"id_dsa_with_sha1",
+	[OID_id_dsa] = L"id_dsa",
+	[OID_id_ecdsa_with_sha1] = L"id_ecdsa_with_sha1",
+	[OID_id_ecPublicKey] = L"id_ecPublicKey",
+	[OID_id_prime192v1] = L"P-192",
+	[OID_id_prime256v1] = L"P-256",
+	[OID_id_ecdsa_with_sha256] = L"id_ecdsa_with_sha256",
+	[OID_id_ecdsa_with_sha384] = L"id_ecdsa_with_sha384",
+	[OID_id_ecdsa_with_sha512] = L"id_ecdsa_with_sha512",
+	[OID_rsaEncryption] = L"rsaEncryption",
+	[OID_md2WithRSAEncryption] = L"md2WithRSAEncryption",
+	[OID_md3WithRSAEncryption] = L"md3WithRSAEncryption",
+	[OID_md4WithRSAEncryption] = L"md4WithRSAEncryption",
+	[OID_sha1WithRSAEncryption] = L"sha1WithRSAEncryption",
+	[OID_sha256WithRSAEncryption] = L"sha256WithRSAEncryption",
+	[OID_sha384WithRSAEncryption] = L"sha384WithRSAEncryption",
+	[OID_sha512WithRSAEncryption] = L"sha512WithRSAEncryption",
+	[OID_sha224WithRSAEncryption] = L"sha224WithRSAEncryption",
+	[OID_data] = L"data",
+	[OID_signed_data] = L"signed_data",
+	[OID_email_address] = L"email_address",
+	[OID_content_type] = L"content_type",
+	[OID_messageDigest] = L"messageDigest",
+	[OID_signingTime] = L"signingTime",
+	[OID_smimeCapabilites] = L"smimeCapabilites",
+	[OID_smimeAuthenticatedAttrs] = L"smimeAuthenticatedAttrs",
+	[OID_md2] = L"md2",
+	[OID_md4] = L"md4",
+	[OID_md5] = L"md5",
+	[OID_msIndirectData] = L"SpcIndirectDataContent",
+	[OID_msStatementType] = L"msStatementType",
+	[OID_msSpOpusInfo] = L"msSpOpusInfo",
+	[OID_msPeImageDataObjId] = L"SpcPeImageData",
+	[OID_msOutlookExpress] = L"msOutlookExpress",
+	[OID_msEnrollCerttypeExtension] = L"msEnrollCertTypeExtension",
+	[OID_msCertsrvCAVersion] = L"msCertsrvCAVersion",
+	[OID_msCertsrvPreviousCertHash] = L"msCertsrvPreviousCertHash",
+	[OID_certAuthInfoAccess] = L"CertAuthInfoAccess",
+	[OID_sha1] = L"sha1",
+	[OID_id_secp224r1] = L"P-224",
+	[OID_id_secp384r1] = L"P-384",
+	[OID_id_secp521r1] = L"P-521",
+	[OID_commonName] = L"CN",
+	[OID_surname] = L"SN",
+	[OID_countryName] = L"C",
+	[OID_locality] = L"L",
+	[OID_stateOrProvinceName] = L"ST",
+	[OID_organizationName] = L"O",
+	[OID_organizationUnitName] = L"OU",
+	[OID_title] = L"title",
+	[OID_description] = L"description",
+	[OID_name] = L"name",
+	[OID_givenName] = L"givenName",
+	[OID_initials] = L"initials",
+	[OID_generationalQualifier] = L"generationalQualifier",
+	[OID_subjectKeyIdentifier] = L"SubjectKeyIdentifier",
+	[OID_keyUsage] = L"KeyUsage",
+	[OID_subjectAltName] = L"SubjectAltName",
+	[OID_issuerAltName] = L"IssuerAltName",
+	[OID_basicConstraints] = L"BasicConstraints",
+	[OID_crlDistributionPoints] = L"CrlDistributionPoints",
+	[OID_certPolicies] = L"CertPolicies",
+	[OID_authorityKeyIdentifier] = L"AuthorityKeyIdentifier",
+	[OID_extKeyUsage] = L"ExtKeyUsage",
+	[OID_sha256] = L"sha256",
+	[OID_sha384] = L"sha384",
+	[OID_sha512] = L"sha512",
+	[OID_sha224] = L"sha224",
 };
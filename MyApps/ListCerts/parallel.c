@@ -0,0 +1,102 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Work items are handed out through one shared counter: every processor,
+//  the BSP as well as the APs, takes the next index until none are left,
+//  so a slow item holds up only the processor decoding it.  The APs are
+//  started in non-blocking mode so the BSP can work alongside them; it
+//  then waits for the event StartupAllAPs signals when they are all done.
+//  Without MP services, or with no enabled APs, the BSP does every item.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+#include "parallel.h"
+
+typedef struct {
+    PARALLEL_FUNCTION Function;
+    VOID              *Context;
+    UINTN             Count;
+    volatile UINT32   Next;         // items handed out so far
+} PARALLEL_JOB;
+
+
+static VOID
+EFIAPI
+Worker( VOID *Buffer )
+{
+    PARALLEL_JOB *Job = Buffer;
+    UINTN Index;
+
+    for (;;) {
+        Index = InterlockedIncrement(&Job->Next) - 1;
+        if (Index >= Job->Count)
+            break;
+        Job->Function(Job->Context, Index);
+    }
+}
+
+
+VOID
+ParallelInit( PARALLEL *Par )
+{
+    EFI_STATUS Status;
+    UINTN Processors, Enabled;
+
+    Par->Mp = NULL;
+    Par->Processors = 1;
+    Par->Runs = Par->Shared = Par->Items = 0;
+
+    Status = gBS->LocateProtocol(&gEfiMpServiceProtocolGuid, NULL, (VOID **)&Par->Mp);
+    if (EFI_ERROR(Status)) {
+        Par->Mp = NULL;
+        return;
+    }
+    Status = Par->Mp->GetNumberOfProcessors(Par->Mp, &Processors, &Enabled);
+    if (EFI_ERROR(Status) || Enabled < 2) {
+        Par->Mp = NULL;
+        return;
+    }
+    Par->Processors = Enabled;
+}
+
+
+VOID
+ParallelForEach( PARALLEL *Par,
+                 UINTN Count,
+                 PARALLEL_FUNCTION Function,
+                 VOID *Context )
+{
+    PARALLEL_JOB Job;
+    EFI_EVENT Done = NULL;
+    EFI_STATUS Status = EFI_NOT_STARTED;
+    UINTN Index;
+
+    Job.Function = Function;
+    Job.Context = Context;
+    Job.Count = Count;
+    Job.Next = 0;
+
+    Par->Runs++;
+    Par->Items += Count;
+
+    if (Par->Mp != NULL && Count >= PARALLEL_MIN_ITEMS &&
+        !EFI_ERROR(gBS->CreateEvent(0, TPL_NOTIFY, NULL, NULL, &Done))) {
+        Status = Par->Mp->StartupAllAPs(Par->Mp, Worker, FALSE, Done, 0, &Job, NULL);
+        if (!EFI_ERROR(Status))
+            Par->Shared++;
+    }
+
+    // whatever the APs do not take, or all of it if they never started
+    Worker(&Job);
+
+    if (!EFI_ERROR(Status))
+        gBS->WaitForEvent(1, &Done, &Index);
+    if (Done != NULL)
+        gBS->CloseEvent(Done);
+}
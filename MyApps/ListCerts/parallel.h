@@ -0,0 +1,34 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Running independent work items on every enabled processor through
+//  EFI_MP_SERVICES_PROTOCOL, the BSP included
+//
+//  License: BSD License
+//
+
+#ifndef _PARALLEL_H
+#define _PARALLEL_H
+
+#include <Protocol/MpService.h>
+
+#define PARALLEL_MIN_ITEMS  8       // fewer are not worth waking the APs for
+
+//
+//  Called once for every Index below the item count, on any processor.
+//  It must not use boot or runtime services, Print included.
+//
+typedef VOID (EFIAPI *PARALLEL_FUNCTION)(VOID *Context, UINTN Index);
+
+typedef struct {
+    EFI_MP_SERVICES_PROTOCOL *Mp;   // NULL if there is none
+    UINTN Processors;               // enabled, the BSP included
+    UINTN Runs;                     // ParallelForEach calls
+    UINTN Shared;                   // of those, the ones the APs took part in
+    UINTN Items;
+} PARALLEL;
+
+VOID ParallelInit(PARALLEL *Par);
+VOID ParallelForEach(PARALLEL *Par, UINTN Count, PARALLEL_FUNCTION Function, VOID *Context);
+
+#endif /* _PARALLEL_H */
@@ -0,0 +1,358 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Authenticode hash of a PE/COFF image file.  The file is streamed in
+//  PE_READ_CHUNK pieces following the Authenticode PE specification:
+//  the headers minus the CheckSum field and the certificate table data
+//  directory, each section in file order, then any trailing data up to
+//  the attribute certificate table.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/ShellLib.h>
+
+#include <Guid/WinCertificate.h>
+
+#include <IndustryStandard/PeImage.h>
+
+#include "pecoff.h"
+#include "authenticode.h"
+
+
+static EFI_STATUS
+ReadAt( SHELL_FILE_HANDLE File,
+        UINT64 Offset,
+        VOID *Buffer,
+        UINTN Size )
+{
+    EFI_STATUS Status;
+    UINTN Read = Size;
+
+    Status = ShellSetFilePosition(File, Offset);
+    if (EFI_ERROR(Status))
+        return Status;
+    Status = ShellReadFile(File, &Read, Buffer);
+    if (EFI_ERROR(Status))
+        return Status;
+
+    return (Read == Size) ? EFI_SUCCESS : EFI_END_OF_FILE;
+}
+
+
+static EFI_STATUS
+HashRange( SHELL_FILE_HANDLE File,
+           SHA256_CONTEXT *Ctx,
+           UINT8 *Chunk,
+           UINT64 Offset,
+           UINT64 Size )
+{
+    EFI_STATUS Status;
+    UINTN Read;
+
+    if (Size == 0)
+        return EFI_SUCCESS;
+
+    Status = ShellSetFilePosition(File, Offset);
+    while (!EFI_ERROR(Status) && Size > 0) {
+        Read = (UINTN)MIN(Size, PE_READ_CHUNK);
+        Status = ShellReadFile(File, &Read, Chunk);
+        if (EFI_ERROR(Status))
+            break;
+        if (Read == 0)
+            return EFI_END_OF_FILE;
+        Sha256Update(Ctx, Chunk, Read);
+        Size -= Read;
+    }
+
+    return Status;
+}
+
+
+EFI_STATUS
+PeImageHash( SHELL_FILE_HANDLE File,
+             PE_IMAGE_HASH *Hash )
+{
+    EFI_IMAGE_DOS_HEADER DosHdr;
+    EFI_IMAGE_OPTIONAL_HEADER_UNION Hdr;
+    EFI_IMAGE_SECTION_HEADER *Sections = NULL;
+    EFI_IMAGE_SECTION_HEADER Section;
+    EFI_IMAGE_DATA_DIRECTORY *CertDir;
+    SHA256_CONTEXT Ctx;
+    EFI_STATUS Status;
+    UINT64 FileSize, SumOfBytes;
+    UINT32 PeOffset, CheckSumOffset, CertDirOffset, SizeOfHeaders, NumberOfRvaAndSizes;
+    UINT32 SectionsOffset, NumberOfSections;
+    UINT8 *Chunk = NULL;
+    UINTN i, j;
+
+    ZeroMem(Hash, sizeof(*Hash));
+
+    Status = ShellGetFileSize(File, &FileSize);
+    if (EFI_ERROR(Status))
+        return Status;
+
+    Status = ReadAt(File, 0, &DosHdr, sizeof(DosHdr));
+    if (EFI_ERROR(Status) || DosHdr.e_magic != EFI_IMAGE_DOS_SIGNATURE)
+        return EFI_UNSUPPORTED;
+
+    PeOffset = DosHdr.e_lfanew;
+    if (PeOffset >= FileSize)
+        return EFI_UNSUPPORTED;
+    ZeroMem(&Hdr, sizeof(Hdr));
+    Status = ReadAt(File, PeOffset, &Hdr, (UINTN)MIN(sizeof(Hdr), FileSize - PeOffset));
+    if (EFI_ERROR(Status) || Hdr.Pe32.Signature != EFI_IMAGE_NT_SIGNATURE)
+        return EFI_UNSUPPORTED;
+
+    if (Hdr.Pe32.OptionalHeader.Magic == EFI_IMAGE_NT_OPTIONAL_HDR32_MAGIC) {
+        CheckSumOffset = PeOffset + OFFSET_OF(EFI_IMAGE_NT_HEADERS32, OptionalHeader.CheckSum);
+        CertDirOffset = PeOffset + OFFSET_OF(EFI_IMAGE_NT_HEADERS32, OptionalHeader.DataDirectory) +
+                        EFI_IMAGE_DIRECTORY_ENTRY_SECURITY * sizeof(EFI_IMAGE_DATA_DIRECTORY);
+        CertDir = &Hdr.Pe32.OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_SECURITY];
+        NumberOfRvaAndSizes = Hdr.Pe32.OptionalHeader.NumberOfRvaAndSizes;
+        SizeOfHeaders = Hdr.Pe32.OptionalHeader.SizeOfHeaders;
+    } else if (Hdr.Pe32Plus.OptionalHeader.Magic == EFI_IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
+        CheckSumOffset = PeOffset + OFFSET_OF(EFI_IMAGE_NT_HEADERS64, OptionalHeader.CheckSum);
+        CertDirOffset = PeOffset + OFFSET_OF(EFI_IMAGE_NT_HEADERS64, OptionalHeader.DataDirectory) +
+                        EFI_IMAGE_DIRECTORY_ENTRY_SECURITY * sizeof(EFI_IMAGE_DATA_DIRECTORY);
+        CertDir = &Hdr.Pe32Plus.OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_SECURITY];
+        NumberOfRvaAndSizes = Hdr.Pe32Plus.OptionalHeader.NumberOfRvaAndSizes;
+        SizeOfHeaders = Hdr.Pe32Plus.OptionalHeader.SizeOfHeaders;
+    } else {
+        return EFI_UNSUPPORTED;
+    }
+
+    // images without a certificate table directory hash everything but CheckSum
+    if (NumberOfRvaAndSizes <= EFI_IMAGE_DIRECTORY_ENTRY_SECURITY)
+        CertDir = NULL;
+
+    NumberOfSections = Hdr.Pe32.FileHeader.NumberOfSections;
+    SectionsOffset = PeOffset + sizeof(UINT32) + sizeof(EFI_IMAGE_FILE_HEADER) +
+                     Hdr.Pe32.FileHeader.SizeOfOptionalHeader;
+
+    if (SizeOfHeaders > FileSize || SizeOfHeaders < CertDirOffset + sizeof(EFI_IMAGE_DATA_DIRECTORY) ||
+        (CertDir != NULL && (UINT64)CertDir->VirtualAddress + CertDir->Size > FileSize) ||
+        (UINT64)SectionsOffset + NumberOfSections * sizeof(EFI_IMAGE_SECTION_HEADER) > FileSize)
+        return EFI_VOLUME_CORRUPTED;
+
+    Chunk = AllocatePool(PE_READ_CHUNK);
+    Sections = AllocatePool(MAX(NumberOfSections, 1) * sizeof(EFI_IMAGE_SECTION_HEADER));
+    if (Chunk == NULL || Sections == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto Done;
+    }
+
+    Sha256Init(&Ctx);
+    Status = HashRange(File, &Ctx, Chunk, 0, CheckSumOffset);
+    if (EFI_ERROR(Status))
+        goto Done;
+    if (CertDir != NULL) {
+        Status = HashRange(File, &Ctx, Chunk, CheckSumOffset + sizeof(UINT32),
+                           CertDirOffset - CheckSumOffset - sizeof(UINT32));
+        if (!EFI_ERROR(Status))
+            Status = HashRange(File, &Ctx, Chunk, CertDirOffset + sizeof(EFI_IMAGE_DATA_DIRECTORY),
+                               SizeOfHeaders - CertDirOffset - sizeof(EFI_IMAGE_DATA_DIRECTORY));
+    } else {
+        Status = HashRange(File, &Ctx, Chunk, CheckSumOffset + sizeof(UINT32),
+                           SizeOfHeaders - CheckSumOffset - sizeof(UINT32));
+    }
+    if (EFI_ERROR(Status))
+        goto Done;
+    SumOfBytes = SizeOfHeaders;
+
+    Status = ReadAt(File, SectionsOffset, Sections, NumberOfSections * sizeof(EFI_IMAGE_SECTION_HEADER));
+    if (EFI_ERROR(Status))
+        goto Done;
+
+    // sections are hashed in file order; tables are short so insertion sort
+    for (i = 1; i < NumberOfSections; i++) {
+        Section = Sections[i];
+        for (j = i; j > 0 && Sections[j - 1].PointerToRawData > Section.PointerToRawData; j--)
+            Sections[j] = Sections[j - 1];
+        Sections[j] = Section;
+    }
+
+    for (i = 0; i < NumberOfSections; i++) {
+        if (Sections[i].SizeOfRawData == 0)
+            continue;
+        if ((UINT64)Sections[i].PointerToRawData + Sections[i].SizeOfRawData > FileSize) {
+            Status = EFI_VOLUME_CORRUPTED;
+            goto Done;
+        }
+        Status = HashRange(File, &Ctx, Chunk, Sections[i].PointerToRawData, Sections[i].SizeOfRawData);
+        if (EFI_ERROR(Status))
+            goto Done;
+        SumOfBytes += Sections[i].SizeOfRawData;
+    }
+
+    // trailing data that is not part of the certificate table
+    if (CertDir != NULL && FileSize > SumOfBytes + CertDir->Size) {
+        Status = HashRange(File, &Ctx, Chunk, SumOfBytes, FileSize - CertDir->Size - SumOfBytes);
+        SumOfBytes = FileSize - CertDir->Size;
+    } else if (CertDir == NULL && FileSize > SumOfBytes) {
+        Status = HashRange(File, &Ctx, Chunk, SumOfBytes, FileSize - SumOfBytes);
+        SumOfBytes = FileSize;
+    }
+    if (EFI_ERROR(Status))
+        goto Done;
+
+    Sha256Final(&Ctx, Hash->Digest);
+    Hash->BytesHashed = SumOfBytes;
+
+    if (CertDir != NULL && CertDir->Size >= sizeof(WIN_CERTIFICATE)) {
+        Hash->Signatures = AllocatePool(CertDir->Size);
+        if (Hash->Signatures == NULL) {
+            Status = EFI_OUT_OF_RESOURCES;
+            goto Done;
+        }
+        Status = ReadAt(File, CertDir->VirtualAddress, Hash->Signatures, CertDir->Size);
+        if (EFI_ERROR(Status)) {
+            FreePool(Hash->Signatures);
+            Hash->Signatures = NULL;
+            goto Done;
+        }
+        Hash->SignaturesSize = CertDir->Size;
+    }
+
+Done:
+    if (Chunk != NULL)
+        FreePool(Chunk);
+    if (Sections != NULL)
+        FreePool(Sections);
+
+    return Status;
+}
+
+
+typedef BOOLEAN (*PE_SIGNATURE_VISITOR)(CONST struct pkcs7_message *Msg, UINTN Offset, VOID *Context);
+
+//
+//  Decode each PKCS#7 signature in the attribute certificate table until
+//  Visitor returns TRUE; Offset is where its WIN_CERTIFICATE starts
+//
+static BOOLEAN
+WalkSignatures( PE_IMAGE_HASH *Hash,
+                PE_SIGNATURE_VISITOR Visitor,
+                VOID *Context )
+{
+    struct pkcs7_message *Msg;
+    WIN_CERTIFICATE *Cert;
+    UINTN Offset = 0;
+    BOOLEAN Found = FALSE;
+
+    Msg = AllocatePool(sizeof(*Msg));
+    if (Msg == NULL)
+        return FALSE;
+
+    while (!Found && Hash->SignaturesSize - Offset >= sizeof(WIN_CERTIFICATE)) {
+        Cert = (WIN_CERTIFICATE *)(Hash->Signatures + Offset);
+        if (Cert->dwLength < sizeof(WIN_CERTIFICATE) || Cert->dwLength > Hash->SignaturesSize - Offset)
+            break;
+
+        if (Cert->wCertificateType == WIN_CERT_TYPE_PKCS_SIGNED_DATA &&
+            pkcs7_decode(Msg, (CONST UINT8 *)(Cert + 1), Cert->dwLength - sizeof(WIN_CERTIFICATE)) == 0)
+            Found = Visitor(Msg, Offset, Context);
+
+        // entries are quadword aligned
+        Offset += ALIGN_VALUE(Cert->dwLength, 8);
+    }
+
+    FreePool(Msg);
+
+    return Found;
+}
+
+
+typedef struct {
+    CONST UINT8 *Der;
+    UINTN DerSize;
+    CONST PE_SIGNED_DIGEST *Signed;
+} EMBEDDED_CERT;
+
+
+static BOOLEAN
+EmbedsCertificate( CONST struct pkcs7_message *Msg,
+                   UINTN Offset,
+                   VOID *Context )
+{
+    EMBEDDED_CERT *Wanted = Context;
+    int i;
+
+    if (Wanted->Signed != NULL && Offset != Wanted->Signed->Offset)
+        return FALSE;
+
+    for (i = 0; i < Msg->nr_certs; i++) {
+        if (Msg->certs[i].length == Wanted->DerSize &&
+            CompareMem(PKCS7_SLICE_PTR(Msg, Msg->certs[i]), Wanted->Der, Wanted->DerSize) == 0)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+//
+//  Does a PKCS#7 signature of the image embed this DER certificate?  Any
+//  signature if Signed is NULL, else only the one Signed was taken from.
+//  The signature itself is not verified.
+//
+BOOLEAN
+PeSignatureContains( PE_IMAGE_HASH *Hash,
+                     CONST PE_SIGNED_DIGEST *Signed,
+                     CONST UINT8 *Der,
+                     UINTN DerSize )
+{
+    EMBEDDED_CERT Wanted = { Der, DerSize, Signed };
+
+    if (DerSize == 0)
+        return FALSE;
+
+    return WalkSignatures(Hash, EmbedsCertificate, &Wanted);
+}
+
+
+static BOOLEAN
+CopySignedDigest( CONST struct pkcs7_message *Msg,
+                  UINTN Offset,
+                  VOID *Context )
+{
+    PE_SIGNED_DIGEST *Signed = Context;
+    struct authenticode_content Spc;
+
+    if (authenticode_decode(&Spc, Msg) < 0 || Spc.digest.length > sizeof(Signed->Digest))
+        return FALSE;
+
+    Signed->Offset = Offset;
+    Signed->Algorithm = Spc.digest_algo;
+    Signed->Size = Spc.digest.length;
+    CopyMem(Signed->Digest, PKCS7_SLICE_PTR(Msg, Spc.digest), Signed->Size);
+
+    return TRUE;
+}
+
+
+//
+//  The image digest recorded in the SpcIndirectDataContent of the first
+//  Authenticode signature
+//
+BOOLEAN
+PeSignedDigest( PE_IMAGE_HASH *Hash,
+                PE_SIGNED_DIGEST *Signed )
+{
+    ZeroMem(Signed, sizeof(*Signed));
+
+    return WalkSignatures(Hash, CopySignedDigest, Signed);
+}
+
+
+VOID
+PeImageHashFree( PE_IMAGE_HASH *Hash )
+{
+    if (Hash->Signatures != NULL)
+        FreePool(Hash->Signatures);
+    ZeroMem(Hash, sizeof(*Hash));
+}
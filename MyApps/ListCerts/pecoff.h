@@ -0,0 +1,37 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Authenticode hash of a PE/COFF image file
+//
+//  License: BSD License
+//
+
+#ifndef _PECOFF_H
+#define _PECOFF_H
+
+#include "sha256.h"
+#include "oid_registry.h"
+
+#define PE_READ_CHUNK  SIZE_1MB
+
+typedef struct {
+    UINT8  Digest[SHA256_DIGEST_SIZE];
+    UINT64 BytesHashed;
+    UINT8  *Signatures;          // attribute certificate table, NULL if unsigned
+    UINTN  SignaturesSize;
+} PE_IMAGE_HASH;
+
+typedef struct {
+    UINTN  Offset;               // of its signature in Signatures
+    enum OID Algorithm;
+    UINT8  Digest[64];
+    UINTN  Size;
+} PE_SIGNED_DIGEST;
+
+EFI_STATUS PeImageHash(SHELL_FILE_HANDLE File, PE_IMAGE_HASH *Hash);
+BOOLEAN    PeSignatureContains(PE_IMAGE_HASH *Hash, CONST PE_SIGNED_DIGEST *Signed,
+                               CONST UINT8 *Der, UINTN DerSize);
+BOOLEAN    PeSignedDigest(PE_IMAGE_HASH *Hash, PE_SIGNED_DIGEST *Signed);
+VOID       PeImageHashFree(PE_IMAGE_HASH *Hash);
+
+#endif /* _PECOFF_H */
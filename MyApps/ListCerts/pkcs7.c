@@ -0,0 +1,162 @@
+/*
+ * Automatically generated by ASN1 compiler.  Do not manually edit!
+ *
+ * ASN.1 parser for pkcs7
+ */
+
+#include "asn1_ber_bytecode.h"
+#include "pkcs7.h"
+
+enum pkcs7_actions {
+	ACT_do_pkcs7_algorithm = 0,
+	ACT_do_pkcs7_certificate = 1,
+	ACT_do_pkcs7_digest_algo = 2,
+	ACT_do_pkcs7_inner_content = 3,
+	ACT_do_pkcs7_inner_type = 4,
+	ACT_do_pkcs7_sig_algo = 5,
+	ACT_do_pkcs7_signature = 6,
+	ACT_do_pkcs7_signer = 7,
+	ACT_do_pkcs7_signer_issuer = 8,
+	ACT_do_pkcs7_signer_serial = 9,
+	ACT_do_pkcs7_signer_skid = 10,
+	ACT_do_pkcs7_version = 11,
+	NR__pkcs7_actions = 12
+};
+
+static const asn1_action_t pkcs7_action_table[NR__pkcs7_actions] = {
+	[   0] = do_pkcs7_algorithm,
+	[   1] = do_pkcs7_certificate,
+	[   2] = do_pkcs7_digest_algo,
+	[   3] = do_pkcs7_inner_content,
+	[   4] = do_pkcs7_inner_type,
+	[   5] = do_pkcs7_sig_algo,
+	[   6] = do_pkcs7_signature,
+	[   7] = do_pkcs7_signer,
+	[   8] = do_pkcs7_signer_issuer,
+	[   9] = do_pkcs7_signer_serial,
+	[  10] = do_pkcs7_signer_skid,
+	[  11] = do_pkcs7_version,
+};
+
+static const unsigned char pkcs7_machine[] = {
+	// SignedData
+	[   0] = ASN1_OP_MATCH,
+	[   1] = _tag(UNIV, CONS, SEQ),
+	[   2] =  ASN1_OP_MATCH_ACT,		// version
+	[   3] =  _tag(UNIV, PRIM, INT),
+	[   4] =  _action(ACT_do_pkcs7_version),
+	[   5] =  ASN1_OP_MATCH,		// digestAlgorithms
+	[   6] =  _tag(UNIV, CONS, SET),
+	// AlgorithmIdentifier
+	[   7] =   ASN1_OP_MATCH_JUMP,
+	[   8] =   _tag(UNIV, CONS, SEQ),
+	[   9] =   _jump_target(65),		// --> AlgorithmIdentifier
+	[  10] =  ASN1_OP_END_SET_OF,
+	[  11] =  _jump_target(7),
+	// ContentInfo
+	[  12] =  ASN1_OP_MATCH,
+	[  13] =  _tag(UNIV, CONS, SEQ),
+	[  14] =   ASN1_OP_MATCH_ACT,		// contentType
+	[  15] =   _tag(UNIV, PRIM, OID),
+	[  16] =   _action(ACT_do_pkcs7_inner_type),
+	[  17] =   ASN1_OP_MATCH_JUMP_OR_SKIP,		// content
+	[  18] =   _tagn(CONT, CONS,  0),
+	[  19] =   _jump_target(71),
+	[  20] =  ASN1_OP_END_SEQ,
+	// Certificates
+	[  21] =  ASN1_OP_MATCH_JUMP_OR_SKIP,
+	[  22] =  _tagn(CONT, CONS,  0),
+	[  23] =  _jump_target(75),		// --> Certificates
+	// CertificateRevocationLists
+	[  24] =  ASN1_OP_MATCH_JUMP_OR_SKIP,
+	[  25] =  _tagn(CONT, CONS,  1),
+	[  26] =  _jump_target(80),		// --> CertificateRevocationLists
+	[  27] =  ASN1_OP_MATCH,		// signerInfos
+	[  28] =  _tag(UNIV, CONS, SET),
+	// SignerInfo
+	[  29] =   ASN1_OP_MATCH,
+	[  30] =   _tag(UNIV, CONS, SEQ),
+	[  31] =    ASN1_OP_MATCH_ACT,		// version
+	[  32] =    _tag(UNIV, PRIM, INT),
+	[  33] =    _action(ACT_do_pkcs7_signer),
+	// SignerIdentifier
+	// IssuerAndSerialNumber
+	[  34] =    ASN1_OP_MATCH_JUMP_OR_SKIP,
+	[  35] =    _tag(UNIV, CONS, SEQ),
+	[  36] =    _jump_target(84),		// --> IssuerAndSerialNumber
+	[  37] =    ASN1_OP_COND_MATCH_ACT_OR_SKIP,		// subjectKeyIdentifier
+	[  38] =    _tagn(CONT, PRIM,  0),
+	[  39] =    _action(ACT_do_pkcs7_signer_skid),
+	[  40] =    ASN1_OP_COND_FAIL,
+	// AlgorithmIdentifier
+	[  41] =    ASN1_OP_MATCH_JUMP,
+	[  42] =    _tag(UNIV, CONS, SEQ),
+	[  43] =    _jump_target(65),		// --> AlgorithmIdentifier
+	[  44] =    ASN1_OP_ACT,
+	[  45] =    _action(ACT_do_pkcs7_digest_algo),
+	// Attributes
+	[  46] =    ASN1_OP_MATCH_JUMP_OR_SKIP,
+	[  47] =    _tagn(CONT, CONS,  0),
+	[  48] =    _jump_target(91),		// --> Attributes
+	// AlgorithmIdentifier
+	[  49] =    ASN1_OP_MATCH_JUMP,
+	[  50] =    _tag(UNIV, CONS, SEQ),
+	[  51] =    _jump_target(65),		// --> AlgorithmIdentifier
+	[  52] =    ASN1_OP_ACT,
+	[  53] =    _action(ACT_do_pkcs7_sig_algo),
+	[  54] =    ASN1_OP_MATCH_ACT,		// encryptedDigest
+	[  55] =    _tag(UNIV, PRIM, OTS),
+	[  56] =    _action(ACT_do_pkcs7_signature),
+	// Attributes
+	[  57] =    ASN1_OP_MATCH_JUMP_OR_SKIP,
+	[  58] =    _tagn(CONT, CONS,  1),
+	[  59] =    _jump_target(91),		// --> Attributes
+	[  60] =   ASN1_OP_END_SEQ,
+	[  61] =  ASN1_OP_END_SET_OF,
+	[  62] =  _jump_target(29),
+	[  63] = ASN1_OP_END_SEQ,
+	[  64] = ASN1_OP_COMPLETE,
+
+	[  65] =  ASN1_OP_MATCH_ACT,		// algorithm
+	[  66] =  _tag(UNIV, PRIM, OID),
+	[  67] =  _action(ACT_do_pkcs7_algorithm),
+	[  68] =  ASN1_OP_MATCH_ANY,		// parameters
+	[  69] = ASN1_OP_END_SEQ,
+	[  70] = ASN1_OP_RETURN,
+
+	[  71] =  ASN1_OP_MATCH_ANY_ACT,
+	[  72] =  _action(ACT_do_pkcs7_inner_content),
+	[  73] = ASN1_OP_END_SEQ,
+	[  74] = ASN1_OP_RETURN,
+
+	// Certificate
+	[  75] =  ASN1_OP_MATCH_ANY_ACT,
+	[  76] =  _action(ACT_do_pkcs7_certificate),
+	[  77] = ASN1_OP_END_SET_OF,
+	[  78] = _jump_target(75),
+	[  79] = ASN1_OP_RETURN,
+
+	[  80] =  ASN1_OP_MATCH_ANY,
+	[  81] = ASN1_OP_END_SET_OF,
+	[  82] = _jump_target(80),
+	[  83] = ASN1_OP_RETURN,
+
+	[  84] =  ASN1_OP_MATCH_ANY_ACT,		// issuer
+	[  85] =  _action(ACT_do_pkcs7_signer_issuer),
+	[  86] =  ASN1_OP_MATCH_ACT,		// serialNumber
+	[  87] =  _tag(UNIV, PRIM, INT),
+	[  88] =  _action(ACT_do_pkcs7_signer_serial),
+	[  89] = ASN1_OP_END_SEQ,
+	[  90] = ASN1_OP_RETURN,
+
+	[  91] =  ASN1_OP_MATCH_ANY,
+	[  92] = ASN1_OP_END_SET_OF,
+	[  93] = _jump_target(91),
+	[  94] = ASN1_OP_RETURN,
+};
+
+const struct asn1_decoder pkcs7_decoder = {
+	.machine = pkcs7_machine,
+	.machlen = sizeof(pkcs7_machine),
+	.actions = pkcs7_action_table,
+};
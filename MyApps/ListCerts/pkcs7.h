@@ -0,0 +1,23 @@
+/*
+ * Automatically generated by ASN1 compiler.  Do not manually edit!
+ *
+ * ASN.1 parser for pkcs7
+ */
+
+#include "asn1_ber_bytecode.h"
+
+extern const struct asn1_decoder pkcs7_decoder;
+
+extern int do_pkcs7_algorithm(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_certificate(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_digest_algo(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_inner_content(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_inner_type(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_sig_algo(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_signature(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_signer(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_signer_issuer(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_signer_serial(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_signer_skid(void *, long, unsigned char, const void *, long);
+extern int do_pkcs7_version(void *, long, unsigned char, const void *, long);
+
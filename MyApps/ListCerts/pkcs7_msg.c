@@ -0,0 +1,337 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Actions for the pkcs7 decoder.  Like the x509 actions they only record
+ *  where each field lives in the DER buffer.
+ *
+ */
+
+#include <errno.h>
+
+#include <Uefi.h>
+#include <Library/UefiLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/OutputLib.h>
+
+#include "pkcs7.h"
+#include "pkcs7_msg.h"
+
+
+static void
+set_slice( struct pkcs7_message *msg,
+           struct x509_slice *slice,
+           const void *value,
+           long vlen )
+{
+    slice->offset = (unsigned int)((const unsigned char *)value - msg->data);
+    slice->length = (unsigned int)vlen;
+}
+
+
+static struct pkcs7_signer *
+current_signer( struct pkcs7_message *msg )
+{
+    if (msg->nr_signers == 0 || msg->skip_signer)
+        return NULL;
+
+    return &msg->signers[msg->nr_signers - 1];
+}
+
+
+/*
+ * Offset of the SignedData.  Authenticode signatures wrap it in a
+ * ContentInfo; authenticated variables hold it bare.
+ *
+ *     ContentInfo ::= SEQUENCE {
+ *         contentType   OBJECT IDENTIFIER,
+ *         content       [0] EXPLICIT SignedData }
+ */
+static int
+signed_data_offset( const unsigned char *data,
+                    size_t datalen,
+                    size_t *offset )
+{
+    size_t dp = 0, len;
+    unsigned char tag;
+
+    *offset = 0;
+    if (asn1_read_header(data, datalen, &dp, &tag, &len) < 0 || tag != (ASN1_CONS_BIT | ASN1_SEQ))
+        return -EBADMSG;
+    if (dp < datalen && data[dp] == ASN1_INT)
+        return 0;
+
+    if (asn1_read_header(data, datalen, &dp, &tag, &len) < 0 || tag != ASN1_OID)
+        return -EBADMSG;
+    if (Lookup_OID(data + dp, len) != OID_signed_data) {
+        OutPrint(L"ERROR: PKCS7 content is not SignedData\n");
+        return -EBADMSG;
+    }
+    dp += len;
+
+    if (asn1_read_header(data, datalen, &dp, &tag, &len) < 0 ||
+        tag != ((ASN1_CONT << 6) | ASN1_CONS_BIT | 0))
+        return -EBADMSG;
+    *offset = dp;
+
+    return 0;
+}
+
+
+int
+pkcs7_decode( struct pkcs7_message *msg,
+              const unsigned char *data,
+              size_t datalen )
+{
+    size_t offset;
+    int ret;
+
+    ZeroMem(msg, sizeof(*msg));
+    msg->data = data;
+    msg->length = datalen;
+    msg->content_type = OID__NR;
+
+    ret = signed_data_offset(data, datalen, &offset);
+    if (ret < 0)
+        return ret;
+
+    return asn1_ber_decoder(&pkcs7_decoder, msg, data + offset, datalen - offset);
+}
+
+
+/*
+ * Find the embedded certificate of a signer by issuer and serial number,
+ * leaving it decoded in cert.  Returns its index in certs[], or -1.
+ */
+int
+pkcs7_signer_certificate( const struct pkcs7_message *msg,
+                          unsigned int signer,
+                          struct x509_certificate *cert )
+{
+    const struct pkcs7_signer *sinfo;
+    int i;
+
+    if (signer >= msg->nr_signers)
+        return -1;
+    sinfo = &msg->signers[signer];
+
+    for (i = 0; i < msg->nr_certs; i++) {
+        if (x509_decode(cert, PKCS7_SLICE_PTR(msg, msg->certs[i]), msg->certs[i].length) < 0)
+            continue;
+
+        if (sinfo->serial.length > 0 &&
+            sinfo->serial.length == cert->serial.length &&
+            sinfo->issuer.length == cert->issuer.raw.length &&
+            CompareMem(PKCS7_SLICE_PTR(msg, sinfo->serial), X509_SLICE_PTR(cert, cert->serial),
+                       sinfo->serial.length) == 0 &&
+            CompareMem(PKCS7_SLICE_PTR(msg, sinfo->issuer), X509_SLICE_PTR(cert, cert->issuer.raw),
+                       sinfo->issuer.length) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+
+int
+do_pkcs7_version( void *context,
+                  long hdrlen,
+                  unsigned char tag,
+                  const void *value,
+                  long vlen )
+{
+    struct pkcs7_message *msg = context;
+
+    set_slice(msg, &msg->version, value, vlen);
+
+    return 0;
+}
+
+
+int
+do_pkcs7_algorithm( void *context,
+                    long hdrlen,
+                    unsigned char tag,
+                    const void *value,
+                    long vlen )
+{
+    struct pkcs7_message *msg = context;
+
+    msg->last_algo.oid = Lookup_OID(value, vlen);
+    set_slice(msg, &msg->last_algo.id, value, vlen);
+
+    return 0;
+}
+
+
+int
+do_pkcs7_inner_type( void *context,
+                     long hdrlen,
+                     unsigned char tag,
+                     const void *value,
+                     long vlen )
+{
+    struct pkcs7_message *msg = context;
+
+    msg->content_type = Lookup_OID(value, vlen);
+
+    return 0;
+}
+
+
+int
+do_pkcs7_inner_content( void *context,
+                        long hdrlen,
+                        unsigned char tag,
+                        const void *value,
+                        long vlen )
+{
+    struct pkcs7_message *msg = context;
+
+    set_slice(msg, &msg->content, (const unsigned char *)value - hdrlen, vlen + hdrlen);
+
+    return 0;
+}
+
+
+int
+do_pkcs7_certificate( void *context,
+                      long hdrlen,
+                      unsigned char tag,
+                      const void *value,
+                      long vlen )
+{
+    struct pkcs7_message *msg = context;
+
+    if (msg->nr_certs >= PKCS7_MAX_CERTS) {
+        msg->truncated = 1;
+        return 0;
+    }
+
+    set_slice(msg, &msg->certs[msg->nr_certs++], (const unsigned char *)value - hdrlen, vlen + hdrlen);
+
+    return 0;
+}
+
+
+int
+do_pkcs7_signer( void *context,
+                 long hdrlen,
+                 unsigned char tag,
+                 const void *value,
+                 long vlen )
+{
+    struct pkcs7_message *msg = context;
+
+    if (msg->nr_signers >= PKCS7_MAX_SIGNERS) {
+        msg->truncated = 1;
+        msg->skip_signer = 1;
+        return 0;
+    }
+
+    msg->nr_signers++;
+
+    return 0;
+}
+
+
+int
+do_pkcs7_signer_issuer( void *context,
+                        long hdrlen,
+                        unsigned char tag,
+                        const void *value,
+                        long vlen )
+{
+    struct pkcs7_message *msg = context;
+    struct pkcs7_signer *signer = current_signer(msg);
+
+    if (signer != NULL)
+        set_slice(msg, &signer->issuer, value, vlen);
+
+    return 0;
+}
+
+
+int
+do_pkcs7_signer_serial( void *context,
+                        long hdrlen,
+                        unsigned char tag,
+                        const void *value,
+                        long vlen )
+{
+    struct pkcs7_message *msg = context;
+    struct pkcs7_signer *signer = current_signer(msg);
+
+    if (signer != NULL)
+        set_slice(msg, &signer->serial, value, vlen);
+
+    return 0;
+}
+
+
+int
+do_pkcs7_signer_skid( void *context,
+                      long hdrlen,
+                      unsigned char tag,
+                      const void *value,
+                      long vlen )
+{
+    struct pkcs7_message *msg = context;
+    struct pkcs7_signer *signer = current_signer(msg);
+
+    if (signer != NULL)
+        set_slice(msg, &signer->skid, value, vlen);
+
+    return 0;
+}
+
+
+int
+do_pkcs7_digest_algo( void *context,
+                      long hdrlen,
+                      unsigned char tag,
+                      const void *value,
+                      long vlen )
+{
+    struct pkcs7_message *msg = context;
+    struct pkcs7_signer *signer = current_signer(msg);
+
+    if (signer != NULL)
+        signer->digest_algo = msg->last_algo;
+
+    return 0;
+}
+
+
+int
+do_pkcs7_sig_algo( void *context,
+                   long hdrlen,
+                   unsigned char tag,
+                   const void *value,
+                   long vlen )
+{
+    struct pkcs7_message *msg = context;
+    struct pkcs7_signer *signer = current_signer(msg);
+
+    if (signer != NULL)
+        signer->sig_algo = msg->last_algo;
+
+    return 0;
+}
+
+
+int
+do_pkcs7_signature( void *context,
+                    long hdrlen,
+                    unsigned char tag,
+                    const void *value,
+                    long vlen )
+{
+    struct pkcs7_message *msg = context;
+    struct pkcs7_signer *signer = current_signer(msg);
+
+    if (signer != NULL)
+        set_slice(msg, &signer->signature, value, vlen);
+
+    return 0;
+}
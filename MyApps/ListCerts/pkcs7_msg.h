@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Parsed form of a PKCS#7 SignedData message.  As with x509_cert.h,
+ *  every field is an (offset, length) slice into the DER buffer handed
+ *  to pkcs7_decode().
+ *
+ */
+
+#ifndef _PKCS7_MSG_H
+#define _PKCS7_MSG_H
+
+#include "x509_cert.h"
+
+#define PKCS7_MAX_CERTS      16
+#define PKCS7_MAX_SIGNERS    4
+
+struct pkcs7_signer {
+    struct x509_slice issuer;        /* Name contents, excluding header */
+    struct x509_slice serial;
+    struct x509_slice skid;          /* CMS subjectKeyIdentifier form */
+    struct x509_algorithm digest_algo;
+    struct x509_algorithm sig_algo;
+    struct x509_slice signature;
+};
+
+struct pkcs7_message {
+    const unsigned char *data;       /* DER encoded message */
+    size_t length;
+
+    struct x509_slice version;
+    enum OID content_type;           /* of the signed content */
+    struct x509_slice content;       /* signed content, header included */
+
+    unsigned char nr_certs;
+    unsigned char nr_signers;
+    unsigned char truncated;         /* certs[] or signers[] overflowed */
+    unsigned char skip_signer;       /* current SignerInfo did not fit */
+    struct x509_algorithm last_algo; /* AlgorithmIdentifier awaiting its owner */
+
+    struct x509_slice certs[PKCS7_MAX_CERTS];    /* header included */
+    struct pkcs7_signer signers[PKCS7_MAX_SIGNERS];
+};
+
+#define PKCS7_SLICE_PTR(msg, slice)  ((msg)->data + (slice).offset)
+
+extern int pkcs7_decode(struct pkcs7_message *msg,
+                        const unsigned char *data,
+                        size_t datalen);
+extern int pkcs7_signer_certificate(const struct pkcs7_message *msg,
+                                    unsigned int signer,
+                                    struct x509_certificate *cert);
+
+#endif /* _PKCS7_MSG_H */
@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Actions for the rsapubkey and ecparams decoders, and the key size of
+ *  a decoded certificate.
+ *
+ */
+
+#include <errno.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+
+#include "rsapubkey.h"
+#include "ecparams.h"
+#include "public_key.h"
+
+static const struct {
+    enum OID curve;
+    unsigned int bits;
+} named_curves[] = {
+    { OID_id_prime192v1, 192 },
+    { OID_id_secp224r1,  224 },
+    { OID_id_prime256v1, 256 },
+    { OID_id_secp384r1,  384 },
+    { OID_id_secp521r1,  521 },
+};
+
+
+/*
+ * Significant bits of an unsigned big-endian INTEGER
+ */
+unsigned int
+integer_bits( const unsigned char *data,
+              size_t len )
+{
+    unsigned int bits;
+    unsigned char top;
+
+    while (len > 0 && *data == 0) {
+        data++;
+        len--;
+    }
+    if (len == 0)
+        return 0;
+
+    for (bits = 0, top = *data; top != 0; top >>= 1)
+        bits++;
+
+    return (unsigned int)(len - 1) * 8 + bits;
+}
+
+
+int
+do_rsa_modulus( void *context,
+                long hdrlen,
+                unsigned char tag,
+                const void *value,
+                long vlen )
+{
+    struct x509_public_key *key = context;
+
+    key->bits = integer_bits(value, vlen);
+
+    return 0;
+}
+
+
+int
+do_rsa_exponent( void *context,
+                 long hdrlen,
+                 unsigned char tag,
+                 const void *value,
+                 long vlen )
+{
+    struct x509_public_key *key = context;
+    const unsigned char *p = value;
+    long i;
+
+    key->exponent = 0;
+    if (integer_bits(value, vlen) > sizeof(key->exponent) * 8)
+        return 0;
+    for (i = 0; i < vlen; i++)
+        key->exponent = (key->exponent << 8) | p[i];
+
+    return 0;
+}
+
+
+int
+do_ec_named_curve( void *context,
+                   long hdrlen,
+                   unsigned char tag,
+                   const void *value,
+                   long vlen )
+{
+    struct x509_public_key *key = context;
+    size_t i;
+
+    key->curve = Lookup_OID(value, vlen);
+    for (i = 0; i < ARRAY_SIZE(named_curves); i++) {
+        if (named_curves[i].curve == key->curve)
+            key->bits = named_curves[i].bits;
+    }
+
+    return 0;
+}
+
+
+int
+do_ec_order( void *context,
+             long hdrlen,
+             unsigned char tag,
+             const void *value,
+             long vlen )
+{
+    struct x509_public_key *key = context;
+
+    key->bits = integer_bits(value, vlen);
+
+    return 0;
+}
+
+
+/*
+ * Work out the key type and size.  Returns -ENOTSUP for key algorithms
+ * other than RSA and EC, -EBADMSG if the key does not decode.
+ */
+int
+x509_public_key( const struct x509_certificate *cert,
+                 struct x509_public_key *key )
+{
+    const unsigned char *p = X509_SLICE_PTR(cert, cert->pub_key);
+    size_t len = cert->pub_key.length;
+    int ret;
+
+    ZeroMem(key, sizeof(*key));
+    key->algo = cert->pub_key_algo.oid;
+    key->curve = OID__NR;
+
+    /* the BIT STRING contents start with the count of unused bits */
+    if (len < 2 || p[0] != 0)
+        return -EBADMSG;
+
+    switch (key->algo) {
+    case OID_rsaEncryption:
+        return asn1_ber_decoder(&rsapubkey_decoder, key, p + 1, len - 1);
+
+    case OID_id_ecPublicKey:
+        if (cert->pub_key_algo.params.length > 0) {
+            ret = asn1_ber_decoder(&ecparams_decoder, key,
+                                   X509_SLICE_PTR(cert, cert->pub_key_algo.params),
+                                   cert->pub_key_algo.params.length);
+            if (ret < 0)
+                return ret;
+        }
+        /* unknown curve: an uncompressed point is 04 || X || Y */
+        if (key->bits == 0 && p[1] == 0x04)
+            key->bits = (unsigned int)(len - 2) / 2 * 8;
+        return 0;
+
+    default:
+        return -ENOTSUP;
+    }
+}
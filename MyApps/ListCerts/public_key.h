@@ -0,0 +1,26 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Type and size of a certificate's public key.  RSA keys are decoded
+ *  with the rsapubkey grammar, EC domain parameters with ecparams.
+ *
+ */
+
+#ifndef _PUBLIC_KEY_H
+#define _PUBLIC_KEY_H
+
+#include "x509_cert.h"
+
+struct x509_public_key {
+    enum OID algo;                   /* rsaEncryption, id_ecPublicKey, ... */
+    enum OID curve;                  /* EC named curve, OID__NR if none */
+    unsigned int bits;               /* modulus or group order, 0 if unknown */
+    unsigned long exponent;          /* RSA public exponent, 0 if too large */
+};
+
+extern int x509_public_key(const struct x509_certificate *cert,
+                           struct x509_public_key *key);
+extern unsigned int integer_bits(const unsigned char *data,
+                                 size_t len);
+
+#endif /* _PUBLIC_KEY_H */
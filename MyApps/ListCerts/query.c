@@ -0,0 +1,430 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Certificate queries.  --select takes a comma separated list of field
+ *  names, --where a single comparison such as
+ *
+ *      notAfter<2027-01-01     subject~microsoft     publicKey<2048
+ *
+ *  Every --where condition of a query has to hold.
+ *
+ */
+
+#include <errno.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+
+#include "query.h"
+#include "public_key.h"
+#include "sha256.h"
+
+#define KIND_NUMBER     0            /* compared as an integer */
+#define KIND_DATE       1            /* YYYY-MM-DD [hh:mm[:ss]] */
+#define KIND_BYTES      2            /* hex, colons allowed */
+#define KIND_NAME       3            /* any attribute value of a Name */
+#define KIND_ALGORITHM  4            /* OID registry name */
+#define KIND_EXTENSION  5            /* any extension name */
+
+static const struct {
+    const char *name;
+    unsigned int field;
+    unsigned char kind;
+} query_fields[] = {
+    { "version",     X509_VERSION,     KIND_NUMBER },
+    { "serial",      X509_SERIAL,      KIND_BYTES },
+    { "sigAlg",      X509_SIG_ALGO,    KIND_ALGORITHM },
+    { "issuer",      X509_ISSUER,      KIND_NAME },
+    { "notBefore",   X509_NOT_BEFORE,  KIND_DATE },
+    { "notAfter",    X509_NOT_AFTER,   KIND_DATE },
+    { "subject",     X509_SUBJECT,     KIND_NAME },
+    { "fingerprint", X509_FINGERPRINT, KIND_BYTES },
+    { "keyAlg",      X509_KEY_ALGO,    KIND_ALGORITHM },
+    { "publicKey",   X509_PUBLIC_KEY,  KIND_NUMBER },     /* key size in bits */
+    { "extensions",  X509_EXTENSIONS,  KIND_EXTENSION },
+};
+
+
+static int
+lookup_field( const char *name,
+              size_t len )
+{
+    size_t i, n;
+
+    for (i = 0; i < ARRAY_SIZE(query_fields); i++) {
+        for (n = 0; n < len && query_fields[i].name[n] == name[n]; n++)
+            ;
+        if (n == len && query_fields[i].name[n] == '\0')
+            return (int)i;
+    }
+
+    return -1;
+}
+
+
+static int
+is_digit( char c )
+{
+    return c >= '0' && c <= '9';
+}
+
+
+static char
+to_lower( char c )
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+
+static void
+update_decode( struct x509_query *query )
+{
+    int i;
+
+    query->decode = query->select;
+    for (i = 0; i < query->nr_conditions; i++)
+        query->decode |= query->conditions[i].field;
+}
+
+
+void
+x509_query_init( struct x509_query *query )
+{
+    ZeroMem(query, sizeof(*query));
+    query->select = X509_ALL_FIELDS;
+    update_decode(query);
+}
+
+
+int
+x509_query_select( struct x509_query *query,
+                   const char *list )
+{
+    unsigned int select = 0;
+    const char *end;
+    int i;
+
+    for (;;) {
+        for (end = list; *end != '\0' && *end != ','; end++)
+            ;
+        if (end - list == 3 && list[0] == 'a' && list[1] == 'l' && list[2] == 'l') {
+            select |= X509_ALL_FIELDS;
+        } else {
+            i = lookup_field(list, (size_t)(end - list));
+            if (i < 0)
+                return -EINVAL;
+            select |= query_fields[i].field;
+        }
+        if (*end == '\0')
+            break;
+        list = end + 1;
+    }
+
+    query->select = select;
+    update_decode(query);
+
+    return 0;
+}
+
+
+/*
+ * A date given as YYYY-MM-DD, optionally followed by hh:mm or hh:mm:ss,
+ * becomes a packed UTC time.  Separators are not checked.
+ */
+static int
+parse_date( const char *s,
+            UINT64 *date )
+{
+    unsigned int digits = 0, i, part[6] = { 0 };
+
+    for (; *s != '\0'; s++) {
+        if (is_digit(*s)) {
+            if (digits >= 14)
+                return -EINVAL;
+            /* YYYY then two digits per field */
+            i = (digits < 4) ? 0 : (digits - 2) / 2;
+            part[i] = part[i] * 10 + (unsigned int)(*s - '0');
+            digits++;
+        } else if (*s != '-' && *s != ':' && *s != ' ' && *s != 'T' && *s != 'Z') {
+            return -EINVAL;
+        }
+    }
+    if (digits != 8 && digits != 12 && digits != 14)
+        return -EINVAL;
+    if (part[1] < 1 || part[1] > 12 || part[2] < 1 || part[2] > 31 ||
+        part[3] > 23 || part[4] > 59 || part[5] > 59)
+        return -EINVAL;
+
+    *date = X509_TIME(part[0], part[1], part[2], part[3], part[4], part[5]);
+    return 0;
+}
+
+
+static int
+parse_hex( const char *s,
+           struct x509_condition *cond )
+{
+    unsigned int nibbles = 0;
+    unsigned char v;
+
+    for (; *s != '\0'; s++) {
+        if (*s == ':' || *s == ' ')
+            continue;
+        if (is_digit(*s))
+            v = (unsigned char)(*s - '0');
+        else if (to_lower(*s) >= 'a' && to_lower(*s) <= 'f')
+            v = (unsigned char)(to_lower(*s) - 'a' + 10);
+        else
+            return -EINVAL;
+        if (nibbles / 2 >= X509_MAX_VALUE)
+            return -EINVAL;
+        if (nibbles % 2 == 0)
+            cond->value[nibbles / 2] = (char)(v << 4);
+        else
+            cond->value[nibbles / 2] |= (char)v;
+        nibbles++;
+    }
+    if (nibbles == 0 || nibbles % 2)
+        return -EINVAL;
+
+    cond->length = nibbles / 2;
+    return 0;
+}
+
+
+int
+x509_query_where( struct x509_query *query,
+                  const char *expr )
+{
+    struct x509_condition *cond;
+    const char *name, *end;
+    char text[X509_MAX_VALUE];
+    int i, kind;
+
+    if (query->nr_conditions >= X509_MAX_CONDITIONS)
+        return -EINVAL;
+    cond = &query->conditions[query->nr_conditions];
+    ZeroMem(cond, sizeof(*cond));
+
+    for (; *expr == ' '; expr++)
+        ;
+    for (name = expr; (*expr >= 'a' && *expr <= 'z') || (*expr >= 'A' && *expr <= 'Z'); expr++)
+        ;
+    i = lookup_field(name, (size_t)(expr - name));
+    if (i < 0)
+        return -EINVAL;
+    cond->field = query_fields[i].field;
+    kind = query_fields[i].kind;
+
+    for (; *expr == ' '; expr++)
+        ;
+    switch (*expr++) {
+    case '=':
+        cond->op = X509_EQ;
+        break;
+    case '~':
+        cond->op = X509_CONTAINS;
+        break;
+    case '!':
+        if (*expr++ != '=')
+            return -EINVAL;
+        cond->op = X509_NE;
+        break;
+    case '<':
+        cond->op = (*expr == '=') ? X509_LE : X509_LT;
+        expr += (*expr == '=');
+        break;
+    case '>':
+        cond->op = (*expr == '=') ? X509_GE : X509_GT;
+        expr += (*expr == '=');
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    /* ordering for numbers and dates, ~ for text only */
+    if (cond->op >= X509_LT && cond->op <= X509_GE && kind != KIND_NUMBER && kind != KIND_DATE)
+        return -EINVAL;
+    if (cond->op == X509_CONTAINS && (kind == KIND_NUMBER || kind == KIND_DATE || kind == KIND_BYTES))
+        return -EINVAL;
+
+    for (; *expr == ' '; expr++)
+        ;
+    for (end = expr; *end != '\0'; end++)
+        ;
+    for (; end > expr && end[-1] == ' '; end--)
+        ;
+    if (end == expr || end - expr >= X509_MAX_VALUE)
+        return -EINVAL;
+    ZeroMem(text, sizeof(text));
+    CopyMem(text, expr, (UINTN)(end - expr));
+
+    switch (kind) {
+    case KIND_NUMBER:
+        for (cond->number = 0; expr < end; expr++) {
+            if (!is_digit(*expr))
+                return -EINVAL;
+            cond->number = cond->number * 10 + (UINT64)(*expr - '0');
+        }
+        break;
+    case KIND_DATE:
+        if (parse_date(text, &cond->number) < 0)
+            return -EINVAL;
+        break;
+    case KIND_BYTES:
+        if (parse_hex(text, cond) < 0)
+            return -EINVAL;
+        break;
+    default:
+        CopyMem(cond->value, text, sizeof(text));
+        cond->length = (unsigned int)(end - expr);
+        break;
+    }
+
+    query->nr_conditions++;
+    update_decode(query);
+
+    return 0;
+}
+
+
+static int
+compare_number( enum x509_op op,
+                UINT64 a,
+                UINT64 b )
+{
+    switch (op) {
+    case X509_EQ: return a == b;
+    case X509_NE: return a != b;
+    case X509_LT: return a < b;
+    case X509_LE: return a <= b;
+    case X509_GT: return a > b;
+    case X509_GE: return a >= b;
+    default:      return 0;
+    }
+}
+
+
+/*
+ * Does text equal, or with X509_CONTAINS contain, the condition value?
+ */
+static int
+text_matches( const struct x509_condition *cond,
+              const char *text,
+              size_t len )
+{
+    size_t i, n;
+
+    if (cond->op != X509_CONTAINS)
+        return len == cond->length && CompareMem(text, cond->value, len) == 0;
+
+    for (i = 0; i + cond->length <= len; i++) {
+        for (n = 0; n < cond->length && to_lower(text[i + n]) == to_lower(cond->value[n]); n++)
+            ;
+        if (n == cond->length)
+            return 1;
+    }
+
+    return 0;
+}
+
+
+static int
+name_matches( const struct x509_condition *cond,
+              const CHAR16 *name )
+{
+    char text[X509_MAX_VALUE * 2];
+    size_t len;
+
+    if (name == NULL)
+        return 0;
+    for (len = 0; name[len] != 0 && len < sizeof(text); len++)
+        text[len] = (char)name[len];
+
+    return text_matches(cond, text, len);
+}
+
+
+static int
+condition_matches( const struct x509_condition *cond,
+                   const struct x509_certificate *cert )
+{
+    const struct x509_name *name;
+    const struct x509_attribute *attr;
+    struct x509_public_key key;
+    unsigned char digest[SHA256_DIGEST_SIZE];
+    UINT64 value;
+    int i, found = 0;
+
+    switch (cond->field) {
+    case X509_VERSION:
+        value = 1;
+        if (cert->version.length > 0)
+            value += *X509_SLICE_PTR(cert, cert->version);
+        return compare_number(cond->op, value, cond->number);
+
+    case X509_PUBLIC_KEY:
+        if (x509_public_key(cert, &key) < 0 || key.bits == 0)
+            return 0;
+        return compare_number(cond->op, key.bits, cond->number);
+
+    case X509_NOT_BEFORE:
+    case X509_NOT_AFTER:
+        value = (cond->field == X509_NOT_BEFORE) ? cert->valid_from : cert->valid_to;
+        return value != 0 && compare_number(cond->op, value, cond->number);
+
+    case X509_SERIAL:
+        found = cert->serial.length == cond->length &&
+                CompareMem(X509_SLICE_PTR(cert, cert->serial), cond->value, cond->length) == 0;
+        break;
+
+    case X509_FINGERPRINT:
+        Sha256(cert->data, cert->length, digest);
+        found = cond->length == sizeof(digest) && CompareMem(digest, cond->value, sizeof(digest)) == 0;
+        break;
+
+    case X509_ISSUER:
+    case X509_SUBJECT:
+        name = (cond->field == X509_ISSUER) ? &cert->issuer : &cert->subject;
+        attr = &cert->attrs[name->first];
+        for (i = 0; i < name->count && !found; i++, attr++)
+            found = text_matches(cond, (const char *)X509_SLICE_PTR(cert, attr->value), attr->value.length);
+        break;
+
+    case X509_SIG_ALGO:
+        found = name_matches(cond, OID_Name(cert->sig_algo.oid));
+        break;
+
+    case X509_KEY_ALGO:
+        found = name_matches(cond, OID_Name(cert->pub_key_algo.oid));
+        break;
+
+    case X509_EXTENSIONS:
+        for (i = 0; i < cert->nr_extensions && !found; i++)
+            found = name_matches(cond, OID_Name(cert->extensions[i].oid));
+        break;
+    }
+
+    /* text and bytes: = and ~ need one match, != needs none */
+    return (cond->op == X509_NE) ? !found : found;
+}
+
+
+/*
+ * Returns 1 if every condition holds.  cert must have been decoded with
+ * at least query->decode.
+ */
+int
+x509_query_match( const struct x509_query *query,
+                  const struct x509_certificate *cert )
+{
+    int i;
+
+    for (i = 0; i < query->nr_conditions; i++) {
+        if (!condition_matches(&query->conditions[i], cert))
+            return 0;
+    }
+
+    return 1;
+}
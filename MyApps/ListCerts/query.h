@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Certificate queries: which fields to show (--select) and which
+ *  certificates to show (--where).  The query also tells the decoder
+ *  which fields it has to fill in at all.
+ *
+ */
+
+#ifndef _QUERY_H
+#define _QUERY_H
+
+#include "x509_cert.h"
+
+#define X509_MAX_CONDITIONS  8
+#define X509_MAX_VALUE       128
+
+enum x509_op {
+    X509_EQ,                         /* =  */
+    X509_NE,                         /* != */
+    X509_LT,                         /* <  */
+    X509_LE,                         /* <= */
+    X509_GT,                         /* >  */
+    X509_GE,                         /* >= */
+    X509_CONTAINS                    /* ~, case insensitive */
+};
+
+struct x509_condition {
+    unsigned int field;              /* one X509_* field */
+    enum x509_op op;
+    UINT64 number;                   /* packed time, key bits or version */
+    unsigned int length;             /* bytes in value */
+    char value[X509_MAX_VALUE];      /* text, or serial/fingerprint bytes */
+};
+
+struct x509_query {
+    unsigned int select;             /* fields to show */
+    unsigned int decode;             /* fields x509_decode_fields() must fill in */
+    int nr_conditions;
+    struct x509_condition conditions[X509_MAX_CONDITIONS];
+};
+
+extern void x509_query_init(struct x509_query *query);
+extern int x509_query_select(struct x509_query *query,
+                             const char *list);
+extern int x509_query_where(struct x509_query *query,
+                            const char *expr);
+extern int x509_query_match(const struct x509_query *query,
+                            const struct x509_certificate *cert);
+
+#endif /* _QUERY_H */
@@ -0,0 +1,39 @@
+/*
+ * Automatically generated by ASN1 compiler.  Do not manually edit!
+ *
+ * ASN.1 parser for rsapubkey
+ */
+
+#include "asn1_ber_bytecode.h"
+#include "rsapubkey.h"
+
+enum rsapubkey_actions {
+	ACT_do_rsa_exponent = 0,
+	ACT_do_rsa_modulus = 1,
+	NR__rsapubkey_actions = 2
+};
+
+static const asn1_action_t rsapubkey_action_table[NR__rsapubkey_actions] = {
+	[   0] = do_rsa_exponent,
+	[   1] = do_rsa_modulus,
+};
+
+static const unsigned char rsapubkey_machine[] = {
+	// RSAPublicKey
+	[   0] = ASN1_OP_MATCH,
+	[   1] = _tag(UNIV, CONS, SEQ),
+	[   2] =  ASN1_OP_MATCH_ACT,		// modulus
+	[   3] =  _tag(UNIV, PRIM, INT),
+	[   4] =  _action(ACT_do_rsa_modulus),
+	[   5] =  ASN1_OP_MATCH_ACT,		// publicExponent
+	[   6] =  _tag(UNIV, PRIM, INT),
+	[   7] =  _action(ACT_do_rsa_exponent),
+	[   8] = ASN1_OP_END_SEQ,
+	[   9] = ASN1_OP_COMPLETE,
+};
+
+const struct asn1_decoder rsapubkey_decoder = {
+	.machine = rsapubkey_machine,
+	.machlen = sizeof(rsapubkey_machine),
+	.actions = rsapubkey_action_table,
+};
@@ -0,0 +1,13 @@
+/*
+ * Automatically generated by ASN1 compiler.  Do not manually edit!
+ *
+ * ASN.1 parser for rsapubkey
+ */
+
+#include "asn1_ber_bytecode.h"
+
+extern const struct asn1_decoder rsapubkey_decoder;
+
+extern int do_rsa_exponent(void *, long, unsigned char, const void *, long);
+extern int do_rsa_modulus(void *, long, unsigned char, const void *, long);
+
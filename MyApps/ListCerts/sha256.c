@@ -0,0 +1,186 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  SHA-256 (FIPS 180-4).  On X64 the block function is picked once at
+//  first use: the SHA extensions kernel in sha256_shani.c if CPUID reports
+//  them, otherwise the portable C version below.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+
+#include "sha256.h"
+
+#define ROTR(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define CH(x, y, z)   (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z)  (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define EP0(x)  (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define EP1(x)  (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define SIG0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define SIG1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+CONST UINT32 Sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+
+typedef VOID (*SHA256_BLOCKS)(UINT32 *State, CONST UINT8 *Data, UINTN Blocks);
+
+static SHA256_BLOCKS Sha256Blocks = NULL;
+
+
+static VOID
+Sha256BlocksPortable( UINT32 *State,
+                      CONST UINT8 *Data,
+                      UINTN Blocks )
+{
+    UINT32 W[64];
+    UINT32 a, b, c, d, e, f, g, h, t1, t2;
+    UINTN i;
+
+    for (; Blocks > 0; Blocks--, Data += SHA256_BLOCK_SIZE) {
+        for (i = 0; i < 16; i++)
+            W[i] = ((UINT32)Data[i * 4] << 24) | ((UINT32)Data[i * 4 + 1] << 16) |
+                   ((UINT32)Data[i * 4 + 2] << 8) | Data[i * 4 + 3];
+        for (; i < 64; i++)
+            W[i] = SIG1(W[i - 2]) + W[i - 7] + SIG0(W[i - 15]) + W[i - 16];
+
+        a = State[0]; b = State[1]; c = State[2]; d = State[3];
+        e = State[4]; f = State[5]; g = State[6]; h = State[7];
+
+        for (i = 0; i < 64; i++) {
+            t1 = h + EP1(e) + CH(e, f, g) + Sha256K[i] + W[i];
+            t2 = EP0(a) + MAJ(a, b, c);
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        State[0] += a; State[1] += b; State[2] += c; State[3] += d;
+        State[4] += e; State[5] += f; State[6] += g; State[7] += h;
+    }
+}
+
+
+CONST CHAR16 *
+Sha256Engine( VOID )
+{
+#if defined(MDE_CPU_X64)
+    if (Sha256Blocks == NULL)
+        Sha256Blocks = Sha256ShaNiSupported() ? Sha256BlocksShaNi : Sha256BlocksPortable;
+    if (Sha256Blocks == Sha256BlocksShaNi)
+        return L"SHA extensions";
+#endif
+    return L"portable";
+}
+
+
+VOID
+Sha256Init( SHA256_CONTEXT *Ctx )
+{
+    if (Sha256Blocks == NULL) {
+#if defined(MDE_CPU_X64)
+        Sha256Blocks = Sha256ShaNiSupported() ? Sha256BlocksShaNi : Sha256BlocksPortable;
+#else
+        Sha256Blocks = Sha256BlocksPortable;
+#endif
+    }
+
+    Ctx->State[0] = 0x6a09e667;
+    Ctx->State[1] = 0xbb67ae85;
+    Ctx->State[2] = 0x3c6ef372;
+    Ctx->State[3] = 0xa54ff53a;
+    Ctx->State[4] = 0x510e527f;
+    Ctx->State[5] = 0x9b05688c;
+    Ctx->State[6] = 0x1f83d9ab;
+    Ctx->State[7] = 0x5be0cd19;
+    Ctx->Length = 0;
+    Ctx->Used = 0;
+}
+
+
+VOID
+Sha256Update( SHA256_CONTEXT *Ctx,
+              CONST VOID *Data,
+              UINTN Size )
+{
+    CONST UINT8 *p = Data;
+    UINTN n;
+
+    Ctx->Length += Size;
+
+    if (Ctx->Used > 0) {
+        n = MIN(Size, SHA256_BLOCK_SIZE - Ctx->Used);
+        CopyMem(Ctx->Buffer + Ctx->Used, p, n);
+        Ctx->Used += n;
+        p += n;
+        Size -= n;
+        if (Ctx->Used < SHA256_BLOCK_SIZE)
+            return;
+        Sha256Blocks(Ctx->State, Ctx->Buffer, 1);
+        Ctx->Used = 0;
+    }
+
+    // whole blocks straight from the caller's buffer
+    n = Size / SHA256_BLOCK_SIZE;
+    if (n > 0) {
+        Sha256Blocks(Ctx->State, p, n);
+        p += n * SHA256_BLOCK_SIZE;
+        Size -= n * SHA256_BLOCK_SIZE;
+    }
+
+    if (Size > 0) {
+        CopyMem(Ctx->Buffer, p, Size);
+        Ctx->Used = Size;
+    }
+}
+
+
+VOID
+Sha256Final( SHA256_CONTEXT *Ctx,
+             UINT8 *Digest )
+{
+    UINT64 Bits = Ctx->Length * 8;
+    UINTN i;
+
+    Ctx->Buffer[Ctx->Used++] = 0x80;
+    if (Ctx->Used > SHA256_BLOCK_SIZE - 8) {
+        ZeroMem(Ctx->Buffer + Ctx->Used, SHA256_BLOCK_SIZE - Ctx->Used);
+        Sha256Blocks(Ctx->State, Ctx->Buffer, 1);
+        Ctx->Used = 0;
+    }
+    ZeroMem(Ctx->Buffer + Ctx->Used, SHA256_BLOCK_SIZE - 8 - Ctx->Used);
+    for (i = 0; i < 8; i++)
+        Ctx->Buffer[SHA256_BLOCK_SIZE - 1 - i] = (UINT8)(Bits >> (i * 8));
+    Sha256Blocks(Ctx->State, Ctx->Buffer, 1);
+
+    for (i = 0; i < 8; i++) {
+        Digest[i * 4]     = (UINT8)(Ctx->State[i] >> 24);
+        Digest[i * 4 + 1] = (UINT8)(Ctx->State[i] >> 16);
+        Digest[i * 4 + 2] = (UINT8)(Ctx->State[i] >> 8);
+        Digest[i * 4 + 3] = (UINT8)Ctx->State[i];
+    }
+}
+
+
+VOID
+Sha256( CONST VOID *Data,
+        UINTN Size,
+        UINT8 *Digest )
+{
+    SHA256_CONTEXT Ctx;
+
+    Sha256Init(&Ctx);
+    Sha256Update(&Ctx, Data, Size);
+    Sha256Final(&Ctx, Digest);
+}
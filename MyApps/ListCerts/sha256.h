@@ -0,0 +1,35 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  SHA-256 (FIPS 180-4)
+//
+//  License: BSD License
+//
+
+#ifndef _SHA256_H
+#define _SHA256_H
+
+#define SHA256_DIGEST_SIZE  32
+#define SHA256_BLOCK_SIZE   64
+
+typedef struct {
+    UINT32 State[8];
+    UINT64 Length;                       // bytes hashed so far
+    UINT8  Buffer[SHA256_BLOCK_SIZE];    // partial block
+    UINTN  Used;
+} SHA256_CONTEXT;
+
+extern CONST UINT32 Sha256K[64];
+
+VOID Sha256Init(SHA256_CONTEXT *Ctx);
+VOID Sha256Update(SHA256_CONTEXT *Ctx, CONST VOID *Data, UINTN Size);
+VOID Sha256Final(SHA256_CONTEXT *Ctx, UINT8 *Digest);
+VOID Sha256(CONST VOID *Data, UINTN Size, UINT8 *Digest);
+CONST CHAR16 *Sha256Engine(VOID);
+
+#if defined(MDE_CPU_X64)
+BOOLEAN Sha256ShaNiSupported(VOID);
+VOID    Sha256BlocksShaNi(UINT32 *State, CONST UINT8 *Data, UINTN Blocks);
+#endif
+
+#endif /* _SHA256_H */
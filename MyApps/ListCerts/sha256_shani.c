@@ -0,0 +1,95 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  SHA-256 block function using the x86 SHA extensions (SHA-NI).  Only
+//  called after Sha256ShaNiSupported() has checked CPUID.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+
+#include <Register/Cpuid.h>
+
+#include <immintrin.h>
+
+#include "sha256.h"
+
+#ifdef __GNUC__
+#define SHANI_TARGET  __attribute__((target("sha,ssse3,sse4.1")))
+#else
+#define SHANI_TARGET
+#endif
+
+
+BOOLEAN
+Sha256ShaNiSupported( VOID )
+{
+    UINT32 MaxLeaf, Ebx, Ecx;
+
+    AsmCpuid(CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+    if (MaxLeaf < CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS)
+        return FALSE;
+
+    // SSSE3 and SSE4.1 for the byte shuffle and blend
+    AsmCpuid(CPUID_VERSION_INFO, NULL, NULL, &Ecx, NULL);
+    if (!(Ecx & BIT9) || !(Ecx & BIT19))
+        return FALSE;
+
+    AsmCpuidEx(CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS, 0, NULL, &Ebx, NULL, NULL);
+
+    return (Ebx & BIT29) ? TRUE : FALSE;
+}
+
+
+SHANI_TARGET VOID
+Sha256BlocksShaNi( UINT32 *State,
+                   CONST UINT8 *Data,
+                   UINTN Blocks )
+{
+    CONST __m128i Mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i State0, State1, AbefSave, CdghSave, Msg, Tmp;
+    __m128i W[4];
+    UINTN i;
+
+    // the rounds instruction wants the state as ABEF / CDGH
+    Tmp = _mm_loadu_si128((CONST __m128i *)&State[0]);
+    State1 = _mm_loadu_si128((CONST __m128i *)&State[4]);
+    Tmp = _mm_shuffle_epi32(Tmp, 0xB1);
+    State1 = _mm_shuffle_epi32(State1, 0x1B);
+    State0 = _mm_alignr_epi8(Tmp, State1, 8);
+    State1 = _mm_blend_epi16(State1, Tmp, 0xF0);
+
+    for (; Blocks > 0; Blocks--, Data += SHA256_BLOCK_SIZE) {
+        AbefSave = State0;
+        CdghSave = State1;
+
+        for (i = 0; i < 4; i++)
+            W[i] = _mm_shuffle_epi8(_mm_loadu_si128((CONST __m128i *)(Data + i * 16)), Mask);
+
+        // four rounds per step; W[] is a ring of the last 16 schedule words
+        for (i = 0; i < 16; i++) {
+            if (i >= 4)
+                W[i & 3] = _mm_sha256msg2_epu32(
+                               _mm_add_epi32(_mm_sha256msg1_epu32(W[i & 3], W[(i + 1) & 3]),
+                                             _mm_alignr_epi8(W[(i + 3) & 3], W[(i + 2) & 3], 4)),
+                               W[(i + 3) & 3]);
+            Msg = _mm_add_epi32(W[i & 3], _mm_loadu_si128((CONST __m128i *)&Sha256K[i * 4]));
+            State1 = _mm_sha256rnds2_epu32(State1, State0, Msg);
+            Msg = _mm_shuffle_epi32(Msg, 0x0E);
+            State0 = _mm_sha256rnds2_epu32(State0, State1, Msg);
+        }
+
+        State0 = _mm_add_epi32(State0, AbefSave);
+        State1 = _mm_add_epi32(State1, CdghSave);
+    }
+
+    // back to ABCD / EFGH
+    Tmp = _mm_shuffle_epi32(State0, 0x1B);
+    State1 = _mm_shuffle_epi32(State1, 0xB1);
+    State0 = _mm_blend_epi16(Tmp, State1, 0xF0);
+    State1 = _mm_alignr_epi8(State1, Tmp, 8);
+    _mm_storeu_si128((__m128i *)&State[0], State0);
+    _mm_storeu_si128((__m128i *)&State[4], State1);
+}
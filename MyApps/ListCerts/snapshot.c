@@ -0,0 +1,251 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Signature database snapshots.  Records are sorted once when a snapshot
+//  is taken, so comparing two snapshots is a linear merge of each pair of
+//  lists.  The file is a header, then per variable a section header and
+//  its records, in the layout of the structures in snapshot.h.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/ShellLib.h>
+#include <Library/SortLib.h>
+
+#include "snapshot.h"
+
+#define SNAPSHOT_INITIAL  64
+
+
+SNAPSHOT_VARIABLE *
+SnapshotFindVariable( SNAPSHOT *Snap,
+                      CHAR16 *Name,
+                      EFI_GUID *Vendor )
+{
+    UINTN i;
+
+    for (i = 0; i < Snap->Count; i++) {
+        if (StrCmp(Snap->Variables[i].Section.Name, Name) == 0 &&
+            CompareGuid(&Snap->Variables[i].Section.Vendor, Vendor))
+            return &Snap->Variables[i];
+    }
+
+    return NULL;
+}
+
+
+SNAPSHOT_VARIABLE *
+SnapshotAddVariable( SNAPSHOT *Snap,
+                     CHAR16 *Name,
+                     EFI_GUID *Vendor )
+{
+    SNAPSHOT_VARIABLE *Var;
+
+    if (Snap->Count >= SNAPSHOT_MAX_VARIABLES || StrLen(Name) >= SNAPSHOT_NAME_MAX)
+        return NULL;
+
+    Var = &Snap->Variables[Snap->Count++];
+    ZeroMem(Var, sizeof(*Var));
+    StrCpyS(Var->Section.Name, SNAPSHOT_NAME_MAX, Name);
+    CopyGuid(&Var->Section.Vendor, Vendor);
+
+    return Var;
+}
+
+
+EFI_STATUS
+SnapshotAddRecord( SNAPSHOT_VARIABLE *Var,
+                   CONST UINT8 *Digest,
+                   EFI_GUID *Type,
+                   EFI_GUID *Owner )
+{
+    SNAPSHOT_RECORD *Record;
+    UINTN Capacity;
+
+    if (Var->Section.Count == Var->Capacity) {
+        Capacity = (Var->Capacity == 0) ? SNAPSHOT_INITIAL : Var->Capacity * 2;
+        Record = ReallocatePool(Var->Capacity * sizeof(SNAPSHOT_RECORD),
+                                Capacity * sizeof(SNAPSHOT_RECORD), Var->Records);
+        if (Record == NULL)
+            return EFI_OUT_OF_RESOURCES;
+        Var->Records = Record;
+        Var->Capacity = Capacity;
+    }
+
+    Record = &Var->Records[Var->Section.Count++];
+    CopyMem(Record->Digest, Digest, SHA256_DIGEST_SIZE);
+    CopyGuid(&Record->Type, Type);
+    CopyGuid(&Record->Owner, Owner);
+
+    return EFI_SUCCESS;
+}
+
+
+//
+//  Order by digest, then type, then owner: the record's byte order
+//
+INTN
+SnapshotCompareRecord( CONST SNAPSHOT_RECORD *Record1,
+                       CONST SNAPSHOT_RECORD *Record2 )
+{
+    return CompareMem(Record1, Record2, sizeof(SNAPSHOT_RECORD));
+}
+
+
+static INTN
+EFIAPI
+CompareRecord( CONST VOID *Buffer1,
+               CONST VOID *Buffer2 )
+{
+    return SnapshotCompareRecord(Buffer1, Buffer2);
+}
+
+
+//
+//  PerformQuickSort is quadratic on sorted input, which is what a saved
+//  snapshot holds, so lists already in order are left alone
+//
+VOID
+SnapshotSort( SNAPSHOT *Snap )
+{
+    SNAPSHOT_VARIABLE *Var;
+    UINTN i, j;
+
+    for (i = 0; i < Snap->Count; i++) {
+        Var = &Snap->Variables[i];
+        for (j = 1; j < Var->Section.Count; j++) {
+            if (SnapshotCompareRecord(&Var->Records[j - 1], &Var->Records[j]) > 0)
+                break;
+        }
+        if (j < Var->Section.Count)
+            PerformQuickSort(Var->Records, Var->Section.Count, sizeof(SNAPSHOT_RECORD), CompareRecord);
+    }
+}
+
+
+EFI_STATUS
+SnapshotSave( SNAPSHOT *Snap,
+              CHAR16 *FileName )
+{
+    SHELL_FILE_HANDLE FileHandle;
+    SNAPSHOT_HEADER Header;
+    EFI_STATUS Status;
+    UINTN Size, i;
+
+    // EFI_FILE_MODE_CREATE does not truncate, so remove the previous snapshot first
+    Status = ShellOpenFileByName(FileName, &FileHandle, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0);
+    if (!EFI_ERROR(Status))
+        ShellDeleteFile(&FileHandle);
+
+    Status = ShellOpenFileByName( FileName,
+                                  &FileHandle,
+                                  EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE,
+                                  0 );
+    if (EFI_ERROR(Status))
+        return Status;
+
+    Header.Magic = SNAPSHOT_MAGIC;
+    Header.Version = SNAPSHOT_VERSION;
+    Header.Variables = (UINT16)Snap->Count;
+    Size = sizeof(Header);
+    Status = ShellWriteFile(FileHandle, &Size, &Header);
+    for (i = 0; !EFI_ERROR(Status) && i < Snap->Count; i++) {
+        Size = sizeof(SNAPSHOT_SECTION);
+        Status = ShellWriteFile(FileHandle, &Size, &Snap->Variables[i].Section);
+        if (!EFI_ERROR(Status) && Snap->Variables[i].Section.Count > 0) {
+            Size = Snap->Variables[i].Section.Count * sizeof(SNAPSHOT_RECORD);
+            Status = ShellWriteFile(FileHandle, &Size, Snap->Variables[i].Records);
+        }
+    }
+    ShellCloseFile(&FileHandle);
+
+    return Status;
+}
+
+
+//
+//  Counts are checked against the file size before anything is allocated
+//
+EFI_STATUS
+SnapshotLoad( SNAPSHOT *Snap,
+              CHAR16 *FileName )
+{
+    SHELL_FILE_HANDLE FileHandle;
+    SNAPSHOT_HEADER Header;
+    SNAPSHOT_SECTION Section;
+    SNAPSHOT_VARIABLE *Var;
+    EFI_STATUS Status;
+    UINT64 FileSize, Left;
+    UINTN Size, i;
+
+    ZeroMem(Snap, sizeof(*Snap));
+
+    Status = ShellOpenFileByName(FileName, &FileHandle, EFI_FILE_MODE_READ, 0);
+    if (EFI_ERROR(Status))
+        return Status;
+
+    Status = ShellGetFileSize(FileHandle, &FileSize);
+    Size = sizeof(Header);
+    if (!EFI_ERROR(Status))
+        Status = ShellReadFile(FileHandle, &Size, &Header);
+    if (!EFI_ERROR(Status) &&
+        (Size != sizeof(Header) || Header.Magic != SNAPSHOT_MAGIC ||
+         Header.Version != SNAPSHOT_VERSION || Header.Variables > SNAPSHOT_MAX_VARIABLES))
+        Status = EFI_VOLUME_CORRUPTED;
+    Left = FileSize - sizeof(Header);
+
+    for (i = 0; !EFI_ERROR(Status) && i < Header.Variables; i++) {
+        Size = sizeof(Section);
+        Status = ShellReadFile(FileHandle, &Size, &Section);
+        if (EFI_ERROR(Status))
+            break;
+        if (Size != sizeof(Section) || Left < sizeof(Section) ||
+            Section.Name[SNAPSHOT_NAME_MAX - 1] != CHAR_NULL ||
+            Section.Count > (Left - sizeof(Section)) / sizeof(SNAPSHOT_RECORD)) {
+            Status = EFI_VOLUME_CORRUPTED;
+            break;
+        }
+        Left -= sizeof(Section) + (UINT64)Section.Count * sizeof(SNAPSHOT_RECORD);
+
+        Var = &Snap->Variables[Snap->Count++];
+        Var->Section = Section;
+        Var->Present = TRUE;
+        if (Section.Count == 0)
+            continue;
+        Var->Capacity = Section.Count;
+        Var->Records = AllocatePool(Section.Count * sizeof(SNAPSHOT_RECORD));
+        if (Var->Records == NULL) {
+            Status = EFI_OUT_OF_RESOURCES;
+            break;
+        }
+        Size = Section.Count * sizeof(SNAPSHOT_RECORD);
+        Status = ShellReadFile(FileHandle, &Size, Var->Records);
+        if (!EFI_ERROR(Status) && Size != Section.Count * sizeof(SNAPSHOT_RECORD))
+            Status = EFI_VOLUME_CORRUPTED;
+    }
+    ShellCloseFile(&FileHandle);
+
+    if (EFI_ERROR(Status))
+        SnapshotFree(Snap);
+    else
+        SnapshotSort(Snap);
+
+    return Status;
+}
+
+
+VOID
+SnapshotFree( SNAPSHOT *Snap )
+{
+    UINTN i;
+
+    for (i = 0; i < Snap->Count; i++) {
+        if (Snap->Variables[i].Records != NULL)
+            FreePool(Snap->Variables[i].Records);
+    }
+    ZeroMem(Snap, sizeof(*Snap));
+}
@@ -0,0 +1,61 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Signature database snapshots: per variable, the sorted list of
+//  (digest, signature type, owner) records, saved in a compact binary file
+//
+//  License: BSD License
+//
+
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include "sha256.h"
+
+#define SNAPSHOT_MAGIC          SIGNATURE_32('L', 'C', 'S', 'N')
+#define SNAPSHOT_VERSION        1
+#define SNAPSHOT_MAX_VARIABLES  16
+#define SNAPSHOT_NAME_MAX       16        // CHAR16s, terminator included
+
+#pragma pack(1)
+typedef struct {
+    UINT32 Magic;
+    UINT16 Version;
+    UINT16 Variables;                     // sections that follow
+} SNAPSHOT_HEADER;
+
+typedef struct {
+    CHAR16   Name[SNAPSHOT_NAME_MAX];
+    EFI_GUID Vendor;
+    UINT32   Count;                       // records that follow
+} SNAPSHOT_SECTION;
+
+typedef struct {
+    UINT8    Digest[SHA256_DIGEST_SIZE];  // the hash itself, or SHA-256 of the entry
+    EFI_GUID Type;                        // SignatureType, zero if not known
+    EFI_GUID Owner;                       // SignatureOwner
+} SNAPSHOT_RECORD;
+#pragma pack()
+
+typedef struct {
+    SNAPSHOT_SECTION Section;
+    SNAPSHOT_RECORD  *Records;
+    UINTN            Capacity;
+    BOOLEAN          Present;             // variable exists; always set when loaded
+} SNAPSHOT_VARIABLE;
+
+typedef struct {
+    SNAPSHOT_VARIABLE Variables[SNAPSHOT_MAX_VARIABLES];
+    UINTN             Count;
+} SNAPSHOT;
+
+SNAPSHOT_VARIABLE *SnapshotAddVariable(SNAPSHOT *Snap, CHAR16 *Name, EFI_GUID *Vendor);
+SNAPSHOT_VARIABLE *SnapshotFindVariable(SNAPSHOT *Snap, CHAR16 *Name, EFI_GUID *Vendor);
+EFI_STATUS         SnapshotAddRecord(SNAPSHOT_VARIABLE *Var, CONST UINT8 *Digest, EFI_GUID *Type, EFI_GUID *Owner);
+VOID               SnapshotSort(SNAPSHOT *Snap);
+INTN               SnapshotCompareRecord(CONST SNAPSHOT_RECORD *Record1, CONST SNAPSHOT_RECORD *Record2);
+EFI_STATUS         SnapshotSave(SNAPSHOT *Snap, CHAR16 *FileName);
+EFI_STATUS         SnapshotLoad(SNAPSHOT *Snap, CHAR16 *FileName);
+VOID               SnapshotFree(SNAPSHOT *Snap);
+
+#endif /* _SNAPSHOT_H */
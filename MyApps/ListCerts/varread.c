@@ -0,0 +1,116 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Variable reads.  Asking GetVariable for the size first and then for
+//  the data costs two runtime calls per variable, and where the variable
+//  store lives in SMM each call is an SMI.  Instead the buffer starts at
+//  the largest size QueryVariableInfo says a variable can have, so nearly
+//  every read is a single call; when it is too small anyway it grows to
+//  the size GetVariable reported and stays that size for the next read.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+
+#include "varread.h"
+
+
+static EFI_STATUS
+Grow( VAR_READER *Reader,
+      UINTN Size )
+{
+    UINT8 *Buffer;
+
+    Buffer = AllocatePool(Size);
+    if (Buffer == NULL)
+        return EFI_OUT_OF_RESOURCES;
+    if (Reader->Buffer != NULL)
+        FreePool(Reader->Buffer);
+    Reader->Buffer = Buffer;
+    Reader->Size = Size;
+
+    return EFI_SUCCESS;
+}
+
+
+EFI_STATUS
+VarReaderInit( VAR_READER *Reader )
+{
+    UINT64 MaxStorage, Remaining, MaxVariable;
+    UINTN Size = VAR_READ_DEFAULT_SIZE;
+    EFI_STATUS Status;
+
+    ZeroMem(Reader, sizeof(*Reader));
+
+    // QueryVariableInfo is UEFI 2.0; older firmware leaves the default
+    if (gRT->Hdr.Revision >= EFI_2_00_SYSTEM_TABLE_REVISION) {
+        Reader->Calls++;
+        Status = gRT->QueryVariableInfo(EFI_VARIABLE_NON_VOLATILE |
+                                        EFI_VARIABLE_BOOTSERVICE_ACCESS |
+                                        EFI_VARIABLE_RUNTIME_ACCESS,
+                                        &MaxStorage, &Remaining, &MaxVariable);
+        if (!EFI_ERROR(Status) && MaxVariable > 0) {
+            Reader->Hint = (UINTN)MIN(MaxVariable, VAR_READ_MAX_HINT);
+            Size = Reader->Hint;
+        }
+    }
+
+    return Grow(Reader, Size);
+}
+
+
+//
+//  *Data points into the reader's buffer and is only good until the next
+//  VarRead; callers that keep it must copy it
+//
+EFI_STATUS
+VarRead( VAR_READER *Reader,
+         CHAR16 *Name,
+         EFI_GUID *Owner,
+         UINT8 **Data,
+         UINTN *Len )
+{
+    EFI_STATUS Status, GrowStatus;
+    UINTN Tries;
+
+    *Data = NULL;
+    *Len = 0;
+    Reader->Reads++;
+
+    // a variable can grow between the calls, so allow one more resize;
+    // Status is always that of the last GetVariable
+    for (Tries = 0; Tries < 3; Tries++) {
+        *Len = Reader->Size;
+        Reader->Calls++;
+        Status = gRT->GetVariable(Name, Owner, NULL, Len, Reader->Buffer);
+        if (Status != EFI_BUFFER_TOO_SMALL || Tries == 2)
+            break;
+        Reader->Grows++;
+        GrowStatus = Grow(Reader, *Len);
+        if (EFI_ERROR(GrowStatus)) {
+            *Len = 0;
+            return GrowStatus;
+        }
+    }
+
+    if (Status == EFI_SUCCESS)
+        *Data = Reader->Buffer;
+    else
+        *Len = 0;
+
+    return Status;
+}
+
+
+VOID
+VarReaderFree( VAR_READER *Reader )
+{
+    if (Reader->Buffer != NULL)
+        FreePool(Reader->Buffer);
+    ZeroMem(Reader, sizeof(*Reader));
+}
@@ -0,0 +1,29 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  Reading UEFI variables with one GetVariable call each into a buffer
+//  that is kept from one read to the next
+//
+//  License: BSD License
+//
+
+#ifndef _VARREAD_H
+#define _VARREAD_H
+
+#define VAR_READ_DEFAULT_SIZE  SIZE_32KB
+#define VAR_READ_MAX_HINT      SIZE_1MB
+
+typedef struct {
+    UINT8 *Buffer;
+    UINTN Size;
+    UINTN Hint;                 // MaxVariableSize, 0 if not reported
+    UINTN Reads;                // variables asked for
+    UINTN Calls;                // runtime service calls, each an SMI on SMM stores
+    UINTN Grows;                // reads the buffer was too small for
+} VAR_READER;
+
+EFI_STATUS VarReaderInit(VAR_READER *Reader);
+EFI_STATUS VarRead(VAR_READER *Reader, CHAR16 *Name, EFI_GUID *Owner, UINT8 **Data, UINTN *Len);
+VOID       VarReaderFree(VAR_READER *Reader);
+
+#endif /* _VARREAD_H */
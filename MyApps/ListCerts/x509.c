@@ -9,35 +9,41 @@
 
 enum x509_actions {
 	ACT_do_algorithm = 0,
-	ACT_do_attribute_type = 1,
-	ACT_do_attribute_value = 2,
-	ACT_do_extension_id = 3,
-	ACT_do_extensions = 4,
-	ACT_do_issuer = 5,
-	ACT_do_serialnumber = 6,
-	ACT_do_signature = 7,
-	ACT_do_subject = 8,
-	ACT_do_subject_public_key_info = 9,
-	ACT_do_validity_not_after = 10,
-	ACT_do_validity_not_before = 11,
-	ACT_do_version = 12,
-	NR__x509_actions = 13
+	ACT_do_algorithm_params = 1,
+	ACT_do_attribute_type = 2,
+	ACT_do_attribute_value = 3,
+	ACT_do_extension_id = 4,
+	ACT_do_extension_value = 5,
+	ACT_do_extensions = 6,
+	ACT_do_issuer = 7,
+	ACT_do_public_key = 8,
+	ACT_do_serialnumber = 9,
+	ACT_do_signature = 10,
+	ACT_do_subject = 11,
+	ACT_do_subject_public_key_info = 12,
+	ACT_do_validity_not_after = 13,
+	ACT_do_validity_not_before = 14,
+	ACT_do_version = 15,
+	NR__x509_actions = 16
 };
 
 static const asn1_action_t x509_action_table[NR__x509_actions] = {
 	[   0] = do_algorithm,
-	[   1] = do_attribute_type,
-	[   2] = do_attribute_value,
-	[   3] = do_extension_id,
-	[   4] = do_extensions,
-	[   5] = do_issuer,
-	[   6] = do_serialnumber,
-	[   7] = do_signature,
-	[   8] = do_subject,
-	[   9] = do_subject_public_key_info,
-	[  10] = do_validity_not_after,
-	[  11] = do_validity_not_before,
-	[  12] = do_version,
+	[   1] = do_algorithm_params,
+	[   2] = do_attribute_type,
+	[   3] = do_attribute_value,
+	[   4] = do_extension_id,
+	[   5] = do_extension_value,
+	[   6] = do_extensions,
+	[   7] = do_issuer,
+	[   8] = do_public_key,
+	[   9] = do_serialnumber,
+	[  10] = do_signature,
+	[  11] = do_subject,
+	[  12] = do_subject_public_key_info,
+	[  13] = do_validity_not_after,
+	[  14] = do_validity_not_before,
+	[  15] = do_version,
 };
 
 static const unsigned char x509_machine[] = {
@@ -49,7 +55,7 @@ static const unsigned char x509_machine[] = {
 	[   3] =  _tag(UNIV, CONS, SEQ),
 	[   4] =   ASN1_OP_MATCH_JUMP_OR_SKIP,		// version
 	[   5] =   _tagn(CONT, CONS,  0),
-	[   6] =   _jump_target(67),
+	[   6] =   _jump_target(68),
 	// CertificateSerialNumber
 	[   7] =   ASN1_OP_MATCH_ACT,
 	[   8] =   _tag(UNIV, PRIM, INT),
@@ -57,13 +63,13 @@ static const unsigned char x509_machine[] = {
 	// AlgorithmIdentifier
 	[  10] =   ASN1_OP_MATCH_JUMP,
 	[  11] =   _tag(UNIV, CONS, SEQ),
-	[  12] =   _jump_target(72),		// --> AlgorithmIdentifier
+	[  12] =   _jump_target(73),		// --> AlgorithmIdentifier
 	[  13] =   ASN1_OP_ACT,
 	[  14] =   _action(ACT_do_signature),
 	// Name
 	[  15] =   ASN1_OP_MATCH_JUMP,
 	[  16] =   _tag(UNIV, CONS, SEQ),
-	[  17] =   _jump_target(78),		// --> Name
+	[  17] =   _jump_target(80),		// --> Name
 	[  18] =   ASN1_OP_ACT,
 	[  19] =   _action(ACT_do_issuer),
 	// Validity
@@ -89,7 +95,7 @@ static const unsigned char x509_machine[] = {
 	// Name
 	[  37] =   ASN1_OP_MATCH_JUMP,
 	[  38] =   _tag(UNIV, CONS, SEQ),
-	[  39] =   _jump_target(78),		// --> Name
+	[  39] =   _jump_target(80),		// --> Name
 	[  40] =   ASN1_OP_ACT,
 	[  41] =   _action(ACT_do_subject),
 	// SubjectPublicKeyInfo
@@ -98,83 +104,86 @@ static const unsigned char x509_machine[] = {
 	// AlgorithmIdentifier
 	[  44] =    ASN1_OP_MATCH_JUMP,
 	[  45] =    _tag(UNIV, CONS, SEQ),
-	[  46] =    _jump_target(72),		// --> AlgorithmIdentifier
-	[  47] =    ASN1_OP_MATCH,		// subjectPublicKey
+	[  46] =    _jump_target(73),		// --> AlgorithmIdentifier
+	[  47] =    ASN1_OP_MATCH_ACT,		// subjectPublicKey
 	[  48] =    _tag(UNIV, PRIM, BTS),
-	[  49] =   ASN1_OP_END_SEQ,
-	[  50] =   ASN1_OP_ACT,
-	[  51] =   _action(ACT_do_subject_public_key_info),
+	[  49] =    _action(ACT_do_public_key),
+	[  50] =   ASN1_OP_END_SEQ,
+	[  51] =   ASN1_OP_ACT,
+	[  52] =   _action(ACT_do_subject_public_key_info),
 	// UniqueIdentifier
-	[  52] =   ASN1_OP_MATCH_OR_SKIP,
-	[  53] =   _tagn(CONT, PRIM,  1),
+	[  53] =   ASN1_OP_MATCH_OR_SKIP,
+	[  54] =   _tagn(CONT, PRIM,  1),
 	// UniqueIdentifier
-	[  54] =   ASN1_OP_MATCH_OR_SKIP,
-	[  55] =   _tagn(CONT, PRIM,  2),
-	[  56] =   ASN1_OP_MATCH_JUMP_OR_SKIP,		// extensions
-	[  57] =   _tagn(CONT, CONS,  3),
-	[  58] =   _jump_target(93),
-	[  59] =  ASN1_OP_END_SEQ,
+	[  55] =   ASN1_OP_MATCH_OR_SKIP,
+	[  56] =   _tagn(CONT, PRIM,  2),
+	[  57] =   ASN1_OP_MATCH_JUMP_OR_SKIP,		// extensions
+	[  58] =   _tagn(CONT, CONS,  3),
+	[  59] =   _jump_target(95),
+	[  60] =  ASN1_OP_END_SEQ,
 	// AlgorithmIdentifier
-	[  60] =  ASN1_OP_MATCH_JUMP,
-	[  61] =  _tag(UNIV, CONS, SEQ),
-	[  62] =  _jump_target(72),		// --> AlgorithmIdentifier
-	[  63] =  ASN1_OP_MATCH,		// signature
-	[  64] =  _tag(UNIV, PRIM, BTS),
-	[  65] = ASN1_OP_END_SEQ,
-	[  66] = ASN1_OP_COMPLETE,
+	[  61] =  ASN1_OP_MATCH_JUMP,
+	[  62] =  _tag(UNIV, CONS, SEQ),
+	[  63] =  _jump_target(73),		// --> AlgorithmIdentifier
+	[  64] =  ASN1_OP_MATCH,		// signature
+	[  65] =  _tag(UNIV, PRIM, BTS),
+	[  66] = ASN1_OP_END_SEQ,
+	[  67] = ASN1_OP_COMPLETE,
 
 	// Version
-	[  67] =  ASN1_OP_MATCH_ACT,
-	[  68] =  _tag(UNIV, PRIM, INT),
-	[  69] =  _action(ACT_do_version),
-	[  70] = ASN1_OP_END_SEQ,
-	[  71] = ASN1_OP_RETURN,
+	[  68] =  ASN1_OP_MATCH_ACT,
+	[  69] =  _tag(UNIV, PRIM, INT),
+	[  70] =  _action(ACT_do_version),
+	[  71] = ASN1_OP_END_SEQ,
+	[  72] = ASN1_OP_RETURN,
 
-	[  72] =  ASN1_OP_MATCH_ACT,		// algorithm
-	[  73] =  _tag(UNIV, PRIM, OID),
-	[  74] =  _action(ACT_do_algorithm),
-	[  75] =  ASN1_OP_MATCH_ANY,		// parameters
-	[  76] = ASN1_OP_END_SEQ,
-	[  77] = ASN1_OP_RETURN,
+	[  73] =  ASN1_OP_MATCH_ACT,		// algorithm
+	[  74] =  _tag(UNIV, PRIM, OID),
+	[  75] =  _action(ACT_do_algorithm),
+	[  76] =  ASN1_OP_MATCH_ANY_ACT,		// parameters
+	[  77] =  _action(ACT_do_algorithm_params),
+	[  78] = ASN1_OP_END_SEQ,
+	[  79] = ASN1_OP_RETURN,
 
 	// RelativeDistinguishedName
-	[  78] =  ASN1_OP_MATCH,
-	[  79] =  _tag(UNIV, CONS, SET),
+	[  80] =  ASN1_OP_MATCH,
+	[  81] =  _tag(UNIV, CONS, SET),
 	// AttributeValueAssertion
-	[  80] =   ASN1_OP_MATCH,
-	[  81] =   _tag(UNIV, CONS, SEQ),
-	[  82] =    ASN1_OP_MATCH_ACT,		// attributeType
-	[  83] =    _tag(UNIV, PRIM, OID),
-	[  84] =    _action(ACT_do_attribute_type),
-	[  85] =    ASN1_OP_MATCH_ANY_ACT,		// attributeValue
-	[  86] =    _action(ACT_do_attribute_value),
-	[  87] =   ASN1_OP_END_SEQ,
-	[  88] =  ASN1_OP_END_SET_OF,
-	[  89] =  _jump_target(80),
-	[  90] = ASN1_OP_END_SEQ_OF,
-	[  91] = _jump_target(78),
-	[  92] = ASN1_OP_RETURN,
+	[  82] =   ASN1_OP_MATCH,
+	[  83] =   _tag(UNIV, CONS, SEQ),
+	[  84] =    ASN1_OP_MATCH_ACT,		// attributeType
+	[  85] =    _tag(UNIV, PRIM, OID),
+	[  86] =    _action(ACT_do_attribute_type),
+	[  87] =    ASN1_OP_MATCH_ANY_ACT,		// attributeValue
+	[  88] =    _action(ACT_do_attribute_value),
+	[  89] =   ASN1_OP_END_SEQ,
+	[  90] =  ASN1_OP_END_SET_OF,
+	[  91] =  _jump_target(82),
+	[  92] = ASN1_OP_END_SEQ_OF,
+	[  93] = _jump_target(80),
+	[  94] = ASN1_OP_RETURN,
 
 	// Extensions
-	[  93] =  ASN1_OP_MATCH,
-	[  94] =  _tag(UNIV, CONS, SEQ),
+	[  95] =  ASN1_OP_MATCH,
+	[  96] =  _tag(UNIV, CONS, SEQ),
 	// Extension
-	[  95] =   ASN1_OP_MATCH,
-	[  96] =   _tag(UNIV, CONS, SEQ),
-	[  97] =    ASN1_OP_MATCH_ACT,		// extId
-	[  98] =    _tag(UNIV, PRIM, OID),
-	[  99] =    _action(ACT_do_extension_id),
-	[ 100] =    ASN1_OP_MATCH_OR_SKIP,		// critical
-	[ 101] =    _tag(UNIV, PRIM, BOOL),
-	[ 102] =    ASN1_OP_MATCH,		// extValue
-	[ 103] =    _tag(UNIV, PRIM, OTS),
-	[ 104] =   ASN1_OP_END_SEQ,
-	[ 105] =  ASN1_OP_END_SEQ_OF,
-	[ 106] =  _jump_target(95),
-	[ 107] =  ASN1_OP_ACT,
-	[ 108] =  _action(ACT_do_extensions),
-	[ 109] = ASN1_OP_END_SEQ,
-	[ 110] = ASN1_OP_RETURN,
+	[  97] =   ASN1_OP_MATCH,
+	[  98] =   _tag(UNIV, CONS, SEQ),
+	[  99] =    ASN1_OP_MATCH_ACT,		// extId
+	[ 100] =    _tag(UNIV, PRIM, OID),
+	[ 101] =    _action(ACT_do_extension_id),
+	[ 102] =    ASN1_OP_MATCH_OR_SKIP,		// critical
+	[ 103] =    _tag(UNIV, PRIM, BOOL),
+	[ 104] =    ASN1_OP_MATCH_ACT,		// extValue
+	[ 105] =    _tag(UNIV, PRIM, OTS),
+	[ 106] =    _action(ACT_do_extension_value),
+	[ 107] =   ASN1_OP_END_SEQ,
+	[ 108] =  ASN1_OP_END_SEQ_OF,
+	[ 109] =  _jump_target(97),
+	[ 110] =  ASN1_OP_ACT,
+	[ 111] =  _action(ACT_do_extensions),
+	[ 112] = ASN1_OP_END_SEQ,
+	[ 113] = ASN1_OP_RETURN,
 };
 
 const struct asn1_decoder x509_decoder = {
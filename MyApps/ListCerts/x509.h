@@ -9,11 +9,14 @@
 extern const struct asn1_decoder x509_decoder;
 
 extern int do_algorithm(void *, long, unsigned char, const void *, long);
+extern int do_algorithm_params(void *, long, unsigned char, const void *, long);
 extern int do_attribute_type(void *, long, unsigned char, const void *, long);
 extern int do_attribute_value(void *, long, unsigned char, const void *, long);
 extern int do_extension_id(void *, long, unsigned char, const void *, long);
+extern int do_extension_value(void *, long, unsigned char, const void *, long);
 extern int do_extensions(void *, long, unsigned char, const void *, long);
 extern int do_issuer(void *, long, unsigned char, const void *, long);
+extern int do_public_key(void *, long, unsigned char, const void *, long);
 extern int do_serialnumber(void *, long, unsigned char, const void *, long);
 extern int do_signature(void *, long, unsigned char, const void *, long);
 extern int do_subject(void *, long, unsigned char, const void *, long);
@@ -0,0 +1,632 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Actions for the x509 decoder.  They only record where each field lives
+ *  in the DER buffer; formatting is done afterwards by the caller.
+ *
+ */
+
+#include <errno.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+
+#include "x509.h"
+#include "x509_cert.h"
+
+
+static void
+set_slice( struct x509_certificate *cert,
+           struct x509_slice *slice,
+           const void *value,
+           long vlen )
+{
+    slice->offset = (unsigned int)((const unsigned char *)value - cert->data);
+    slice->length = (unsigned int)vlen;
+}
+
+
+/*
+ * Close off the attributes collected since the last Name
+ */
+static void
+end_name( struct x509_certificate *cert,
+          struct x509_name *name,
+          long hdrlen,
+          const void *value,
+          long vlen )
+{
+    set_slice(cert, &name->raw, value, vlen);
+    name->hdrlen = (unsigned char)hdrlen;
+    name->first = cert->name_start;
+    name->count = cert->nr_attrs - cert->name_start;
+    cert->name_start = cert->nr_attrs;
+}
+
+
+/*
+ * Size of the outer Certificate SEQUENCE, header included.  Signature list
+ * entries can be padded past the end of the DER.
+ */
+static size_t
+der_length( const unsigned char *data,
+            size_t datalen )
+{
+    size_t len = 0;
+    unsigned char n, i;
+
+    if (datalen < 2 || data[0] != (ASN1_CONS_BIT | ASN1_SEQ))
+        return datalen;
+    if (data[1] < 0x80)
+        return MIN(datalen, 2 + (size_t)data[1]);
+
+    n = data[1] & 0x7f;
+    if (n == 0 || n > sizeof(len) - 1 || datalen < 2 + (size_t)n)
+        return datalen;
+    for (i = 0; i < n; i++)
+        len = (len << 8) | data[2 + i];
+
+    return MIN(datalen, 2 + n + len);
+}
+
+
+int
+x509_decode( struct x509_certificate *cert,
+             const unsigned char *data,
+             size_t datalen )
+{
+    ZeroMem(cert, sizeof(*cert));
+    cert->data = data;
+    cert->length = der_length(data, datalen);
+
+    return x509_direct_decoder(cert, data, datalen);
+}
+
+
+/*
+ * Same as x509_decode() but runs the x509 bytecode through the generic
+ * interpreter.  Kept as the reference for the direct-coded decoder.
+ */
+int
+x509_decode_interpreted( struct x509_certificate *cert,
+                         const unsigned char *data,
+                         size_t datalen )
+{
+    ZeroMem(cert, sizeof(*cert));
+    cert->data = data;
+    cert->length = der_length(data, datalen);
+
+    return asn1_ber_decoder(&x509_decoder, cert, data, datalen);
+}
+
+
+/*
+ * One TLV met while walking the certificate by hand
+ */
+struct element {
+    unsigned char tag;
+    long hdrlen;
+    size_t value;                    /* offset of the contents */
+    size_t length;
+};
+
+
+/*
+ * Read the element at *dp, which must lie before end, and step over it.
+ * A non-zero tag must match.
+ */
+static int
+next_element( const unsigned char *data,
+              size_t end,
+              size_t *dp,
+              unsigned char tag,
+              struct element *elem )
+{
+    size_t start = *dp;
+
+    if (asn1_read_header(data, end, dp, &elem->tag, &elem->length) < 0)
+        return -EBADMSG;
+    if (tag != 0 && elem->tag != tag)
+        return -EBADMSG;
+
+    elem->hdrlen = (long)(*dp - start);
+    elem->value = *dp;
+    *dp += elem->length;
+
+    return 0;
+}
+
+
+static int
+act( asn1_action_t action,
+     struct x509_certificate *cert,
+     const struct element *elem )
+{
+    return action(cert, elem->hdrlen, elem->tag, cert->data + elem->value, (long)elem->length);
+}
+
+
+static int
+walk_algorithm( struct x509_certificate *cert,
+                const struct element *algo )
+{
+    size_t dp = algo->value, end = algo->value + algo->length;
+    struct element elem;
+
+    if (next_element(cert->data, end, &dp, ASN1_OID, &elem) < 0 ||
+        act(do_algorithm, cert, &elem) < 0)
+        return -EBADMSG;
+    if (dp < end &&
+        (next_element(cert->data, end, &dp, 0, &elem) < 0 ||
+         act(do_algorithm_params, cert, &elem) < 0))
+        return -EBADMSG;
+
+    return 0;
+}
+
+
+/*
+ * Name ::= SEQUENCE OF SET OF SEQUENCE { type, value }
+ */
+static int
+walk_name( struct x509_certificate *cert,
+           const struct element *name,
+           asn1_action_t action )
+{
+    size_t dp = name->value, end = name->value + name->length;
+    size_t rp, ap;
+    struct element rdn, ava, elem;
+
+    while (dp < end) {
+        if (next_element(cert->data, end, &dp, ASN1_CONS_BIT | ASN1_SET, &rdn) < 0)
+            return -EBADMSG;
+        for (rp = rdn.value; rp < rdn.value + rdn.length; ) {
+            if (next_element(cert->data, rdn.value + rdn.length, &rp, ASN1_CONS_BIT | ASN1_SEQ, &ava) < 0)
+                return -EBADMSG;
+            ap = ava.value;
+            if (next_element(cert->data, ava.value + ava.length, &ap, ASN1_OID, &elem) < 0 ||
+                act(do_attribute_type, cert, &elem) < 0 ||
+                next_element(cert->data, ava.value + ava.length, &ap, 0, &elem) < 0 ||
+                act(do_attribute_value, cert, &elem) < 0)
+                return -EBADMSG;
+        }
+    }
+
+    return act(action, cert, name);
+}
+
+
+/*
+ * [3] EXPLICIT SEQUENCE OF Extension
+ */
+static int
+walk_extensions( struct x509_certificate *cert,
+                 const struct element *exts )
+{
+    size_t dp = exts->value, ep, end;
+    struct element list, ext, elem;
+
+    if (next_element(cert->data, exts->value + exts->length, &dp, ASN1_CONS_BIT | ASN1_SEQ, &list) < 0)
+        return -EBADMSG;
+
+    end = list.value + list.length;
+    for (dp = list.value; dp < end; ) {
+        if (next_element(cert->data, end, &dp, ASN1_CONS_BIT | ASN1_SEQ, &ext) < 0)
+            return -EBADMSG;
+        ep = ext.value;
+        if (next_element(cert->data, ext.value + ext.length, &ep, ASN1_OID, &elem) < 0 ||
+            act(do_extension_id, cert, &elem) < 0)
+            return -EBADMSG;
+        /* critical BOOLEAN DEFAULT FALSE */
+        if (ep < ext.value + ext.length && cert->data[ep] == ASN1_BOOL &&
+            next_element(cert->data, ext.value + ext.length, &ep, ASN1_BOOL, &elem) < 0)
+            return -EBADMSG;
+        if (next_element(cert->data, ext.value + ext.length, &ep, ASN1_OTS, &elem) < 0 ||
+            act(do_extension_value, cert, &elem) < 0)
+            return -EBADMSG;
+    }
+
+    return act(do_extensions, cert, exts);
+}
+
+
+/*
+ * Decode only the given X509_* fields.  The TBSCertificate is walked by
+ * its TLV headers: a subtree that is not wanted is stepped over using its
+ * length without being looked into, and the decoder actions run only for
+ * the parts that were asked for, so the other fields of cert stay zero.
+ * Asking for every field is the same as x509_decode().
+ */
+int
+x509_decode_fields( struct x509_certificate *cert,
+                    const unsigned char *data,
+                    size_t datalen,
+                    unsigned int fields )
+{
+    struct element tbs, elem, inner;
+    size_t dp = 0, vp, end;
+
+    fields &= X509_ALL_FIELDS & ~X509_FINGERPRINT;
+    if (fields == (X509_ALL_FIELDS & ~X509_FINGERPRINT))
+        return x509_decode(cert, data, datalen);
+
+    ZeroMem(cert, sizeof(*cert));
+    cert->data = data;
+    cert->length = der_length(data, datalen);
+
+    if (next_element(data, datalen, &dp, ASN1_CONS_BIT | ASN1_SEQ, &elem) < 0)
+        return -EBADMSG;
+    dp = elem.value;
+    if (next_element(data, elem.value + elem.length, &dp, ASN1_CONS_BIT | ASN1_SEQ, &tbs) < 0)
+        return -EBADMSG;
+    dp = tbs.value;
+    end = tbs.value + tbs.length;
+
+    /* version [0] EXPLICIT, absent for v1 */
+    if (dp < end && data[dp] == ((ASN1_CONT << 6) | ASN1_CONS_BIT | 0)) {
+        if (next_element(data, end, &dp, 0, &elem) < 0)
+            return -EBADMSG;
+        vp = elem.value;
+        if ((fields & X509_VERSION) &&
+            (next_element(data, elem.value + elem.length, &vp, ASN1_INT, &inner) < 0 ||
+             act(do_version, cert, &inner) < 0))
+            return -EBADMSG;
+    }
+
+    if (next_element(data, end, &dp, ASN1_INT, &elem) < 0)
+        return -EBADMSG;
+    if ((fields & X509_SERIAL) && act(do_serialnumber, cert, &elem) < 0)
+        return -EBADMSG;
+
+    if (next_element(data, end, &dp, ASN1_CONS_BIT | ASN1_SEQ, &elem) < 0)
+        return -EBADMSG;
+    if ((fields & X509_SIG_ALGO) &&
+        (walk_algorithm(cert, &elem) < 0 || act(do_signature, cert, &elem) < 0))
+        return -EBADMSG;
+
+    if (next_element(data, end, &dp, ASN1_CONS_BIT | ASN1_SEQ, &elem) < 0)
+        return -EBADMSG;
+    if ((fields & X509_ISSUER) && walk_name(cert, &elem, do_issuer) < 0)
+        return -EBADMSG;
+
+    if (next_element(data, end, &dp, ASN1_CONS_BIT | ASN1_SEQ, &elem) < 0)
+        return -EBADMSG;
+    if (fields & (X509_NOT_BEFORE | X509_NOT_AFTER)) {
+        vp = elem.value;
+        if (next_element(data, elem.value + elem.length, &vp, 0, &inner) < 0 ||
+            act(do_validity_not_before, cert, &inner) < 0 ||
+            next_element(data, elem.value + elem.length, &vp, 0, &inner) < 0 ||
+            act(do_validity_not_after, cert, &inner) < 0)
+            return -EBADMSG;
+    }
+
+    if (next_element(data, end, &dp, ASN1_CONS_BIT | ASN1_SEQ, &elem) < 0)
+        return -EBADMSG;
+    if ((fields & X509_SUBJECT) && walk_name(cert, &elem, do_subject) < 0)
+        return -EBADMSG;
+
+    if (next_element(data, end, &dp, ASN1_CONS_BIT | ASN1_SEQ, &elem) < 0)
+        return -EBADMSG;
+    if (fields & (X509_KEY_ALGO | X509_PUBLIC_KEY)) {
+        vp = elem.value;
+        if (next_element(data, elem.value + elem.length, &vp, ASN1_CONS_BIT | ASN1_SEQ, &inner) < 0 ||
+            walk_algorithm(cert, &inner) < 0 ||
+            next_element(data, elem.value + elem.length, &vp, ASN1_BTS, &inner) < 0 ||
+            act(do_public_key, cert, &inner) < 0 ||
+            act(do_subject_public_key_info, cert, &elem) < 0)
+            return -EBADMSG;
+    }
+
+    /* issuerUniqueID [1], subjectUniqueID [2], extensions [3] */
+    while ((fields & X509_EXTENSIONS) && dp < end) {
+        if (next_element(data, end, &dp, 0, &elem) < 0)
+            return -EBADMSG;
+        if (elem.tag == ((ASN1_CONT << 6) | ASN1_CONS_BIT | 3) && walk_extensions(cert, &elem) < 0)
+            return -EBADMSG;
+    }
+
+    return 0;
+}
+
+
+int
+do_version( void *context,
+            long hdrlen,
+            unsigned char tag,
+            const void *value,
+            long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    /* v1, v2 or v3: one content byte, which is all the callers read */
+    if (vlen != 1)
+        return -EBADMSG;
+
+    set_slice(cert, &cert->version, value, vlen);
+    cert->decoded |= X509_VERSION;
+
+    return 0;
+}
+
+
+int
+do_serialnumber( void *context,
+                 long hdrlen,
+                 unsigned char tag,
+                 const void *value,
+                 long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    set_slice(cert, &cert->serial, value, vlen);
+    cert->decoded |= X509_SERIAL;
+
+    return 0;
+}
+
+
+int
+do_algorithm( void *context,
+              long hdrlen,
+              unsigned char tag,
+              const void *value,
+              long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    cert->last_algo.oid = Lookup_OID(value, vlen);
+    set_slice(cert, &cert->last_algo.id, value, vlen);
+    ZeroMem(&cert->last_algo.params, sizeof(cert->last_algo.params));
+
+    return 0;
+}
+
+
+int
+do_algorithm_params( void *context,
+                     long hdrlen,
+                     unsigned char tag,
+                     const void *value,
+                     long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    set_slice(cert, &cert->last_algo.params, (const unsigned char *)value - hdrlen, vlen + hdrlen);
+
+    return 0;
+}
+
+
+int
+do_signature( void *context,
+              long hdrlen,
+              unsigned char tag,
+              const void *value,
+              long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    cert->sig_algo = cert->last_algo;
+    cert->decoded |= X509_SIG_ALGO;
+
+    return 0;
+}
+
+
+int
+do_attribute_type( void *context,
+                   long hdrlen,
+                   unsigned char tag,
+                   const void *value,
+                   long vlen )
+{
+    struct x509_certificate *cert = context;
+    struct x509_attribute *attr;
+
+    if (cert->nr_attrs >= X509_MAX_ATTRS) {
+        cert->truncated = 1;
+        return 0;
+    }
+
+    attr = &cert->attrs[cert->nr_attrs];
+    attr->type = Lookup_OID(value, vlen);
+    set_slice(cert, &attr->id, value, vlen);
+
+    return 0;
+}
+
+
+int
+do_attribute_value( void *context,
+                    long hdrlen,
+                    unsigned char tag,
+                    const void *value,
+                    long vlen )
+{
+    struct x509_certificate *cert = context;
+    struct x509_attribute *attr;
+
+    if (cert->nr_attrs >= X509_MAX_ATTRS)
+        return 0;
+
+    attr = &cert->attrs[cert->nr_attrs++];
+    attr->tag = tag;
+    set_slice(cert, &attr->value, value, vlen);
+
+    return 0;
+}
+
+
+int
+do_issuer( void *context,
+           long hdrlen,
+           unsigned char tag,
+           const void *value,
+           long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    end_name(cert, &cert->issuer, hdrlen, value, vlen);
+    cert->decoded |= X509_ISSUER;
+
+    return 0;
+}
+
+
+int
+do_subject( void *context,
+            long hdrlen,
+            unsigned char tag,
+            const void *value,
+            long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    end_name(cert, &cert->subject, hdrlen, value, vlen);
+    cert->decoded |= X509_SUBJECT;
+
+    return 0;
+}
+
+
+int
+do_validity_not_before( void *context,
+                        long hdrlen,
+                        unsigned char tag,
+                        const void *value,
+                        long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    cert->not_before_tag = tag;
+    set_slice(cert, &cert->not_before, value, vlen);
+    x509_decode_time(&cert->valid_from, tag, value, vlen);
+    cert->decoded |= X509_NOT_BEFORE;
+
+    return 0;
+}
+
+
+int
+do_validity_not_after( void *context,
+                       long hdrlen,
+                       unsigned char tag,
+                       const void *value,
+                       long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    cert->not_after_tag = tag;
+    set_slice(cert, &cert->not_after, value, vlen);
+    x509_decode_time(&cert->valid_to, tag, value, vlen);
+    cert->decoded |= X509_NOT_AFTER;
+
+    return 0;
+}
+
+
+int
+do_subject_public_key_info( void *context,
+                            long hdrlen,
+                            unsigned char tag,
+                            const void *value,
+                            long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    cert->pub_key_algo = cert->last_algo;
+    set_slice(cert, &cert->pub_key_info, value, vlen);
+    cert->decoded |= X509_KEY_ALGO | X509_PUBLIC_KEY;
+
+    return 0;
+}
+
+
+int
+do_public_key( void *context,
+               long hdrlen,
+               unsigned char tag,
+               const void *value,
+               long vlen )
+{
+    struct x509_certificate *cert = context;
+
+    set_slice(cert, &cert->pub_key, value, vlen);
+
+    return 0;
+}
+
+
+int
+do_extension_id( void *context,
+                 long hdrlen,
+                 unsigned char tag,
+                 const void *value,
+                 long vlen )
+{
+    struct x509_certificate *cert = context;
+    struct x509_extension *ext;
+
+    cert->last_extension = Lookup_OID(value, vlen);
+    if (cert->nr_extensions >= X509_MAX_EXTENSIONS) {
+        cert->truncated = 1;
+        return 0;
+    }
+
+    ext = &cert->extensions[cert->nr_extensions++];
+    ext->oid = cert->last_extension;
+    set_slice(cert, &ext->id, value, vlen);
+    cert->decoded |= X509_EXTENSIONS;
+
+    return 0;
+}
+
+
+/*
+ * Key identifiers, for matching a certificate to its issuer:
+ *
+ *     SubjectKeyIdentifier ::= OCTET STRING
+ *     AuthorityKeyIdentifier ::= SEQUENCE {
+ *         keyIdentifier             [0] IMPLICIT OCTET STRING OPTIONAL,
+ *         authorityCertIssuer       [1] IMPLICIT GeneralNames OPTIONAL,
+ *         authorityCertSerialNumber [2] IMPLICIT INTEGER OPTIONAL }
+ *
+ * A malformed identifier is left unset rather than failing the whole
+ * certificate.  Other extension values are not looked into.
+ */
+int
+do_extension_value( void *context,
+                    long hdrlen,
+                    unsigned char tag,
+                    const void *value,
+                    long vlen )
+{
+    struct x509_certificate *cert = context;
+    const unsigned char *data = value;
+    size_t dp = 0, len;
+    unsigned char t;
+
+    if (cert->last_extension == OID_subjectKeyIdentifier) {
+        if (asn1_read_header(data, (size_t)vlen, &dp, &t, &len) == 0 && t == ASN1_OTS)
+            set_slice(cert, &cert->skid, data + dp, (long)len);
+    } else if (cert->last_extension == OID_authorityKeyIdentifier) {
+        if (asn1_read_header(data, (size_t)vlen, &dp, &t, &len) == 0 &&
+            t == (ASN1_CONS_BIT | ASN1_SEQ) && len > 0 && data[dp] == ((ASN1_CONT << 6) | 0) &&
+            asn1_read_header(data, dp + len, &dp, &t, &len) == 0)
+            set_slice(cert, &cert->akid, data + dp, (long)len);
+    }
+
+    return 0;
+}
+
+
+int
+do_extensions( void *context,
+               long hdrlen,
+               unsigned char tag,
+               const void *value,
+               long vlen )
+{
+    return 0;
+}
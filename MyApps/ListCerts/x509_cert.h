@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Parsed form of an X.509 certificate.  The x509 decoder actions fill in
+ *  this structure; nothing is copied, every field is an (offset, length)
+ *  slice into the DER buffer that was handed to x509_decode().
+ *
+ */
+
+#ifndef _X509_CERT_H
+#define _X509_CERT_H
+
+#include "asn1_ber_decoder.h"
+#include "oid_registry.h"
+#include "x509_time.h"
+
+#define X509_MAX_ATTRS       32      /* RDN attributes, issuer + subject */
+#define X509_MAX_EXTENSIONS  24
+
+struct x509_slice {
+    unsigned int offset;
+    unsigned int length;
+};
+
+struct x509_algorithm {
+    enum OID oid;
+    struct x509_slice id;            /* encoded OID */
+    struct x509_slice params;        /* encoded parameters, header included */
+};
+
+struct x509_attribute {
+    enum OID type;
+    struct x509_slice id;            /* encoded OID */
+    struct x509_slice value;
+    unsigned char tag;               /* string type of the value */
+};
+
+struct x509_name {
+    struct x509_slice raw;           /* Name contents, excluding header */
+    unsigned char hdrlen;
+    unsigned char first;             /* index into attrs[] */
+    unsigned char count;
+};
+
+struct x509_extension {
+    enum OID oid;
+    struct x509_slice id;            /* encoded OID */
+};
+
+struct x509_certificate {
+    const unsigned char *data;       /* DER encoded certificate */
+    size_t length;
+
+    struct x509_slice version;
+    struct x509_slice serial;
+    struct x509_algorithm sig_algo;
+    struct x509_name issuer;
+    struct x509_slice not_before;
+    struct x509_slice not_after;
+    unsigned char not_before_tag;
+    unsigned char not_after_tag;
+    UINT64 valid_from;               /* packed UTC times, 0 if malformed */
+    UINT64 valid_to;
+    struct x509_name subject;
+    struct x509_algorithm pub_key_algo;
+    struct x509_slice pub_key_info;
+    struct x509_slice pub_key;       /* subjectPublicKey BIT STRING contents */
+    struct x509_slice skid;          /* subjectKeyIdentifier */
+    struct x509_slice akid;          /* authorityKeyIdentifier keyIdentifier */
+
+    unsigned int decoded;            /* X509_* fields recorded so far, for
+                                        showing what came before an error */
+    unsigned char nr_attrs;
+    unsigned char nr_extensions;
+    unsigned char truncated;         /* attrs[] or extensions[] overflowed */
+    unsigned char name_start;        /* first attribute of the Name being parsed */
+    enum OID last_extension;         /* extension whose value comes next */
+    struct x509_algorithm last_algo; /* AlgorithmIdentifier awaiting its owner */
+
+    struct x509_attribute attrs[X509_MAX_ATTRS];
+    struct x509_extension extensions[X509_MAX_EXTENSIONS];
+};
+
+#define X509_SLICE_PTR(cert, slice)  ((cert)->data + (slice).offset)
+
+/* Fields for x509_decode_fields(); the fingerprint needs no decoding */
+#define X509_VERSION         0x0001
+#define X509_SERIAL          0x0002
+#define X509_SIG_ALGO        0x0004
+#define X509_ISSUER          0x0008
+#define X509_NOT_BEFORE      0x0010
+#define X509_NOT_AFTER       0x0020
+#define X509_SUBJECT         0x0040
+#define X509_FINGERPRINT     0x0080
+#define X509_KEY_ALGO        0x0100
+#define X509_PUBLIC_KEY      0x0200
+#define X509_EXTENSIONS      0x0400
+#define X509_ALL_FIELDS      0x07ff
+
+extern int x509_decode(struct x509_certificate *cert,
+                       const unsigned char *data,
+                       size_t datalen);
+extern int x509_decode_fields(struct x509_certificate *cert,
+                              const unsigned char *data,
+                              size_t datalen,
+                              unsigned int fields);
+extern int x509_decode_interpreted(struct x509_certificate *cert,
+                                   const unsigned char *data,
+                                   size_t datalen);
+
+/* x509_direct.c, generated from x509.c by build_asn1_direct.py */
+extern int x509_direct_decoder(void *context,
+                               const unsigned char *data,
+                               size_t datalen);
+
+#endif /* _X509_CERT_H */
@@ -0,0 +1,519 @@
+/*
+ * Automatically generated by build_asn1_direct.py.  Do not edit
+ *
+ * Direct-coded ASN.1 decoder for x509
+ */
+
+#include <errno.h>
+
+#include <Uefi.h>
+#include <Library/UefiLib.h>
+#include <Library/OutputLib.h>
+
+#include "asn1_ber_direct.h"
+#include "x509.h"
+
+int x509_direct_decoder(void *context,
+			const unsigned char *data,
+			size_t datalen)
+{
+	struct asn1_direct s;
+	int ret;
+
+	asn1_direct_init(&s, data, datalen);
+
+	/* [0] ASN1_OP_MATCH: Certificate */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [2] ASN1_OP_MATCH: TBSCertificate */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [4] ASN1_OP_MATCH_JUMP_OR_SKIP: version */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_JUMP_OR_SKIP, _tagn(CONT, CONS,  0));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_push(&s, 7) < 0)
+			goto error;
+		goto op_68;
+	}
+
+op_7:	/* [7] ASN1_OP_MATCH_ACT: CertificateSerialNumber */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_ACT, _tag(UNIV, PRIM, INT));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		ret = do_serialnumber(context, s.hdr, s.tag, data + s.dp, s.len);
+		if (ret < 0)
+			return ret;
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [10] ASN1_OP_MATCH_JUMP: AlgorithmIdentifier */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_JUMP, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_push(&s, 13) < 0)
+			goto error;
+		goto op_73;
+	}
+
+op_13:	/* [13] ASN1_OP_ACT */
+	do_signature(context, s.hdr, s.tag, data + s.tdp, s.len);
+
+	/* [15] ASN1_OP_MATCH_JUMP: Name */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_JUMP, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_push(&s, 18) < 0)
+			goto error;
+		goto op_80;
+	}
+
+op_18:	/* [18] ASN1_OP_ACT */
+	do_issuer(context, s.hdr, s.tag, data + s.tdp, s.len);
+
+	/* [20] ASN1_OP_MATCH: Validity */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [22] ASN1_OP_MATCH_OR_SKIP: Time utcTime */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_OR_SKIP, _tag(UNIV, PRIM, UNITIM));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [24] ASN1_OP_COND_MATCH_OR_SKIP: generalTime */
+	ret = asn1_direct_match(&s, ASN1_OP_COND_MATCH_OR_SKIP, _tag(UNIV, PRIM, GENTIM));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [26] ASN1_OP_COND_FAIL */
+	if (unlikely(!(s.flags & ASN1_DIRECT_MATCHED))) {
+		asn1_direct_error(&s, L"Unexpected tag");
+		goto error;
+	}
+
+	/* [27] ASN1_OP_ACT */
+	do_validity_not_before(context, s.hdr, s.tag, data + s.tdp, s.len);
+
+	/* [29] ASN1_OP_MATCH_OR_SKIP: Time utcTime */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_OR_SKIP, _tag(UNIV, PRIM, UNITIM));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [31] ASN1_OP_COND_MATCH_OR_SKIP: generalTime */
+	ret = asn1_direct_match(&s, ASN1_OP_COND_MATCH_OR_SKIP, _tag(UNIV, PRIM, GENTIM));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [33] ASN1_OP_COND_FAIL */
+	if (unlikely(!(s.flags & ASN1_DIRECT_MATCHED))) {
+		asn1_direct_error(&s, L"Unexpected tag");
+		goto error;
+	}
+
+	/* [34] ASN1_OP_ACT */
+	do_validity_not_after(context, s.hdr, s.tag, data + s.tdp, s.len);
+
+	/* [36] ASN1_OP_END_SEQ */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ);
+	if (ret < 0)
+		goto error;
+
+	/* [37] ASN1_OP_MATCH_JUMP: Name */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_JUMP, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_push(&s, 40) < 0)
+			goto error;
+		goto op_80;
+	}
+
+op_40:	/* [40] ASN1_OP_ACT */
+	do_subject(context, s.hdr, s.tag, data + s.tdp, s.len);
+
+	/* [42] ASN1_OP_MATCH: SubjectPublicKeyInfo */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [44] ASN1_OP_MATCH_JUMP: AlgorithmIdentifier */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_JUMP, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_push(&s, 47) < 0)
+			goto error;
+		goto op_73;
+	}
+
+op_47:	/* [47] ASN1_OP_MATCH_ACT: subjectPublicKey */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_ACT, _tag(UNIV, PRIM, BTS));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		ret = do_public_key(context, s.hdr, s.tag, data + s.dp, s.len);
+		if (ret < 0)
+			return ret;
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [50] ASN1_OP_END_SEQ */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ);
+	if (ret < 0)
+		goto error;
+
+	/* [51] ASN1_OP_ACT */
+	do_subject_public_key_info(context, s.hdr, s.tag, data + s.tdp, s.len);
+
+	/* [53] ASN1_OP_MATCH_OR_SKIP: UniqueIdentifier */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_OR_SKIP, _tagn(CONT, PRIM,  1));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [55] ASN1_OP_MATCH_OR_SKIP: UniqueIdentifier */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_OR_SKIP, _tagn(CONT, PRIM,  2));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [57] ASN1_OP_MATCH_JUMP_OR_SKIP: extensions */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_JUMP_OR_SKIP, _tagn(CONT, CONS,  3));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_push(&s, 60) < 0)
+			goto error;
+		goto op_95;
+	}
+
+op_60:	/* [60] ASN1_OP_END_SEQ */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ);
+	if (ret < 0)
+		goto error;
+
+	/* [61] ASN1_OP_MATCH_JUMP: AlgorithmIdentifier */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_JUMP, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_push(&s, 64) < 0)
+			goto error;
+		goto op_73;
+	}
+
+op_64:	/* [64] ASN1_OP_MATCH: signature */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH, _tag(UNIV, PRIM, BTS));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [66] ASN1_OP_END_SEQ */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ);
+	if (ret < 0)
+		goto error;
+
+	/* [67] ASN1_OP_COMPLETE */
+	if (unlikely(s.jsp != 0 || s.csp != 0))
+		return -EBADMSG;
+	return 0;
+
+op_68:	/* [68] ASN1_OP_MATCH_ACT: Version */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_ACT, _tag(UNIV, PRIM, INT));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		ret = do_version(context, s.hdr, s.tag, data + s.dp, s.len);
+		if (ret < 0)
+			return ret;
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [71] ASN1_OP_END_SEQ */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ);
+	if (ret < 0)
+		goto error;
+
+	/* [72] ASN1_OP_RETURN */
+	if (unlikely(s.jsp <= 0)) {
+		asn1_direct_error(&s, L"Jump stack underflow");
+		goto error;
+	}
+	switch (s.jump_stack[--s.jsp]) {
+	case 7: goto op_7;
+	case 13: goto op_13;
+	case 18: goto op_18;
+	case 40: goto op_40;
+	case 47: goto op_47;
+	case 60: goto op_60;
+	case 64: goto op_64;
+	}
+	goto error;
+
+op_73:	/* [73] ASN1_OP_MATCH_ACT: algorithm */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_ACT, _tag(UNIV, PRIM, OID));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		ret = do_algorithm(context, s.hdr, s.tag, data + s.dp, s.len);
+		if (ret < 0)
+			return ret;
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [76] ASN1_OP_MATCH_ANY_ACT: parameters */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_ANY_ACT, 0);
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		ret = do_algorithm_params(context, s.hdr, s.tag, data + s.dp, s.len);
+		if (ret < 0)
+			return ret;
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [78] ASN1_OP_END_SEQ */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ);
+	if (ret < 0)
+		goto error;
+
+	/* [79] ASN1_OP_RETURN */
+	if (unlikely(s.jsp <= 0)) {
+		asn1_direct_error(&s, L"Jump stack underflow");
+		goto error;
+	}
+	switch (s.jump_stack[--s.jsp]) {
+	case 7: goto op_7;
+	case 13: goto op_13;
+	case 18: goto op_18;
+	case 40: goto op_40;
+	case 47: goto op_47;
+	case 60: goto op_60;
+	case 64: goto op_64;
+	}
+	goto error;
+
+op_80:	/* [80] ASN1_OP_MATCH: RelativeDistinguishedName */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH, _tag(UNIV, CONS, SET));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+op_82:	/* [82] ASN1_OP_MATCH: AttributeValueAssertion */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [84] ASN1_OP_MATCH_ACT: attributeType */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_ACT, _tag(UNIV, PRIM, OID));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		ret = do_attribute_type(context, s.hdr, s.tag, data + s.dp, s.len);
+		if (ret < 0)
+			return ret;
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [87] ASN1_OP_MATCH_ANY_ACT: attributeValue */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_ANY_ACT, 0);
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		ret = do_attribute_value(context, s.hdr, s.tag, data + s.dp, s.len);
+		if (ret < 0)
+			return ret;
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [89] ASN1_OP_END_SEQ */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ);
+	if (ret < 0)
+		goto error;
+
+	/* [90] ASN1_OP_END_SET_OF */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SET_OF);
+	if (ret < 0)
+		goto error;
+	if (ret > 0)
+		goto op_82;
+
+	/* [92] ASN1_OP_END_SEQ_OF */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ_OF);
+	if (ret < 0)
+		goto error;
+	if (ret > 0)
+		goto op_80;
+
+	/* [94] ASN1_OP_RETURN */
+	if (unlikely(s.jsp <= 0)) {
+		asn1_direct_error(&s, L"Jump stack underflow");
+		goto error;
+	}
+	switch (s.jump_stack[--s.jsp]) {
+	case 7: goto op_7;
+	case 13: goto op_13;
+	case 18: goto op_18;
+	case 40: goto op_40;
+	case 47: goto op_47;
+	case 60: goto op_60;
+	case 64: goto op_64;
+	}
+	goto error;
+
+op_95:	/* [95] ASN1_OP_MATCH: Extensions */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+op_97:	/* [97] ASN1_OP_MATCH: Extension */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH, _tag(UNIV, CONS, SEQ));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [99] ASN1_OP_MATCH_ACT: extId */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_ACT, _tag(UNIV, PRIM, OID));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		ret = do_extension_id(context, s.hdr, s.tag, data + s.dp, s.len);
+		if (ret < 0)
+			return ret;
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [102] ASN1_OP_MATCH_OR_SKIP: critical */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_OR_SKIP, _tag(UNIV, PRIM, BOOL));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [104] ASN1_OP_MATCH_ACT: extValue */
+	ret = asn1_direct_match(&s, ASN1_OP_MATCH_ACT, _tag(UNIV, PRIM, OTS));
+	if (ret < 0)
+		goto error;
+	if (ret > 0) {
+		ret = do_extension_value(context, s.hdr, s.tag, data + s.dp, s.len);
+		if (ret < 0)
+			return ret;
+		if (asn1_direct_skip(&s) < 0)
+			goto error;
+	}
+
+	/* [107] ASN1_OP_END_SEQ */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ);
+	if (ret < 0)
+		goto error;
+
+	/* [108] ASN1_OP_END_SEQ_OF */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ_OF);
+	if (ret < 0)
+		goto error;
+	if (ret > 0)
+		goto op_97;
+
+	/* [110] ASN1_OP_ACT */
+	do_extensions(context, s.hdr, s.tag, data + s.tdp, s.len);
+
+	/* [112] ASN1_OP_END_SEQ */
+	ret = asn1_direct_end(&s, ASN1_OP_END_SEQ);
+	if (ret < 0)
+		goto error;
+
+	/* [113] ASN1_OP_RETURN */
+	if (unlikely(s.jsp <= 0)) {
+		asn1_direct_error(&s, L"Jump stack underflow");
+		goto error;
+	}
+	switch (s.jump_stack[--s.jsp]) {
+	case 7: goto op_7;
+	case 13: goto op_13;
+	case 18: goto op_18;
+	case 40: goto op_40;
+	case 47: goto op_47;
+	case 60: goto op_60;
+	case 64: goto op_64;
+	}
+	goto error;
+
+error:
+	if (asn1_report_errors)
+		OutPrint(L"ERROR: %s\n", s.errmsg);
+	return -EBADMSG;
+}
@@ -0,0 +1,187 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Decode UTCTime and GeneralizedTime to packed UTC timestamps.
+ *
+ *      UTCTime          YYMMDDhhmm[ss](Z|+hhmm|-hhmm)
+ *      GeneralizedTime  YYYYMMDDhhmm[ss[.fff]](Z|+hhmm|-hhmm)
+ *
+ *  A UTCTime year of 50 or more is 19xx, anything below is 20xx (RFC 5280
+ *  4.1.2.5.1).  Fractions of a second are dropped and a time with an
+ *  offset is moved to UTC.
+ *
+ */
+
+#include <errno.h>
+
+#include <Uefi.h>
+
+#include "x509_cert.h"
+
+static const unsigned char month_days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+
+static int
+is_leap( unsigned int year )
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+
+/*
+ * Days between 1970-01-01 and a proleptic Gregorian date
+ */
+static INT64
+days_from_civil( INT64 year,
+                 unsigned int month,
+                 unsigned int day )
+{
+    INT64 era, yoe, doy, doe;
+
+    year -= (month <= 2);
+    era = (year >= 0 ? year : year - 399) / 400;
+    yoe = year - era * 400;
+    doy = (153 * (INT64)(month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + doe - 719468;
+}
+
+
+static void
+civil_from_days( INT64 days,
+                 INT64 *year,
+                 unsigned int *month,
+                 unsigned int *day )
+{
+    INT64 era, doe, yoe, doy, mp;
+
+    days += 719468;
+    era = (days >= 0 ? days : days - 146096) / 146097;
+    doe = days - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+    *day = (unsigned int)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (unsigned int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = yoe + era * 400 + (*month <= 2);
+}
+
+
+INT64
+x509_time_days( UINT64 time )
+{
+    return days_from_civil(X509_TIME_YEAR(time), X509_TIME_MONTH(time), X509_TIME_DAY(time));
+}
+
+
+/*
+ * Move a time by a number of seconds, 0 if the result is out of range
+ */
+UINT64
+x509_time_add( UINT64 time,
+               INT64 seconds )
+{
+    INT64 days, year;
+    unsigned int month, day;
+
+    seconds += X509_TIME_HOUR(time) * 3600 + X509_TIME_MINUTE(time) * 60 + X509_TIME_SECOND(time);
+    days = x509_time_days(time) + seconds / 86400;
+    seconds %= 86400;
+    if (seconds < 0) {
+        seconds += 86400;
+        days--;
+    }
+
+    civil_from_days(days, &year, &month, &day);
+    if (year < 0 || year > 9999)
+        return 0;
+
+    return X509_TIME(year, month, day, seconds / 3600, seconds / 60 % 60, seconds % 60);
+}
+
+
+static int
+read_digits( const unsigned char **p,
+             const unsigned char *end,
+             unsigned int n,
+             unsigned int *value )
+{
+    for (*value = 0; n > 0; n--, (*p)++) {
+        if (*p >= end || **p < '0' || **p > '9')
+            return -EBADMSG;
+        *value = *value * 10 + (**p - '0');
+    }
+
+    return 0;
+}
+
+
+/*
+ * Decode a certificate time.  On error *time is 0.
+ */
+int
+x509_decode_time( UINT64 *time,
+                  unsigned char tag,
+                  const unsigned char *value,
+                  size_t vlen )
+{
+    const unsigned char *p = value, *end = value + vlen;
+    unsigned int year, month, day, hour, minute, second = 0, oh, om;
+    INT64 offset = 0;
+    int sign;
+
+    *time = 0;
+
+    if (tag == ASN1_UNITIM) {
+        if (read_digits(&p, end, 2, &year) < 0)
+            return -EBADMSG;
+        year += (year >= 50) ? 1900 : 2000;
+    } else if (tag == ASN1_GENTIM) {
+        if (read_digits(&p, end, 4, &year) < 0)
+            return -EBADMSG;
+    } else {
+        return -EBADMSG;
+    }
+
+    if (read_digits(&p, end, 2, &month) < 0 ||
+        read_digits(&p, end, 2, &day) < 0 ||
+        read_digits(&p, end, 2, &hour) < 0 ||
+        read_digits(&p, end, 2, &minute) < 0)
+        return -EBADMSG;
+    if (p < end && *p >= '0' && *p <= '9' && read_digits(&p, end, 2, &second) < 0)
+        return -EBADMSG;
+    if (tag == ASN1_GENTIM && p < end && (*p == '.' || *p == ',')) {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++)
+            ;
+    }
+
+    if (month < 1 || month > 12 || day < 1 ||
+        day > month_days[month - 1] + (month == 2 && is_leap(year)) ||
+        hour > 23 || minute > 59 || second > 60)
+        return -EBADMSG;
+
+    if (p < end && *p == 'Z') {
+        p++;
+    } else if (p < end && (*p == '+' || *p == '-')) {
+        sign = (*p++ == '+') ? 1 : -1;
+        if (read_digits(&p, end, 2, &oh) < 0 || read_digits(&p, end, 2, &om) < 0 ||
+            oh > 23 || om > 59)
+            return -EBADMSG;
+        offset = sign * (INT64)(oh * 3600 + om * 60);
+    } else {
+        return -EBADMSG;            /* local time without a zone */
+    }
+    if (p != end)
+        return -EBADMSG;
+
+    /* a leap second is taken as the last second of the minute */
+    if (second == 60)
+        second = 59;
+
+    *time = X509_TIME(year, month, day, hour, minute, second);
+    if (offset != 0)
+        *time = x509_time_add(*time, -offset);
+
+    return (*time != 0) ? 0 : -EBADMSG;
+}
@@ -0,0 +1,32 @@
+/*
+ *  Copyright (c) 2018 Finnbarr P. Murphy.   All rights reserved.
+ *
+ *  Certificate times.  UTCTime and GeneralizedTime values are decoded to
+ *  a packed UTC timestamp whose bit fields run from year down to second,
+ *  so two times compare as plain integers.  0 is not a valid time.
+ *
+ */
+
+#ifndef _X509_TIME_H
+#define _X509_TIME_H
+
+#define X509_TIME(y, mo, d, h, mi, s)                                   \
+    (((UINT64)(y) << 26) | ((UINT64)(mo) << 22) | ((UINT64)(d) << 17) | \
+     ((UINT64)(h) << 12) | ((UINT64)(mi) << 6) | (UINT64)(s))
+
+#define X509_TIME_YEAR(t)    ((unsigned int)((t) >> 26))
+#define X509_TIME_MONTH(t)   ((unsigned int)((t) >> 22) & 0x0f)
+#define X509_TIME_DAY(t)     ((unsigned int)((t) >> 17) & 0x1f)
+#define X509_TIME_HOUR(t)    ((unsigned int)((t) >> 12) & 0x1f)
+#define X509_TIME_MINUTE(t)  ((unsigned int)((t) >> 6) & 0x3f)
+#define X509_TIME_SECOND(t)  ((unsigned int)(t) & 0x3f)
+
+extern int x509_decode_time(UINT64 *time,
+                            unsigned char tag,
+                            const unsigned char *value,
+                            size_t vlen);
+extern INT64 x509_time_days(UINT64 time);
+extern UINT64 x509_time_add(UINT64 time,
+                            INT64 seconds);
+
+#endif /* _X509_TIME_H */
@@ -0,0 +1,10 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  DisplayBMP as a MyTools command
+//
+//  License: BSD License
+//
+
+#define ShellAppMain DisplayBMPMain
+#include "../DisplayBMP/DisplayBMP.c"
@@ -0,0 +1,10 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  ListACPI as a MyTools command
+//
+//  License: BSD License
+//
+
+#define ShellAppMain ListACPIMain
+#include "../ListACPI/ListACPI.c"
@@ -0,0 +1,223 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  All the MyApps utilities in one image.  The utility to run is the name
+//  the image was started by (copy MyTools.efi to ListACPI.efi, say) or
+//  else the first argument.  Several utilities separated by + arguments
+//  run one after another in the same image:
+//
+//      MyTools ListACPI -v + ShowFACS + ShowPCI --json -o pci.json
+//
+//  so the image is loaded and relocated once, and the ACPI, PCI and
+//  variable indexes PlatformIndexLib builds for the first utility that
+//  needs them are there for the rest.
+//
+//  License: BSD License
+//
+
+#include <Uefi.h>
+#include <Library/UefiLib.h>
+#include <Library/ShellCEntryLib.h>
+#include <Library/ShellLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+
+#include "MyTools.h"
+
+#define UTILITY_VERSION L"20181018"
+#define NAME_MAX        32
+#undef DEBUG
+
+typedef struct {
+    CONST CHAR16     *Name;
+    MYTOOLS_COMMAND  Main;
+} COMMAND;
+
+static CONST COMMAND Commands[] = {
+    { L"Beep",              BeepMain },
+    { L"BootFWUI",          BootFWUIMain },
+    { L"Cpuid",             CpuidMain },
+    { L"DisplayBMP",        DisplayBMPMain },
+    { L"GraphicModes",      GraphicModesMain },
+    { L"Inventory",         InventoryMain },
+    { L"ListACPI",          ListACPIMain },
+    { L"ListCerts",         ListCertsMain },
+    { L"ShowBGRT",          ShowBGRTMain },
+    { L"ShowEDID",          ShowEDIDMain },
+    { L"ShowESRT",          ShowESRTMain },
+    { L"ShowFACS",          ShowFACSMain },
+    { L"ShowMSDM",          ShowMSDMMain },
+    { L"ShowOsIndications", ShowOsIndicationsMain },
+    { L"ShowPCI",           ShowPCIMain },
+    { L"ShowPCIx",          ShowPCIxMain },
+    { L"ShowQVI",           ShowQVIMain },
+    { L"ShowSLIC",          ShowSLICMain },
+    { L"XBeep",             XBeepMain },
+};
+
+
+//
+//  Names are compared without regard to case, as the shell does
+//
+static BOOLEAN
+SameName( CONST CHAR16 *Name1,
+          CONST CHAR16 *Name2 )
+{
+    CHAR16 c1, c2;
+
+    do {
+        c1 = *Name1++;
+        c2 = *Name2++;
+        if (c1 >= L'a' && c1 <= L'z')
+            c1 -= (L'a' - L'A');
+        if (c2 >= L'a' && c2 <= L'z')
+            c2 -= (L'a' - L'A');
+        if (c1 != c2)
+            return FALSE;
+    } while (c1 != CHAR_NULL);
+
+    return TRUE;
+}
+
+
+static CONST COMMAND *
+FindCommand( CONST CHAR16 *Name )
+{
+    for (UINTN i = 0; i < ARRAY_SIZE(Commands); i++) {
+        if (SameName(Commands[i].Name, Name))
+            return &Commands[i];
+    }
+
+    return NULL;
+}
+
+
+//
+//  fs0:\tools\ListACPI.efi is ListACPI
+//
+static VOID
+ImageName( CONST CHAR16 *Path,
+           CHAR16 *Name )
+{
+    CONST CHAR16 *Start = Path;
+    UINTN Length;
+
+    for (; *Path != CHAR_NULL; Path++) {
+        if (*Path == L'\\' || *Path == L'/' || *Path == L':')
+            Start = Path + 1;
+    }
+
+    Length = StrLen(Start);
+    if (Length > 4 && SameName(&Start[Length - 4], L".efi"))
+        Length -= 4;
+    if (Length >= NAME_MAX)
+        Length = NAME_MAX - 1;
+
+    CopyMem(Name, Start, Length * sizeof(CHAR16));
+    Name[Length] = CHAR_NULL;
+}
+
+
+static BOOLEAN
+IsSeparator( CONST CHAR16 *Arg )
+{
+    return !StrCmp(Arg, L"+");
+}
+
+
+//
+//  Each utility in Argv up to the next + is run with that part of Argv,
+//  its name as Argv[0].  The status returned is the first failure.
+//
+static INTN
+RunCommands( UINTN Argc,
+             CHAR16 **Argv )
+{
+    CONST COMMAND *Command;
+    INTN Status = EFI_SUCCESS, Result;
+    UINTN Start, End;
+
+    // check every name before anything runs
+    for (Start = 0; Start < Argc; Start = End + 1) {
+        for (End = Start; End < Argc && !IsSeparator(Argv[End]); End++)
+            ;
+        if (End == Start || FindCommand(Argv[Start]) == NULL) {
+            OutPrint(L"ERROR: Unknown command: %s\n", (End == Start) ? L"+" : Argv[Start]);
+            return EFI_INVALID_PARAMETER;
+        }
+    }
+
+    for (Start = 0; Start < Argc; Start = End + 1) {
+        for (End = Start; End < Argc && !IsSeparator(Argv[End]); End++)
+            ;
+        Command = FindCommand(Argv[Start]);
+        Result = Command->Main(End - Start, &Argv[Start]);
+
+        // each utility gets its own document and output file
+        EmitEnd();
+        OutFlush();
+
+        if (Result != EFI_SUCCESS && Status == EFI_SUCCESS)
+            Status = Result;
+    }
+
+    return Status;
+}
+
+
+static VOID
+Usage( BOOLEAN ErrorMsg )
+{
+    if ( ErrorMsg ) {
+        OutPrint(L"ERROR: Unknown option.\n");
+    }
+    OutPrint(L"Usage: MyTools command [arguments] [+ command [arguments]] ...\n");
+    OutPrint(L"       MyTools [-l | --list]\n");
+    OutPrint(L"       MyTools [-V | --version]\n");
+}
+
+
+INTN
+EFIAPI
+ShellAppMain( UINTN Argc,
+              CHAR16 **Argv )
+{
+    CHAR16 Name[NAME_MAX];
+    EFI_STATUS Status = EFI_SUCCESS;
+
+    // started as one of the utilities
+    ImageName(Argv[0], Name);
+    if (FindCommand(Name) != NULL) {
+        Argv[0] = Name;
+        return RunCommands(Argc, Argv);
+    }
+
+    if (Argc < 2) {
+        Usage(FALSE);
+        return Status;
+    }
+    if (Argc == 2) {
+        if (!StrCmp(Argv[1], L"--version") ||
+            !StrCmp(Argv[1], L"-V")) {
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
+            return Status;
+        } else if (!StrCmp(Argv[1], L"--list") ||
+            !StrCmp(Argv[1], L"-l")) {
+            for (UINTN i = 0; i < ARRAY_SIZE(Commands); i++)
+                OutPrint(L"%s\n", Commands[i].Name);
+            return Status;
+        } else if (!StrCmp(Argv[1], L"--help") ||
+            !StrCmp(Argv[1], L"-h")) {
+            Usage(FALSE);
+            return Status;
+        }
+    }
+    if (Argv[1][0] == L'-') {
+        Usage(TRUE);
+        return Status;
+    }
+
+    return RunCommands(Argc - 1, &Argv[1]);
+}
@@ -0,0 +1,35 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  The utilities MyTools is built from.  Each xxxCommand.c compiles one
+//  utility's source unchanged, with its ShellAppMain renamed xxxMain.
+//
+//  License: BSD License
+//
+
+#ifndef _MYTOOLS_H
+#define _MYTOOLS_H
+
+typedef INTN (EFIAPI *MYTOOLS_COMMAND)(UINTN Argc, CHAR16 **Argv);
+
+INTN EFIAPI BeepMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI BootFWUIMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI CpuidMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI DisplayBMPMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI GraphicModesMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI InventoryMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ListACPIMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ListCertsMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowBGRTMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowEDIDMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowESRTMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowFACSMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowMSDMMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowOsIndicationsMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowPCIMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowPCIxMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowQVIMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI ShowSLICMain(UINTN Argc, CHAR16 **Argv);
+INTN EFIAPI XBeepMain(UINTN Argc, CHAR16 **Argv);
+
+#endif /* _MYTOOLS_H */
@@ -0,0 +1,10 @@
+//
+//  Copyright (c) 2018  Finnbarr P. Murphy.  All rights reserved.
+//
+//  ShowBGRT as a MyTools command
+//
+//  License: BSD License
+//
+
+#define ShellAppMain ShowBGRTMain
+#include "../ShowBGRT/ShowBGRT.c"
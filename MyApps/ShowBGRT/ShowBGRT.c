@@ -16,6 +16,9 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+#include <Library/PlatformIndexLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -73,22 +76,6 @@ AsciiToUnicodeSize( CHAR8 *String,
 }
 
 
-static VOID
-DumpHex( UINT8 *ptr,
-         int Count )
-{
-    int i = 0;
-
-    Print(L"  ");
-    for (i = 0; i < Count; i++ ) {
-        if ( i > 0 && i%16 == 0)
-            Print(L"\n  ");
-        Print(L"0x%02x ", 0xff & *ptr++);
-    }
-    Print(L"\n");
-}
-
-
 //
 // Save Boot Logo image as a BMP file
 //
@@ -107,13 +94,13 @@ SaveBMP( CHAR16 *FileName,
                                   NULL,
                                   (VOID **)&SimpleFileSystem);
     if (EFI_ERROR(Status)) {
-        Print(L"ERROR: Cannot find EFI_SIMPLE_FILE_SYSTEM_PROTOCOL\r\n");
+        EmitError(L"Cannot find EFI_SIMPLE_FILE_SYSTEM_PROTOCOL");
         return Status;    
     }
 
     Status = SimpleFileSystem->OpenVolume(SimpleFileSystem, &Root);
     if (EFI_ERROR(Status)) {
-        Print(L"ERROR: Volume open\n");
+        EmitError(L"Volume open");
         return Status;    
     }
 
@@ -123,7 +110,7 @@ SaveBMP( CHAR16 *FileName,
                          EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE, 
                          0 );
     if (EFI_ERROR(Status)) {
-        Print(L"ERROR: File open\n");
+        EmitError(L"File open");
         return Status;
     }    
     
@@ -132,9 +119,11 @@ SaveBMP( CHAR16 *FileName,
     FileHandle->Close(FileHandle);
     
     if (EFI_ERROR(Status)) {
-        Print(L"ERROR: Saving image to file: %x\n", Status);
+        EmitError(L"Saving image to file: %x", Status);
+    } else if (EmitFormat() != EmitText) {
+        EmitString(L"saved", FileName);
     } else {
-        Print(L"Successfully saved image to bootlogo.bmp\n");
+        OutPrint(L"Successfully saved image to bootlogo.bmp\n");
     }
 
     return Status;
@@ -146,21 +135,21 @@ PrintAcpiHeader( EFI_ACPI_SDT_HEADER *Ptr )
 {
     CHAR16 Buffer[50];
 
-    Print(L"ACPI Standard Header\n");
+    OutPrint(L"ACPI Standard Header\n");
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->Signature), 4, Buffer, TRUE);
-    Print(L"  Signature         : %s\n", Buffer);
-    Print(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
-    Print(L"  Revision          : 0x%02x (%d)\n", Ptr->Revision, Ptr->Revision);
-    Print(L"  Checksum          : 0x%02x (%d)\n", Ptr->Checksum, Ptr->Checksum);
+    OutPrint(L"  Signature         : %s\n", Buffer);
+    OutPrint(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
+    OutPrint(L"  Revision          : 0x%02x (%d)\n", Ptr->Revision, Ptr->Revision);
+    OutPrint(L"  Checksum          : 0x%02x (%d)\n", Ptr->Checksum, Ptr->Checksum);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->OemId), 6, Buffer, TRUE);
-    Print(L"  OEM ID            : %s\n", Buffer);
+    OutPrint(L"  OEM ID            : %s\n", Buffer);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->OemTableId), 8, Buffer, TRUE);
-    Print(L"  OEM Table ID      : %s\n", Buffer);
-    Print(L"  OEM Revision      : 0x%08x (%d)\n", Ptr->OemRevision, Ptr->OemRevision);
+    OutPrint(L"  OEM Table ID      : %s\n", Buffer);
+    OutPrint(L"  OEM Revision      : 0x%08x (%d)\n", Ptr->OemRevision, Ptr->OemRevision);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->CreatorId), 4, Buffer, TRUE);
-    Print(L"  Creator ID        : %s\n", Buffer);
-    Print(L"  Creator Revision  : 0x%08x (%d)\n", Ptr->CreatorRevision, Ptr->CreatorRevision);
-    Print(L"\n");
+    OutPrint(L"  Creator ID        : %s\n", Buffer);
+    OutPrint(L"  Creator Revision  : 0x%08x (%d)\n", Ptr->CreatorRevision, Ptr->CreatorRevision);
+    OutPrint(L"\n");
 }
 
 
@@ -177,20 +166,20 @@ ParseBMP( UINT64 BmpImage,
 
     // Not BMP format
     if (BmpHeader->CharB != 'B' || BmpHeader->CharM != 'M') {
-        Print(L"ERROR: Unsupported image format\n"); 
+        EmitError(L"Unsupported image format");
         return EFI_UNSUPPORTED;
     }
 
     // BITMAPINFOHEADER format unsupported
     if (BmpHeader->HeaderSize != sizeof (BMP_IMAGE_HEADER) \
         - ((UINTN) &(((BMP_IMAGE_HEADER *)0)->HeaderSize))) {
-        Print(L"ERROR: Unsupported BITMAPFILEHEADER\n");
+        EmitError(L"Unsupported BITMAPFILEHEADER");
         return EFI_UNSUPPORTED;
     }
 
     // Compression type not 0
     if (BmpHeader->CompressionType != 0) {
-        Print(L"ERROR: Compression Type not 0\n");
+        EmitError(L"Compression Type not 0");
         return EFI_UNSUPPORTED;
     }
 
@@ -199,36 +188,96 @@ ParseBMP( UINT64 BmpImage,
         BmpHeader->BitPerPixel != 8 &&
         BmpHeader->BitPerPixel != 12 &&
         BmpHeader->BitPerPixel != 24) {
-        Print(L"ERROR: Bits per pixel is not one of 4, 8, 12 or 24\n");
+        EmitError(L"Bits per pixel is not one of 4, 8, 12 or 24");
         return EFI_UNSUPPORTED;
     }
 
     if (Mode == Saveimage) {
         Status = SaveBMP(L"bootlogo.bmp", (UINT8 *)BmpImage, BmpHeader->Size);
+    } else if (Mode == Verbose && EmitFormat() != EmitText) {
+        EmitObject(L"image");
+        EmitAscii(L"signature", (CHAR8 *)BmpHeader, 2);
+        EmitUint(L"size", BmpHeader->Size);
+        EmitUint(L"imageOffset", BmpHeader->ImageOffset);
+        EmitUint(L"headerSize", BmpHeader->HeaderSize);
+        EmitUint(L"width", BmpHeader->PixelWidth);
+        EmitUint(L"height", BmpHeader->PixelHeight);
+        EmitUint(L"planes", BmpHeader->Planes);
+        EmitUint(L"bitsPerPixel", BmpHeader->BitPerPixel);
+        EmitUint(L"compressionType", BmpHeader->CompressionType);
+        EmitUint(L"imageSize", BmpHeader->ImageSize);
+        EmitUint(L"xPixelsPerMeter", BmpHeader->XPixelsPerMeter);
+        EmitUint(L"yPixelsPerMeter", BmpHeader->YPixelsPerMeter);
+        EmitUint(L"numberOfColors", BmpHeader->NumberOfColors);
+        EmitUint(L"importantColors", BmpHeader->ImportantColors);
+        EmitClose();
     } else if (Mode == Verbose) {
-        Print(L"\n");
-        Print(L"Image Details\n");
+        OutPrint(L"\n");
+        OutPrint(L"Image Details\n");
         AsciiToUnicodeSize((CHAR8 *)BmpHeader, 2, Buffer, TRUE);
-        Print(L"  BMP Signature     : %s\n", Buffer);
-        Print(L"  Size              : %d\n", BmpHeader->Size);
-        Print(L"  Image Offset      : %d\n", BmpHeader->ImageOffset);
-        Print(L"  Header Size       : %d\n", BmpHeader->HeaderSize);
-        Print(L"  Image Width       : %d\n", BmpHeader->PixelWidth);
-        Print(L"  Image Height      : %d\n", BmpHeader->PixelHeight);
-        Print(L"  Planes            : %d\n", BmpHeader->Planes);
-        Print(L"  Bit Per Pixel     : %d\n", BmpHeader->BitPerPixel);
-        Print(L"  Compression Type  : %d\n", BmpHeader->CompressionType);
-        Print(L"  Image Size        : %d\n", BmpHeader->ImageSize);
-        Print(L"  X Pixels Per Meter: %d\n", BmpHeader->XPixelsPerMeter);
-        Print(L"  Y Pixels Per Meter: %d\n", BmpHeader->YPixelsPerMeter);
-        Print(L"  Number of Colors  : %d\n", BmpHeader->NumberOfColors);
-        Print(L"  Important Colors  : %d\n", BmpHeader->ImportantColors);
+        OutPrint(L"  BMP Signature     : %s\n", Buffer);
+        OutPrint(L"  Size              : %d\n", BmpHeader->Size);
+        OutPrint(L"  Image Offset      : %d\n", BmpHeader->ImageOffset);
+        OutPrint(L"  Header Size       : %d\n", BmpHeader->HeaderSize);
+        OutPrint(L"  Image Width       : %d\n", BmpHeader->PixelWidth);
+        OutPrint(L"  Image Height      : %d\n", BmpHeader->PixelHeight);
+        OutPrint(L"  Planes            : %d\n", BmpHeader->Planes);
+        OutPrint(L"  Bit Per Pixel     : %d\n", BmpHeader->BitPerPixel);
+        OutPrint(L"  Compression Type  : %d\n", BmpHeader->CompressionType);
+        OutPrint(L"  Image Size        : %d\n", BmpHeader->ImageSize);
+        OutPrint(L"  X Pixels Per Meter: %d\n", BmpHeader->XPixelsPerMeter);
+        OutPrint(L"  Y Pixels Per Meter: %d\n", BmpHeader->YPixelsPerMeter);
+        OutPrint(L"  Number of Colors  : %d\n", BmpHeader->NumberOfColors);
+        OutPrint(L"  Important Colors  : %d\n", BmpHeader->ImportantColors);
     } 
     
     return Status;
 }
 
 
+static VOID
+EmitBGRT( EFI_ACPI_BGRT *Bgrt,
+          MODE Mode )
+{
+    BMP_IMAGE_HEADER *BmpHeader = (BMP_IMAGE_HEADER *)Bgrt->ImageAddress;
+    EFI_ACPI_SDT_HEADER *Header = &(Bgrt->Header);
+
+    EmitObject(L"bgrt");
+    if (Mode == Hexdump) {
+        EmitBytes(L"data", Bgrt, sizeof(EFI_ACPI_BGRT));
+        if (BmpHeader->CharB == 'B' && BmpHeader->CharM == 'M')
+            EmitBytes(L"image", BmpHeader, BmpHeader->Size);
+        EmitClose();
+        return;
+    }
+
+    if (Mode == Verbose) {
+        EmitObject(L"header");
+        EmitAscii(L"signature", (CHAR8 *)&(Header->Signature), 4);
+        EmitUint(L"length", Header->Length);
+        EmitUint(L"revision", Header->Revision);
+        EmitHex(L"checksum", Header->Checksum, 2);
+        EmitAscii(L"oemId", (CHAR8 *)&(Header->OemId), 6);
+        EmitAscii(L"oemTableId", (CHAR8 *)&(Header->OemTableId), 8);
+        EmitHex(L"oemRevision", Header->OemRevision, 8);
+        EmitAscii(L"creatorId", (CHAR8 *)&(Header->CreatorId), 4);
+        EmitHex(L"creatorRevision", Header->CreatorRevision, 8);
+        EmitClose();
+    }
+    if (Mode != Saveimage) {
+        EmitUint(L"version", Bgrt->Version);
+        EmitUint(L"status", Bgrt->Status);
+        EmitBool(L"displayed", Bgrt->Status == EFI_ACPI_5_0_BGRT_STATUS_DISPLAYED);
+        EmitUint(L"imageType", Bgrt->ImageType);
+        EmitUint(L"offsetX", Bgrt->ImageOffsetX);
+        EmitUint(L"offsetY", Bgrt->ImageOffsetY);
+        EmitHex(L"imageAddress", Bgrt->ImageAddress, 16);
+    }
+    ParseBMP(Bgrt->ImageAddress, Mode);
+    EmitClose();
+}
+
+
 //
 // Parse Boot Graphic Resource Table
 //
@@ -236,66 +285,77 @@ static VOID
 ParseBGRT( EFI_ACPI_BGRT *Bgrt, 
            MODE Mode )
 {
-    Print(L"\n");
+    BMP_IMAGE_HEADER *BmpHeader = (BMP_IMAGE_HEADER *)Bgrt->ImageAddress;
+
+    if (EmitFormat() != EmitText) {
+        EmitBGRT(Bgrt, Mode);
+        return;
+    }
+
+    OutPrint(L"\n");
 
     if ( Mode == Hexdump ) {
-        DumpHex( (UINT8 *)Bgrt, (int)sizeof(EFI_ACPI_BGRT) );
+        OutHexDump( Bgrt, sizeof(EFI_ACPI_BGRT), 0 );
+        // the logo itself, which the BMP header gives the size of
+        if (BmpHeader->CharB == 'B' && BmpHeader->CharM == 'M') {
+            OutPrint(L"\nImage at 0x%08lx, %d bytes\n", Bgrt->ImageAddress, BmpHeader->Size);
+            OutHexDump( BmpHeader, BmpHeader->Size, 0 );
+        }
     } else {
         if ( Mode == Verbose) {
             PrintAcpiHeader( (EFI_ACPI_SDT_HEADER *)&(Bgrt->Header) );
         }
         if ( Mode != Saveimage ) {
-            Print(L"  Version           : %d\n", Bgrt->Version);
-            Print(L"  Status            : %d", Bgrt->Status);
+            OutPrint(L"  Version           : %d\n", Bgrt->Version);
+            OutPrint(L"  Status            : %d", Bgrt->Status);
             if (Bgrt->Status == EFI_ACPI_5_0_BGRT_STATUS_NOT_DISPLAYED) {
-                Print(L" (Not displayed)");
+                OutPrint(L" (Not displayed)");
             }
             if (Bgrt->Status == EFI_ACPI_5_0_BGRT_STATUS_DISPLAYED) {
-                Print(L" (Displayed)");
+                OutPrint(L" (Displayed)");
             }
-            Print(L"\n"); 
-            Print(L"  Image Type        : %d", Bgrt->ImageType); 
+            OutPrint(L"\n"); 
+            OutPrint(L"  Image Type        : %d", Bgrt->ImageType); 
             if (Bgrt->ImageType == EFI_ACPI_5_0_BGRT_IMAGE_TYPE_BMP) {
-                Print(L" (BMP format)");
+                OutPrint(L" (BMP format)");
             }
-            Print(L"\n"); 
-            Print(L"  Offset Y          : %ld\n", Bgrt->ImageOffsetY);
-            Print(L"  Offset X          : %ld\n", Bgrt->ImageOffsetX);
+            OutPrint(L"\n"); 
+            OutPrint(L"  Offset Y          : %ld\n", Bgrt->ImageOffsetY);
+            OutPrint(L"  Offset X          : %ld\n", Bgrt->ImageOffsetX);
         }
         if (Mode == Verbose) {
-            Print(L"  Physical Address  : 0x%08x\n", Bgrt->ImageAddress);
+            OutPrint(L"  Physical Address  : 0x%08x\n", Bgrt->ImageAddress);
         }
         ParseBMP( Bgrt->ImageAddress, Mode );
     }
  
-    Print(L"\n");
+    OutPrint(L"\n");
 }
 
 
 static int
-ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp, 
-           CHAR16* GuidStr,
+ParseRSDP( CONST ACPI_ROOT *Root,
            MODE Mode )
 {
+    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = Root->Rsdp;
     EFI_ACPI_SDT_HEADER *Xsdt, *Entry;
 #if 0
     CHAR16 OemStr[20];
 #endif
     UINT32 EntryCount;
-    UINT64 *EntryPtr;
 
 #ifdef DEBUG
-    Print(L"\n\nACPI GUID: %s\n", GuidStr);
+    OutPrint(L"\n\nACPI GUID: %g\n", Root->Guid);
 #endif
 
 #if 0
     AsciiToUnicodeSize((CHAR8 *)(Rsdp->OemId), 6, OemStr, FALSE);
 #endif
     if (Rsdp->Revision >= EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER_REVISION) {
-        Xsdt = (EFI_ACPI_SDT_HEADER *)(Rsdp->XsdtAddress);
+        Xsdt = Root->Xsdt;
     } else {
 #ifdef DEBUG
-        Print(L"ERROR: RSDP table < revision ACPI 2.0 found.\n");
+        OutPrint(L"ERROR: RSDP table < revision ACPI 2.0 found.\n");
 #endif
         return 1;
     }
@@ -307,13 +367,12 @@ ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp,
 #if 0
     AsciiToUnicodeSize((CHAR8 *)(Xsdt->OemId), 6, OemStr, FALSE);
 #endif
-    EntryCount = (Xsdt->Length - sizeof (EFI_ACPI_SDT_HEADER)) / sizeof(UINT64);
+    EntryCount = (UINT32)Root->TableCount;
 
-    EntryPtr = (UINT64 *)(Xsdt + 1);
-    for (int Index = 0; Index < EntryCount; Index++, EntryPtr++) {
-        Entry = (EFI_ACPI_SDT_HEADER *)((UINTN)(*EntryPtr));
+    for (UINTN Index = 0; Index < EntryCount; Index++) {
+        Entry = Root->Tables[Index];
         if (Entry->Signature == SIGNATURE_32 ('B', 'G', 'R', 'T')) {
-            ParseBGRT((EFI_ACPI_BGRT *)((UINTN)(*EntryPtr)), Mode);
+            ParseBGRT((EFI_ACPI_BGRT *)Entry, Mode);
         }
     }
 
@@ -324,10 +383,10 @@ ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp,
 static void
 Usage( void )
 {
-    Print(L"Usage: ShowBGRT [-v | --verbose]\n");
-    Print(L"       ShowBGRT [-s | --save]\n");
-    Print(L"       ShowBGRT [-d | --dump]\n");
-    Print(L"       ShowBGRT [-V | --version]\n");
+    OutPrint(L"Usage: ShowBGRT [-v | --verbose] [--json | --csv] [-o | --output filename]\n");
+    OutPrint(L"       ShowBGRT [-s | --save]\n");
+    OutPrint(L"       ShowBGRT [-d | --dump]\n");
+    OutPrint(L"       ShowBGRT [-V | --version]\n");
 }
 
 
@@ -336,13 +395,11 @@ EFIAPI
 ShellAppMain( UINTN Argc, 
               CHAR16 **Argv )
 {
-    EFI_CONFIGURATION_TABLE *ect = gST->ConfigurationTable;
-    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = NULL;
-    EFI_GUID gAcpi20TableGuid = EFI_ACPI_20_TABLE_GUID;
-    EFI_GUID gAcpi10TableGuid = ACPI_10_TABLE_GUID;
     EFI_STATUS Status = EFI_SUCCESS;
-    CHAR16 GuidStr[100];
-    MODE Mode;
+    MODE Mode = 0;
+
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
 
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--verbose") ||
@@ -356,7 +413,7 @@ ShellAppMain( UINTN Argc,
             Mode = Saveimage;
         } else if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -372,22 +429,18 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
+    EmitBegin(L"ShowBGRT", UTILITY_VERSION);
 
     // locate RSDP (Root System Description Pointer) 
-    for (int i = 0; i < gST->NumberOfTableEntries; i++) {
-        if ((CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi20TableGuid)) ||
-            (CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi10TableGuid))) {
-            if (!AsciiStrnCmp("RSD PTR ", (CHAR8 *)(ect->VendorTable), 8)) {
-                UnicodeSPrint(GuidStr, sizeof(GuidStr), L"%g", &(gST->ConfigurationTable[i].VendorGuid));
-                Rsdp = (EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *)ect->VendorTable;
-                ParseRSDP(Rsdp, GuidStr, Mode);
-            }
+    for (UINTN i = 0; i < AcpiRootCount(); i++) {
+        if (ParseRSDP(AcpiGetRoot(i), Mode) == 0 &&
+            EmitFormat() != EmitText) {
+            break;
         }
-        ect++;
     }
 
-    if (Rsdp == NULL) {
-	Print(L"ERROR: Could not find an ACPI RSDP table.\n");
+    if (AcpiRootCount() == 0) {
+	EmitError(L"Could not find an ACPI RSDP table.");
 	Status = EFI_NOT_FOUND;
     }
 
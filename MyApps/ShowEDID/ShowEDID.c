@@ -15,6 +15,8 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -304,11 +306,11 @@ CheckForValidEdid( EDID_DATA_BLOCK *EdidDataBlock )
 VOID
 PrintDetailedTimingBlock( UINT8 *dtb )
 {
-    Print(L"  Horizonal Image Size: %d mm\n", EDID_DET_TIMING_HSIZE(dtb));
-    Print(L"   Vertical Image Size: %d mm\n", EDID_DET_TIMING_VSIZE(dtb));
-    Print(L"  HoriImgSzByVertImgSz: %d\n", dtb[14]);
-    Print(L"     Horizontal Border: %d\n", EDID_DET_TIMING_HBORDER(dtb));
-    Print(L"       Vertical Border: %d\n", EDID_DET_TIMING_VBORDER(dtb));
+    OutPrint(L"  Horizonal Image Size: %d mm\n", EDID_DET_TIMING_HSIZE(dtb));
+    OutPrint(L"   Vertical Image Size: %d mm\n", EDID_DET_TIMING_VSIZE(dtb));
+    OutPrint(L"  HoriImgSzByVertImgSz: %d\n", dtb[14]);
+    OutPrint(L"     Horizontal Border: %d\n", EDID_DET_TIMING_HBORDER(dtb));
+    OutPrint(L"       Vertical Border: %d\n", EDID_DET_TIMING_VBORDER(dtb));
 }
 
 
@@ -317,81 +319,93 @@ PrintEdid( EDID_DATA_BLOCK *EdidDataBlock )
 { 
     UINT8 tmp;
 
-    Print(L"          EDID Version: 0x%02x (%d)\n", EdidDataBlock->EdidVersion,
-                                                    EdidDataBlock->EdidVersion );
-    Print(L"         EDID Revision: 0x%02x (%d)\n", EdidDataBlock->EdidRevision,
-                                                    EdidDataBlock->EdidRevision );
-    Print(L"   Vendor Abbreviation: %s\n", ManufacturerAbbrev(&(EdidDataBlock->ManufactureName)));
-    Print(L"            Product ID: 0x%08X\n", EdidDataBlock->ProductCode);
-    Print(L"         Serial Number: 0x%08X\n", EdidDataBlock->SerialNumber);
-    Print(L"      Manufacture Week: %02d\n", EdidDataBlock->WeekOfManufacture);
-    Print(L"      Manufacture Year: %d\n", EdidDataBlock->YearOfManufacture + 1990);
+    OutPrint(L"          EDID Version: 0x%02x (%d)\n", EdidDataBlock->EdidVersion,
+                                                       EdidDataBlock->EdidVersion );
+    OutPrint(L"         EDID Revision: 0x%02x (%d)\n", EdidDataBlock->EdidRevision,
+                                                       EdidDataBlock->EdidRevision );
+    OutPrint(L"   Vendor Abbreviation: %s\n", ManufacturerAbbrev(&(EdidDataBlock->ManufactureName)));
+    OutPrint(L"            Product ID: 0x%08X\n", EdidDataBlock->ProductCode);
+    OutPrint(L"         Serial Number: 0x%08X\n", EdidDataBlock->SerialNumber);
+    OutPrint(L"      Manufacture Week: %02d\n", EdidDataBlock->WeekOfManufacture);
+    OutPrint(L"      Manufacture Year: %d\n", EdidDataBlock->YearOfManufacture + 1990);
 
     tmp = (UINT8) EdidDataBlock->VideoInputDefinition;
-    Print(L"           Video Input: ");
+    OutPrint(L"           Video Input: ");
     if (CHECK_BIT(tmp, 7)) {
-        Print(L"Analog\n");
+        OutPrint(L"Analog\n");
     } else {
-        Print(L"Digital\n");
+        OutPrint(L"Digital\n");
     }
     if (tmp & 0x1F) {
-        Print(L"        Syncronization: ");
+        OutPrint(L"        Syncronization: ");
         if (CHECK_BIT(tmp, 4))
-            Print(L"BlankToBackSetup ");
+            OutPrint(L"BlankToBackSetup ");
         if (CHECK_BIT(tmp, 3))
-            Print(L"SeparateSync ");
+            OutPrint(L"SeparateSync ");
         if (CHECK_BIT(tmp, 2))
-            Print(L"CompositeSync ");
+            OutPrint(L"CompositeSync ");
         if (CHECK_BIT(tmp, 1))
-            Print(L"SyncOnGreen ");
+            OutPrint(L"SyncOnGreen ");
         if (CHECK_BIT(tmp, 0))
-            Print(L"SerrationVSync ");
-        Print(L"\n");
+            OutPrint(L"SerrationVSync ");
+        OutPrint(L"\n");
     }
 
     tmp = (UINT8) EdidDataBlock->DpmSupport;
-    Print(L"          Display Type: ");
+    OutPrint(L"          Display Type: ");
     if (CHECK_BIT(tmp, 3) && CHECK_BIT(tmp, 4)) {
-        Print(L"Undefined");
+        OutPrint(L"Undefined");
     } else if (CHECK_BIT(tmp, 3)) {
-        Print(L"RGB color");
+        OutPrint(L"RGB color");
     } else if (CHECK_BIT(tmp, 4)) {
-        Print(L"Non-RGB multicolor");
+        OutPrint(L"Non-RGB multicolor");
     } else {
-        Print(L"Monochrome");
+        OutPrint(L"Monochrome");
     }
-    Print(L"\n");
+    OutPrint(L"\n");
 
-    Print(L"    Max Horizonal Size: %1d cm\n", EdidDataBlock->MaxHorizontalImageSize);
-    Print(L"     Max Vertical Size: %1d cm\n", EdidDataBlock->MaxVerticalImageSize);
-    Print(L"                 Gamma: %s\n", DisplayGammaString(EdidDataBlock->DisplayGamma));
+    OutPrint(L"    Max Horizonal Size: %1d cm\n", EdidDataBlock->MaxHorizontalImageSize);
+    OutPrint(L"     Max Vertical Size: %1d cm\n", EdidDataBlock->MaxVerticalImageSize);
+    OutPrint(L"                 Gamma: %s\n", DisplayGammaString(EdidDataBlock->DisplayGamma));
 
     PrintDetailedTimingBlock((UINT8 *)&(EdidDataBlock->DescriptionBlock1[0]));
 }
 
 
-static VOID
-DumpEdid( UINT8 *ptr,
-          int Count )
+VOID
+EmitEdid( EDID_DATA_BLOCK *EdidDataBlock,
+          BOOLEAN Hexdump )
 {
-    int i = 0;
-
-    Print(L"\n");
-    Print(L"  ");
-    for (i = 0; i < Count; i++ ) {
-        if ( i > 0 && i%16 == 0)
-            Print(L"\n  ");
-        Print(L"0x%02x ", 0xff & *ptr++);
+    UINT8 *dtb = (UINT8 *)&(EdidDataBlock->DescriptionBlock1[0]);
+
+    EmitObject(NULL);
+    if (Hexdump) {
+        EmitBytes(L"data", EdidDataBlock, sizeof(EDID_DATA_BLOCK));
+        EmitClose();
+        return;
     }
-    Print(L"\n\n");
+    EmitUint(L"edidVersion", EdidDataBlock->EdidVersion);
+    EmitUint(L"edidRevision", EdidDataBlock->EdidRevision);
+    EmitString(L"vendor", ManufacturerAbbrev(&(EdidDataBlock->ManufactureName)));
+    EmitHex(L"productId", EdidDataBlock->ProductCode, 4);
+    EmitHex(L"serialNumber", EdidDataBlock->SerialNumber, 8);
+    EmitUint(L"manufactureWeek", EdidDataBlock->WeekOfManufacture);
+    EmitUint(L"manufactureYear", EdidDataBlock->YearOfManufacture + 1990);
+    EmitString(L"videoInput", CHECK_BIT(EdidDataBlock->VideoInputDefinition, 7) ? L"analog" : L"digital");
+    EmitUint(L"maxHorizontalSizeCm", EdidDataBlock->MaxHorizontalImageSize);
+    EmitUint(L"maxVerticalSizeCm", EdidDataBlock->MaxVerticalImageSize);
+    EmitString(L"gamma", DisplayGammaString(EdidDataBlock->DisplayGamma));
+    EmitUint(L"imageWidthMm", EDID_DET_TIMING_HSIZE(dtb));
+    EmitUint(L"imageHeightMm", EDID_DET_TIMING_VSIZE(dtb));
+    EmitClose();
 }
 
 
 static void
 Usage( void )
 {
-    Print(L"Usage: ShowEDID [-V | --version]\n");
-    Print(L"       ShowEDID [-d | --dump]\n");
+    OutPrint(L"Usage: ShowEDID [-V | --version]\n");
+    OutPrint(L"       ShowEDID [-d | --dump] [--json | --csv] [-o | --output filename]\n");
 }
 
 
@@ -409,11 +423,13 @@ ShellAppMain( UINTN Argc,
     BOOLEAN Found = FALSE;
     BOOLEAN Hexdump = FALSE;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
 
     if (Argc == 2) {
        if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
        } else if (!StrCmp(Argv[1], L"--dump") ||
             !StrCmp(Argv[1], L"-d")) {
@@ -432,6 +448,7 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
+    EmitBegin(L"ShowEDID", UTILITY_VERSION);
 
     // Try locating GOP by handle
     Status = gBS->LocateHandleBuffer( ByProtocol,
@@ -440,10 +457,12 @@ ShellAppMain( UINTN Argc,
                                       &HandleCount,
                                       &HandleBuffer );
     if (EFI_ERROR (Status)) {
-        Print(L"ERROR: No GOP handle found. Cannot locate an EDID.\n");
+        EmitError(L"No GOP handle found. Cannot locate an EDID.");
         return Status;
     }
 
+    EmitArray(L"displays");
+
     for (int i = 0; i < HandleCount; i++) {
         Status = gBS->OpenProtocol( HandleBuffer[i],
                                     &gEfiEdidDiscoveredProtocolGuid, 
@@ -454,19 +473,27 @@ ShellAppMain( UINTN Argc,
         if (Status == EFI_SUCCESS) {
             if (!CheckForValidEdid((EDID_DATA_BLOCK *)(Edp->Edid))) { 
                 Found = TRUE;
-                if (Hexdump) {
-                    DumpEdid((UINT8 *)(Edp->Edid), (int)sizeof(EDID_DATA_BLOCK) );
+                if (EmitFormat() != EmitText) {
+                    EmitEdid((EDID_DATA_BLOCK *)(Edp->Edid), Hexdump);
+                } else if (Hexdump) {
+                    OutPrint(L"\n");
+                    OutHexDump( Edp->Edid, sizeof(EDID_DATA_BLOCK), 0 );
+                    OutPrint(L"\n");
                 } else {
                     PrintEdid((EDID_DATA_BLOCK *)(Edp->Edid));
                 }
             } else {
-                Print(L"ERROR: Invalid EDID checksum\n");
+                EmitError(L"Invalid EDID checksum");
             }
         }
     }
+    EmitClose();
 
     if (!Found) {
-        Print(L"Cannot locate an EDID.\n");
+        if (EmitFormat() != EmitText)
+            EmitError(L"Cannot locate an EDID.");
+        else
+            OutPrint(L"Cannot locate an EDID.\n");
     }
 
     return EFI_SUCCESS;
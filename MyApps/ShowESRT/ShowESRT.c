@@ -14,6 +14,8 @@
 #include <Library/ShellLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -30,22 +32,6 @@ typedef enum {
 } MODE;
 
 
-static VOID
-DumpHex( UINT8 *ptr,
-         int Count )
-{
-    int i = 0;
-
-    Print(L"  ");
-    for (i = 0; i < Count; i++ ) {
-        if ( i > 0 && i%16 == 0)
-            Print(L"\n  ");
-        Print(L"0x%02x ", 0xff & *ptr++);
-    }
-    Print(L"\n");
-}
-
-
 VOID
 DumpEsrt( VOID *data,
           MODE Mode )
@@ -56,114 +42,145 @@ DumpEsrt( VOID *data,
     UINT16 PrivateFlags;
 
     if ( Mode == Hexdump ) {
-        Print(L"\n");
-        DumpHex( (UINT8 *)Esrt, (int)(sizeof(EFI_SYSTEM_RESOURCE_TABLE) \
-                                      + ((Esrt->FwResourceCount) * sizeof(EFI_SYSTEM_RESOURCE_ENTRY))) );
-        Print(L"\n");
+        OutPrint(L"\n");
+        OutHexDump( Esrt, sizeof(EFI_SYSTEM_RESOURCE_TABLE) \
+                          + ((Esrt->FwResourceCount) * sizeof(EFI_SYSTEM_RESOURCE_ENTRY)), 0 );
+        OutPrint(L"\n");
         return;
     }
 
     if ( Mode == Verbose ) {
-        Print(L"ESRT found at 0x%08x\n", data);
-        Print(L"Firmware Resource Count: %d\n", Esrt->FwResourceCount);
-        Print(L"Firmware Resource Max Count: %d\n", Esrt->FwResourceCountMax);
-        Print(L"Firmware Resource Version: %ld\n", Esrt->FwResourceVersion);
-        Print(L"\n");
+        OutPrint(L"ESRT found at 0x%08x\n", data);
+        OutPrint(L"Firmware Resource Count: %d\n", Esrt->FwResourceCount);
+        OutPrint(L"Firmware Resource Max Count: %d\n", Esrt->FwResourceCountMax);
+        OutPrint(L"Firmware Resource Version: %ld\n", Esrt->FwResourceVersion);
+        OutPrint(L"\n");
     }
 
     if (Esrt->FwResourceVersion != 1) {
-        Print(L"ERROR: Unsupported ESRT version: %d\n", Esrt->FwResourceVersion);
+        OutPrint(L"ERROR: Unsupported ESRT version: %d\n", Esrt->FwResourceVersion);
         return;
     }
 
     for (int i = 0; i < Esrt->FwResourceCount; i++) {
         ob = FALSE;
-        Print(L"Firmware Resource Entry: %d\n", i);
-        Print(L"Firmware Class GUID: %g\n", &EsrtEntry->FwClass);
-        Print(L"Firmware Type: %d ", EsrtEntry->FwType);
+        OutPrint(L"Firmware Resource Entry: %d\n", i);
+        OutPrint(L"Firmware Class GUID: %g\n", &EsrtEntry->FwClass);
+        OutPrint(L"Firmware Type: %d ", EsrtEntry->FwType);
         switch (EsrtEntry->FwType) {
-            case 0:  Print(L"(Unknown)\n");
+            case 0:  OutPrint(L"(Unknown)\n");
                      break;
-            case 1:  Print(L"(System)\n");
+            case 1:  OutPrint(L"(System)\n");
                      break;
-            case 2:  Print(L"(Device)\n");
+            case 2:  OutPrint(L"(Device)\n");
                      break;
-            case 3:  Print(L"(UEFI Driver)\n");
+            case 3:  OutPrint(L"(UEFI Driver)\n");
                      break;
-            default: Print(L"\n");
+            default: OutPrint(L"\n");
         }
-        Print(L"Firmware Version: 0x%08x\n", EsrtEntry->FwVersion);
-        Print(L"Lowest Supported Firmware Version: 0x%08x\n", EsrtEntry->LowestSupportedFwVersion);
+        OutPrint(L"Firmware Version: 0x%08x\n", EsrtEntry->FwVersion);
+        OutPrint(L"Lowest Supported Firmware Version: 0x%08x\n", EsrtEntry->LowestSupportedFwVersion);
 
-        Print(L"Capsule Flags: 0x%08x", EsrtEntry->CapsuleFlags);
+        OutPrint(L"Capsule Flags: 0x%08x", EsrtEntry->CapsuleFlags);
         PrivateFlags = (EsrtEntry->CapsuleFlags) &= 0xffff;
         if ( EsrtEntry->CapsuleFlags & CAPSULE_FLAGS_PERSIST_ACROSS_RESET ) {
             if (!ob) {
                 ob = TRUE;
-                Print(L" (");
+                OutPrint(L" (");
             }
-            Print(L"Persist Across Reboot");
+            OutPrint(L"Persist Across Reboot");
         }
         if ( EsrtEntry->CapsuleFlags & CAPSULE_FLAGS_POPULATE_SYSTEM_TABLE ) {
             if (!ob) {
                 ob = TRUE;
-                Print(L" (");
+                OutPrint(L" (");
             } else 
-                Print(L", ");
-            Print(L"Populate System Table");
+                OutPrint(L", ");
+            OutPrint(L"Populate System Table");
         }
         if ( EsrtEntry->CapsuleFlags & CAPSULE_FLAGS_INITIATE_RESET ) {
             if (!ob) {
                 ob = TRUE;
-                Print(L" (");
+                OutPrint(L" (");
             } else 
-                Print(L", ");
-            Print(L"Initiate Reset");
+                OutPrint(L", ");
+            OutPrint(L"Initiate Reset");
         }
         if ( PrivateFlags ) {
             if (!ob) {
                 ob = TRUE;
-                Print(L" (");
+                OutPrint(L" (");
             } else 
-                Print(L", ");
-            Print(L"Private Update Flags: 0x%04x", PrivateFlags);
+                OutPrint(L", ");
+            OutPrint(L"Private Update Flags: 0x%04x", PrivateFlags);
         }
         if (ob) 
-            Print(L")");
-        Print(L"\n");
-        Print(L"Last Attempt Version: 0x%08x\n", EsrtEntry->LastAttemptVersion);
-        Print(L"Last Attempt Status: %d ", EsrtEntry->LastAttemptStatus);
+            OutPrint(L")");
+        OutPrint(L"\n");
+        OutPrint(L"Last Attempt Version: 0x%08x\n", EsrtEntry->LastAttemptVersion);
+        OutPrint(L"Last Attempt Status: %d ", EsrtEntry->LastAttemptStatus);
         switch(EsrtEntry->LastAttemptStatus) {
-            case 0:  Print(L"(Success)\n");
+            case 0:  OutPrint(L"(Success)\n");
                      break;
-            case 1:  Print(L"(Unsuccessful)\n");
+            case 1:  OutPrint(L"(Unsuccessful)\n");
                      break;
-            case 2:  Print(L"(Insufficient Resources)\n");
+            case 2:  OutPrint(L"(Insufficient Resources)\n");
                      break;
-            case 3:  Print(L"(Incorrect Version)\n");
+            case 3:  OutPrint(L"(Incorrect Version)\n");
                      break;
-            case 4:  Print(L"(Invalid Image Format)\n");
+            case 4:  OutPrint(L"(Invalid Image Format)\n");
                      break;
-            case 5:  Print(L"(Authentication Error)\n");
+            case 5:  OutPrint(L"(Authentication Error)\n");
                      break;
-            case 6:  Print(L"(AC Power Not Connected)\n");
+            case 6:  OutPrint(L"(AC Power Not Connected)\n");
                      break;
-            case 7:  Print(L"(Insufficent Battery Power)\n");
+            case 7:  OutPrint(L"(Insufficent Battery Power)\n");
                      break;
-            default: Print(L"(Unknown)\n");
+            default: OutPrint(L"(Unknown)\n");
         }
-        Print(L"\n");
+        OutPrint(L"\n");
         EsrtEntry++;
     }
 }
 
 
+static VOID
+EmitEsrt( EFI_SYSTEM_RESOURCE_TABLE *Esrt )
+{
+    EFI_SYSTEM_RESOURCE_ENTRY *EsrtEntry = (EFI_SYSTEM_RESOURCE_ENTRY *)(Esrt + 1);
+
+    EmitHex(L"address", (UINTN)Esrt, 8);
+    EmitUint(L"resourceCount", Esrt->FwResourceCount);
+    EmitUint(L"resourceCountMax", Esrt->FwResourceCountMax);
+    EmitUint(L"resourceVersion", Esrt->FwResourceVersion);
+    if (Esrt->FwResourceVersion != 1) {
+        EmitError(L"Unsupported ESRT version: %d", Esrt->FwResourceVersion);
+        return;
+    }
+
+    EmitArray(L"entries");
+    for (int i = 0; i < Esrt->FwResourceCount; i++, EsrtEntry++) {
+        EmitObject(NULL);
+        EmitGuid(L"fwClass", &EsrtEntry->FwClass);
+        EmitUint(L"fwType", EsrtEntry->FwType);
+        EmitHex(L"fwVersion", EsrtEntry->FwVersion, 8);
+        EmitHex(L"lowestSupportedFwVersion", EsrtEntry->LowestSupportedFwVersion, 8);
+        EmitHex(L"capsuleFlags", EsrtEntry->CapsuleFlags, 8);
+        EmitHex(L"lastAttemptVersion", EsrtEntry->LastAttemptVersion, 8);
+        EmitUint(L"lastAttemptStatus", EsrtEntry->LastAttemptStatus);
+        EmitClose();
+    }
+    EmitClose();
+}
+
+
 static void
 Usage( void )
 {
-    Print(L"Usage: ShowESRT [-v | --verbose]\n");
-    Print(L"       ShowESRT [-d | --dump]\n");
-    Print(L"       ShowESRT [-V | --version]\n");
+    OutPrint(L"Usage: ShowESRT [-v | --verbose]\n");
+    OutPrint(L"       ShowESRT [-d | --dump]\n");
+    OutPrint(L"       ShowESRT [--json | --csv] [-o | --output filename]\n");
+    OutPrint(L"       ShowESRT [-V | --version]\n");
 }
 
 
@@ -177,6 +194,9 @@ ShellAppMain( UINTN Argc,
     EFI_STATUS Status = EFI_SUCCESS;
     MODE Mode = 0;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--verbose") ||
             !StrCmp(Argv[1], L"-v")) {
@@ -186,7 +206,7 @@ ShellAppMain( UINTN Argc,
             Mode = Hexdump;
         } else if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -202,16 +222,24 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
+    EmitBegin(L"ShowESRT", UTILITY_VERSION);
+
     for (int Index = 0; Index < gST->NumberOfTableEntries; Index++) {
         if (!CompareMem(&ect->VendorGuid, &EsrtGuid, sizeof(EsrtGuid))) {
-            DumpEsrt( ect->VendorTable, Mode );
+            if (EmitFormat() != EmitText)
+                EmitEsrt( ect->VendorTable );
+            else
+                DumpEsrt( ect->VendorTable, Mode );
             return EFI_SUCCESS;
         }
         ect++;
         continue;
     }
 
-    Print(L"No ESRT found\n");
+    if (EmitFormat() != EmitText)
+        EmitError(L"No ESRT found");
+    else
+        OutPrint(L"No ESRT found\n");
 
     return Status;
 }
@@ -14,6 +14,9 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+#include <Library/PlatformIndexLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -62,99 +65,101 @@ AsciiToUnicodeSize( CHAR8 *String,
 }
 
 
-static VOID
-PrintHexTable( UINT8 *ptr,
-               int Count )
-{
-    int i = 0;
-
-    Print(L"  ");
-    for (i = 0; i < Count; i++ ) {
-        if ( i > 0 && i%16 == 0)
-            Print(L"\n  ");
-        Print(L"0x%02x ", 0xff & *ptr++);
-    }
-    Print(L"\n");
-}
-
-
 static VOID 
 PrintFACS( EFI_ACPI_2_0_FIRMWARE_ACPI_CONTROL_STRUCTURE *Facs,
            BOOLEAN Hexdump )
 {
     CHAR16 Buffer[50];
 
-    Print(L"\n");
+    if (EmitFormat() != EmitText) {
+        EmitObject(L"facs");
+        EmitHex(L"address", (UINT64)(UINTN)Facs, 16);
+        if (Hexdump) {
+            EmitBytes(L"data", Facs, Facs->Length);
+        } else {
+            EmitAscii(L"signature", (CHAR8 *)&(Facs->Signature), 4);
+            EmitUint(L"length", Facs->Length);
+            EmitHex(L"hardwareSignature", Facs->HardwareSignature, 8);
+            EmitHex(L"firmwareWakingVector", Facs->FirmwareWakingVector, 8);
+            EmitHex(L"globalLock", Facs->GlobalLock, 8);
+            EmitHex(L"flags", Facs->Flags, 8);
+            EmitHex(L"xFirmwareWakingVector", Facs->XFirmwareWakingVector, 16);
+            EmitUint(L"version", Facs->Version);
+        }
+        EmitClose();
+        return;
+    }
+
+    OutPrint(L"\n");
     if (Hexdump) {
-        PrintHexTable( (UINT8 *)Facs, (int)(Facs->Length) );
+        OutHexDump( Facs, Facs->Length, 0 );
     } else {
-        Print(L"FACS Table Details\n"); 
+        OutPrint(L"FACS Table Details\n"); 
         AsciiToUnicodeSize((CHAR8 *)&(Facs->Signature), 4, Buffer, TRUE);
-        Print(L"  Signature             : %s\n", Buffer);
-        Print(L"  Length                : 0x%08x (%d)\n", Facs->Length, Facs->Length);
-        Print(L"  Hardware Signature    : 0x%08x (%d)\n", Facs->HardwareSignature, 
-                                                          Facs->HardwareSignature);
-        Print(L"  FirmwareWakingVector  : 0x%08x (%d)\n", Facs->FirmwareWakingVector, 
-                                                          Facs->FirmwareWakingVector);
-        Print(L"  GlobalLock            : 0x%08x (%d)\n", Facs->GlobalLock, Facs->GlobalLock);
-        Print(L"  Flags                 : 0x%08x (%d)\n", Facs->Flags, Facs->Flags);
-        Print(L"  XFirmwareWakingVector : 0x%016x (%ld)\n", Facs->XFirmwareWakingVector, 
-                                                            Facs->XFirmwareWakingVector);
-        Print(L"  Version               : 0x%02x (%d)\n", Facs->Version, Facs->Version);
-	Print(L"  Reserved:\n");
-        PrintHexTable( (UINT8 *)&(Facs->Reserved), 31 );
+        OutPrint(L"  Signature             : %s\n", Buffer);
+        OutPrint(L"  Length                : 0x%08x (%d)\n", Facs->Length, Facs->Length);
+        OutPrint(L"  Hardware Signature    : 0x%08x (%d)\n", Facs->HardwareSignature, 
+                                                             Facs->HardwareSignature);
+        OutPrint(L"  FirmwareWakingVector  : 0x%08x (%d)\n", Facs->FirmwareWakingVector, 
+                                                             Facs->FirmwareWakingVector);
+        OutPrint(L"  GlobalLock            : 0x%08x (%d)\n", Facs->GlobalLock, Facs->GlobalLock);
+        OutPrint(L"  Flags                 : 0x%08x (%d)\n", Facs->Flags, Facs->Flags);
+        OutPrint(L"  XFirmwareWakingVector : 0x%016x (%ld)\n", Facs->XFirmwareWakingVector, 
+                                                               Facs->XFirmwareWakingVector);
+        OutPrint(L"  Version               : 0x%02x (%d)\n", Facs->Version, Facs->Version);
+	OutPrint(L"  Reserved:\n");
+        OutHexDump( Facs->Reserved, sizeof(Facs->Reserved),
+                    OFFSET_OF(EFI_ACPI_2_0_FIRMWARE_ACPI_CONTROL_STRUCTURE, Reserved) );
     }
-    Print(L"\n");
+    OutPrint(L"\n");
 }
 
 
 static int
-ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp, 
-           CHAR16* GuidStr, 
+ParseRSDP( CONST ACPI_ROOT *Root,
            BOOLEAN Hexdump )
 {
     EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE *Fadt2Table;
     EFI_ACPI_2_0_FIRMWARE_ACPI_CONTROL_STRUCTURE *Facs2Table;
+    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = Root->Rsdp;
     EFI_ACPI_SDT_HEADER *Xsdt, *Entry;
     UINT32 EntryCount;
-    UINT64 *EntryPtr;
 #ifdef DEBUG
     CHAR16 OemStr[20];
 
-    Print(L"\n\nACPI GUID: %s\n", GuidStr);
+    OutPrint(L"\n\nACPI GUID: %g\n", Root->Guid);
 
     AsciiToUnicodeSize((CHAR8 *)(Rsdp->OemId), 6, OemStr, FALSE);
-    Print(L"\nFound RSDP. Version: %d  OEM ID: %s\n", (int)(Rsdp->Revision), OemStr);
+    OutPrint(L"\nFound RSDP. Version: %d  OEM ID: %s\n", (int)(Rsdp->Revision), OemStr);
 #endif
 
     if (Rsdp->Revision >= EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER_REVISION) {
-        Xsdt = (EFI_ACPI_SDT_HEADER *)(Rsdp->XsdtAddress);
+        Xsdt = Root->Xsdt;
     } else {
 #ifdef DEBUG 
-        Print(L"ERROR: No ACPI XSDT table found.\n");
+        OutPrint(L"ERROR: No ACPI XSDT table found.\n");
 #endif
         return 1;
     }
 
     if (Xsdt->Signature != SIGNATURE_32 ('X', 'S', 'D', 'T')) {
 #ifdef DEBUG 
-        Print(L"ERROR: Invalid ACPI XSDT table found.\n");
+        OutPrint(L"ERROR: Invalid ACPI XSDT table found.\n");
 #endif
         return 1;
     }
 
-    EntryCount = (Xsdt->Length - sizeof (EFI_ACPI_SDT_HEADER)) / sizeof(UINT64);
+    EntryCount = (UINT32)Root->TableCount;
 #ifdef DEBUG 
     AsciiToUnicodeSize((CHAR8 *)(Xsdt->OemId), 6, OemStr, FALSE);
-    Print(L"Found XSDT. OEM ID: %s  Entry Count: %d\n\n", OemStr, EntryCount);
+    OutPrint(L"Found XSDT. OEM ID: %s  Entry Count: %d\n\n", OemStr, EntryCount);
 #endif
 
     // Locate Fixed ACPI Description Table - "FACP"
-    EntryPtr = (UINT64 *)(Xsdt + 1);
-    for (int Index = 0; Index < EntryCount; Index++, EntryPtr++) {
-        Entry = (EFI_ACPI_SDT_HEADER *)((UINTN)(*EntryPtr));
+    for (UINTN Index = 0; Index < EntryCount; Index++) {
+        Entry = Root->Tables[Index];
         if (!AsciiStrnCmp( (CHAR8 *)&(Entry->Signature), "FACP", 4)) {
-            Fadt2Table = (EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE *)((UINTN)(*EntryPtr));
+            Fadt2Table = (EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE *)Entry;
             Facs2Table = (EFI_ACPI_2_0_FIRMWARE_ACPI_CONTROL_STRUCTURE *)((UINTN)(Fadt2Table->FirmwareCtrl));
             PrintFACS(Facs2Table, Hexdump);
         }
@@ -167,8 +172,8 @@ ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp,
 static void
 Usage( void )
 {
-    Print(L"Usage: ShowFACS [-d | --dump]\n");
-    Print(L"       ShowFACS [-V | --version]\n");
+    OutPrint(L"Usage: ShowFACS [-d | --dump] [--json | --csv] [-o | --output filename]\n");
+    OutPrint(L"       ShowFACS [-V | --version]\n");
 }
 
 
@@ -177,21 +182,19 @@ EFIAPI
 ShellAppMain( UINTN Argc, 
               CHAR16 **Argv )
 {
-    EFI_CONFIGURATION_TABLE *ect = gST->ConfigurationTable;
-    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = NULL;
-    EFI_GUID gAcpi20TableGuid = EFI_ACPI_20_TABLE_GUID;
-    EFI_GUID gAcpi10TableGuid = ACPI_10_TABLE_GUID;
     EFI_STATUS Status = EFI_SUCCESS;
-    CHAR16 GuidStr[100];
     BOOLEAN Hexdump = FALSE;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--dump") ||
             !StrCmp(Argv[1], L"-d")) {
             Hexdump = TRUE;
         } else if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -207,21 +210,18 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
+    EmitBegin(L"ShowFACS", UTILITY_VERSION);
+
     // Locate Root System Description Pointer Table - "RSDP" 
-    for (int i = 0; i < gST->NumberOfTableEntries; i++) {
-        if ((CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi20TableGuid)) ||
-            (CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi10TableGuid))) {
-            if (!AsciiStrnCmp("RSD PTR ", (CHAR8 *)(ect->VendorTable), 8)) {
-                UnicodeSPrint(GuidStr, sizeof(GuidStr), L"%g", &(gST->ConfigurationTable[i].VendorGuid));
-                Rsdp = (EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *)ect->VendorTable;
-                ParseRSDP(Rsdp, GuidStr, Hexdump); 
-            }        
+    for (UINTN i = 0; i < AcpiRootCount(); i++) {
+        if (ParseRSDP(AcpiGetRoot(i), Hexdump) == 0 &&
+            EmitFormat() != EmitText) {
+            break;
         }
-        ect++;
     }
 
-    if (Rsdp == NULL) {
-        Print(L"ERROR: Could not find an ACPI RSDP table.\n");
+    if (AcpiRootCount() == 0) {
+        EmitError(L"Could not find an ACPI RSDP table.");
         Status = EFI_NOT_FOUND;
     }
 
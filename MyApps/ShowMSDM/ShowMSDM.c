@@ -14,6 +14,9 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+#include <Library/PlatformIndexLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -66,42 +69,43 @@ AsciiToUnicodeSize( CHAR8 *String,
 }
 
 
-static VOID
-PrintHexTable( UINT8 *ptr,
-               int Count )
-{
-    int i = 0;
-
-    Print(L"  ");
-    for (i = 0; i < Count; i++ ) {
-        if ( i > 0 && i%16 == 0)
-            Print(L"\n  ");
-        Print(L"0x%02x ", 0xff & *ptr++);
-    }
-    Print(L"\n");
-}
-
-
 static VOID
 PrintAcpiHeader( EFI_ACPI_SDT_HEADER *Ptr )
 {
     CHAR16 Buffer[50];
 
-    Print(L"ACPI Standard Header\n");
+    OutPrint(L"ACPI Standard Header\n");
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->Signature), 4, Buffer, TRUE);
-    Print(L"  Signature         : %s\n", Buffer);
-    Print(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
-    Print(L"  Revision          : 0x%02x (%d)\n", Ptr->Revision, Ptr->Revision);
-    Print(L"  Checksum          : 0x%02x (%d)\n", Ptr->Checksum, Ptr->Checksum);
+    OutPrint(L"  Signature         : %s\n", Buffer);
+    OutPrint(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
+    OutPrint(L"  Revision          : 0x%02x (%d)\n", Ptr->Revision, Ptr->Revision);
+    OutPrint(L"  Checksum          : 0x%02x (%d)\n", Ptr->Checksum, Ptr->Checksum);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->OemId), 6, Buffer, TRUE);
-    Print(L"  OEM ID            : %s\n", Buffer);
+    OutPrint(L"  OEM ID            : %s\n", Buffer);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->OemTableId), 8, Buffer, TRUE);
-    Print(L"  OEM Table ID      : %s\n", Buffer);
-    Print(L"  OEM Revision      : 0x%08x (%d)\n", Ptr->OemRevision, Ptr->OemRevision);
+    OutPrint(L"  OEM Table ID      : %s\n", Buffer);
+    OutPrint(L"  OEM Revision      : 0x%08x (%d)\n", Ptr->OemRevision, Ptr->OemRevision);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->CreatorId), 4, Buffer, TRUE);
-    Print(L"  Creator ID        : %s\n", Buffer);
-    Print(L"  Creator Revision  : 0x%08x (%d)\n", Ptr->CreatorRevision, Ptr->CreatorRevision);
-    Print(L"\n");
+    OutPrint(L"  Creator ID        : %s\n", Buffer);
+    OutPrint(L"  Creator Revision  : 0x%08x (%d)\n", Ptr->CreatorRevision, Ptr->CreatorRevision);
+    OutPrint(L"\n");
+}
+
+
+static VOID
+EmitAcpiHeader( EFI_ACPI_SDT_HEADER *Ptr )
+{
+    EmitObject(L"header");
+    EmitAscii(L"signature", (CHAR8 *)&(Ptr->Signature), 4);
+    EmitUint(L"length", Ptr->Length);
+    EmitUint(L"revision", Ptr->Revision);
+    EmitHex(L"checksum", Ptr->Checksum, 2);
+    EmitAscii(L"oemId", (CHAR8 *)&(Ptr->OemId), 6);
+    EmitAscii(L"oemTableId", (CHAR8 *)&(Ptr->OemTableId), 8);
+    EmitHex(L"oemRevision", Ptr->OemRevision, 8);
+    EmitAscii(L"creatorId", (CHAR8 *)&(Ptr->CreatorId), 4);
+    EmitHex(L"creatorRevision", Ptr->CreatorRevision, 8);
+    EmitClose();
 }
 
 
@@ -112,17 +116,17 @@ PrintSoftwareLicensing( SOFTWARE_LICENSING *Ptr,
     CHAR16 Buffer[50];
 
     if (Verbose) {
-        Print(L"Software Licensing\n");
-        Print(L"  Version       : 0x%08x (%d)\n", Ptr->Version, Ptr->Version);
-        Print(L"  Reserved      : 0x%08x (%d)\n", Ptr->Reserved, Ptr->Reserved);
-        Print(L"  Data Type     : 0x%08x (%d)\n", Ptr->DataType, Ptr->DataType);
-        Print(L"  Data Reserved : 0x%08x (%d)\n", Ptr->DataReserved, Ptr->DataReserved);
-        Print(L"  Data Length   : 0x%08x (%d)\n", Ptr->DataLength, Ptr->DataLength);
+        OutPrint(L"Software Licensing\n");
+        OutPrint(L"  Version       : 0x%08x (%d)\n", Ptr->Version, Ptr->Version);
+        OutPrint(L"  Reserved      : 0x%08x (%d)\n", Ptr->Reserved, Ptr->Reserved);
+        OutPrint(L"  Data Type     : 0x%08x (%d)\n", Ptr->DataType, Ptr->DataType);
+        OutPrint(L"  Data Reserved : 0x%08x (%d)\n", Ptr->DataReserved, Ptr->DataReserved);
+        OutPrint(L"  Data Length   : 0x%08x (%d)\n", Ptr->DataLength, Ptr->DataLength);
         AsciiToUnicodeSize((CHAR8 *)(Ptr->Data), 30, Buffer, TRUE);
-        Print(L"  Data          : %s\n", Buffer);
+        OutPrint(L"  Data          : %s\n", Buffer);
     } else {
         AsciiToUnicodeSize((CHAR8 *)(Ptr->Data), 30, Buffer, FALSE);
-        Print(L"  %s\n", Buffer);
+        OutPrint(L"  %s\n", Buffer);
     }
 }
 
@@ -132,65 +136,82 @@ PrintMSDM( EFI_ACPI_MSDM *Msdm,
            BOOLEAN Verbose,
            BOOLEAN Hexdump )
 {
-    Print(L"\n");
+    SOFTWARE_LICENSING *SoftLic = &(Msdm->SoftLic);
+
+    if (EmitFormat() != EmitText) {
+        EmitObject(L"msdm");
+        if (Hexdump) {
+            EmitBytes(L"data", Msdm, Msdm->Header.Length);
+        } else {
+            if (Verbose) {
+                EmitAcpiHeader(&(Msdm->Header));
+                EmitUint(L"version", SoftLic->Version);
+                EmitUint(L"dataType", SoftLic->DataType);
+                EmitUint(L"dataLength", SoftLic->DataLength);
+            }
+            EmitAscii(L"productKey", SoftLic->Data, sizeof(SoftLic->Data));
+        }
+        EmitClose();
+        return;
+    }
+
+    OutPrint(L"\n");
     if (Hexdump) {
-        PrintHexTable( (UINT8 *)Msdm, (int)(Msdm->Header.Length) );
+        OutHexDump( Msdm, Msdm->Header.Length, 0 );
     } else {
         if (Verbose) {
             PrintAcpiHeader( (EFI_ACPI_SDT_HEADER *)&(Msdm->Header) );
         }
-        PrintSoftwareLicensing( (SOFTWARE_LICENSING *)&(Msdm->SoftLic), Verbose);
+        PrintSoftwareLicensing( SoftLic, Verbose);
     }
-    Print(L"\n");
+    OutPrint(L"\n");
 }
 
 
 static int
-ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp, 
-           CHAR16* GuidStr, 
+ParseRSDP( CONST ACPI_ROOT *Root,
            BOOLEAN Verbose,
            BOOLEAN Hexdump )
 {
+    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = Root->Rsdp;
     EFI_ACPI_SDT_HEADER *Xsdt, *Entry;
 #ifdef DEBUG 
     CHAR16 OemStr[20];
 #endif
     UINT32 EntryCount;
-    UINT64 *EntryPtr;
 
 #ifdef DEBUG 
-    Print(L"\n\nACPI GUID: %s\n", GuidStr);
+    OutPrint(L"\n\nACPI GUID: %g\n", Root->Guid);
 
     AsciiToUnicodeSize((CHAR8 *)(Rsdp->OemId), 6, OemStr, FALSE);
-    Print(L"\nFound RSDP. Version: %d  OEM ID: %s\n", (int)(Rsdp->Revision), OemStr);
+    OutPrint(L"\nFound RSDP. Version: %d  OEM ID: %s\n", (int)(Rsdp->Revision), OemStr);
 #endif
     if (Rsdp->Revision >= EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER_REVISION) {
-        Xsdt = (EFI_ACPI_SDT_HEADER *)(Rsdp->XsdtAddress);
+        Xsdt = Root->Xsdt;
     } else {
 #ifdef DEBUG 
-        Print(L"ERROR: No ACPI XSDT table found.\n");
+        OutPrint(L"ERROR: No ACPI XSDT table found.\n");
 #endif
         return 1;
     }
 
     if (Xsdt->Signature != SIGNATURE_32 ('X', 'S', 'D', 'T')) {
 #ifdef DEBUG 
-        Print(L"ERROR: Invalid ACPI XSDT table found.\n");
+        OutPrint(L"ERROR: Invalid ACPI XSDT table found.\n");
 #endif
         return 1;
     }
 
-    EntryCount = (Xsdt->Length - sizeof (EFI_ACPI_SDT_HEADER)) / sizeof(UINT64);
+    EntryCount = (UINT32)Root->TableCount;
 #ifdef DEBUG 
     AsciiToUnicodeSize((CHAR8 *)(Xsdt->OemId), 6, OemStr, FALSE);
-    Print(L"Found XSDT. OEM ID: %s  Entry Count: %d\n\n", OemStr, EntryCount);
+    OutPrint(L"Found XSDT. OEM ID: %s  Entry Count: %d\n\n", OemStr, EntryCount);
 #endif
 
-    EntryPtr = (UINT64 *)(Xsdt + 1);
-    for (int Index = 0; Index < EntryCount; Index++, EntryPtr++) {
-        Entry = (EFI_ACPI_SDT_HEADER *)((UINTN)(*EntryPtr));
+    for (UINTN Index = 0; Index < EntryCount; Index++) {
+        Entry = Root->Tables[Index];
         if (Entry->Signature == SIGNATURE_32 ('M', 'S', 'D', 'M')) {
-            PrintMSDM((EFI_ACPI_MSDM *)((UINTN)(*EntryPtr)), Verbose, Hexdump);
+            PrintMSDM((EFI_ACPI_MSDM *)Entry, Verbose, Hexdump);
         }
     }
 
@@ -201,9 +222,9 @@ ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp,
 static void
 Usage( void )
 {
-    Print(L"Usage: ShowMSDM [-v | --verbose]\n");
-    Print(L"       ShowMSDM [-V | --version]\n");
-    Print(L"       ShowMSDM [-d | --dump]\n");
+    OutPrint(L"Usage: ShowMSDM [-v | --verbose] [--json | --csv] [-o | --output filename]\n");
+    OutPrint(L"       ShowMSDM [-V | --version]\n");
+    OutPrint(L"       ShowMSDM [-d | --dump]\n");
 }
 
 
@@ -212,15 +233,13 @@ EFIAPI
 ShellAppMain( UINTN Argc, 
               CHAR16 **Argv )
 {
-    EFI_CONFIGURATION_TABLE *ect = gST->ConfigurationTable;
-    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = NULL;
-    EFI_GUID gAcpi20TableGuid = EFI_ACPI_20_TABLE_GUID;
-    EFI_GUID gAcpi10TableGuid = ACPI_10_TABLE_GUID;
     EFI_STATUS Status = EFI_SUCCESS;
-    CHAR16 GuidStr[100];
     BOOLEAN Verbose = FALSE;
     BOOLEAN Hexdump = FALSE;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--verbose") ||
             !StrCmp(Argv[1], L"-v")) {
@@ -230,7 +249,7 @@ ShellAppMain( UINTN Argc,
             Hexdump = TRUE;
         } else if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -246,21 +265,18 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
+    EmitBegin(L"ShowMSDM", UTILITY_VERSION);
+
     // locate RSDP (Root System Description Pointer) 
-    for (int i = 0; i < gST->NumberOfTableEntries; i++) {
-        if ((CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi20TableGuid)) ||
-            (CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi10TableGuid))) {
-            if (!AsciiStrnCmp("RSD PTR ", (CHAR8 *)(ect->VendorTable), 8)) {
-                UnicodeSPrint(GuidStr, sizeof(GuidStr), L"%g", &(gST->ConfigurationTable[i].VendorGuid));
-                Rsdp = (EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *)ect->VendorTable;
-                ParseRSDP(Rsdp, GuidStr, Verbose, Hexdump); 
-            }        
+    for (UINTN i = 0; i < AcpiRootCount(); i++) {
+        if (ParseRSDP(AcpiGetRoot(i), Verbose, Hexdump) == 0 &&
+            EmitFormat() != EmitText) {
+            break;
         }
-        ect++;
     }
 
-    if (Rsdp == NULL) {
-        Print(L"ERROR: Could not find an ACPI RSDP table.\n");
+    if (AcpiRootCount() == 0) {
+        EmitError(L"Could not find an ACPI RSDP table.");
         Status = EFI_NOT_FOUND;
     }
 
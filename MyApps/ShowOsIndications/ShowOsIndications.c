@@ -18,6 +18,9 @@
 #include <Library/ShellLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+#include <Library/PlatformIndexLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -26,11 +29,25 @@
 #undef DEBUG
 
 
-VOID
+static VOID
 Usage( VOID )
 {
-    Print(L"Usage: ShowOsIndications [-v | --verbose]\n");
-    Print(L"                         [-V | --version]\n");
+    OutPrint(L"Usage: ShowOsIndications [-v | --verbose]\n");
+    OutPrint(L"                         [--json | --csv] [-o | --output filename]\n");
+    OutPrint(L"                         [-V | --version]\n");
+}
+
+
+static VOID
+EmitFeature( CHAR16 *Name,
+             BOOLEAN Supported,
+             BOOLEAN Set )
+{
+    EmitObject(NULL);
+    EmitString(L"name", Name);
+    EmitBool(L"supported", Supported);
+    EmitBool(L"set", Set);
+    EmitClose();
 }
 
 
@@ -52,10 +69,13 @@ ShellAppMain( UINTN Argc,
     UINTN      DataSize;
     UINT32     Attributes;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--version") || 
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--verbose") ||
             !StrCmp(Argv[1], L"-v")) {
@@ -74,39 +94,40 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
+    EmitBegin(L"ShowOsIndications", UTILITY_VERSION);
 
     Attributes = EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
     DataSize = sizeof(UINT64);
 
-    Status = gRT->GetVariable( EFI_OS_INDICATIONS_SUPPORT_VARIABLE_NAME,
-                               &gEfiGlobalVariableGuid,
-                               &Attributes,
-                               &DataSize,
-                               &OsIndicationsSupported);
+    Status = VarCacheGet( EFI_OS_INDICATIONS_SUPPORT_VARIABLE_NAME,
+                          &gEfiGlobalVariableGuid,
+                          &Attributes,
+                          &DataSize,
+                          &OsIndicationsSupported);
     if (Status == EFI_NOT_FOUND) {
-        Print(L"ERROR: OsIndicationsSupported variable not found.\n");
+        EmitError(L"OsIndicationsSupported variable not found.");
         return Status;
     }
 
 #ifdef DEBUG
-    Print(L"OSIndicationsSupported variable found: 0x%016x\n", OsIndicationSupport );
+    OutPrint(L"OSIndicationsSupported variable found: 0x%016x\n", OsIndicationSupport );
 #endif
 
     Attributes = EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
     DataSize = sizeof(UINT64);
 
-    Status = gRT->GetVariable( EFI_OS_INDICATIONS_VARIABLE_NAME,
-                               &gEfiGlobalVariableGuid,
-                               &Attributes,
-                               &DataSize,
-                               &OsIndications);
+    Status = VarCacheGet( EFI_OS_INDICATIONS_VARIABLE_NAME,
+                          &gEfiGlobalVariableGuid,
+                          &Attributes,
+                          &DataSize,
+                          &OsIndications);
     if (Status == EFI_NOT_FOUND) {
-        Print(L"ERROR: OSIndications variable not found.\n");
+        EmitError(L"OSIndications variable not found.");
         return Status;
     }
 
 #ifdef DEBUG
-    Print(L"OsIndications variable found: 0x%016x\n", OsIndication);
+    OutPrint(L"OsIndications variable found: 0x%016x\n", OsIndication);
 #endif
 
     SupportBootFwUi = (BOOLEAN) ((OsIndicationsSupported & EFI_OS_INDICATIONS_BOOT_TO_FW_UI) != 0);
@@ -123,25 +144,39 @@ ShellAppMain( UINTN Argc,
     CapsuleResultVariable = (BOOLEAN) ((OsIndications & EFI_OS_INDICATIONS_CAPSULE_RESULT_VAR_SUPPORTED) != 0);
     PlatformRecovery = (BOOLEAN) ((OsIndications & EFI_OS_INDICATIONS_START_PLATFORM_RECOVERY) != 0);
 
-    Print(L"\n");
+    if (EmitFormat() != EmitText) {
+        EmitHex(L"osIndicationsSupported", OsIndicationsSupported, 16);
+        EmitHex(L"osIndications", OsIndications, 16);
+        EmitArray(L"features");
+        EmitFeature(L"Boot to Firmware UI", SupportBootFwUi, BootFwUi);
+        EmitFeature(L"Timestamp Revocation", SupportTimeStampRevocation, TimeStampRevocation);
+        EmitFeature(L"File Capsule Delivery Support", SupportFileCapsuleDelivery, FileCapsuleDelivery);
+        EmitFeature(L"FMP Capsule Support", SupportFMPCapsuleSupported, FMPCapsuleSupported);
+        EmitFeature(L"Capsule Result Variable Support", SupportCapsuleResultVariable, CapsuleResultVariable);
+        EmitFeature(L"Start Platform Recovery", SupportPlatformRecovery, PlatformRecovery);
+        EmitClose();
+        return Status;
+    }
+
+    OutPrint(L"\n");
     if (Verbose) {
-        Print(L"    OsIndicationsSupported Variable: 0x%016x\n", OsIndicationsSupported); 
-        Print(L"             OsIndications Variable: 0x%016x\n", OsIndications); 
-        Print(L"\n");
+        OutPrint(L"    OsIndicationsSupported Variable: 0x%016x\n", OsIndicationsSupported); 
+        OutPrint(L"             OsIndications Variable: 0x%016x\n", OsIndications); 
+        OutPrint(L"\n");
     }
-    Print(L"                Boot to Firmware UI: %s [%s]\n", SupportBootFwUi ? L"Supported  " : L"Unsupported", 
-                                                             BootFwUi ? L"Set" : L"Unset");
-    Print(L"               Timestamp Revocation: %s [%s]\n", SupportTimeStampRevocation ? L"Supported  " : L"Unsupported", 
-                                                             TimeStampRevocation ? L"Set" : L"Unset");
-    Print(L"      File Capsule Delivery Support: %s [%s]\n", SupportFileCapsuleDelivery ? L"Supported  " : L"Unsupported",
-                                                             FileCapsuleDelivery ? L"Set" : L"Unset");
-    Print(L"                FMP Capsule Support: %s [%s]\n", SupportFMPCapsuleSupported ? L"Supported  " : L"Unsupported",
-                                                             FMPCapsuleSupported ? L"Set" : L"Unset");
-    Print(L"    Capsule Result Variable Support: %s [%s]\n", SupportCapsuleResultVariable ? L"Supported  " : L"Unsupported", 
-                                                             CapsuleResultVariable ? L"Set" : L"Unset");
-    Print(L"            Start Platform Recovery: %s [%s]\n", SupportPlatformRecovery ? L"Supported  " : L"Unsupported",
-                                                             PlatformRecovery ? L"Set" : L"Unset");
-    Print(L"\n");
+    OutPrint(L"                Boot to Firmware UI: %s [%s]\n", SupportBootFwUi ? L"Supported  " : L"Unsupported", 
+                                                                BootFwUi ? L"Set" : L"Unset");
+    OutPrint(L"               Timestamp Revocation: %s [%s]\n", SupportTimeStampRevocation ? L"Supported  " : L"Unsupported", 
+                                                                TimeStampRevocation ? L"Set" : L"Unset");
+    OutPrint(L"      File Capsule Delivery Support: %s [%s]\n", SupportFileCapsuleDelivery ? L"Supported  " : L"Unsupported",
+                                                                FileCapsuleDelivery ? L"Set" : L"Unset");
+    OutPrint(L"                FMP Capsule Support: %s [%s]\n", SupportFMPCapsuleSupported ? L"Supported  " : L"Unsupported",
+                                                                FMPCapsuleSupported ? L"Set" : L"Unset");
+    OutPrint(L"    Capsule Result Variable Support: %s [%s]\n", SupportCapsuleResultVariable ? L"Supported  " : L"Unsupported", 
+                                                                CapsuleResultVariable ? L"Set" : L"Unset");
+    OutPrint(L"            Start Platform Recovery: %s [%s]\n", SupportPlatformRecovery ? L"Supported  " : L"Unsupported",
+                                                                PlatformRecovery ? L"Set" : L"Unset");
+    OutPrint(L"\n");
 
     return Status;
 }
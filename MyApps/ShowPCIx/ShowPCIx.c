@@ -20,16 +20,15 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+#include <Library/PlatformIndexLib.h>
 
 #include <Protocol/EfiShell.h>
-#include <Protocol/PciEnumerationComplete.h>
 #include <Protocol/PciRootBridgeIo.h>
 
 #include <IndustryStandard/Pci.h>
 
-#define CALC_EFI_PCI_ADDRESS(Bus, Dev, Func, Reg) \
-    ((UINT64) ((((UINTN) Bus) << 24) + (((UINTN) Dev) << 16) + (((UINTN) Func) << 8) + ((UINTN) Reg)))
-
 // all typedefs from UDK2015 sources
 
 #if 0    // Pci22.h
@@ -84,27 +83,11 @@ typedef struct {
 } PCI_CARDBUS_CONTROL_REGISTER;
 #endif
 
-#pragma pack(1)
-typedef union {
-   PCI_DEVICE_HEADER_TYPE_REGION  Device;
-   PCI_CARDBUS_CONTROL_REGISTER   CardBus;
-} NON_COMMON_UNION;
-
-typedef struct {
-   PCI_DEVICE_INDEPENDENT_REGION  Common;
-   NON_COMMON_UNION               NonCommon;
-   UINT32                         Data[48];
-} PCI_CONFIG_SPACE;
-#pragma pack()
-
 #define UTILITY_VERSION L"20180327"
 #undef DEBUG
 #define LINE_MAX 1024
 #define PCIDATABASE L"pci.ids"
 
-#define EFI_PCI_EMUMERATION_COMPLETE_GUID \
-    { 0x30cfe3e7, 0x3de1, 0x4586, {0xbe, 0x20, 0xde, 0xab, 0xa1, 0xb3, 0xb7, 0x93}}
-
 
 CHAR16 *
 GetDeviceDesc( CHAR16 *Line )
@@ -159,70 +142,6 @@ GetVendorDesc( CHAR16 *Line )
 }
 
 
-//
-// Copyed from UDK2015 Source.
-//
-EFI_STATUS
-PciGetNextBusRange( EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR **Descriptors,
-                    UINT16 *MinBus,
-                    UINT16 *MaxBus,
-                    BOOLEAN *IsEnd )
-{
-    *IsEnd = FALSE;
-
-    if ((*Descriptors) == NULL) {
-        *MinBus = 0;
-        *MaxBus = PCI_MAX_BUS;
-        return EFI_SUCCESS;
-    }
-
-    while ((*Descriptors)->Desc != ACPI_END_TAG_DESCRIPTOR) {
-        if ((*Descriptors)->ResType == ACPI_ADDRESS_SPACE_TYPE_BUS) {
-            *MinBus = (UINT16) (*Descriptors)->AddrRangeMin;
-            *MaxBus = (UINT16) (*Descriptors)->AddrRangeMax;
-            (*Descriptors)++;
-            return (EFI_SUCCESS);
-        }
-
-        (*Descriptors)++;
-    }
-
-    if ((*Descriptors)->Desc == ACPI_END_TAG_DESCRIPTOR) {
-        *IsEnd = TRUE;
-    }
-
-    return EFI_SUCCESS;
-}
-
-
-//
-// Copyed from UDK2015 Source. 
-//
-EFI_STATUS
-PciGetProtocolAndResource( EFI_HANDLE Handle,
-                           EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL **IoDev,
-                           EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR **Descriptors )
-{
-    EFI_STATUS Status;
-
-    Status = gBS->HandleProtocol( Handle,
-                                  &gEfiPciRootBridgeIoProtocolGuid,
-                                  (VOID**)IoDev );
-    if (EFI_ERROR (Status)) {
-        return Status;
-    }
-
-    Status = (*IoDev)->Configuration ( *IoDev,
-                                       (VOID**)Descriptors );
-    if (Status == EFI_UNSUPPORTED) {
-        *Descriptors = NULL;
-        return EFI_SUCCESS;
-    }
-
-    return Status;
-}
-
-
 VOID
 LowerCaseStr( CHAR16 *Str )
 {
@@ -271,10 +190,16 @@ SearchPciData( SHELL_FILE_HANDLE FileHandle,
         }
  
         if (StrnCmp(ReadLine, Vendor, 4) == 0) {
-            Print(L"     %s", GetVendorDesc(ReadLine));
+            if (EmitFormat() != EmitText)
+                EmitString(L"vendorName", GetVendorDesc(ReadLine));
+            else
+                OutPrint(L"     %s", GetVendorDesc(ReadLine));
             VendorFound = TRUE;
         } else if (VendorFound && StrnCmp(&ReadLine[1], Device, 4) == 0) {
-            Print(L", %s", GetDeviceDesc(ReadLine));
+            if (EmitFormat() != EmitText)
+                EmitString(L"deviceName", GetDeviceDesc(ReadLine));
+            else
+                OutPrint(L", %s", GetDeviceDesc(ReadLine));
             Found = TRUE;
             break;
         } else if (VendorFound && (StrnCmp(ReadLine, L"\t", 1) != 0) && 
@@ -283,19 +208,28 @@ SearchPciData( SHELL_FILE_HANDLE FileHandle,
         }
     }
 
+    // the same columns for every device
+    if (EmitFormat() != EmitText) {
+        if (!VendorFound)
+            EmitString(L"vendorName", L"");
+        if (!Found)
+            EmitString(L"deviceName", L"");
+    }
+
     return Found;
 } 
 
 
-VOID
+static VOID
 Usage( BOOLEAN ErrorMsg )
 {
     if ( ErrorMsg ) {
-        Print(L"ERROR: Unknown option(s).\n");
+        OutPrint(L"ERROR: Unknown option(s).\n");
     }
 
-    Print(L"Usage: ShowPCIx [ -v | --verbose ]\n");
-    Print(L"       ShowPCIx [ -V | --version ]\n");
+    OutPrint(L"Usage: ShowPCIx [ -v | --verbose ]\n");
+    OutPrint(L"       ShowPCIx [ --json | --csv ] [ -o | --output filename ]\n");
+    OutPrint(L"       ShowPCIx [ -V | --version ]\n");
 }
 
 
@@ -304,31 +238,25 @@ EFIAPI
 ShellAppMain( UINTN Argc, 
               CHAR16 **Argv )
 {
-    EFI_GUID gEfiPciEnumerationCompleteProtocolGuid = EFI_PCI_EMUMERATION_COMPLETE_GUID;  
+    CONST PCI_FUNCTION *Functions, *Function;
+    CONST PCI_DEVICE_INDEPENDENT_REGION *PciHeader;
+    CONST PCI_DEVICE_HEADER_TYPE_REGION *DeviceHeader;
     EFI_STATUS Status = EFI_SUCCESS;
-    EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL *IoDev;
-    EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR *Descriptors;
     SHELL_FILE_HANDLE InFileHandle = (SHELL_FILE_HANDLE)NULL;
-    PCI_DEVICE_HEADER_TYPE_REGION *DeviceHeader;
-    PCI_DEVICE_INDEPENDENT_REGION PciHeader;
-    PCI_CONFIG_SPACE ConfigSpace;
     CHAR16 *FullFileName = (CHAR16 *)NULL;
     CHAR16 FileName[] = PCIDATABASE;
     CHAR16 *ReadLine = (CHAR16 *)NULL;
-    VOID *Interface;
-    EFI_HANDLE *HandleBuf;
-    UINTN HandleBufSize;
-    UINTN HandleCount;
+    UINTN Count, Ranges;
     UINTN Size = LINE_MAX;
-    UINT16 MinBus, MaxBus;
-    UINT64 Address;
-    BOOLEAN IsEnd; 
     BOOLEAN Verbose = FALSE;
   
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--verbose") ||
             !StrCmp(Argv[1], L"-v")) {
@@ -347,52 +275,24 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
-    Status = gBS->LocateProtocol( &gEfiPciEnumerationCompleteProtocolGuid,
-                                  NULL,
-                                  &Interface );
-    if (EFI_ERROR(Status)) {
-        Print(L"ERROR: Could not find PCI database file: %s\n", PCIDATABASE);
-        return Status;
-    }
+    EmitBegin(L"ShowPCIx", UTILITY_VERSION);
 
-    HandleBufSize = sizeof(EFI_HANDLE);
-    HandleBuf = (EFI_HANDLE *) AllocateZeroPool( HandleBufSize );
-    if (HandleBuf == NULL) {
-        Print(L"ERROR: Out of memory resources\n");
-        goto Done;
-    }
-
-    Status = gBS->LocateHandle( ByProtocol,
-                                &gEfiPciRootBridgeIoProtocolGuid,
-                                NULL,
-                                &HandleBufSize,
-                                HandleBuf );
-
-    if (Status == EFI_BUFFER_TOO_SMALL) {
-        HandleBuf = ReallocatePool ( sizeof (EFI_HANDLE), 
-                                     HandleBufSize, 
-                                     HandleBuf );
-        if (HandleBuf == NULL) {
-            Print(L"ERROR: Out of memory resources\n");
-            goto Done;
-        }
-
-        Status = gBS->LocateHandle( ByProtocol,
-                                    &gEfiPciRootBridgeIoProtocolGuid,
-                                    NULL,
-                                    &HandleBufSize,
-                                    HandleBuf );
-    }
-
-    if (EFI_ERROR (Status)) {
-        Print(L"ERROR: Failed to find any PCI handles\n");
-        goto Done;
+    Status = PciGetFunctions(&Functions, &Count, &Ranges);
+    if (Status == EFI_NOT_READY) {
+        EmitError(L"PCI enumeration has not completed");
+        return Status;
+    } else if (Status == EFI_OUT_OF_RESOURCES) {
+        EmitError(L"Out of memory resources");
+        return Status;
+    } else if (EFI_ERROR(Status)) {
+        EmitError(L"Failed to find any PCI handles");
+        return Status;
     }
 
     if (Verbose) {
         FullFileName = ShellFindFilePath( FileName );
         if (FullFileName == NULL) {
-            Print(L"ERROR: Could not find %s\n", FileName);
+            EmitError(L"Could not find %s", FileName);
             Status = EFI_NOT_FOUND;
             goto Done;
         }
@@ -403,109 +303,68 @@ ShellAppMain( UINTN Argc,
                                       EFI_FILE_MODE_READ,
                                       0 );
         if (EFI_ERROR(Status)) {
-            Print(L"ERROR: Could not open %s\n", FileName);
+            EmitError(L"Could not open %s", FileName);
             goto Done;
         }
 
         // allocate a buffer to read lines into
         ReadLine = AllocateZeroPool(Size);
         if (ReadLine == NULL) {
-            Print(L"ERROR: Could not allocate memory\n");
+            EmitError(L"Could not allocate memory");
             Status = EFI_OUT_OF_RESOURCES;
             goto Done;
         }
     }
 
-    HandleCount = HandleBufSize / sizeof (EFI_HANDLE);
+    EmitArray(L"devices");
 
-    for (UINT16 Index = 0; Index < HandleCount; Index++) {
-        Status = PciGetProtocolAndResource( HandleBuf[Index],
-                                            &IoDev,
-                                            &Descriptors );
-        if (EFI_ERROR(Status)) {
-            Print(L"ERROR: PciGetProtocolAndResource [%d]\n, Status");
-            goto Done;
+    for (UINTN Range = 0; Range < Ranges; Range++) {
+        if (EmitFormat() == EmitText) {
+            OutPrint(L"\n");
+            OutPrint(L"Bus    Vendor   Device  Subvendor SVDevice\n");
+            OutPrint(L"\n");
         }
-  
-        while(1) {
-            Status = PciGetNextBusRange( &Descriptors, &MinBus, &MaxBus, &IsEnd );
-            if (EFI_ERROR(Status)) {
-                Print(L"ERROR: Retrieving PCI bus range [%d]\n", Status);
-                goto Done;
-            }
 
-            if ( IsEnd ) {
-                break;
+        for (UINTN Index = 0; Index < Count; Index++) {
+            Function = &Functions[Index];
+            if (Function->Range != Range)
+                continue;
+            PciHeader = &Function->Config.Type0.Hdr;
+            DeviceHeader = &Function->Config.Type0.Device;
+
+            if (EmitFormat() != EmitText) {
+                EmitObject(NULL);
+                EmitUint(L"bus", Function->Bus);
+                EmitUint(L"device", Function->Device);
+                EmitUint(L"function", Function->Function);
+                EmitHex(L"vendorId", PciHeader->VendorId, 4);
+                EmitHex(L"deviceId", PciHeader->DeviceId, 4);
+                EmitHex(L"subsystemVendorId", DeviceHeader->SubsystemVendorID, 4);
+                EmitHex(L"subsystemId", DeviceHeader->SubsystemID, 4);
+            } else {
+                OutPrint(L" %02d     %04x     %04x     %04x     %04x", 
+                         Function->Bus, PciHeader->VendorId, PciHeader->DeviceId,
+                         DeviceHeader->SubsystemVendorID, DeviceHeader->SubsystemID);
             }
 
-            Print(L"\n");
-            Print(L"Bus    Vendor   Device  Subvendor SVDevice\n");
-            Print(L"\n");
-
-            for ( UINT16 Bus = MinBus; Bus <= MaxBus; Bus++ ) {
-                for ( UINT16 Device = 0; Device <= PCI_MAX_DEVICE; Device++ ) {
-                    for ( UINT16 Func = 0; Func <= PCI_MAX_FUNC; Func++ ) {
-                        Address = CALC_EFI_PCI_ADDRESS( Bus, Device, Func, 0 );
-
-                        Status = IoDev->Pci.Read( IoDev,
-                                                  EfiPciWidthUint8,
-                                                  Address,
-                                                  sizeof(ConfigSpace),
-                                                  &ConfigSpace );
-
-                        DeviceHeader = (PCI_DEVICE_HEADER_TYPE_REGION *) &(ConfigSpace.NonCommon.Device);
-
-                        Status = IoDev->Pci.Read( IoDev,
-                                                  EfiPciWidthUint16,
-                                                  Address,
-                                                  1,
-                                                  &PciHeader.VendorId );
-
-                        if ( PciHeader.VendorId == 0xffff && Func == 0 ) {
-                            break;
-                        }
-
-                        if ( PciHeader.VendorId != 0xffff ) {
-                           Status = IoDev->Pci.Read( IoDev,
-                                                     EfiPciWidthUint32,
-                                                     Address,
-                                                     sizeof(PciHeader)/sizeof(UINT32),
-                                                     &PciHeader );
-
-                            Print(L" %02d     %04x     %04x     %04x     %04x", 
-                                  Bus, PciHeader.VendorId, PciHeader.DeviceId, 
-                                  DeviceHeader->SubsystemVendorID, DeviceHeader->SubsystemID);
-
-                            if (Verbose) {
-                                SearchPciData( InFileHandle, 
-                                               ReadLine, 
-                                               PciHeader.VendorId, 
-                                               PciHeader.DeviceId);
-                            }
-
-                            Print(L"\n");
-
-                            if ( Func == 0 && 
-                               ((PciHeader.HeaderType & HEADER_TYPE_MULTI_FUNCTION) == 0x00) ) {
-                               break;
-                            }
-                        }
-                    }
-                }
+            if (Verbose) {
+                SearchPciData( InFileHandle, 
+                               ReadLine, 
+                               PciHeader->VendorId, 
+                               PciHeader->DeviceId);
             }
 
-            if ( Descriptors == NULL ) {
-                break;
-            }
+            if (EmitFormat() != EmitText)
+                EmitClose();
+            else
+                OutPrint(L"\n");
         }
     }
 
-    Print(L"\n");
+    if (EmitFormat() == EmitText)
+        OutPrint(L"\n");
 
 Done:
-    if ( HandleBuf != NULL ) {
-        FreePool( HandleBuf );
-    }
     if ( Verbose ) {
         if ( ReadLine != NULL ) {
             FreePool( ReadLine );
@@ -18,6 +18,8 @@
 #include <Library/ShellLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -26,10 +28,11 @@
 #undef DEBUG
 
 
-VOID
+static VOID
 Usage( VOID )
 {
-    Print(L"Usage: ShowQVI [-V | --version]\n");
+    OutPrint(L"Usage: ShowQVI [--json | --csv] [-o | --output filename]\n");
+    OutPrint(L"       ShowQVI [-V | --version]\n");
 }
 
 
@@ -44,10 +47,13 @@ ShellAppMain( UINTN Argc,
     UINT64 RemainStoreSize = 0;
     UINT64 MaxVariableSize = 0;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--version") || 
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -64,6 +70,8 @@ ShellAppMain( UINTN Argc,
     }
 
 
+    EmitBegin(L"ShowQVI", UTILITY_VERSION);
+
     Attributes = EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
 
     Status = gRT->QueryVariableInfo( Attributes,
@@ -71,15 +79,22 @@ ShellAppMain( UINTN Argc,
                                      &RemainStoreSize,
                                      &MaxVariableSize );
     if (Status != EFI_SUCCESS) {
-        Print(L"ERROR: QueryVariableInfo: %d\n", Status);
+        EmitError(L"QueryVariableInfo: %d", Status);
+        return Status;
+    }
+
+    if (EmitFormat() != EmitText) {
+        EmitUint(L"maximumStorageSize", MaxStoreSize);
+        EmitUint(L"remainingStorageSize", RemainStoreSize);
+        EmitUint(L"maximumVariableSize", MaxVariableSize);
         return Status;
     }
 
-    Print(L"\n");
-    Print(L"    Maximum Variable Storage Size: 0x%016x [%ld]\n", MaxStoreSize, MaxStoreSize);
-    Print(L"  Remaining Variable Storage Size: 0x%016x [%ld]\n", RemainStoreSize, RemainStoreSize);
-    Print(L"            Maximum Variable Size: 0x%016x [%ld]\n", MaxVariableSize, MaxVariableSize);
-    Print(L"\n");
+    OutPrint(L"\n");
+    OutPrint(L"    Maximum Variable Storage Size: 0x%016x [%ld]\n", MaxStoreSize, MaxStoreSize);
+    OutPrint(L"  Remaining Variable Storage Size: 0x%016x [%ld]\n", RemainStoreSize, RemainStoreSize);
+    OutPrint(L"            Maximum Variable Size: 0x%016x [%ld]\n", MaxVariableSize, MaxVariableSize);
+    OutPrint(L"\n");
 
     return Status;
 }
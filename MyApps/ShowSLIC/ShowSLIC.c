@@ -14,6 +14,9 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
+#include <Library/PlatformIndexLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -85,44 +88,28 @@ AsciiToUnicodeSize( CHAR8 *String,
 
 
 
-static VOID
-PrintHexTable( UINT8 *ptr, 
-               int Count )
-{
-    int i = 0;
-
-    Print(L"  ");
-    for (i = 0; i < Count; i++ ) {
-        if ( i > 0 && i%16 == 0)
-            Print(L"\n  ");
-        Print(L"0x%02x ", 0xff & *ptr++);
-    }
-    Print(L"\n");
-}
-
-
 static VOID
 PrintAcpiHeader( EFI_ACPI_SDT_HEADER *Ptr )
 {
     CHAR16 Buffer[50];
 
-    Print(L"ACPI Standard Header\n");
+    OutPrint(L"ACPI Standard Header\n");
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->Signature), 4, Buffer, TRUE);
-    Print(L"  Signature         : %s\n", Buffer);
-    Print(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
-    Print(L"  Revision          : 0x%02x (%d)\n", Ptr->Revision, Ptr->Revision);
-    Print(L"  Checksum          : 0x%02x (%d)\n", Ptr->Checksum, Ptr->Checksum);
+    OutPrint(L"  Signature         : %s\n", Buffer);
+    OutPrint(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
+    OutPrint(L"  Revision          : 0x%02x (%d)\n", Ptr->Revision, Ptr->Revision);
+    OutPrint(L"  Checksum          : 0x%02x (%d)\n", Ptr->Checksum, Ptr->Checksum);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->OemId), 6, Buffer, TRUE);
-    Print(L"  OEM ID            : %s\n", Buffer);
+    OutPrint(L"  OEM ID            : %s\n", Buffer);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->OemTableId), 8, Buffer, TRUE);
-    Print(L"  OEM Table ID      : %s\n", Buffer);
-    Print(L"  OEM Revision      : 0x%08x (%d)\n", Ptr->OemRevision,
-                                                  Ptr->OemRevision);
+    OutPrint(L"  OEM Table ID      : %s\n", Buffer);
+    OutPrint(L"  OEM Revision      : 0x%08x (%d)\n", Ptr->OemRevision,
+                                                     Ptr->OemRevision);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->CreatorId), 4, Buffer, TRUE);
-    Print(L"  Creator ID        : %s\n", Buffer);
-    Print(L"  Creator Revision  : 0x%08x (%d)\n", Ptr->CreatorRevision, 
-                                                  Ptr->CreatorRevision);
-    Print(L"\n");
+    OutPrint(L"  Creator ID        : %s\n", Buffer);
+    OutPrint(L"  Creator Revision  : 0x%08x (%d)\n", Ptr->CreatorRevision, 
+                                                     Ptr->CreatorRevision);
+    OutPrint(L"\n");
 }
 
 
@@ -132,22 +119,22 @@ PrintOemPublicKey( OEM_PUBLIC_KEY *Ptr,
 {
     CHAR16 Buffer[50];
 
-    Print(L"OEM Public Key\n");
-    Print(L"  Type              : 0x%08x (%d)\n", Ptr->Type, Ptr->Type);
-    Print(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
-    Print(L"  KeyType           : 0x%02x (%d)\n", Ptr->KeyType, Ptr->KeyType);
-    Print(L"  Version           : 0x%02x (%d)\n", Ptr->Version, Ptr->Version);
-    Print(L"  Reserved          : 0x%04x (%d)\n", Ptr->Reserved, Ptr->Reserved);
-    Print(L"  Algorithm         : 0x%08x (%d)\n", Ptr->Algorithm, Ptr->Algorithm);
+    OutPrint(L"OEM Public Key\n");
+    OutPrint(L"  Type              : 0x%08x (%d)\n", Ptr->Type, Ptr->Type);
+    OutPrint(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
+    OutPrint(L"  KeyType           : 0x%02x (%d)\n", Ptr->KeyType, Ptr->KeyType);
+    OutPrint(L"  Version           : 0x%02x (%d)\n", Ptr->Version, Ptr->Version);
+    OutPrint(L"  Reserved          : 0x%04x (%d)\n", Ptr->Reserved, Ptr->Reserved);
+    OutPrint(L"  Algorithm         : 0x%08x (%d)\n", Ptr->Algorithm, Ptr->Algorithm);
     AsciiToUnicodeSize((CHAR8 *)&(Ptr->Magic), 4, Buffer, TRUE);
-    Print(L"  Magic             : %s\n", Buffer);
-    Print(L"  Bit Length        : 0x%08x (%d)\n", Ptr->BitLength, Ptr->BitLength);
-    Print(L"  Exponent          : 0x%08x (%d)\n", Ptr->Exponent, Ptr->Exponent);
+    OutPrint(L"  Magic             : %s\n", Buffer);
+    OutPrint(L"  Bit Length        : 0x%08x (%d)\n", Ptr->BitLength, Ptr->BitLength);
+    OutPrint(L"  Exponent          : 0x%08x (%d)\n", Ptr->Exponent, Ptr->Exponent);
     if (Verbose) {
-        Print(L"  Modulus:\n");
-        PrintHexTable( (UINT8 *)&(Ptr->Modulus), (int)(Ptr->BitLength)/8 );
+        OutPrint(L"  Modulus:\n");
+        OutHexDump( &(Ptr->Modulus), Ptr->BitLength/8, 0 );
     }
-    Print(L"\n");
+    OutPrint(L"\n");
 }
 
 
@@ -157,23 +144,75 @@ PrintWindowsMarker( WINDOWS_MARKER *Ptr,
 {
     CHAR16 Buffer[50];
 
-    Print(L"Windows Marker\n");
-    Print(L"  Type              : 0x%08x (%d)\n", Ptr->Type, Ptr->Type);
-    Print(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
-    Print(L"  Version           : 0x%02x (%d)\n", Ptr->Version, Ptr->Version);
+    OutPrint(L"Windows Marker\n");
+    OutPrint(L"  Type              : 0x%08x (%d)\n", Ptr->Type, Ptr->Type);
+    OutPrint(L"  Length            : 0x%08x (%d)\n", Ptr->Length, Ptr->Length);
+    OutPrint(L"  Version           : 0x%02x (%d)\n", Ptr->Version, Ptr->Version);
     AsciiToUnicodeSize((CHAR8 *)(Ptr->OemId), 6, Buffer, TRUE);
-    Print(L"  OEM ID            : %s\n", Buffer);
+    OutPrint(L"  OEM ID            : %s\n", Buffer);
     AsciiToUnicodeSize((CHAR8 *)(Ptr->OemTableId), 8, Buffer, TRUE);
-    Print(L"  OEM Table ID      : %s\n", Buffer);
+    OutPrint(L"  OEM Table ID      : %s\n", Buffer);
     AsciiToUnicodeSize((CHAR8 *)(Ptr->Product), 8, Buffer, TRUE);
-    Print(L"  Windows Flag      : %s\n", Buffer);
-    Print(L"  SLIC Version      : 0x%04x%04x (%d.%d)\n", Ptr->MajorVersion, Ptr->MinorVersion,
-                                                         Ptr->MajorVersion, Ptr->MinorVersion);
+    OutPrint(L"  Windows Flag      : %s\n", Buffer);
+    OutPrint(L"  SLIC Version      : 0x%04x%04x (%d.%d)\n", Ptr->MajorVersion, Ptr->MinorVersion,
+                                                            Ptr->MajorVersion, Ptr->MinorVersion);
     if (Verbose) {
-        Print(L"  Signature:\n");
-        PrintHexTable( (UINT8 *)&(Ptr->Signature), 144 );   // 144 - Fix up in next version
+        OutPrint(L"  Signature:\n");
+        OutHexDump( &(Ptr->Signature), 144, 0 );   // 144 - Fix up in next version
     }
-    Print(L"\n");
+    OutPrint(L"\n");
+}
+
+
+static VOID
+EmitSLIC( EFI_ACPI_SLIC *Slic,
+          int Verbose )
+{
+    EFI_ACPI_SDT_HEADER *Header = (EFI_ACPI_SDT_HEADER *)&(Slic->Header);
+    OEM_PUBLIC_KEY *PubKey = &(Slic->PubKey);
+    WINDOWS_MARKER *Marker = &(Slic->Marker);
+
+    EmitObject(L"slic");
+
+    EmitObject(L"header");
+    EmitAscii(L"signature", (CHAR8 *)&(Header->Signature), 4);
+    EmitUint(L"length", Header->Length);
+    EmitUint(L"revision", Header->Revision);
+    EmitHex(L"checksum", Header->Checksum, 2);
+    EmitAscii(L"oemId", (CHAR8 *)&(Header->OemId), 6);
+    EmitAscii(L"oemTableId", (CHAR8 *)&(Header->OemTableId), 8);
+    EmitHex(L"oemRevision", Header->OemRevision, 8);
+    EmitAscii(L"creatorId", (CHAR8 *)&(Header->CreatorId), 4);
+    EmitHex(L"creatorRevision", Header->CreatorRevision, 8);
+    EmitClose();
+
+    EmitObject(L"publicKey");
+    EmitUint(L"type", PubKey->Type);
+    EmitUint(L"length", PubKey->Length);
+    EmitUint(L"keyType", PubKey->KeyType);
+    EmitUint(L"version", PubKey->Version);
+    EmitHex(L"algorithm", PubKey->Algorithm, 8);
+    EmitAscii(L"magic", (CHAR8 *)&(PubKey->Magic), 4);
+    EmitUint(L"bitLength", PubKey->BitLength);
+    EmitUint(L"exponent", PubKey->Exponent);
+    if (Verbose)
+        EmitBytes(L"modulus", PubKey->Modulus, MIN(PubKey->BitLength/8, sizeof(PubKey->Modulus)));
+    EmitClose();
+
+    EmitObject(L"marker");
+    EmitUint(L"type", Marker->Type);
+    EmitUint(L"length", Marker->Length);
+    EmitUint(L"version", Marker->Version);
+    EmitAscii(L"oemId", (CHAR8 *)(Marker->OemId), 6);
+    EmitAscii(L"oemTableId", (CHAR8 *)(Marker->OemTableId), 8);
+    EmitAscii(L"windowsFlag", (CHAR8 *)(Marker->Product), 8);
+    EmitUint(L"majorVersion", Marker->MajorVersion);
+    EmitUint(L"minorVersion", Marker->MinorVersion);
+    if (Verbose)
+        EmitBytes(L"signature", Marker->Signature, sizeof(Marker->Signature));
+    EmitClose();
+
+    EmitClose();
 }
 
 
@@ -181,7 +220,12 @@ static VOID
 PrintSLIC( EFI_ACPI_SLIC *Slic, 
            int Verbose )
 {
-    Print(L"\n");
+    if (EmitFormat() != EmitText) {
+        EmitSLIC(Slic, Verbose);
+        return;
+    }
+
+    OutPrint(L"\n");
     PrintAcpiHeader( (EFI_ACPI_SDT_HEADER *)&(Slic->Header) );
     PrintOemPublicKey( (OEM_PUBLIC_KEY *)&(Slic->PubKey), Verbose );
     PrintWindowsMarker( (WINDOWS_MARKER *)&(Slic->Marker), Verbose );
@@ -189,50 +233,48 @@ PrintSLIC( EFI_ACPI_SLIC *Slic,
 
 
 static int
-ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp, 
-           CHAR16* GuidStr, 
+ParseRSDP( CONST ACPI_ROOT *Root,
            int Verbose )
 {
+    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = Root->Rsdp;
     EFI_ACPI_SDT_HEADER *Xsdt, *Entry;
     UINT32 EntryCount;
-    UINT64 *EntryPtr;
 
 #ifdef DEBUG 
     CHAR16 OemStr[20];
 
-    Print(L"\n\nACPI GUID: %s\n", GuidStr);
+    OutPrint(L"\n\nACPI GUID: %g\n", Root->Guid);
 
     AsciiToUnicodeSize((CHAR8 *)(Rsdp->OemId), 6, OemStr, FALSE);
-    Print(L"\nFound RSDP. Version: %d  OEM ID: %s\n", (int)(Rsdp->Revision), OemStr);
+    OutPrint(L"\nFound RSDP. Version: %d  OEM ID: %s\n", (int)(Rsdp->Revision), OemStr);
 #endif
 
     if (Rsdp->Revision >= EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER_REVISION) {
-        Xsdt = (EFI_ACPI_SDT_HEADER *)(Rsdp->XsdtAddress);
+        Xsdt = Root->Xsdt;
     } else {
 #ifdef DEBUG 
-        Print(L"ERROR: No ACPI XSDT table found.\n");
+        OutPrint(L"ERROR: No ACPI XSDT table found.\n");
 #endif
         return 1;
     }
 
     if (Xsdt->Signature != SIGNATURE_32 ('X', 'S', 'D', 'T')) {
 #ifdef DEBUG 
-        Print(L"ERROR: Invalid ACPI XSDT table found.\n");
+        OutPrint(L"ERROR: Invalid ACPI XSDT table found.\n");
 #endif
         return 1;
     }
 
-    EntryCount = (Xsdt->Length - sizeof (EFI_ACPI_SDT_HEADER)) / sizeof(UINT64);
+    EntryCount = (UINT32)Root->TableCount;
 #ifdef DEBUG 
     AsciiToUnicodeSize((CHAR8 *)(Xsdt->OemId), 6, OemStr, FALSE);
-    Print(L"Found XSDT. OEM ID: %s  Entry Count: %d\n\n", OemStr, EntryCount);
+    OutPrint(L"Found XSDT. OEM ID: %s  Entry Count: %d\n\n", OemStr, EntryCount);
 #endif
 
-    EntryPtr = (UINT64 *)(Xsdt + 1);
-    for (int Index = 0; Index < EntryCount; Index++, EntryPtr++) {
-        Entry = (EFI_ACPI_SDT_HEADER *)((UINTN)(*EntryPtr));
+    for (UINTN Index = 0; Index < EntryCount; Index++) {
+        Entry = Root->Tables[Index];
         if (Entry->Signature == SIGNATURE_32 ('S', 'L', 'I', 'C')) {
-            PrintSLIC((EFI_ACPI_SLIC *)((UINTN)(*EntryPtr)), Verbose);
+            PrintSLIC((EFI_ACPI_SLIC *)Entry, Verbose);
         }
     }
 
@@ -243,8 +285,8 @@ ParseRSDP( EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp,
 static void
 Usage( void )
 {
-    Print(L"Usage: ShowSLIC [-v | --verbose]\n");
-    Print(L"       ShowSLIC [-V | --version]\n");
+    OutPrint(L"Usage: ShowSLIC [-v | --verbose] [--json | --csv] [-o | --output filename]\n");
+    OutPrint(L"       ShowSLIC [-V | --version]\n");
 }
 
 
@@ -253,14 +295,11 @@ EFIAPI
 ShellAppMain( UINTN Argc,
               CHAR16 **Argv )
 {
-    EFI_CONFIGURATION_TABLE *ect = gST->ConfigurationTable;
-    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *Rsdp = NULL;
-    EFI_GUID gAcpi20TableGuid = EFI_ACPI_20_TABLE_GUID;
-    EFI_GUID gAcpi10TableGuid = ACPI_10_TABLE_GUID;
     EFI_STATUS Status = EFI_SUCCESS;
-    CHAR16 GuidStr[100];
     int Verbose = 0;
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
 
     if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--verbose") ||
@@ -268,7 +307,7 @@ ShellAppMain( UINTN Argc,
             Verbose = 1;
         } else if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
             return Status;
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
@@ -284,22 +323,18 @@ ShellAppMain( UINTN Argc,
         return Status;
     }
 
+    EmitBegin(L"ShowSLIC", UTILITY_VERSION);
 
     // locate RSDP (Root System Description Pointer) 
-    for (int i = 0; i < gST->NumberOfTableEntries; i++) {
-        if ((CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi20TableGuid)) ||
-            (CompareGuid (&(gST->ConfigurationTable[i].VendorGuid), &gAcpi10TableGuid))) {
-            if (!AsciiStrnCmp("RSD PTR ", (CHAR8 *)(ect->VendorTable), 8)) {
-                UnicodeSPrint(GuidStr, sizeof(GuidStr), L"%g", &(gST->ConfigurationTable[i].VendorGuid));
-                Rsdp = (EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER *)ect->VendorTable;
-                ParseRSDP(Rsdp, GuidStr, Verbose); 
-            }        
+    for (UINTN i = 0; i < AcpiRootCount(); i++) {
+        if (ParseRSDP(AcpiGetRoot(i), Verbose) == 0 &&
+            EmitFormat() != EmitText) {
+            break;
         }
-        ect++;
     }
 
-    if (Rsdp == NULL) {
-        Print(L"ERROR: Could not find an ACPI RSDP table.\n");
+    if (AcpiRootCount() == 0) {
+        EmitError(L"Could not find an ACPI RSDP table.");
         Status = EFI_NOT_FOUND;
     }
 
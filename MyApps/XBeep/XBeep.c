@@ -16,6 +16,8 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PrintLib.h>
 #include <Library/IoLib.h>
+#include <Library/OutputLib.h>
+#include <Library/EmitLib.h>
 
 #include <Protocol/EfiShell.h>
 #include <Protocol/LoadedImage.h>
@@ -101,7 +103,7 @@ IsDecNumber( CHAR16* str )
 }
 
 
-EFI_STATUS
+static EFI_STATUS
 TurnOnSpeaker( VOID )
 {
     UINT8 Data;
@@ -114,7 +116,7 @@ TurnOnSpeaker( VOID )
 }
 
 
-EFI_STATUS
+static EFI_STATUS
 TurnOffSpeaker( VOID )
 {
     UINT8 Data;
@@ -239,26 +241,38 @@ ComplexBeep( UINTN NumBeeps,
 VOID
 PrintDefaults( VOID )
 {
-    Print(L"\n");
-    Print(L"                   Default beep count: %d\n",   EFI_DEFAULT_BEEP_NUMBER ); 
-    Print(L"            Default beep enabled time: 0x%x\n", EFI_DEFAULT_BEEP_ON_TIME ); 
-    Print(L"           Default beep disabled time: 0x%x\n", EFI_DEFAULT_BEEP_OFF_TIME );
-    Print(L"               Default beep frequency: 0x%x\n", EFI_DEFAULT_BEEP_FREQUENCY );
-    Print(L"   Default beep alternative frequency: 0x%x\n", EFI_DEFAULT_BEEP_ALTFREQUENCY );
-    Print(L"\n");
+    if (EmitFormat() != EmitText) {
+        EmitObject(L"defaults");
+        EmitUint(L"beeps", EFI_DEFAULT_BEEP_NUMBER);
+        EmitHex(L"duration", EFI_DEFAULT_BEEP_ON_TIME, 1);
+        EmitHex(L"interval", EFI_DEFAULT_BEEP_OFF_TIME, 1);
+        EmitHex(L"frequency", EFI_DEFAULT_BEEP_FREQUENCY, 1);
+        EmitHex(L"altFrequency", EFI_DEFAULT_BEEP_ALTFREQUENCY, 1);
+        EmitClose();
+        return;
+    }
+
+    OutPrint(L"\n");
+    OutPrint(L"                   Default beep count: %d\n",   EFI_DEFAULT_BEEP_NUMBER ); 
+    OutPrint(L"            Default beep enabled time: 0x%x\n", EFI_DEFAULT_BEEP_ON_TIME ); 
+    OutPrint(L"           Default beep disabled time: 0x%x\n", EFI_DEFAULT_BEEP_OFF_TIME );
+    OutPrint(L"               Default beep frequency: 0x%x\n", EFI_DEFAULT_BEEP_FREQUENCY );
+    OutPrint(L"   Default beep alternative frequency: 0x%x\n", EFI_DEFAULT_BEEP_ALTFREQUENCY );
+    OutPrint(L"\n");
 }
 
 
-VOID
+static VOID
 Usage( BOOLEAN ErrorMsg )
 {
     if ( ErrorMsg ) {
-        Print(L"ERROR: Unknown option(s).\n");
+        OutPrint(L"ERROR: Unknown option(s).\n");
     }
-    Print(L"Usage: XBeep [-T] [-n number ] [-d duration] [-i interavl] [-f frequency] [-a altfreq]\n");
-    Print(L"       XBeep -D | --defaults\n");
-    Print(L"       XBeep -T | --twotone\n");
-    Print(L"       XBeep -V | --version\n");
+    OutPrint(L"Usage: XBeep [-T] [-n number ] [-d duration] [-i interavl] [-f frequency] [-a altfreq]\n");
+    OutPrint(L"       XBeep -D | --defaults\n");
+    OutPrint(L"       XBeep -T | --twotone\n");
+    OutPrint(L"       XBeep -V | --version\n");
+    OutPrint(L"       [--json | --csv] [-o | --output filename] may be added to any of these\n");
 }
 
 
@@ -278,13 +292,18 @@ ShellAppMain( UINTN Argc,
     UINT32 Val = 0;
 #endif
 
+    if (EFI_ERROR(EmitParseArgs(&Argc, Argv)))
+        return EFI_INVALID_PARAMETER;
+
+    EmitBegin(L"XBeep", UTILITY_VERSION);
+
     if (Argc == 1) {
        SimpleBeep(FALSE);
        return Status;
     } else if (Argc == 2) {
         if (!StrCmp(Argv[1], L"--version") ||
             !StrCmp(Argv[1], L"-V")) {
-            Print(L"Version: %s\n", UTILITY_VERSION);
+            OutPrint(L"Version: %s\n", UTILITY_VERSION);
         } else if (!StrCmp(Argv[1], L"--help") ||
             !StrCmp(Argv[1], L"-h")) {
             Usage(FALSE);
@@ -299,7 +318,7 @@ ShellAppMain( UINTN Argc,
 #ifdef DEBUG
         } else if (!StrCmp(Argv[1], L"-R")) {      // undocumented experimental option
             Val = ReadCounter(2);
-            Print(L"Timer 3 count value: %d %x\n", Val, Val);
+            OutPrint(L"Timer 3 count value: %d %x\n", Val, Val);
             return Status;
 #endif
         } else {
@@ -314,12 +333,12 @@ ShellAppMain( UINTN Argc,
                i++;
                NumBeeps = (UINTN) StrDecimalToUint64( Argv[i] );            
                if (NumBeeps < 1) {
-                   Print(L"ERROR: Invalid number of beeps entered.\n");               
+                   EmitError(L"Invalid number of beeps entered.");               
                    Usage(FALSE);
                    return Status;
                }
             } else {
-                Print(L"ERROR: Invalid or missing argument to option.\n");               
+                EmitError(L"Invalid or missing argument to option.");               
                 Usage(FALSE);
                 return Status;
             }
@@ -328,12 +347,12 @@ ShellAppMain( UINTN Argc,
                i++;
                Duration = (UINTN) StrHexToUint64( Argv[i] );            
                if (Duration < 1) {
-                   Print(L"ERROR: Invalid duration entered.\n");               
+                   EmitError(L"Invalid duration entered.");               
                    Usage(FALSE);
                    return Status;
                }
             } else {
-                Print(L"ERROR: Invalid or missing argument to option.\n");               
+                EmitError(L"Invalid or missing argument to option.");               
                 Usage(FALSE);
                 return Status;
             }
@@ -342,12 +361,12 @@ ShellAppMain( UINTN Argc,
                i++;
                Interval = (UINTN) StrHexToUint64( Argv[i] );            
                if (Interval < 1) {
-                   Print(L"ERROR: Invalid interval entered.\n");               
+                   EmitError(L"Invalid interval entered.");               
                    Usage(FALSE);
                    return Status;
                }
             } else {
-                Print(L"ERROR: Invalid or missing argument to option.\n");               
+                EmitError(L"Invalid or missing argument to option.");               
                 Usage(FALSE);
                 return Status;
             }
@@ -356,12 +375,12 @@ ShellAppMain( UINTN Argc,
                i++;
                Frequency = (UINTN) StrHexToUint64( Argv[i] );            
                if (Frequency < 1) {
-                   Print(L"ERROR: Invalid frequency entered.\n");               
+                   EmitError(L"Invalid frequency entered.");               
                    Usage(FALSE);
                    return Status;
                }
             } else {
-                Print(L"ERROR: Invalid or missing argument to option.\n");               
+                EmitError(L"Invalid or missing argument to option.");               
                 Usage(FALSE);
                 return Status;
             }
@@ -370,12 +389,12 @@ ShellAppMain( UINTN Argc,
                i++;
                AltFreq = (UINTN) StrHexToUint64( Argv[i] );            
                if (AltFreq < 1) {
-                   Print(L"ERROR: Invalid alternative frequency entered.\n");               
+                   EmitError(L"Invalid alternative frequency entered.");               
                    Usage(FALSE);
                    return Status;
                }
             } else {
-                Print(L"ERROR: Invalid or missing argument to option.\n");               
+                EmitError(L"Invalid or missing argument to option.");               
                 Usage(FALSE);
                 return Status;
             }
@@ -390,5 +409,12 @@ ShellAppMain( UINTN Argc,
 
     Status = ComplexBeep( NumBeeps, Duration, Interval, Frequency, AltFreq, TwoTone );
 
+    EmitUint(L"beeps", NumBeeps);
+    EmitHex(L"duration", Duration, 1);
+    EmitHex(L"interval", Interval, 1);
+    EmitHex(L"frequency", Frequency, 1);
+    EmitHex(L"altFrequency", AltFreq, 1);
+    EmitBool(L"twoTone", TwoTone);
+
     return Status;
 }